@@ -0,0 +1,75 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*  Cryptarithmetic: solve SEND+MORE=MONEY by column-wise search with
+    carries, selecting digits from a shrinking list.
+*/
+
+:- module(bench_crypt, [top/0]).
+
+top :-
+    findall([S,E,N,D,M,O,R,Y], sendmore([S,E,N,D,M,O,R,Y]), L),
+    L == [[9,5,6,7,1,0,8,2]].
+
+sendmore([S,E,N,D,M,O,R,Y]) :-
+    Digits = [0,1,2,3,4,5,6,7,8,9],
+    sel(D, Digits, D1),
+    sel(E, D1, D2),
+    sum_digit(D, E, 0, Y, C1, D2, D3),
+    sel(N, D3, D4),
+    sel(R, D4, D5),
+    sum_digit(N, R, C1, E, C2, D5, D6),
+    sel(O, D6, D7),
+    sum_digit(E, O, C2, N, C3, D7, D8),
+    sel(S, D8, D9),
+    S > 0,
+    sel(M, D9, _),
+    M > 0,
+    sum_digit(S, M, C3, O, M, [], _).
+
+% sum_digit(+A, +B, +CarryIn, ?Digit, -CarryOut, +Free, -Free)
+sum_digit(A, B, C0, Digit, C, Free0, Free) :-
+    Sum is A+B+C0,
+    Digit0 is Sum mod 10,
+    C is Sum // 10,
+    (   var(Digit)
+    ->  sel(Digit, Free0, Free),
+        Digit =:= Digit0
+    ;   Digit =:= Digit0,
+        Free = Free0
+    ).
+
+sel(X, [X|T], T).
+sel(X, [H|T], [H|R]) :-
+    sel(X, T, R).
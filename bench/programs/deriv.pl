@@ -0,0 +1,71 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*  Symbolic differentiation of a set of expressions.
+*/
+
+:- module(bench_deriv, [top/0]).
+
+top :-
+    forall(expr(E), (d(E, x, D), ground(D))).
+
+expr((x+1)*((x^2+2)*(x^3+3))).
+expr(((((((((x/x)/x)/x)/x)/x)/x)/x)/x)/x).
+expr(log(log(log(log(log(log(log(log(log(log(x))))))))))).
+expr(x*x*x*x*x*x*x*x*x*x).
+
+d(U+V, X, DU+DV) :- !,
+    d(U, X, DU),
+    d(V, X, DV).
+d(U-V, X, DU-DV) :- !,
+    d(U, X, DU),
+    d(V, X, DV).
+d(U*V, X, DU*V+U*DV) :- !,
+    d(U, X, DU),
+    d(V, X, DV).
+d(U/V, X, (DU*V-U*DV)/(^(V,2))) :- !,
+    d(U, X, DU),
+    d(V, X, DV).
+d(^(U,N), X, DU*N*(^(U,N1))) :- !,
+    integer(N),
+    N1 is N-1,
+    d(U, X, DU).
+d(-U, X, -DU) :- !,
+    d(U, X, DU).
+d(exp(U), X, exp(U)*DU) :- !,
+    d(U, X, DU).
+d(log(U), X, DU/U) :- !,
+    d(U, X, DU).
+d(X, X, 1) :- !.
+d(_, _, 0).
@@ -0,0 +1,91 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*  Parse English sentences with a small ambiguous DCG grammar and
+    build parse trees.  Exercises backtracking over grammar rules and
+    term construction, as the classic chat_parser benchmark.
+*/
+
+:- module(bench_parser, [top/0]).
+
+top :-
+    forall(sentence(S),
+           ( findall(T, phrase(s(T), S), Ts),
+             Ts \== []
+           )).
+
+sentence([the,man,saw,the,woman,with,the,telescope,in,the,park]).
+sentence([a,dog,that,the,cat,chased,bit,the,man,on,the,hill]).
+sentence([the,old,man,gave,the,young,woman,a,book,about,the,city]).
+sentence([every,student,who,read,a,book,in,the,library,saw,the,teacher]).
+sentence([the,woman,in,the,house,near,the,river,saw,a,big,old,dog]).
+
+s(s(NP,VP)) --> np(NP), vp(VP).
+
+np(np(D,N,Ms)) --> det(D), adjs(As), noun(N0), { attach(As, N0, N) }, mods(Ms).
+
+adjs([A|As]) --> adj(A), adjs(As).
+adjs([]) --> [].
+
+attach([], N, N).
+attach([A|As], N0, adj(A,N)) :- attach(As, N0, N).
+
+mods([M|Ms]) --> pp(M), mods(Ms).
+mods([rel(VP)]) --> [that], vp(VP).
+mods([rel(NP,V)]) --> rel_pron, np(NP), verb(V).
+mods([rel(VP)]) --> rel_pron, vp(VP).
+mods([]) --> [].
+
+rel_pron --> [who].
+rel_pron --> [that].
+
+vp(vp(V,NP1,NP2,Ms)) --> verb(V), np(NP1), np(NP2), mods(Ms).
+vp(vp(V,NP,Ms)) --> verb(V), np(NP), mods(Ms).
+vp(vp(V)) --> verb(V).
+
+pp(pp(P,NP)) --> prep(P), np(NP).
+
+det(D) --> [D], { det(D) }.
+adj(A) --> [A], { adj(A) }.
+noun(N) --> [N], { noun(N) }.
+verb(V) --> [V], { verb(V) }.
+prep(P) --> [P], { prep(P) }.
+
+det(the). det(a). det(every).
+adj(old). adj(young). adj(big).
+noun(man). noun(woman). noun(telescope). noun(park). noun(dog).
+noun(cat). noun(hill). noun(book). noun(city). noun(student).
+noun(library). noun(teacher). noun(house). noun(river).
+verb(saw). verb(chased). verb(bit). verb(gave). verb(read).
+prep(with). prep(in). prep(on). prep(about). prep(near).
@@ -0,0 +1,69 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*  Read Prolog terms from a text held in memory.
+*/
+
+:- module(bench_read_term, [top/0]).
+
+top :-
+    text(Text),
+    setup_call_cleanup(
+        open_string(Text, In),
+        read_all(In, 0, Count),
+        close(In)),
+    Count == 500.
+
+read_all(In, N0, N) :-
+    read_term(In, T, []),
+    (   T == end_of_file
+    ->  N = N0
+    ;   N1 is N0+1,
+        read_all(In, N1, N)
+    ).
+
+:- dynamic
+    text_cache/1.
+
+text(Text) :-
+    text_cache(Text),
+    !.
+text(Text) :-
+    with_output_to(
+        string(Text),
+        forall(between(1, 500, I),
+               portray_clause(( p(I, [a,b,c], "string", 3.14, f(X,Y,_)) :-
+                                    q(X, Y), X > Y, \+ r(X, 'Quoted atom')
+                              )))),
+    assertz(text_cache(Text)).
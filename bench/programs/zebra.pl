@@ -0,0 +1,72 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*  The zebra puzzle: who owns the zebra and who drinks water?
+*/
+
+:- module(bench_zebra, [top/0]).
+
+top :-
+    houses(Hs),
+    member(h(_,Zebra,_,_,zebra), Hs),
+    member(h(_,Water,water,_,_), Hs),
+    Zebra == japanese,
+    Water == norwegian,
+    !.
+
+houses(Hs) :-
+    Hs = [h(_,norwegian,_,_,_),_,h(_,_,milk,_,_),_,_],
+    member(h(red,english,_,_,_), Hs),
+    member(h(_,spanish,_,_,dog), Hs),
+    member(h(green,_,coffee,_,_), Hs),
+    member(h(_,ukrainian,tea,_,_), Hs),
+    right_of(h(green,_,_,_,_), h(ivory,_,_,_,_), Hs),
+    member(h(_,_,_,oldgold,snails), Hs),
+    member(h(yellow,_,_,kools,_), Hs),
+    next_to(h(_,_,_,chesterfield,_), h(_,_,_,_,fox), Hs),
+    next_to(h(_,_,_,kools,_), h(_,_,_,_,horse), Hs),
+    member(h(_,_,orange_juice,lucky,_), Hs),
+    member(h(_,japanese,_,parliament,_), Hs),
+    next_to(h(_,norwegian,_,_,_), h(blue,_,_,_,_), Hs),
+    member(h(_,_,water,_,_), Hs),
+    member(h(_,_,_,_,zebra), Hs).
+
+right_of(A, B, [B,A|_]).
+right_of(A, B, [_|Y]) :-
+    right_of(A, B, Y).
+
+next_to(A, B, [A,B|_]).
+next_to(A, B, [B,A|_]).
+next_to(A, B, [_|Y]) :-
+    next_to(A, B, Y).
@@ -0,0 +1,372 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(bench,
+          [ run/0,
+            run/1                       % +Options
+          ]).
+:- use_module(library(main)).
+:- use_module(library(lists)).
+:- use_module(library(apply)).
+:- use_module(library(option)).
+:- use_module(library(readutil)).
+
+:- initialization(main, main).
+
+/** <module> Run the SWI-Prolog benchmark suite
+
+Each file in the directory `programs` is a module that exports top/0.
+This file loads the programs, runs each of them repeatedly and prints a
+term
+
+    bench(Program, [iterations(N), time(CPU), wall(Wall), ...])
+
+per program on standard output.  The number of iterations is chosen
+such that each program runs for about `--time` seconds.  Results may be
+saved to a file and compared against a saved baseline, in which case
+the iteration counts of the baseline are reused.  Usage:
+
+    swipl bench/run.pl -- [option ...] [program ...]
+
+Options:
+
+  - --time=Seconds
+    Target CPU time per program (default 1).
+  - --format=prolog|csv
+    Output format on standard output.
+  - --save=File
+    Save the results as Prolog terms to File.
+  - --baseline=File
+    Compare against results saved using `--save`.  Ignored, except for
+    a warning, if File does not exist.
+  - --threshold=Fraction
+    Exit with status 1 if a program is more than Fraction slower than
+    in the baseline.
+
+Peak memory is the high-water mark of the resident set size while
+running the program.  It is only reported on systems that provide
+`/proc/self/status`.
+*/
+
+main(Argv) :-
+    argv_options(Argv, Programs, Options),
+    (   option(help(true), Options)
+    ->  usage
+    ;   run([programs(Programs)|Options])
+    ).
+
+usage :-
+    format(user_error,
+           'Usage: swipl run.pl -- [option ...] [program ...]~n~n', []),
+    format(user_error, 'Options:~n', []),
+    forall(opt_help(Opt, Help),
+           format(user_error, '  ~w~t~26|~w~n', [Opt, Help])).
+
+opt_help('--time=Seconds',     'Target CPU time per program').
+opt_help('--format=Format',    'One of prolog (default) or csv').
+opt_help('--save=File',        'Save results to File').
+opt_help('--baseline=File',    'Compare against saved results').
+opt_help('--threshold=Frac',   'Fail if a program slows down more than Frac').
+
+%!  run is det.
+%!  run(+Options) is det.
+%
+%   Run the benchmark suite.  See the module header for the options.
+%   In addition, programs(List) selects the programs to run.  If the
+%   threshold is exceeded, run/1 halts the process with status 1.
+
+run :-
+    run([]).
+
+run(Options) :-
+    option(baseline(BaseFile), Options, -),
+    load_baseline(BaseFile, Baseline),
+    selected_programs(Options, Programs),
+    option(format(Format), Options, prolog),
+    header(Format),
+    maplist(run_program(Baseline, Options), Programs, Results),
+    save_results(Options, Results),
+    compare_results(Baseline, Results, Options).
+
+%!  selected_programs(+Options, -Programs) is det.
+
+selected_programs(Options, Programs) :-
+    option(programs(Programs0), Options, []),
+    Programs0 \== [],
+    !,
+    maplist(to_atom, Programs0, Programs).
+selected_programs(_, Programs) :-
+    programs_dir(Dir),
+    atom_concat(Dir, '/*.pl', Pattern),
+    expand_file_name(Pattern, Files),
+    findall(Name,
+            ( member(File, Files),
+              file_base_name(File, Base),
+              file_name_extension(Name, pl, Base),
+              can_run(Name)
+            ),
+            Programs).
+
+to_atom(Name, Atom) :-
+    atom_string(Atom, Name).
+
+can_run(queues) :-
+    !,
+    current_prolog_flag(threads, true).
+can_run(_).
+
+:- prolog_load_context(directory, Dir),
+   atom_concat(Dir, '/programs', ProgDir),
+   asserta(programs_dir(ProgDir)).
+
+%!  run_program(+Baseline, +Options, +Name, -Result) is det.
+%
+%   Load and run the program Name.  Result is a term bench(Name, Props).
+
+run_program(Baseline, Options, Name, bench(Name, Props)) :-
+    programs_dir(Dir),
+    atomic_list_concat([Dir, /, Name, '.pl'], File),
+    load_files(File, [if(not_loaded), imports([]), silent(true)]),
+    atom_concat(bench_, Name, Module),
+    Goal = Module:top,
+    (   memberchk(bench(Name, Old), Baseline),
+        option(iterations(N), Old)
+    ->  true
+    ;   calibrate(Goal, Options, N)
+    ),
+    measure(Goal, N, Props),
+    option(format(Format), Options, prolog),
+    print_result(Format, bench(Name, Props)).
+
+%!  calibrate(:Goal, +Options, -Iterations) is det.
+%
+%   Determine the number of iterations for Goal to use about the target
+%   time.  The first run loads code on demand and is not counted.
+
+calibrate(Goal, Options, N) :-
+    option(time(Target), Options, 1),
+    run_n(1, Goal),
+    calibrate(Goal, 1, Target, N).
+
+calibrate(Goal, N0, Target, N) :-
+    statistics(process_cputime, T0),
+    run_n(N0, Goal),
+    statistics(process_cputime, T1),
+    T is T1-T0,
+    (   T > 0.1
+    ->  N is max(1, round(N0*Target/T))
+    ;   N1 is N0*4,
+        calibrate(Goal, N1, Target, N)
+    ).
+
+%!  measure(:Goal, +Iterations, -Props) is det.
+
+measure(Goal, N, Props) :-
+    garbage_collect,
+    garbage_collect_atoms,
+    reset_peak_memory,
+    statistics(collections, GC0),
+    statistics(agc, AGC0),
+    statistics(inferences, I0),
+    get_time(W0),
+    statistics(process_cputime, T0),
+    run_n(N, Goal),
+    statistics(process_cputime, T1),
+    get_time(W1),
+    statistics(inferences, I1),
+    statistics(agc, AGC1),
+    statistics(collections, GC1),
+    Time is T1-T0,
+    Wall is W1-W0,
+    Inferences is I1-I0,
+    (   Time > 0
+    ->  LIPS is round(Inferences/Time)
+    ;   LIPS = 0
+    ),
+    GC is GC1-GC0,
+    AGC is AGC1-AGC0,
+    Props0 = [ iterations(N),
+               time(Time),
+               wall(Wall),
+               inferences(Inferences),
+               lips(LIPS),
+               gc(GC),
+               agc(AGC)
+             ],
+    (   peak_memory(Peak)
+    ->  append(Props0, [peak_memory(Peak)], Props)
+    ;   Props = Props0
+    ).
+
+run_n(N, Goal) :-
+    (   between(1, N, _),
+        \+ Goal
+    ->  throw(error(goal_failed(Goal), _))
+    ;   true
+    ).
+
+%!  reset_peak_memory is det.
+%!  peak_memory(-Bytes) is semidet.
+%
+%   Reset and read the peak resident set size.  Writing `5` to
+%   `/proc/self/clear_refs` resets `VmHWM` on Linux.
+
+reset_peak_memory :-
+    catch(setup_call_cleanup(
+              open('/proc/self/clear_refs', write, Out),
+              format(Out, '5~n', []),
+              close(Out)),
+          _, true).
+
+peak_memory(Bytes) :-
+    catch(setup_call_cleanup(
+              open('/proc/self/status', read, In),
+              hwm(In, KB),
+              close(In)),
+          _, fail),
+    Bytes is KB*1024.
+
+hwm(In, KB) :-
+    read_line_to_string(In, Line),
+    Line \== end_of_file,
+    (   split_string(Line, ":", " \t", ["VmHWM", Value])
+    ->  split_string(Value, " ", "", [KBS|_]),
+        number_string(KB, KBS)
+    ;   hwm(In, KB)
+    ).
+
+		 /*******************************
+		 *             OUTPUT		*
+		 *******************************/
+
+header(csv) :-
+    !,
+    format('program,iterations,time,wall,inferences,lips,gc,agc,peak_memory~n').
+header(_).
+
+print_result(csv, bench(Name, Props)) :-
+    !,
+    findall(V,
+            ( member(K, [iterations,time,wall,inferences,lips,gc,agc,
+                         peak_memory]),
+              Opt =.. [K,V0],
+              (   option(Opt, Props)
+              ->  V = V0
+              ;   V = ''
+              )
+            ),
+            Values),
+    atomic_list_concat([Name|Values], ',', Line),
+    format('~w~n', [Line]).
+print_result(_, Result) :-
+    format('~q.~n', [Result]),
+    flush_output.
+
+save_results(Options, Results) :-
+    option(save(File), Options),
+    !,
+    setup_call_cleanup(
+        open(File, write, Out),
+        ( current_prolog_flag(version, Version),
+          format(Out, '% SWI-Prolog ~w benchmark results~n',
+                 [Version]),
+          forall(member(R, Results),
+                 format(Out, '~q.~n', [R]))
+        ),
+        close(Out)).
+save_results(_, _).
+
+		 /*******************************
+		 *            BASELINE		*
+		 *******************************/
+
+load_baseline(-, []) :-
+    !.
+load_baseline(File, Baseline) :-
+    exists_file(File),
+    !,
+    read_file_to_terms(File, Baseline, []).
+load_baseline(File, []) :-
+    format(user_error, 'No baseline ~w; not comparing~n', [File]).
+
+%!  compare_results(+Baseline, +Results, +Options) is det.
+%
+%   Print a comparison of Results against Baseline on `user_error`.
+%   Ratio is the new time divided by the baseline time.
+
+compare_results([], _, _) :-
+    !.
+compare_results(Baseline, Results, Options) :-
+    format(user_error, '~n~w~t~16|~t~w~28|~t~w~40|~t~w~50|~n',
+           ['Program', 'Baseline', 'Time', 'Ratio']),
+    findall(Name-Ratio,
+            ( member(bench(Name, New), Results),
+              memberchk(bench(Name, Old), Baseline),
+              option(time(T0), Old),
+              option(time(T1), New),
+              T0 > 0,
+              Ratio is T1/T0,
+              format(user_error, '~w~t~16|~t~3f~28|~t~3f~40|~t~3f~50|~n',
+                     [Name, T0, T1, Ratio])
+            ),
+            Pairs),
+    (   Pairs \== []
+    ->  pairs_values(Pairs, Ratios),
+        geometric_mean(Ratios, Mean),
+        format(user_error, '~w~t~40|~t~3f~50|~n', ['Geometric mean', Mean])
+    ;   true
+    ),
+    check_threshold(Pairs, Options).
+
+geometric_mean(Values, Mean) :-
+    foldl(add_log, Values, 0, Sum),
+    length(Values, Len),
+    Mean is exp(Sum/Len).
+
+add_log(V, S0, S) :-
+    S is S0+log(V).
+
+check_threshold(Pairs, Options) :-
+    option(threshold(Frac), Options),
+    Max is 1+Frac,
+    include(slower(Max), Pairs, Slower),
+    Slower \== [],
+    !,
+    pairs_keys(Slower, Names),
+    format(user_error, 'Slower than threshold: ~w~n', [Names]),
+    halt(1).
+check_threshold(_, _).
+
+slower(Max, _-Ratio) :-
+    Ratio > Max.
@@ -42,6 +42,9 @@ implementation is modelled  after  an  older   version  of  Yap.  Ulrich
 Neumerkel fixed the variable preservation of   bagof/3 and setof/3 using
 an algorithm also found in  Yap  6.3,   where  it  is claimed: "uses the
 SICStus algorithm to guarantee that variables will have the same names".
+The grouping of bagof/3 and setof/3 is now  done in C while collecting
+the solutions. Witnesses that are variants   compile to the same record,
+which provides the same canonical binding.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 :- module('$bags',
@@ -50,7 +53,8 @@ SICStus algorithm to guarantee that variables will have the same names".
             findnsols/4,                % +Count, +Templ, :Goal, -List
             findnsols/5,                % +Count, +Templ, :Goal, -List, +Tail
             bagof/3,                    % +Templ, :Goal, -List
-            setof/3                     % +Templ, :Goal, -List
+            setof/3,                    % +Templ, :Goal, -List
+            '$aggregate_bag'/4          % +Op, +Templ, :Goal, -Result
           ]).
 
 :- meta_predicate
@@ -59,7 +63,8 @@ SICStus algorithm to guarantee that variables will have the same names".
     findnsols(+, ?, 0, -),
     findnsols(+, ?, 0, -, ?),
     bagof(?, ^, -),
-    setof(?, ^, -).
+    setof(?, ^, -),
+    '$aggregate_bag'(+, ?, ^, -).
 
 :- noprofile((
         findall/4,
@@ -68,7 +73,9 @@ SICStus algorithm to guarantee that variables will have the same names".
         findnsols/5,
         bagof/3,
         setof/3,
-        findall_loop/4)).
+        '$aggregate_bag'/4,
+        findall_loop/4,
+        group_loop/4)).
 
 :- '$iso'((findall/3,
            bagof/3,
@@ -180,62 +187,63 @@ bagof(Templ, Goal0, List) :-
     (   Vars == v
     ->  findall(Templ, Goal, List),
         List \== []
-    ;   findall(Vars-Templ, Goal, Answers),
-        bind_bagof_keys(Answers,_),
-        keysort(Answers, Sorted),
+    ;   group_bag(bag, Vars, Templ, Goal, Groups),
+        keysort(Groups, Sorted),
         pick(Sorted, Vars, List)
     ).
 
-%!  bind_bagof_keys(+VarsTemplPairs, -SharedVars)
+%!  group_bag(+Op, +Vars, +Templ, :Goal, -Groups) is det.
 %
-%   Establish a canonical binding  of   the  _vars_ structures. This
-%   code   was   added    by    Ulrich     Neumerkel    in    commit
-%   1bf9e87900b3bbd61308e80a784224c856854745.
+%   Groups is a list Witness-Result, where   Result aggregates Templ over
+%   the solutions of Goal for which Vars   is  a variant of Witness. The
+%   grouping is done in C while the  solutions are produced, which also
+%   establishes the canonical binding of   the  witnesses that bagof/3
+%   requires. See '$new_group_bag'/1 for the supported operations.
 
-bind_bagof_keys([], _).
-bind_bagof_keys([W-_|WTs], Vars) :-
-    term_variables(W, Vars, _),
-    bind_bagof_keys(WTs, Vars).
-
-pick(Bags, Vars1, Bag1) :-
-    pick_first(Bags, Vars0, Bag0, RestBags),
-    select_bag(RestBags, Vars0, Bag0, Vars1, Bag1).
+group_bag(Op, Vars, Templ, Goal, Groups) :-
+    setup_call_cleanup(
+        '$new_group_bag'(Op),
+        group_loop(Vars, Templ, Goal, Groups),
+        '$destroy_findall_bag').
 
-select_bag([], Vars0, Bag0, Vars1, Bag1) :-   % last one: deterministic
-    !,
-    Vars0 = Vars1,
-    Bag0 = Bag1.
-select_bag(_, Vars, Bag, Vars, Bag).
-select_bag(RestBags, _, _, Vars1, Bag1) :-
-    pick(RestBags, Vars1, Bag1).
+group_loop(Vars, Templ, Goal, Groups) :-
+    (   Goal,
+        '$add_group_bag'(Vars, Templ)   % fails
+    ;   '$collect_group_bag'(Groups)
+    ).
 
-%!  pick_first(+Bags, +Vars, -Bag1, -RestBags) is semidet.
+%!  pick(+Groups, ?Vars, -Result) is nondet.
 %
-%   Pick the first result-bag from the   list  of Templ-Answer. Note
-%   that we pick all elements that are  equal under =@=, but because
-%   the variables in the witness are canonized this is the same as ==.
-%
-%   @param Bags     List of Templ-Answer
-%   @param Vars     Initial Templ (for rebinding variables)
-%   @param Bag1     First bag of results
-%   @param RestBags Remaining Templ-Answer
+%   Enumerate the groups from the  sorted   list  of  Witness-Result,
+%   binding Vars to Witness. Deterministic on the last group.
 
-pick_first([Vars-Templ|T0], Vars, [Templ|T], RestBag) :-
-    pick_same(T0, Vars, T, RestBag).
+pick([W-R], Vars, Result) :-
+    !,
+    Vars = W,
+    Result = R.
+pick([W-R|_], W, R).
+pick([_|T], Vars, Result) :-
+    pick(T, Vars, Result).
 
+%!  '$aggregate_bag'(+Op, +Templ, :Goal, -Result) is nondet.
+%
+%   As bagof/3, but Result is the  aggregation of Templ according to Op
+%   rather than the list of all  solutions.   Used  by aggregate/3 from
+%   library(aggregate), which also defines  the   operations.  Note that
+%   the elements of a set are not sorted.
 
-pick_same([V-H|T0], Vars, [H|T], Bag) :-
-    V == Vars,
-    !,
-    pick_same(T0, Vars, T, Bag).
-pick_same(Bag, _, [], Bag).
+'$aggregate_bag'(Op, Templ, Goal0, Result) :-
+    '$free_variable_set'(Templ^Goal0, Goal, Vars),
+    group_bag(Op, Vars, Templ, Goal, Groups),
+    keysort(Groups, Sorted),
+    pick(Sorted, Vars, Result).
 
 
 %!  setof(+Var, +Goal, -Set) is semidet.
 %
 %   Equivalent to bagof/3, but sorts the   resulting bag and removes
-%   duplicate answers. We sort  immediately   after  the  findall/3,
-%   removing duplicate Templ-Answer pairs early.
+%   duplicate answers. Ground duplicates are   removed while grouping,
+%   so only the set of the selected group needs to be sorted.
 
 setof(Templ, Goal0, List) :-
     '$free_variable_set'(Templ^Goal0, Goal, Vars),
@@ -243,13 +251,8 @@ setof(Templ, Goal0, List) :-
     ->  findall(Templ, Goal, Answers),
         Answers \== [],
         sort(Answers, List)
-    ;   findall(Vars-Templ, Goal, Answers),
-        (   ground(Answers)
-        ->  sort(Answers,Sorted),
-            pick(Sorted,Vars,List)
-        ;   bind_bagof_keys(Answers,_VDict),
-            sort(Answers, Sorted),
-            pick(Sorted, Vars, Listu),
-            sort(Listu,List) % Listu ordering may be nixed by Vars
-        )
+    ;   group_bag(set, Vars, Templ, Goal, Groups),
+        keysort(Groups, Sorted),
+        pick(Sorted, Vars, Set),
+        sort(Set, List)
     ).
@@ -127,6 +127,10 @@ non_terminal(Spec)       :- '$set_pattr'(Spec, pred, (non_terminal)).
 '$set_pattr'(M:T, _, How, Attr) :-
     !,
     '$set_pattr'(T, M, How, Attr).
+'$set_pattr'(Spec as Options, M, How, Attr) :-  % dynamic p/1 as incremental
+    !,
+    '$set_pattr'(Spec, M, How, Attr),
+    '$pattr_options'(Options, Spec, M, How).
 '$set_pattr'(A, M, pred, Attr) :-
     !,
     '$set_predicate_attribute'(M:A, Attr, true).
@@ -136,6 +140,24 @@ non_terminal(Spec)       :- '$set_pattr'(Spec, pred, (non_terminal)).
           error(E, _),
           print_message(error, error(E, context((Attr)/1,_)))).
 
+%!  '$pattr_options'(+Options, +Spec, +Module, +How) is det.
+%
+%   Process the Options of `Spec as Options`.  Options is a single
+%   option or a comma-list of options.
+
+'$pattr_options'(X, _, _, _) :-
+    var(X),
+    throw(error(instantiation_error, _)).
+'$pattr_options'((A,B), Spec, M, How) :-
+    !,
+    '$pattr_options'(A, Spec, M, How),
+    '$pattr_options'(B, Spec, M, How).
+'$pattr_options'(incremental, Spec, M, How) :-
+    !,
+    '$set_pattr'(Spec, M, How, incremental).
+'$pattr_options'(Opt, _, _, _) :-
+    throw(error(domain_error(predicate_option, Opt), _)).
+
 %!  '$pattr_directive'(+Spec, +Module) is det.
 %
 %   This implements the directive version of dynamic/1, multifile/1,
@@ -1885,7 +1907,11 @@ load_files(Module:Files, Options) :-
     List = [_|_],
     !,
     '$must_be'(list, List),
-    '$load_file_list'(List, Module, Options).
+    (   '$load_threads'(List, Options, Threads)
+    ->  '$concurrent_load'(List, Threads,
+                           '$load_list_member'(Module, Options))
+    ;   '$load_file_list'(List, Module, Options)
+    ).
 '$load_files'(File, Module, Options) :-
     '$load_one_file'(File, Module, Options).
 
@@ -1896,6 +1922,85 @@ load_files(Module:Files, Options) :-
           '$print_message'(error, E)),
     '$load_file_list'(Rest, Module, Options).
 
+'$load_list_member'(Module, Options, File) :-
+    '$load_one_file'(File, Module, Options).
+
+%!  '$load_threads'(+Files, +Options, -Threads) is semidet.
+%
+%   True when Files must be loaded concurrently using Threads threads
+%   due to the option threads(N).  Files are loaded sequentially if
+%   there are no threads or we are compiling into a .qlf file.
+
+'$load_threads'(Files, Options, Threads) :-
+    '$option'(threads(N), Options),
+    '$must_be'(integer, N),
+    N > 1,
+    current_prolog_flag(threads, true),
+    '$compilation_mode'(database),
+    length(Files, Len),
+    Threads is min(N, Len),
+    Threads > 1.
+
+%!  '$concurrent_load'(+Files, +Threads, :Load) is det.
+%
+%   Call call(Load, File) for each  element   of  Files using Threads
+%   worker threads. As for sequential loading,   errors are printed and
+%   other exceptions are re-thrown after all   workers  have completed.
+%   The workers inherit the source location of   the caller such that the
+%   loaded files are registered as being loaded  from the file that is
+%   being loaded.  Dependencies between the files are handled by
+%   '$mt_load_file'/4.
+
+'$concurrent_load'(Files, Threads, Load) :-
+    (   source_location(File, Line)
+    ->  Context = File:Line
+    ;   Context = (-)
+    ),
+    setup_call_cleanup(
+        message_queue_create(Queue),
+        '$concurrent_load'(Files, Threads, Queue, Load, Context),
+        message_queue_destroy(Queue)).
+
+'$concurrent_load'(Files, Threads, Queue, Load, Context) :-
+    forall('$member'(File, Files),
+           thread_send_message(Queue, load(File))),
+    forall(between(1, Threads, _),
+           thread_send_message(Queue, done)),
+    findall(Id,
+            ( between(1, Threads, _),
+              thread_create('$loader'(Queue, Load, Context), Id, [])
+            ),
+            Ids),
+    '$join_loaders'(Ids).
+
+'$loader'(Queue, Load, File:Line) :-
+    !,
+    '$set_source_location'(File, Line),
+    '$loader'(Queue, Load).
+'$loader'(Queue, Load, _) :-
+    '$loader'(Queue, Load).
+
+'$loader'(Queue, Load) :-
+    thread_get_message(Queue, Msg),
+    (   Msg = load(File)
+    ->  E = error(_,_),
+        catch(call(Load, File), E,
+              '$print_message'(error, E)),
+        '$loader'(Queue, Load)
+    ;   true
+    ).
+
+'$join_loaders'(Ids) :-
+    findall(Status,
+            ( '$member'(Id, Ids),
+              thread_join(Id, Status)
+            ),
+            Statuses),
+    (   '$member'(exception(E), Statuses)
+    ->  throw(E)
+    ;   true
+    ).
+
 
 '$load_one_file'(Spec, Module, Options) :-
     atomic(Spec),
@@ -2146,11 +2251,18 @@ load_files(Module:Files, Options) :-
 %   the fact that thread_get_message/1 throws  an existence_error if
 %   the message queue  is  destroyed.  This   is  hacky.  Events  or
 %   condition variables would have made a cleaner design.
+%
+%   If the thread loading the file is   (indirectly)  waiting for a file
+%   that is being loaded by us, waiting would deadlock. In that case we
+%   act as if the file is  already  loaded,   which  is  the same as for
+%   cyclic dependencies between files loaded by a single thread.
 
 :- dynamic
-    '$loading_file'/3.              % File, Queue, Thread
+    '$loading_file'/3,              % File, Queue, Thread
+    '$load_wait_for'/2.             % Thread, File
 :- volatile
-    '$loading_file'/3.
+    '$loading_file'/3,
+    '$load_wait_for'/2.
 
 '$mt_load_file'(File, FullFile, Module, Options) :-
     current_prolog_flag(threads, true),
@@ -2172,6 +2284,13 @@ load_files(Module:Files, Options) :-
 '$mt_start_load'(FullFile, queue(Queue), _) :-
     '$loading_file'(FullFile, Queue, LoadThread),
     \+ thread_self(LoadThread),
+    \+ '$mt_load_cycle'(LoadThread),
+    !,
+    thread_self(Me),
+    assertz('$load_wait_for'(Me, FullFile)).
+'$mt_start_load'(FullFile, already_loaded, _) :-
+    '$loading_file'(FullFile, _, LoadThread),
+    \+ thread_self(LoadThread),
     !.
 '$mt_start_load'(FullFile, already_loaded, Options) :-
     '$option'(if(If), Options, true),
@@ -2194,7 +2313,10 @@ load_files(Module:Files, Options) :-
     '$qdo_load_file'(File, FullFile, Module, Action, Options),
     '$run_initialization'(FullFile, Action, Options).
 
-'$mt_end_load'(queue(_)) :- !.
+'$mt_end_load'(queue(_)) :-
+    !,
+    thread_self(Me),
+    retractall('$load_wait_for'(Me, _)).
 '$mt_end_load'(already_loaded) :- !.
 '$mt_end_load'(Ref) :-
     clause('$loading_file'(_, Queue, _), _, Ref),
@@ -2202,6 +2324,24 @@ load_files(Module:Files, Options) :-
     thread_send_message(Queue, done),
     message_queue_destroy(Queue).
 
+%!  '$mt_load_cycle'(+LoadThread) is semidet.
+%
+%   True when LoadThread is (indirectly) waiting  for a file that is
+%   being loaded by the calling thread.
+
+'$mt_load_cycle'(LoadThread) :-
+    thread_self(Me),
+    '$mt_load_cycle'(LoadThread, Me, [LoadThread]).
+
+'$mt_load_cycle'(Thread, Me, Seen) :-
+    '$load_wait_for'(Thread, File),
+    '$loading_file'(File, _, Loader),
+    (   Loader == Me
+    ->  true
+    ;   \+ memberchk(Loader, Seen),
+        '$mt_load_cycle'(Loader, Me, [Loader|Seen])
+    ).
+
 
 %!  '$qdo_load_file'(+Spec, +FullFile, +ContextModule, +Options) is det.
 %
@@ -270,6 +270,10 @@ syntax_error(end_of_file_in_block_comment) -->
 syntax_error(end_of_file_in_quoted(Quote)) -->
     [ 'End of file in quoted ' ],
     quoted_type(Quote).
+syntax_error(end_of_file_in_csv_field) -->
+    [ 'End of file in quoted CSV field' ].
+syntax_error(csv_separator_expected) -->
+    [ 'Separator or end of record expected after quoted CSV field' ].
 syntax_error(illegal_number) -->
     [ 'Illegal number' ].
 syntax_error(long_atom) -->
@@ -49,15 +49,25 @@
     qcompile(:, +).
 
 %!  qcompile(:Files) is det.
+%!  qcompile(:Files, +Options) is det.
 %
 %   Compile Files as consult/1 and generate   a  Quick Load File for
-%   each compiled file.
+%   each compiled file. If Options contains  threads(N), the files of a
+%   list are compiled concurrently using N threads.
 
 qcompile(M:Files) :-
     qcompile_(Files, M, []).
+qcompile(M:Files, Options) :-
+    Files = [_|_],
+    '$load_threads'(Files, Options, Threads),
+    !,
+    '$concurrent_load'(Files, Threads, '$qlf':qcompile_one(M, Options)).
 qcompile(M:Files, Options) :-
     qcompile_(Files, M, Options).
 
+qcompile_one(M, Options, File) :-
+    qcompile_(File, M, Options).
+
 qcompile_([], _, _) :- !.
 qcompile_([H|T], M, Options) :-
     !,
@@ -92,7 +102,7 @@ qcompile_(FileName, _Module, _Options) :-
 
 '$qload_file'(File, Module, Action, LoadedModule, Options) :-
     setup_call_cleanup(
-        open(File, read, In, [type(binary)]),
+        '$qlf_open_input'(File, In),
         setup_call_cleanup(
             '$save_lex_state'(LexState, Options),
             '$qload_stream'(In, Module,
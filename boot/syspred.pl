@@ -58,6 +58,7 @@
             predicate_property/2,
             '$predicate_property'/2,
             clause_property/2,
+            clause_range/4,                     % :Head, +Arg, +Low, +High
             current_module/1,                   % ?Module
             module_property/2,                  % ?Module, ?Property
             module/1,                           % +Module
@@ -905,6 +906,8 @@ define_or_generate(Pred) :-
     '$get_predicate_attribute'(Pred, (thread_local), 1).
 '$predicate_property'((multifile), Pred) :-
     '$get_predicate_attribute'(Pred, (multifile), 1).
+'$predicate_property'(incremental, Pred) :-
+    '$get_predicate_attribute'(Pred, incremental, 1).
 '$predicate_property'(imported_from(Module), Pred) :-
     '$get_predicate_attribute'(Pred, imported, Module).
 '$predicate_property'(transparent, Pred) :-
@@ -1024,6 +1027,49 @@ clause_property(Clause, Property) :-
     '$get_clause_attribute'(Clause, module, M).
 
 
+%!  clause_range(:Head, +Arg, +Low, +High) is nondet.
+%
+%   True when Head is true  using  a   clause  whose  Arg-th argument is
+%   between Low and High (inclusive) after   executing its body. Numbers
+%   are compared by value and atoms   in  the standard order. Candidate
+%   clauses are selected using an  ordered   index  on  Arg, which makes
+%   selecting a small range from a large   predicate cheap. Solutions are
+%   enumerated in ascending order of the   argument,  followed by clauses
+%   where the argument is not a number or atom in the clause head.
+
+:- meta_predicate
+    clause_range(:, +, +, +).
+
+clause_range(M:Head, Arg, Low, High) :-
+    '$clause_range'(M:Head, Arg, Low, High, Refs),
+    '$member'(Ref, Refs),
+    clause(M:Head, Body, Ref),
+    '$get_clause_attribute'(Ref, module, CM),
+    (   Body == true
+    ->  true
+    ;   CM:Body
+    ),
+    arg(Arg, Head, Key),
+    in_range(Low, Key, High).
+
+in_range(Low, Key, High) :-
+    number(Key),
+    !,
+    range_compare(Low, Key),
+    range_compare(Key, High).
+in_range(Low, Key, High) :-
+    atom(Key),
+    range_compare(Low, Key),
+    range_compare(Key, High).
+
+range_compare(X, Y) :-
+    number(X), number(Y),
+    !,
+    X =< Y.
+range_compare(X, Y) :-
+    X @=< Y.
+
+
                  /*******************************
                  *             REQUIRE          *
                  *******************************/
@@ -1167,6 +1213,12 @@ current_trie(Trie) :-
 %     Number of bytes needed to store the trie.
 %     - hashed(Count)
 %     Number of hashed nodes.
+%     - hashed_size(Bytes)
+%     Number of bytes used by the hash tables of hashed nodes.
+%     - compact(Count)
+%     Number of nodes that store their children in a small array.
+%     - compact_size(Bytes)
+%     Number of bytes used by these arrays.
 
 trie_property(Trie, Property) :-
     current_trie(Trie),
@@ -1177,6 +1229,9 @@ trie_property(node_count(_)).
 trie_property(value_count(_)).
 trie_property(size(_)).
 trie_property(hashed(_)).
+trie_property(hashed_size(_)).
+trie_property(compact(_)).
+trie_property(compact_size(_)).
 
 
 
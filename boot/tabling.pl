@@ -39,15 +39,25 @@
 
             current_table/2,            % :Variant, ?Table
             abolish_all_tables/0,
+            abolish_private_tables/0,
+            abolish_shared_tables/0,
             abolish_table_subgoals/1,   % :Subgoal
 
             start_tabling/2,            % +Wrapper, :Worker
-            start_tabling/4             % +Wrapper, :Worker, :Variant, ?ModeArgs
+            start_tabling/4,            % +Wrapper, :Worker, :Variant, ?ModeArgs
+            start_shared_tabling/2,     % +Wrapper, :Worker
+            start_shared_tabling/4,     % +Wrapper, :Worker, :Variant, ?ModeArgs
+            start_incremental_tabling/2,% +Wrapper, :Worker
+            start_incremental_tabling/4 % +Wrapper, :Worker, :Variant, ?ModeArgs
           ]).
 
 :- meta_predicate
     start_tabling(+, 0),
     start_tabling(+, 0, +, ?),
+    start_shared_tabling(+, 0),
+    start_shared_tabling(+, 0, +, ?),
+    start_incremental_tabling(+, 0),
+    start_incremental_tabling(+, 0, +, ?),
     current_table(:, -),
     abolish_table_subgoals(:).
 
@@ -81,6 +91,26 @@ table space and work lists are part of the SWI-Prolog core.
 %
 %   _Mode directed tabling_ is  discussed   in  the general introduction
 %   section about tabling.
+%
+%   Tables are normally private to the thread that creates them.  Using
+%   `Spec as shared`, the tables for the predicates in Spec are shared
+%   between all threads.  A thread that calls a variant that is being
+%   evaluated by another thread waits for the evaluation to complete.
+%
+%     ==
+%     :- table reachable/2 as shared.
+%     ==
+%
+%   Using `Spec as incremental`, the tables are maintained incrementally
+%   if the dynamic predicates they depend upon are declared as
+%   `:- dynamic p/1 as incremental`.  Modifying such a predicate
+%   invalidates the tables that depend on it and these tables are
+%   re-evaluated on the next call.  Incremental tables are private.
+%
+%     ==
+%     :- table reachable/2 as incremental.
+%     :- dynamic edge/2 as incremental.
+%     ==
 
 table(PIList) :-
     throw(error(context_error(nodirective, table(PIList)), _)).
@@ -97,6 +127,28 @@ table(PIList) :-
 
 start_tabling(Wrapper, Worker) :-
     '$tbl_variant_table'(Wrapper, Trie, Status),
+    run_tabled(Status, Trie, Wrapper, Worker).
+
+%!  start_shared_tabling(:Wrapper, :Implementation)
+%
+%   As start_tabling/2, but use a table that is shared between threads.
+%   If another thread is evaluating the same  variant, wait for it to
+%   complete rather than recomputing it.
+
+start_shared_tabling(Wrapper, Worker) :-
+    '$tbl_shared_variant_table'(Wrapper, Trie, Status),
+    run_tabled(Status, Trie, Wrapper, Worker).
+
+%!  start_incremental_tabling(:Wrapper, :Implementation)
+%
+%   As start_tabling/2, but use a table that is maintained incrementally.
+%   An invalid table is re-evaluated.
+
+start_incremental_tabling(Wrapper, Worker) :-
+    '$tbl_incr_variant_table'(Wrapper, Trie, Status),
+    run_tabled(Status, Trie, Wrapper, Worker).
+
+run_tabled(Status, Trie, Wrapper, Worker) :-
     (   Status == complete
     ->  trie_gen(Trie, Wrapper, _)
     ;   (   '$tbl_create_component'
@@ -138,6 +190,25 @@ activate(Wrapper, Worker, Trie, WorkList) :-
 
 start_tabling(Wrapper, Worker, WrapperNoModes, ModeArgs) :-
     '$tbl_variant_table'(WrapperNoModes, Trie, Status),
+    run_tabled(Status, Trie, Wrapper, Worker, WrapperNoModes, ModeArgs).
+
+%!  start_shared_tabling(:Wrapper, :Implementation, +Variant, +ModeArgs)
+%
+%   As start_tabling/4, using a table that is shared between threads.
+
+start_shared_tabling(Wrapper, Worker, WrapperNoModes, ModeArgs) :-
+    '$tbl_shared_variant_table'(WrapperNoModes, Trie, Status),
+    run_tabled(Status, Trie, Wrapper, Worker, WrapperNoModes, ModeArgs).
+
+%!  start_incremental_tabling(:Wrapper, :Implementation, +Variant, +ModeArgs)
+%
+%   As start_tabling/4, using a table that is maintained incrementally.
+
+start_incremental_tabling(Wrapper, Worker, WrapperNoModes, ModeArgs) :-
+    '$tbl_incr_variant_table'(WrapperNoModes, Trie, Status),
+    run_tabled(Status, Trie, Wrapper, Worker, WrapperNoModes, ModeArgs).
+
+run_tabled(Status, Trie, Wrapper, Worker, WrapperNoModes, ModeArgs) :-
     (   Status == complete
     ->  trie_gen(Trie, WrapperNoModes, ModeArgs)
     ;   (   Status == fresh
@@ -171,14 +242,34 @@ activate(Wrapper, WrapperNoModes, _ModeArgs, Worker, Trie, WorkList) :-
 
 %!  delim(+Wrapper, +Worker, +WorkList)
 %
-%   Call/resume Worker for non-mode directed tabled predicates.
+%   Call/resume Worker for non-mode directed tabled predicates.  The
+%   global variable `$tbl_current` holds the WorkList we are working
+%   for, which is used to record dependencies for incremental tabling.
+%   The previous value is restored  if   Worker  completes or suspends,
+%   such that `$tbl_current` never refers  to   a  worklist that is no
+%   longer being evaluated.
 
 delim(Wrapper, Worker, WorkList) :-
+    tbl_current(Old),
+    b_setval('$tbl_current', WorkList),
     reset(work_and_add_answer(Worker, Wrapper, WorkList),
           SourceCall, Continuation),
+    b_setval('$tbl_current', Old),
     add_answer_or_suspend(Continuation, Wrapper,
                           WorkList, SourceCall).
 
+%!  tbl_current(-WorkList) is det.
+%
+%   WorkList is the worklist we  are   evaluating  or  `[]` if there is
+%   none.  `[]` is also the value  after   an  exception  unwinds the
+%   b_setval/2 calls in delim/3,4 that created the variable.
+
+tbl_current(WorkList) :-
+    (   nb_current('$tbl_current', WorkList0)
+    ->  WorkList = WorkList0
+    ;   WorkList = []
+    ).
+
 work_and_add_answer(Worker, Wrapper, WorkList) :-
     call(Worker),
     '$tbl_wkl_add_answer'(WorkList, Wrapper).
@@ -197,8 +288,11 @@ add_answer_or_suspend(Continuation, Wrapper, WorkList,
 %   Call/resume Worker for mode directed tabled predicates.
 
 delim(Wrapper, WrapperNoModes, Worker, WorkList) :-
+    tbl_current(Old),
+    b_setval('$tbl_current', WorkList),
     reset(work_and_add_moded_answer(Worker, Wrapper, WrapperNoModes, WorkList),
           SourceCall, Continuation),
+    b_setval('$tbl_current', Old),
     add_answer_or_suspend(Continuation, Wrapper, WrapperNoModes,
                           WorkList, SourceCall).
 
@@ -274,14 +368,35 @@ completion_step(SourceTable) :-
 %           in progress.
 
 abolish_all_tables :-
+    abolish_private_tables,
+    abolish_shared_tables.
+
+%!  abolish_private_tables
+%
+%   Remove all tables that are private to the calling thread.
+
+abolish_private_tables :-
     '$tbl_abolish_all_tables'.
 
+%!  abolish_shared_tables
+%
+%   Remove all tables that are shared between threads.
+%
+%   @error  permission_error(abolish, tables, shared) if some thread
+%           is evaluating a shared table.
+
+abolish_shared_tables :-
+    '$tbl_abolish_shared_tables'.
+
 %!  abolish_table_subgoals(:Subgoal) is det.
 %
 %   Abolish all tables that unify with SubGoal.
+%
+%   @error  permission_error(abolish, table, Trie) if a matching shared
+%           table is being computed by some thread.
 
 abolish_table_subgoals(M:SubGoal) :-
-    '$tbl_variant_table'(VariantTrie),
+    variant_table(VariantTrie),
     current_module(M),
     forall(trie_gen(VariantTrie, M:SubGoal, Trie),
            '$tbl_destroy_table'(Trie)).
@@ -296,12 +411,22 @@ abolish_table_subgoals(M:SubGoal) :-
 %   True when Trie is the answer table for Variant.
 
 current_table(M:Variant, Trie) :-
-    '$tbl_variant_table'(VariantTrie),
+    variant_table(VariantTrie),
     (   (var(Variant) ; var(M))
     ->  trie_gen(VariantTrie, M:Variant, Trie)
     ;   trie_lookup(VariantTrie, M:Variant, Trie)
     ).
 
+%!  variant_table(-VariantTrie) is nondet.
+%
+%   True when VariantTrie is the private variant table of this thread or
+%   the variant table for shared tables.
+
+variant_table(VariantTrie) :-
+    '$tbl_variant_table'(VariantTrie).
+variant_table(VariantTrie) :-
+    '$tbl_shared_variant_table'(VariantTrie).
+
 
                  /*******************************
                  *      WRAPPER GENERATION      *
@@ -314,22 +439,29 @@ current_table(M:Variant, Trie) :-
 :- dynamic
     system:term_expansion/2.
 
-wrappers(Var) -->
+wrappers(Spec) -->
+    wrappers(Spec, []).
+
+wrappers(Var, _) -->
     { var(Var),
       !,
       '$instantiation_error'(Var)
     }.
-wrappers((A,B)) -->
+wrappers(Spec as Options, Opts0) -->
+    !,
+    { table_options(Options, Opts0, Opts) },
+    wrappers(Spec, Opts).
+wrappers((A,B), Opts) -->
     !,
-    wrappers(A),
-    wrappers(B).
-wrappers(Name//Arity) -->
+    wrappers(A, Opts),
+    wrappers(B, Opts).
+wrappers(Name//Arity, Opts) -->
     { atom(Name), integer(Arity), Arity >= 0,
       !,
       Arity1 is Arity+2
     },
-    wrappers(Name/Arity1).
-wrappers(Name/Arity) -->
+    wrappers(Name/Arity1, Opts).
+wrappers(Name/Arity, Opts) -->
     { atom(Name), integer(Arity), Arity >= 0,
       !,
       functor(Head, Name, Arity),
@@ -338,15 +470,14 @@ wrappers(Name/Arity) -->
       Head =.. [Name|Args],
       WrappedHead =.. [WrapName|Args],
       prolog_load_context(module, Module),
-      '$tbl_trienode'(Reserved)
+      '$tbl_trienode'(Reserved),
+      start_goal(Opts, Module:Head, WrappedHead, Start)
     },
     [ '$tabled'(Head),
       '$table_mode'(Head, Head, Reserved),
-      (   Head :-
-             start_tabling(Module:Head, WrappedHead)
-      )
+      (   Head :- Start )
     ].
-wrappers(ModeDirectedSpec) -->
+wrappers(ModeDirectedSpec, Opts) -->
     { callable(ModeDirectedSpec),
       !,
       functor(ModeDirectedSpec, Name, Arity),
@@ -360,10 +491,11 @@ wrappers(ModeDirectedSpec) -->
       prolog_load_context(module, Module),
       mode_check(Moded, ModeTest),
       (   ModeTest == true
-      ->  WrapClause = (Head :- start_tabling(Module:Head, WrappedHead))
-      ;   WrapClause = (Head :- ModeTest,
-                            start_tabling(Module:Head, WrappedHead,
-                                          Module:Variant, Moded))
+      ->  start_goal(Opts, Module:Head, WrappedHead, Start),
+          WrapClause = (Head :- Start)
+      ;   start_goal(Opts, Module:Head, WrappedHead, Module:Variant, Moded,
+                     Start),
+          WrapClause = (Head :- ModeTest, Start)
       )
     },
     [ '$tabled'(Head),
@@ -371,10 +503,64 @@ wrappers(ModeDirectedSpec) -->
       WrapClause
     | UpdateClauses
     ].
-wrappers(TableSpec) -->
+wrappers(TableSpec, _) -->
     { '$type_error'(table_desclaration, TableSpec)
     }.
 
+%!  table_options(+Options, +Opts0, -Opts) is det.
+%
+%   Add the options from `Spec as Options` to the list Opts0. Options
+%   is a single option or a comma-list of options.
+
+table_options(Var, _, _) :-
+    var(Var),
+    !,
+    '$instantiation_error'(Var).
+table_options((A,B), Opts0, Opts) :-
+    !,
+    table_options(A, Opts0, Opts1),
+    table_options(B, Opts1, Opts).
+table_options(shared, Opts, [sharing(shared)|Opts]) :- !.
+table_options(private, Opts, [sharing(private)|Opts]) :- !.
+table_options(incremental, Opts, [incremental(true)|Opts]) :- !.
+table_options(opaque, Opts, [incremental(false)|Opts]) :- !.
+table_options(Opt, _, _) :-
+    '$domain_error'(table_option, Opt).
+
+%!  start_goal(+Opts, +Wrapper, +Worker, -Goal) is det.
+%!  start_goal(+Opts, +Wrapper, +Worker, +Variant, +ModeArgs, -Goal) is det.
+%
+%   Goal is the body of the wrapper clause for a tabled predicate.
+
+start_goal(Opts, Wrapper, Worker, Goal) :-
+    (   incremental(Opts)
+    ->  Goal = start_incremental_tabling(Wrapper, Worker)
+    ;   memberchk(sharing(shared), Opts)
+    ->  Goal = start_shared_tabling(Wrapper, Worker)
+    ;   Goal = start_tabling(Wrapper, Worker)
+    ).
+
+start_goal(Opts, Wrapper, Worker, Variant, ModeArgs, Goal) :-
+    (   incremental(Opts)
+    ->  Goal = start_incremental_tabling(Wrapper, Worker, Variant, ModeArgs)
+    ;   memberchk(sharing(shared), Opts)
+    ->  Goal = start_shared_tabling(Wrapper, Worker, Variant, ModeArgs)
+    ;   Goal = start_tabling(Wrapper, Worker, Variant, ModeArgs)
+    ).
+
+%!  incremental(+Opts) is semidet.
+%
+%   True if Opts asks for incremental tabling.  Incremental tables are
+%   always private to a thread.
+
+incremental(Opts) :-
+    memberchk(incremental(Incr), Opts),
+    Incr == true,
+    (   memberchk(sharing(shared), Opts)
+    ->  '$domain_error'(table_option, (shared,incremental))
+    ;   true
+    ).
+
 %!  check_undefined(+PI)
 %
 %   Verify the predicate has no clauses when the :- table is declared.
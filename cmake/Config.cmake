@@ -15,6 +15,7 @@ check_include_file(ieeefp.h HAVE_IEEEFP_H)
 check_include_file(ieee754.h HAVE_IEEE754_H)
 check_include_file(libloaderapi.h HAVE_LIBLOADERAPI_H)
 check_include_file(limits.h HAVE_LIMITS_H)
+check_include_file(linux/perf_event.h HAVE_LINUX_PERF_EVENT_H)
 check_include_file(locale.h HAVE_LOCALE_H)
 check_include_file(malloc.h HAVE_MALLOC_H)
 check_include_file(memory.h HAVE_MEMORY_H)
@@ -336,6 +337,9 @@ endif()
 if(SWIPL_SHARED_LIB)
   set(O_SHARED_KERNEL 1)
 endif()
+if(VMI_STATISTICS)
+  set(O_VMI_STATISTICS 1)
+endif()
 
 ################
 # Stuff we do not need to define is below such that findmacros.pl does
@@ -141,12 +141,14 @@ _|The development of this library was sponsored by SecuritEase,
 %!  aggregate(+Template, :Goal, -Result) is nondet.
 %
 %   Aggregate bindings in Goal according to Template.  The aggregate/3
-%   version performs bagof/3 on Goal.
+%   version performs bagof/3 on Goal.   The  solutions are aggregated per
+%   group while they are produced, so   the  space used does not depend
+%   on the number of solutions unless Template uses bag(X) or set(X).
 
 aggregate(Template, Goal0, Result) :-
     template_to_pattern(bag, Template, Pattern, Goal0, Goal, Aggregate),
-    bagof(Pattern, Goal, List),
-    aggregate_list(Aggregate, List, Result).
+    '$aggregate_bag'(Aggregate, Pattern, Goal, Result0),
+    aggregate_sets(Aggregate, Result0, Result).
 
 %!  aggregate(+Template, +Discriminator, :Goal, -Result) is nondet.
 %
@@ -424,6 +426,22 @@ aggregate_term_list([H|T], Ops, State0, State) :-
     aggregate_term_list(T, Ops, State1, State).
 
 
+%!  aggregate_sets(+Op, +Result0, -Result) is det.
+%
+%   Sort the sets in the result of '$aggregate_bag'/4.
+
+aggregate_sets(set, Set0, Set) :-
+    !,
+    sort(Set0, Set).
+aggregate_sets(term(_, _, Ops), Result0, Result) :-
+    memberchk(set, Ops),
+    !,
+    Result0 =.. [Functor|Args0],
+    maplist(aggregate_sets, Ops, Args0, Args),
+    Result =.. [Functor|Args].
+aggregate_sets(_, Result, Result).
+
+
 %!  min_pair(+Pairs, -Key, -Value) is det.
 %!  max_pair(+Pairs, -Key, -Value) is det.
 %
@@ -51,7 +51,6 @@
           ]).
 :- use_module(library(record)).
 :- use_module(library(error)).
-:- use_module(library(pure_input)).
 :- use_module(library(debug)).
 :- use_module(library(option)).
 :- use_module(library(apply)).
@@ -63,10 +62,14 @@ This library parses and generates CSV data.   CSV data is represented in
 Prolog as a list of rows. Each row   is  a compound term, where all rows
 have the same name and arity.
 
+Reading from and writing to streams   is  implemented natively (see
+=|pl-csv.c|=). The native reader reads the  input one record at a time
+and creates the row  directly  from   the  stream  buffer, which makes
+csv_read_row/3 and csv_read_file_row/3 run in constant memory. csv//2 is
+a pure Prolog grammar that implements the same syntax.
+
 @tbd    Implement immediate assert of the data to avoid possible stack
         overflows.
-@tbd    Writing creates an intermediate code-list, possibly overflowing
-        resources.  This waits for pure output!
 @see RFC 4180
 */
 
@@ -76,13 +79,14 @@ have the same name and arity.
                        ignore_quotes(boolean),
                        convert(boolean),
                        case(oneof([down,preserve,up])),
+                       strings(boolean),
                        functor(atom),
                        arity(-nonneg),          % actually ?nonneg
                        match_arity(boolean)
                      ]).
 :- predicate_options(csv_read_file/3, 3,
                      [ pass_to(csv//2, 2),
-                       pass_to(phrase_from_file/3, 3)
+                       pass_to(open/4, 4)
                      ]).
 :- predicate_options(csv_read_file_row/3, 3,
                      [ pass_to(csv//2, 2),
@@ -106,7 +110,8 @@ have the same name and arity.
                 functor:atom=row,
                 arity:integer,
                 match_arity:boolean=true,
-                skip_header:atom).
+                skip_header:atom,
+                strings:boolean=false).
 
 
 %!  csv_read_file(+File, -Rows) is det.
@@ -114,7 +119,7 @@ have the same name and arity.
 %
 %   Read a CSV file into a list of   rows. Each row is a Prolog term
 %   with the same arity. Options  is   handed  to  csv//2. Remaining
-%   options  are  processed  by    phrase_from_file/3.  The  default
+%   options  are  processed  by    open/4.  The  default
 %   separator depends on the file name   extension and is =|\t|= for
 %   =|.tsv|= files and =|,|= otherwise.
 %
@@ -136,7 +141,10 @@ csv_read_file(File, Rows) :-
 csv_read_file(File, Rows, Options) :-
     default_separator(File, Options, Options1),
     make_csv_options(Options1, Record, RestOptions),
-    phrase_from_file(csv_roptions(Rows, Record), File, RestOptions).
+    setup_call_cleanup(
+        open(File, read, Stream, RestOptions),
+        csv_read_stream_rows(Stream, Rows, Record),
+        close(Stream)).
 
 
 default_separator(File, Options0, Options) :-
@@ -159,7 +167,46 @@ ext_separator(tsv, 0'\t).
 
 csv_read_stream(Stream, Rows, Options) :-
     make_csv_options(Options, Record, _),
-    phrase_from_stream(csv_roptions(Rows, Record), Stream).
+    csv_read_stream_rows(Stream, Rows, Record).
+
+csv_read_stream_rows(Stream, Rows, Record) :-
+    skip_stream_header(Stream, Record),
+    csv_read_rows(Stream, Rows, Record).
+
+csv_read_rows(Stream, Rows, Record) :-
+    csv_read_row(Stream, Row, Record),
+    (   Row == end_of_file
+    ->  Rows = []
+    ;   Rows = [Row|More],
+        csv_read_rows(Stream, More, Record)
+    ).
+
+skip_stream_header(Stream, Record) :-
+    csv_options_skip_header(Record, CommentStart),
+    nonvar(CommentStart),
+    !,
+    atom_length(CommentStart, Len),
+    atom_string(CommentStart, Start),
+    skip_stream_comment_lines(Stream, Start, Len),
+    skip_stream_blank_lines(Stream).
+skip_stream_header(_, _).
+
+skip_stream_comment_lines(Stream, Start, Len) :-
+    peek_string(Stream, Len, Start),
+    !,
+    skip(Stream, 0'\n),
+    skip_stream_comment_lines(Stream, Start, Len).
+skip_stream_comment_lines(_, _, _).
+
+skip_stream_blank_lines(Stream) :-
+    peek_string(Stream, 1, Char),
+    (   Char == "\n"
+    ;   Char == "\r"
+    ),
+    !,
+    get_char(Stream, _),
+    skip_stream_blank_lines(Stream).
+skip_stream_blank_lines(_).
 
 
 %!  csv(?Rows)// is det.
@@ -198,6 +245,10 @@ csv_read_stream(Stream, Rows, Options) :-
 %       If =down=, downcase atomic values.  If =up=, upcase them
 %       and if =preserve= (default), do not change the case.
 %
+%       * strings(+Boolean)
+%       If =true= (default =false=), represent fields that are not
+%       converted to a number as strings rather than atoms.
+%
 %       * functor(+Atom)
 %       Functor to use for creating row terms.  Default is =row=.
 %
@@ -312,7 +363,7 @@ field(Value, Options) -->
 stripped_field(Value, Options) -->
     ws,
     (   "\"",
-        { csv_options_strip(Options, false) }
+        { csv_options_ignore_quotes(Options, false) }
     ->  string_codes(Codes),
         ws
     ;   { csv_options_separator(Options, Sep) },
@@ -366,27 +417,33 @@ field_codes([], _) --> [].              % unterminated last record
 make_value(Codes, Value, Options) :-
     csv_options_convert(Options, Convert),
     csv_options_case(Options, Case),
-    make_value(Convert, Case, Codes, Value).
+    csv_options_strings(Options, Strings),
+    make_value(Convert, Case, Strings, Codes, Value).
 
-make_value(true, preserve, Codes, Value) :-
+make_value(true, preserve, false, Codes, Value) :-
     !,
     name(Value, Codes).
-make_value(true, Case, Codes, Value) :-
+make_value(true, Case, Strings, Codes, Value) :-
     !,
-    (   number_string(Value, Codes)
-    ->  true
-    ;   make_value(false, Case, Codes, Value)
+    (   name(Value0, Codes),
+        number(Value0)
+    ->  Value = Value0
+    ;   make_value(false, Case, Strings, Codes, Value)
     ).
-make_value(false, preserve, Codes, Value) :-
+make_value(false, preserve, false, Codes, Value) :-
     !,
     atom_codes(Value, Codes).
-make_value(false, down, Codes, Value) :-
+make_value(false, preserve, true, Codes, Value) :-
     !,
+    string_codes(Value, Codes).
+make_value(false, Case, Strings, Codes, Value) :-
     string_codes(String, Codes),
-    downcase_atom(String, Value).
-make_value(false, up, Codes, Value) :-
-    string_codes(String, Codes),
-    upcase_atom(String, Value).
+    case_value(Case, Strings, String, Value).
+
+case_value(down, false, String, Value) :- downcase_atom(String, Value).
+case_value(up,   false, String, Value) :- upcase_atom(String, Value).
+case_value(down, true,  String, Value) :- string_lower(String, Value).
+case_value(up,   true,  String, Value) :- string_upper(String, Value).
 
 separator(Options) -->
     { csv_options_separator(Options, Sep) },
@@ -414,10 +471,6 @@ end_of_record --> eos.                  % unterminated last record
 %     read.  Note that Line is not the physical line, but rather the
 %     _logical_ record number.
 %
-%   @tbd    Input is read line by line.  If a record separator is
-%           embedded in a quoted field, parsing the record fails and
-%           another line is added to the input.  This does not nicely
-%           deal with other reasons why parsing the row may fail.
 
 csv_read_file_row(File, Row, Options) :-
     default_separator(File, Options, Options1),
@@ -443,40 +496,22 @@ csv_read_stream_row(Stream, Row, Line, Options) :-
 %   Read the next CSV record from Stream  and unify the result with Row.
 %   CompiledOptions is created from  options   defined  for csv//2 using
 %   csv_options/2. Row is unified with   `end_of_file` upon reaching the
-%   end of the input.
+%   end of the input.  Quoted fields may span multiple lines.
+%
+%   @error  syntax_error(end_of_file_in_csv_field) if the input ends
+%           inside a quoted field and syntax_error(csv_separator_expected)
+%           if a quoted field is followed by anything but the separator
+%           or the end of the record.
 
-csv_read_row(Stream, Row, _Record) :-
-    at_end_of_stream(Stream),
-    !,
-    Row = end_of_file.
 csv_read_row(Stream, Row, Record) :-
-    read_lines_to_codes(Stream, Codes, Record, even),
-    phrase(row(Row0, Record), Codes),
-    !,
+    '$csv_read_row'(Stream, Row0, Record),
+    (   Row0 == end_of_file
+    ->  true
+    ;   functor(Row0, _, Arity),
+        check_arity(Record, Arity)
+    ),
     Row = Row0.
 
-read_lines_to_codes(Stream, Codes, Options, QuoteQuantity) :-
-    read_line_to_codes(Stream, Codes0),
-    Codes0 \== end_of_file,
-    (   (   csv_options_ignore_quotes(Options, true)
-        ;   check_quotes(Codes0, QuoteQuantity, even)
-        )
-    ->  Codes = Codes0
-    ;   append(Codes0, [0'\n|Tail], Codes),
-        read_lines_to_codes(Stream, Tail, Options, odd)
-    ).
-
-check_quotes([], QuoteQuantity, QuoteQuantity) :-
-    !.
-check_quotes([0'"|T], odd, Result) :-
-    !,
-    check_quotes(T, even, Result).
-check_quotes([0'"|T], even, Result) :-
-    !,
-    check_quotes(T, odd, Result).
-check_quotes([_|T], QuoteQuantity, Result) :-
-    check_quotes(T, QuoteQuantity, Result).
-
 
 %!  csv_options(-Compiled, +Options) is det.
 %
@@ -500,6 +535,9 @@ csv_options(Compiled, Options) :-
 %   to csv//2.  Remaining options are given to open/4.  The  default
 %   separator depends on the file name   extension and is =|\t|= for
 %   =|.tsv|= files and =|,|= otherwise.
+%
+%   @error  type_error(atomic, Field) if a field of a row is not an
+%           atom, string or number.
 
 csv_write_file(File, Data) :-
     csv_write_file(File, Data, []).
@@ -514,8 +552,7 @@ csv_write_file(File, Data, Options) :-
         close(Out)).
 
 csv_write_row(Out, OptionsRecord, Row) :-
-    phrase(emit_row(Row, OptionsRecord), String),
-    format(Out, '~s', [String]).
+    '$csv_write_row'(Out, Row, OptionsRecord).
 
 emit_csv([], _) --> [].
 emit_csv([H|T], Options) -->
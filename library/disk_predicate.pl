@@ -0,0 +1,213 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(disk_predicate,
+          [ disk_predicate/2,           % :PI, +File
+            disk_predicate_detach/1,    % :PI
+            current_disk_predicate/2,   % :PI, ?File
+            disk_predicate_count/2,     % :PI, -Count
+            disk_predicate_sync/1,      % :PI
+            disk_assertz/1,             % :Fact
+            disk_retract/1,             % :Fact
+            disk_retractall/1           % :Head
+          ]).
+:- use_module(library(error)).
+
+/** <module> Store facts of a predicate on disk
+
+This library stores the facts of a  predicate   in  a file that is mapped
+into memory rather than in clauses. The  OS loads the pages that are
+used, so the size of the fact base is  not limited by the memory and a
+database that was closed cleanly is opened without reading it. Facts
+are indexed on the first argument.
+
+Facts are added and removed using disk_assertz/1, disk_retract/1 and
+disk_retractall/1. These write through to the file. The attached
+predicate is static, so assertz/1 and friends raise a permission error.
+
+==
+?- disk_predicate(edge/2, 'edges.db').
+?- disk_assertz(edge(a, b)).
+?- edge(a, X).
+X = b.
+==
+
+The database is a pair of files: File  holds the facts and File.idx the
+index. If the process dies without   detaching  the predicate, the index
+is rebuilt from File when it is attached again.  Only one process can
+attach a file at a time.
+
+Unlike the logical update view for dynamic  predicates, a call does not
+see facts added after it started,  but   it  does  stop enumerating facts
+that are retracted while it runs.  The space of retracted facts is not
+reclaimed.
+*/
+
+:- meta_predicate
+    disk_predicate(:, +),
+    disk_predicate_detach(:),
+    current_disk_predicate(:, ?),
+    disk_predicate_count(:, -),
+    disk_predicate_sync(:),
+    disk_assertz(:),
+    disk_retract(:),
+    disk_retractall(:).
+
+:- dynamic
+    disk_db/3.                      % Module:Name/Arity, Handle, File
+
+%!  disk_predicate(:PI, +File) is det.
+%
+%   Attach the predicate PI to the  disk   database  File.  If File does
+%   not exist it is created. The   predicate  may not have clauses. After
+%   this call, the predicate enumerates the facts in File.
+%
+%   @error permission_error(attach, disk_predicate, PI) if PI is already
+%   attached or has clauses.
+
+disk_predicate(M:PI, File) :-
+    must_be(ground, PI),
+    (   PI = Name/Arity
+    ->  must_be(atom, Name),
+        must_be(nonneg, Arity)
+    ;   type_error(predicate_indicator, PI)
+    ),
+    functor(Head, Name, Arity),
+    (   (   disk_db(M:Name/Arity, _, _)
+        ;   predicate_property(M:Head, number_of_clauses(N)), N > 0
+        )
+    ->  permission_error(attach, disk_predicate, M:PI)
+    ;   true
+    ),
+    absolute_file_name(File, Path),
+    (   disk_db(_, _, Path)
+    ->  permission_error(attach, disk_file, File)
+    ;   true
+    ),
+    '$disk_db_open'(Path, Name/Arity, DB),
+    dynamic(M:Name/Arity),
+    assertz(M:(Head :- '$disk_db_clause'(DB, Head, _))),
+    compile_predicates([M:Name/Arity]),
+    assertz(disk_db(M:Name/Arity, DB, Path)).
+
+%!  disk_predicate_detach(:PI) is det.
+%
+%   Close the database of PI and make PI an empty dynamic predicate.
+
+disk_predicate_detach(M:PI) :-
+    must_be(ground, PI),
+    PI = Name/Arity,
+    (   retract(disk_db(M:PI, DB, _))
+    ->  functor(Head, Name, Arity),
+        '$set_predicate_attribute'(M:Head, dynamic, true),
+        retractall(M:Head),
+        '$disk_db_close'(DB)
+    ;   existence_error(disk_predicate, M:PI)
+    ).
+
+%!  current_disk_predicate(:PI, ?File) is nondet.
+%
+%   True when PI is attached to File.
+
+current_disk_predicate(M:PI, File) :-
+    disk_db(M:PI, _, File).
+
+%!  disk_predicate_count(:PI, -Count) is det.
+%
+%   Count is the number of facts in the database of PI.
+
+disk_predicate_count(PI, Count) :-
+    pi_db(PI, DB),
+    '$disk_db_count'(DB, Count).
+
+%!  disk_predicate_sync(:PI) is det.
+%
+%   Flush the database of PI to disk.
+
+disk_predicate_sync(PI) :-
+    pi_db(PI, DB),
+    '$disk_db_sync'(DB).
+
+%!  disk_assertz(:Fact) is det.
+%
+%   Add Fact to the end of the database of its predicate.
+
+disk_assertz(Fact) :-
+    fact_db(Fact, DB, Plain),
+    '$disk_db_assert'(DB, Plain).
+
+%!  disk_retract(:Fact) is nondet.
+%
+%   Remove a fact that unifies with Fact from the database.  Like
+%   retract/1, removes the next matching fact on backtracking.
+
+disk_retract(Fact) :-
+    fact_db(Fact, DB, Plain),
+    '$disk_db_clause'(DB, Plain, Ref),
+    '$disk_db_erase'(DB, Ref).
+
+%!  disk_retractall(:Head) is det.
+%
+%   Remove all facts that unify with Head from the database.
+
+disk_retractall(Head) :-
+    fact_db(Head, DB, Plain),
+    forall('$disk_db_clause'(DB, Plain, Ref),
+           ignore('$disk_db_erase'(DB, Ref))).
+
+
+pi_db(M:PI, DB) :-
+    must_be(ground, PI),
+    (   disk_db(M:PI, DB0, _)
+    ->  DB = DB0
+    ;   existence_error(disk_predicate, M:PI)
+    ).
+
+fact_db(M:Fact, DB, Plain) :-
+    strip_module(M:Fact, M1, Plain),
+    must_be(callable, Plain),
+    functor(Plain, Name, Arity),
+    (   disk_db(M1:Name/Arity, DB0, _)
+    ->  DB = DB0
+    ;   predicate_property(M1:Plain, imported_from(M2)),
+        disk_db(M2:Name/Arity, DB0, _)
+    ->  DB = DB0
+    ;   existence_error(disk_predicate, M1:Name/Arity)
+    ).
+
+close_all :-
+    forall(retract(disk_db(_, DB, _)),
+           '$disk_db_close'(DB)).
+
+:- at_halt(close_all).
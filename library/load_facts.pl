@@ -0,0 +1,174 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(load_facts,
+          [ load_facts/2                % :File, +Options
+          ]).
+:- use_module(library(error)).
+:- use_module(library(option)).
+
+:- predicate_options(load_facts/2, 2,
+                     [ module(atom),
+                       encoding(atom),
+                       expand(boolean)
+                     ]).
+
+/** <module> Fast loading of large fact files
+
+This library loads data files that   consist  mostly of ground facts. It
+is much faster than consult/1 for such files because the facts are added
+to the database as they are  read:   there  is no term expansion, no
+source administration and the term is  compiled   without  passing it
+through Prolog. For example:
+
+==
+?- load_facts('edges.pl', [module(graph)]).
+==
+
+The file may contain other clauses,  directives and grammar rules. These
+are handled as by consult/1, except   that  clauses are added using
+assertz/1. This implies that predicates  that   are  not  yet defined
+become dynamic and that loading the file   again  adds the clauses once
+more rather than replacing them.
+
+Clause indexes are created by the first  call that needs them, so they
+are built once after the data is loaded rather than while loading.
+*/
+
+:- meta_predicate
+    load_facts(:, +).
+
+%!  load_facts(:File, +Options) is det.
+%
+%   Add the clauses of File to the end  of their predicates. Options
+%   processed:
+%
+%     - module(+Module)
+%       Module into which the  clauses  are   loaded  and whose syntax
+%       flags are used to read  them.  Default   is  the  module from
+%       which load_facts/2 is called.
+%     - encoding(+Encoding)
+%       Encoding of File.  Default is `utf8`.
+%     - expand(+Boolean)
+%       If `true`, pass all terms through expand_term/2.  Default is
+%       `true` if term_expansion/2 or term_expansion/4 is defined for
+%       Module or `user` and `false` otherwise.  If `false`, ground
+%       facts are added without calling Prolog.  Other terms are
+%       always expanded.
+
+load_facts(M:Spec, Options) :-
+    must_be(list, Options),
+    option(module(Module), Options, M),
+    must_be(atom, Module),
+    option(encoding(Enc), Options, utf8),
+    (   option(expand(Expand), Options)
+    ->  must_be(boolean, Expand)
+    ;   has_term_expansion(Module)
+    ->  Expand = true
+    ;   Expand = false
+    ),
+    absolute_file_name(Spec, File,
+                       [ file_type(prolog),
+                         access(read)
+                       ]),
+    setup_call_cleanup(
+        open(File, read, In, [encoding(Enc)]),
+        load_stream(Expand, In, Module),
+        close(In)).
+
+%   The term_expansion/2 rules in module `system` only handle directives
+%   and functional notation on dicts.  These terms are not passed to
+%   '$load_facts'/4, so we only need to expand if other rules exist.
+
+has_term_expansion(Module) :-
+    '$def_modules'(Module:[term_expansion/4,term_expansion/2], MList),
+    member(M-_, MList),
+    M \== system,
+    !.
+
+load_stream(Expand, In, Module) :-
+    '$set_source_module'(Old, Module),
+    call_cleanup(load_stream_(Expand, In, Module),
+                 '$set_source_module'(Old)).
+
+load_stream_(false, In, Module) :-
+    '$load_facts'(In, Module, _Count, Term),
+    (   Term == end_of_file
+    ->  true
+    ;   expand_term(Term, Expanded),
+        load_term(Expanded, Module),
+        load_stream_(false, In, Module)
+    ).
+load_stream_(true, In, Module) :-
+    expand_stream(In, Module).
+
+expand_stream(In, Module) :-
+    read_clause(In, Term, []),
+    (   Term == end_of_file
+    ->  true
+    ;   expand_term(Term, Expanded),
+        load_term(Expanded, Module),
+        expand_stream(In, Module)
+    ).
+
+load_term(Var, _) :-
+    var(Var),
+    !,
+    instantiation_error(Var).
+load_term([], _) :- !.
+load_term([H|T], Module) :-
+    !,
+    load_term(H, Module),
+    load_term(T, Module).
+load_term((:- Directive), Module) :-
+    !,
+    directive(Directive, Module).
+load_term((?- Directive), Module) :-
+    !,
+    directive(Directive, Module).
+load_term((Head --> Body), Module) :-
+    !,
+    dcg_translate_rule((Head --> Body), Clause),
+    load_term(Clause, Module).
+load_term(Clause, Module) :-
+    assertz(Module:Clause).
+
+directive(Goal, Module) :-
+    (   catch(Module:Goal, E, true)
+    ->  (   var(E)
+        ->  true
+        ;   print_message(error, E)
+        )
+    ;   print_message(warning, goal_failed(directive, Module:Goal))
+    ).
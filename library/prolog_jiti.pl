@@ -78,6 +78,9 @@ by the system and can help diagnosing space and performance issues.
 %         terms with the same name/arity that may be used to create
 %         deep indexes.  The deep indexes themselves are created
 %         as just-in-time indexes.
+%       - =O= denotes an ordered index as used by clause_range/4.
+%         For these, _Buckets_ is the number of entries and the
+%         _Speedup_ is not defined.
 
 jiti_list :-
     jiti_list(_:_).
@@ -117,6 +120,13 @@ print_indexed((M:Head)-[Args-hash(Buckets,Speedup,_Size,List)|More]) :-
            [M:Name/Arity, ArgsS,Buckets,Speedup,Flags]),
     maplist(print_secondary_index, More),
     !.
+print_indexed((M:Head)-[Args-ordered(Entries,_Size)|More]) :-
+    functor(Head, Name, Arity),
+    phrase(iarg_spec(Args), ArgsS),
+    format('~q ~t~48|~s ~t~8+ ~t~D~6+ ~t~w~8+ ~t~w~3+~n',
+           [M:Name/Arity, ArgsS,Entries,-,'O']),
+    maplist(print_secondary_index, More),
+    !.
 print_indexed(Pair) :-
     format('Failed: ~p~n', [Pair]).
 
@@ -126,6 +136,11 @@ print_secondary_index(Args-hash(Buckets,Speedup,_Size,List)) :-
     format('~t~48|~s ~t~8+ ~t~D~6+ ~t~1f~8+ ~t~s~3+~n',
            [ArgsS,Buckets,Speedup,Flags]),
     !.
+print_secondary_index(Args-ordered(Entries,_Size)) :-
+    phrase(iarg_spec(Args), ArgsS),
+    format('~t~48|~s ~t~8+ ~t~D~6+ ~t~w~8+ ~t~w~3+~n',
+           [ArgsS,Entries,-,'O']),
+    !.
 print_secondary_index(Pair) :-
     format('Secondary failed: ~p~n', [Pair]).
 
@@ -0,0 +1,328 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+:- module(prolog_sampler,
+          [ sample_profile/1,           % :Goal
+            sample_profile/2,           % :Goal, +Options
+            sampler_start/1,            % +Options
+            sampler_stop/0,
+            sampler_reset/0,
+            sampler_samples/1,          % -Samples
+            sampler_collapsed/2,        % +Output, +Options
+            show_samples/1              % +Options
+          ]).
+:- use_module(library(option)).
+:- use_module(library(error)).
+:- use_module(library(lists)).
+:- use_module(library(pairs)).
+:- use_module(library(apply)).
+
+:- meta_predicate
+    sample_profile(0),
+    sample_profile(0, +).
+
+/** <module> Sampling profiler for multi-threaded programs
+
+This library provides a statistical profiler   that samples the call
+stacks of _all_ Prolog threads. Unlike profile/1,  it does not keep a
+call-tree and does not instrument the execution, which makes it suitable
+for profiling a running (server) process.
+
+A sampler thread wakes up at the sampling  rate and asks all other
+threads to record their stack the next  time they check for signals.
+Requests that arrive while the thread is  blocked are counted when it
+records its stack.  Samples thus represent wall time.  Samples of
+identical stacks are combined.  The result can be written in the
+_collapsed stack_ format that is read by flame graph tools such as
+=flamegraph.pl= and https://www.speedscope.app:
+
+```
+?- sampler_start([rate(200)]).
+... run the workload ...
+?- sampler_stop,
+   setup_call_cleanup(open('out.folded', write, Out),
+                      sampler_collapsed(Out, []),
+                      close(Out)).
+```
+
+```
+% flamegraph.pl out.folded > out.svg
+```
+*/
+
+:- dynamic
+    sampler/2.                          % Thread, Queue
+
+%!  sample_profile(:Goal) is semidet.
+%!  sample_profile(:Goal, +Options) is semidet.
+%
+%   Run Goal as once/1 with the sampling profiler enabled for all
+%   threads.  Old samples are removed before starting.  When completed,
+%   the collected samples are written to file(File) in collapsed stack
+%   format if this option is given and summarised using show_samples/1
+%   otherwise.  Options are passed to sampler_start/1, show_samples/1
+%   and sampler_collapsed/2.
+
+sample_profile(Goal) :-
+    sample_profile(Goal, []).
+
+sample_profile(Goal, Options) :-
+    sampler_reset,
+    setup_call_cleanup(
+        sampler_start(Options),
+        once(Goal),
+        ( sampler_stop,
+          report(Options)
+        )).
+
+report(Options) :-
+    option(file(File), Options),
+    !,
+    setup_call_cleanup(
+        open(File, write, Out),
+        sampler_collapsed(Out, Options),
+        close(Out)).
+report(Options) :-
+    show_samples(Options).
+
+%!  sampler_start(+Options) is det.
+%
+%   Start sampling all threads.  Samples are added to the samples that
+%   are already collected.  Options:
+%
+%     - rate(+Hz)
+%       Sampling frequency.  Default is 100.
+%     - depth(+Max)
+%       Record at most the Max innermost frames of each stack.  Default
+%       is 128.  Deeper stacks are marked as truncated.
+%
+%   @error permission_error(start, sampler, Thread) if the sampler is
+%   already running.
+
+sampler_start(Options) :-
+    option(rate(Hz), Options, 100),
+    option(depth(Depth), Options, 128),
+    must_be(positive_integer, Hz),
+    must_be(positive_integer, Depth),
+    Interval is 1/Hz,
+    with_mutex(prolog_sampler, start_sampler(Interval, Depth)).
+
+start_sampler(_, _) :-
+    sampler(Thread, _),
+    !,
+    permission_error(start, sampler, Thread).
+start_sampler(Interval, Depth) :-
+    '$prof_sample_start'(Depth),
+    message_queue_create(Queue),
+    thread_create(sample_loop(Queue, Interval), Thread, []),
+    assertz(sampler(Thread, Queue)).
+
+sample_loop(Queue, Interval) :-
+    (   thread_get_message(Queue, stop, [timeout(Interval)])
+    ->  true
+    ;   '$prof_sample_tick',
+        sample_loop(Queue, Interval)
+    ).
+
+%!  sampler_stop is det.
+%
+%   Stop sampling.  The collected samples are kept.  Succeeds silently
+%   if the sampler is not running.
+
+sampler_stop :-
+    with_mutex(prolog_sampler, stop_sampler).
+
+stop_sampler :-
+    retract(sampler(Thread, Queue)),
+    !,
+    thread_send_message(Queue, stop),
+    thread_join(Thread, _),
+    message_queue_destroy(Queue),
+    '$prof_sample_stop'.
+stop_sampler.
+
+%!  sampler_reset is det.
+%
+%   Remove all collected samples.
+
+sampler_reset :-
+    '$prof_sample_reset'.
+
+%!  sampler_samples(-Samples) is det.
+%
+%   Samples is a list of terms sample(Thread, Stack, Count), where
+%   Thread is the alias or id of the sampled thread, Stack is a list
+%   of predicate indicators Module:Name/Arity, outermost first, and
+%   Count is the number of times this stack was sampled.  If the stack
+%   was deeper than the `depth` option of sampler_start/1, Stack
+%   starts with the atom `'...'`.
+
+sampler_samples(Samples) :-
+    '$prof_samples'(Raw),
+    maplist(sample, Raw, Samples).
+
+sample(sample(Thread, Truncated, Stack0, Count),
+       sample(Thread, Stack, Count)) :-
+    (   Truncated == true
+    ->  Stack = ['...'|Stack0]
+    ;   Stack = Stack0
+    ).
+
+%!  sampler_collapsed(+Output, +Options) is det.
+%
+%   Write the samples to the stream Output in the _collapsed stack_
+%   format: one line per distinct stack holding the frames separated
+%   by `;`, a space and the sample count.  Options:
+%
+%     - threads(+Bool)
+%       If `true` (default), use the thread as outermost frame.  If
+%       `false`, merge the samples of all threads.
+%     - system(+Bool)
+%       If `false` (default), omit frames of predicates in the module
+%       `system`.
+
+sampler_collapsed(Out, Options) :-
+    option(threads(Threads), Options, true),
+    option(system(System), Options, false),
+    sampler_samples(Samples),
+    foldl(collapsed_line(Threads, System), Samples, Lines, []),
+    keysort(Lines, Sorted),
+    group_pairs_by_key(Sorted, Grouped),
+    forall(member(Line-Counts, Grouped),
+           ( sum_list(Counts, Count),
+             format(Out, '~w ~d~n', [Line, Count])
+           )).
+
+collapsed_line(Threads, System, sample(Thread, Stack0, Count)) -->
+    { include(show_frame(System), Stack0, Stack1),
+      (   Threads == true
+      ->  Stack = [Thread|Stack1]
+      ;   Stack = Stack1
+      ),
+      Stack \== [],
+      maplist(frame_label, Stack, Labels),
+      atomic_list_concat(Labels, ;, Line)
+    },
+    !,
+    [Line-Count].
+collapsed_line(_, _, _) -->
+    [].
+
+show_frame(true, _) :- !.
+show_frame(false, Frame) :-
+    Frame \= system:_.
+
+%   Frame labels may not contain ';' or newlines as these separate
+%   frames and lines.
+
+frame_label(Frame, Label) :-
+    format(atom(Label0), '~q', [Frame]),
+    atomic_list_concat(Parts, ;, Label0),
+    atomic_list_concat(Parts, ',', Label1),
+    atomic_list_concat(Lines, '\n', Label1),
+    atomic_list_concat(Lines, ' ', Label).
+
+%!  show_samples(+Options) is det.
+%
+%   Print the predicates that appear most often  in the samples. Self
+%   is the percentage of samples with the predicate innermost; Total is
+%   the percentage of samples in which the  predicate appears anywhere
+%   on the stack.  Options:
+%
+%     - top(+N)
+%       Show the top N predicates (default 25).
+%     - cumulative(+Bool)
+%       If `true`, sort by Total rather than by Self.
+
+show_samples(Options) :-
+    option(top(N), Options, 25),
+    sampler_samples(Samples),
+    '$prof_sample_statistics'(_Ticks, Total, _Stacks),
+    predicate_counts(Samples, Counts),
+    (   option(cumulative(true), Options)
+    ->  map_list_to_pairs(total_key, Counts, Keyed)
+    ;   map_list_to_pairs(self_key, Counts, Keyed)
+    ),
+    sort(1, @>=, Keyed, Sorted),
+    pairs_values(Sorted, Rows),
+    format('~`=t~69|~n'),
+    format('Total samples: ~D~n', [Total]),
+    format('~`=t~69|~n'),
+    format('~w~t~w~57|~t~w~69|~n', ['Predicate', 'Self', 'Total']),
+    format('~`=t~69|~n'),
+    forall(( nth1(I, Rows, count(PI, Self, Incl)), I =< N ),
+           ( SelfP is 100*Self/max(1,Total),
+             InclP is 100*Incl/max(1,Total),
+             format('~q~t~1f%~57|~t~1f%~69|~n', [PI, SelfP, InclP])
+           )).
+
+self_key(count(_, Self, _), Self).
+total_key(count(_, _, Total), Total).
+
+%   predicate_counts(+Samples, -Counts) computes count(PI, Self, Total)
+%   for each predicate.  Recursive predicates are counted once per
+%   sample for Total.
+
+predicate_counts(Samples, Counts) :-
+    foldl(sample_counts, Samples, Pairs, []),
+    keysort(Pairs, Sorted),
+    group_pairs_by_key(Sorted, Grouped),
+    maplist(sum_counts, Grouped, Counts).
+
+sample_counts(sample(_, Stack, Count)) -->
+    { sort(Stack, Unique),
+      last(Stack, Leaf)
+    },
+    self_count(Leaf, Count),
+    total_counts(Unique, Count).
+
+self_count('...', _) --> !.
+self_count(PI, Count) --> [PI-self(Count)].
+
+total_counts([], _) --> [].
+total_counts(['...'|T], Count) --> !, total_counts(T, Count).
+total_counts([PI|T], Count) --> [PI-total(Count)], total_counts(T, Count).
+
+sum_counts(PI-Values, count(PI, Self, Total)) :-
+    aggregate_counts(Values, 0, Self, 0, Total).
+
+aggregate_counts([], S, S, T, T).
+aggregate_counts([self(C)|R], S0, S, T0, T) :-
+    !,
+    S1 is S0+C,
+    aggregate_counts(R, S1, S, T0, T).
+aggregate_counts([total(C)|R], S0, S, T0, T) :-
+    T1 is T0+C,
+    aggregate_counts(R, S0, S, T1, T).
@@ -48,6 +48,8 @@
 
 %:- debug(concurrent).
 
+:- create_prolog_flag(concurrent_pool, false, [type(boolean), keep(true)]).
+
 :- meta_predicate
     concurrent(+, :, +),
     concurrent_maplist(1, +),
@@ -56,7 +58,8 @@
     first_solution(-, :, +).
 
 :- predicate_options(concurrent/3, 3,
-                     [ pass_to(system:thread_create/3, 3)
+                     [ pool(boolean),
+                       pass_to(system:thread_create/3, 3)
                      ]).
 :- predicate_options(first_solution/3, 3,
                      [ on_fail(oneof([stop,continue])),
@@ -129,14 +132,36 @@ following consequences:
 %     * If one or more of the goals may fail or produce an error,
 %     using a higher number of threads may find this earlier.
 %
-%   @param N Number of worker-threads to create. Using 1, no threads
-%          are created.  If N is larger than the number of Goals we
-%          create exactly as many threads as there are Goals.
+%   By default, each call creates its own worker threads.  With the
+%   option pool(true), or if the Prolog flag =concurrent_pool= is
+%   `true` and no pool(false) is given, the goals are executed by a
+%   pool of worker threads that is created on first use and shared by
+%   all calls.  This avoids creating threads for each call.  At most N
+%   goals of a call run at the same time and the pool grows to the
+%   largest N requested.  If a goal fails or raises an exception, the
+%   goals of the call that are still running are cancelled and
+%   concurrent/3 waits for them before it fails or re-throws.  Pool
+%   workers are reused for the goals of later calls.  Clauses of
+%   thread_local/1 predicates, global variables (see nb_setval/2) and
+%   thread-specific Prolog flags that a goal creates or modifies in its
+%   worker are therefore visible to later goals that run in the same
+%   worker, while the flags of the caller are not.  Only use the pool
+%   for goals that do not depend on such thread state.
+%
+%   If concurrent/3 is called from a goal that runs in a pool worker,
+%   the Goals are executed sequentially in that worker, as if N is 1.
+%   Waiting for other pool workers from a pool worker may deadlock.
+%
+%   @param N Number of worker-threads to use. Using 1, no threads
+%          are used.  If N is larger than the number of Goals we
+%          use exactly as many threads as there are Goals.
 %   @param Goals List of callable terms.
-%   @param Options Passed to thread_create/3 for creating the
-%          workers.  Only options changing the stack-sizes can
-%          be used. In particular, do not pass the detached or alias
-%          options.
+%   @param Options Besides pool(Bool), options are passed to
+%          thread_create/3 for creating the workers.  Only options
+%          changing the stack-sizes can be used. In particular, do not
+%          pass the detached or alias options.  If such options are
+%          given, dedicated workers are created for this call, also if
+%          the pool is enabled.
 %   @see In many cases, concurrent_maplist/2 and friends
 %        is easier to program and is tractable to program
 %        analysis.
@@ -147,6 +172,18 @@ concurrent(1, M:List, _) :-
 concurrent(N, M:List, Options) :-
     must_be(positive_integer, N),
     must_be(list(callable), List),
+    current_prolog_flag(concurrent_pool, PoolDefault),
+    select_option(pool(Pool), Options, ThreadOptions, PoolDefault),
+    (   nb_current('$concurrent_job', Job),
+        Job \== []
+    ->  maplist(once_in_module(M), List)
+    ;   Pool == true,
+        ThreadOptions == []
+    ->  pool_concurrent(N, M, List)
+    ;   thread_concurrent(N, M, List, ThreadOptions)
+    ).
+
+thread_concurrent(N, M, List, Options) :-
     length(List, JobCount),
     message_queue_create(Done),
     message_queue_create(Queue),
@@ -277,6 +314,178 @@ join_all([Id|T]) :-
     join_all(T).
 
 
+                 /*******************************
+                 *          WORKER POOL         *
+                 *******************************/
+
+%   The pool is a set of detached threads that read jobs from a shared
+%   queue.  A job is a term job(Done, Id, Goal, Vars), where Done is the
+%   queue of the caller.  The worker replies done(Id, Vars), failed(Id),
+%   error(Id, Error) or cancelled(Id).  While running a job, the global
+%   variable '$concurrent_job' holds Done, which allows the caller to
+%   cancel its own jobs using thread_signal/2 without affecting other
+%   calls.  The caller keeps the number of submitted jobs that did not
+%   reply in a term pending(Count).
+
+:- dynamic
+    pool_queue/2,                   % Queue, Size
+    pool_worker/1,                  % ThreadId
+    pool_cancelled/1.               % Done
+
+pool_concurrent(N, M, List) :-
+    length(List, JobCount),
+    WorkerCount is min(N, JobCount),
+    pool(WorkerCount, Queue),
+    make_jobs(List, 1, M, Jobs, VarList),
+    VT =.. [vars|VarList],
+    Pending = pending(0),
+    setup_call_cleanup(
+        message_queue_create(Done),
+        pool_run(Jobs, WorkerCount, Queue, Done, VT, Pending, Result),
+        pool_cleanup(Result, Done, Pending)),
+    (   Result == true
+    ->  true
+    ;   Result = false
+    ->  fail
+    ;   Result = exception(Error)
+    ->  throw(Error)
+    ).
+
+make_jobs([], _, _, [], []).
+make_jobs([H|T], I, M, [job(I, M:H, Vars)|Jobs], [Vars|VT]) :-
+    term_variables(H, Vars),
+    I2 is I + 1,
+    make_jobs(T, I2, M, Jobs, VT).
+
+%!  pool_run(+Jobs, +Max, +Queue, +Done, +VT, +Pending, -Result) is det.
+%
+%   Submit Jobs to the pool, keeping at most Max of them running, and
+%   collect the results in VT.
+
+pool_run(Jobs0, Max, Queue, Done, VT, Pending, Result) :-
+    submit_jobs(Max, Jobs0, Queue, Done, Pending, Jobs, Running),
+    pool_wait(Running, Jobs, Queue, Done, VT, Pending, Result).
+
+submit_jobs(0, Jobs, _, _, _, Jobs, 0) :- !.
+submit_jobs(_, [], _, _, _, [], 0) :- !.
+submit_jobs(N, [job(Id, Goal, Vars)|Jobs0], Queue, Done, Pending,
+            Jobs, Running) :-
+    thread_send_message(Queue, job(Done, Id, Goal, Vars)),
+    pending_add(Pending, 1),
+    N2 is N - 1,
+    submit_jobs(N2, Jobs0, Queue, Done, Pending, Jobs, Running0),
+    Running is Running0 + 1.
+
+pool_wait(0, [], _, _, _, _, true) :- !.
+pool_wait(Running, Jobs0, Queue, Done, VT, Pending, Result) :-
+    thread_get_message(Done, Msg),
+    pending_add(Pending, -1),
+    debug(concurrent, 'Concurrent: received ~p', [Msg]),
+    (   Msg = done(Id, Vars)
+    ->  arg(Id, VT, Vars),
+        submit_jobs(1, Jobs0, Queue, Done, Pending, Jobs, New),
+        Running1 is Running - 1 + New,
+        pool_wait(Running1, Jobs, Queue, Done, VT, Pending, Result)
+    ;   Msg = failed(_)
+    ->  Result = false
+    ;   Msg = error(_, Error)
+    ->  Result = exception(Error)
+    ).
+
+pending_add(Pending, N) :-
+    arg(1, Pending, N0),
+    N1 is N0 + N,
+    nb_setarg(1, Pending, N1).
+
+%!  pool_cleanup(+Result, +Done, +Pending) is det.
+%
+%   Unless all jobs completed, cancel the jobs of this call and wait
+%   until all of them replied, such that no goal of this call is
+%   running when concurrent/3 returns.  Jobs that did not start are
+%   skipped by the workers because of pool_cancelled/1.  As a worker
+%   sets '$concurrent_job' before it checks pool_cancelled/1, a job is
+%   either skipped or cancelled.  Finally, destroy the reply queue.
+
+pool_cleanup(Result, Done, Pending) :-
+    (   Result == true
+    ->  true
+    ;   arg(1, Pending, Count),
+        Count > 0
+    ->  setup_call_cleanup(
+            assertz(pool_cancelled(Done)),
+            ( forall(pool_worker(Id),
+                     catch(thread_signal(Id, cancel_job(Done)), _, true)),
+              forall(between(1, Count, _),
+                     thread_get_message(Done, _))
+            ),
+            retractall(pool_cancelled(Done)))
+    ;   true
+    ),
+    message_queue_destroy(Done).
+
+cancel_job(Done) :-
+    nb_current('$concurrent_job', Done),
+    !,
+    throw(concurrent_cancelled).
+cancel_job(_).
+
+%!  pool(+Size, -Queue) is det.
+%
+%   Queue is the job queue of a pool with at least Size workers.
+
+pool(Size, Queue) :-
+    pool_queue(Queue, Count),
+    Count >= Size,
+    !.
+pool(Size, Queue) :-
+    with_mutex(concurrent_pool, grow_pool(Size, Queue)).
+
+grow_pool(Size, Queue) :-
+    (   retract(pool_queue(Queue, Count))
+    ->  true
+    ;   message_queue_create(Queue),
+        Count = 0
+    ),
+    NewCount is max(Size, Count),
+    forall(between(Count, NewCount, I),
+           (   I < NewCount
+           ->  thread_create(pool_worker_loop(Queue), Id,
+                             [ detached(true)
+                             ]),
+               assertz(pool_worker(Id))
+           ;   true
+           )),
+    assertz(pool_queue(Queue, NewCount)).
+
+pool_worker_loop(Queue) :-
+    nb_setval('$concurrent_job', []),
+    repeat,
+      thread_get_message(Queue, Job),
+      catch(run_job(Job), _, true),
+      fail.
+
+run_job(job(Done, Id, Goal, Vars)) :-
+    catch(setup_call_cleanup(
+              nb_setval('$concurrent_job', Done),
+              (   pool_cancelled(Done)
+              ->  Reply = cancelled(Id)
+              ;   job_result(Goal, Id, Vars, Reply)
+              ),
+              nb_setval('$concurrent_job', [])),
+          concurrent_cancelled,
+          Reply = cancelled(Id)),
+    thread_send_message(Done, Reply).
+
+job_result(Goal, Id, Vars, Reply) :-
+    (   catch(Goal, E, true)
+    ->  (   var(E)
+        ->  Reply = done(Id, Vars)
+        ;   Reply = error(Id, E)
+        )
+    ;   Reply = failed(Id)
+    ).
+
+
                  /*******************************
                  *             MAPLIST          *
                  *******************************/
@@ -294,14 +503,18 @@ join_all([Id|T]) :-
 %   based on once/1. Note that all goals   are executed as if wrapped in
 %   once/1 and therefore these predicates are _semidet_.
 %
-%   Note that the the overhead  of   this  predicate is considerable and
-%   therefore Goal must  be  fairly  expensive   before  one  reaches  a
-%   speedup.
+%   The lists are split into chunks of   about  a quarter of the length
+%   divided by the number  of  workers.  Each   chunk  is  a job for
+%   concurrent/3. This keeps   the overhead per element low, while
+%   workers that finish early take the next chunk.  The worker pool of
+%   concurrent/3 is used if the Prolog flag =concurrent_pool= is `true`.
 
 concurrent_maplist(Goal, List) :-
-    workers(List, WorkerCount),
+    workers(List, WorkerCount, ChunkSize),
     !,
-    maplist(ml_goal(Goal), List, Goals),
+    strip_module(Goal, M, G),
+    chunks(List, ChunkSize, Chunks),
+    maplist(ml_goal(M:G), Chunks, Goals),
     concurrent(WorkerCount, Goals, []).
 concurrent_maplist(M:Goal, List) :-
     maplist(once_in_module(M, Goal), List).
@@ -309,13 +522,16 @@ concurrent_maplist(M:Goal, List) :-
 once_in_module(M, Goal, Arg) :-
     call(M:Goal, Arg), !.
 
-ml_goal(Goal, Elem, call(Goal, Elem)).
+ml_goal(M:Goal, Chunk, maplist(once_in_module(M, Goal), Chunk)).
 
 concurrent_maplist(Goal, List1, List2) :-
     same_length(List1, List2),
-    workers(List1, WorkerCount),
+    workers(List1, WorkerCount, ChunkSize),
     !,
-    maplist(ml_goal(Goal), List1, List2, Goals),
+    strip_module(Goal, M, G),
+    chunks(List1, ChunkSize, Chunks1),
+    chunks(List2, ChunkSize, Chunks2),
+    maplist(ml_goal(M:G), Chunks1, Chunks2, Goals),
     concurrent(WorkerCount, Goals, []).
 concurrent_maplist(M:Goal, List1, List2) :-
     maplist(once_in_module(M, Goal), List1, List2).
@@ -323,13 +539,18 @@ concurrent_maplist(M:Goal, List1, List2) :-
 once_in_module(M, Goal, Arg1, Arg2) :-
     call(M:Goal, Arg1, Arg2), !.
 
-ml_goal(Goal, Elem1, Elem2, call(Goal, Elem1, Elem2)).
+ml_goal(M:Goal, Chunk1, Chunk2,
+        maplist(once_in_module(M, Goal), Chunk1, Chunk2)).
 
 concurrent_maplist(Goal, List1, List2, List3) :-
     same_length(List1, List2, List3),
-    workers(List1, WorkerCount),
+    workers(List1, WorkerCount, ChunkSize),
     !,
-    maplist(ml_goal(Goal), List1, List2, List3, Goals),
+    strip_module(Goal, M, G),
+    chunks(List1, ChunkSize, Chunks1),
+    chunks(List2, ChunkSize, Chunks2),
+    chunks(List3, ChunkSize, Chunks3),
+    maplist(ml_goal(M:G), Chunks1, Chunks2, Chunks3, Goals),
     concurrent(WorkerCount, Goals, []).
 concurrent_maplist(M:Goal, List1, List2, List3) :-
     maplist(once_in_module(M, Goal), List1, List2, List3).
@@ -337,15 +558,33 @@ concurrent_maplist(M:Goal, List1, List2, List3) :-
 once_in_module(M, Goal, Arg1, Arg2, Arg3) :-
     call(M:Goal, Arg1, Arg2, Arg3), !.
 
-ml_goal(Goal, Elem1, Elem2, Elem3, call(Goal, Elem1, Elem2, Elem3)).
+ml_goal(M:Goal, Chunk1, Chunk2, Chunk3,
+        maplist(once_in_module(M, Goal), Chunk1, Chunk2, Chunk3)).
 
-workers(List, Count) :-
+workers(List, Count, ChunkSize) :-
     current_prolog_flag(cpu_count, Cores),
     Cores > 1,
     length(List, Len),
     Count is min(Cores,Len),
     Count > 1,
-    !.
+    !,
+    ChunkSize is max(1, Len // (Count*4)).
+
+%!  chunks(+List, +Size, -Chunks) is det.
+%
+%   Split List into a list of lists of Size elements.  The last chunk
+%   may be shorter.
+
+chunks([], _, []) :- !.
+chunks(List, Size, [Chunk|Chunks]) :-
+    take(Size, List, Chunk, Rest),
+    chunks(Rest, Size, Chunks).
+
+take(0, List, [], List) :- !.
+take(_, [], [], []) :- !.
+take(N, [H|T0], [H|T], Rest) :-
+    N2 is N - 1,
+    take(N2, T0, T, Rest).
 
 same_length([], [], []).
 same_length([_|T1], [_|T2], [_|T3]) :-
@@ -784,6 +784,16 @@ PL_EXPORT(char *)	PL_record_external(term_t t, size_t *size);
 PL_EXPORT(int)		PL_recorded_external(const char *rec, term_t term);
 PL_EXPORT(int)		PL_erase_external(char *rec);
 
+		 /*******************************
+		 *	  DYNAMIC DATABASE	*
+		 *******************************/
+
+#define PL_ASSERTZ	0x0000		/* Add clauses at the end */
+#define PL_ASSERTA	0x0001		/* Add clauses at the start */
+
+PL_EXPORT(int)		PL_assert_list(term_t clauses, module_t m, int flags);
+PL_EXPORT(int)		PL_retract_list(term_t clauses, module_t m);
+
 		 /*******************************
 		 *	   PROLOG FLAGS		*
 		 *******************************/
@@ -49,7 +49,8 @@ test_arith :-
 		    float_overflow,
 		    float_zero,
 		    float_special,
-		    arith_misc
+		    arith_misc,
+		    ar_float
 		  ]).
 
 :- begin_tests(div).
@@ -456,3 +457,86 @@ test(string) :-
 	0'a =:= "a".
 
 :- end_tests(arith_misc).
+
+
+:- begin_tests(ar_float).
+
+% Compile the clauses below using the arithmetic VM instructions.  The
+% optimise flag is file-scoped, so this unit must be last.
+:- set_prolog_flag(optimise, true).
+
+c_add(X, Y, Z)  :- Z is X+Y.
+c_sub(X, Y, Z)  :- Z is X-Y.
+c_mul(X, Y, Z)  :- Z is X*Y.
+c_div(X, Y, Z)  :- Z is X/Y.
+c_sqrt(X, Y)    :- Y is sqrt(X).
+c_log(X, Y)     :- Y is log(X).
+c_exp(X, Y)     :- Y is exp(X).
+c_neg(X, Y)     :- Y is -X.
+c_abs(X, Y)     :- Y is abs(X).
+c_expr(X, Y, Z) :- Z is sqrt(X*X + Y*Y) / (X - Y) + sin(X) * 2.
+c_lt(X, Y)      :- X < Y.
+c_gt(X, Y)      :- X > Y.
+c_eq(X, Y)      :- X =:= Y.
+
+test(add, Z == 0.30000000000000004) :-
+	c_add(0.1, 0.2, Z).
+test(add_mixed, Z == 2.5) :-
+	c_add(2, 0.5, Z).
+test(sub, Z == 0.5) :-
+	c_sub(1.5, 1, Z).
+test(sub_int, Z == -1) :-
+	c_sub(1, 2, Z).
+test(mul, Z == 7.0) :-
+	c_mul(2, 3.5, Z).
+test(div, Z == 3.5) :-
+	c_div(7, 2.0, Z).
+test(div_int, Z == Expected) :-
+	c_div(4, 2, Z),
+	Expected is 4/2.
+test(expr, Z == Expected) :-
+	X = 3.0, Y = 2.5,
+	c_expr(X, Y, Z),
+	Expected is sqrt(X*X + Y*Y) / (X - Y) + sin(X) * 2.
+test(div_zero, error(evaluation_error(zero_divisor))) :-
+	c_div(1, 0.0, _).
+test(div_zero, error(evaluation_error(zero_divisor))) :-
+	c_div(0.0, 0.0, _).
+test(overflow, error(evaluation_error(float_overflow))) :-
+	c_mul(1.0e200, 1.0e200, _).
+test(overflow, error(evaluation_error(float_overflow))) :-
+	c_sub(1.0e308, -1.0e308, _).
+test(sqrt, Y == 2.0) :-
+	c_sqrt(4.0, Y).
+test(sqrt, Y == 2.0) :-
+	c_sqrt(4, Y).
+test(sqrt, error(evaluation_error(undefined))) :-
+	c_sqrt(-1.0, _).
+test(log, error(evaluation_error(undefined))) :-
+	c_log(0.0, _).
+test(exp, error(evaluation_error(float_overflow))) :-
+	c_exp(1000.0, _).
+test(neg, Y == -2.5) :-
+	c_neg(2.5, Y).
+test(neg, Y == -3) :-
+	c_neg(3, Y).
+test(abs, Y == 2.5) :-
+	c_abs(-2.5, Y).
+test(cmp_mixed) :-
+	c_lt(1, 1.5),
+	\+ c_lt(2, 1.5),
+	c_eq(1, 1.0).
+test(cmp_nan, Compiled == Interpreted) :-
+	X is nan,
+	findall(R, ( member(G, [c_lt(X,1), c_lt(1,X), c_gt(X,1), c_gt(1,X)]),
+		     ( call(G) -> R = true ; R = false )
+		   ), Compiled),
+	findall(R, ( member(G, [X<1, 1<X, X>1, 1>X]),
+		     ( call(G) -> R = true ; R = false )
+		   ), Interpreted).
+test(decompile, Body == (Z is X/Y)) :-
+	clause(c_div(X, Y, Z), Body).
+test(decompile, Body == (Z is X-Y)) :-
+	clause(c_sub(X, Y, Z), Body).
+
+:- end_tests(ar_float).
@@ -83,6 +83,23 @@ test(agc, Xs == [ aaaa100001,aaaa100002,aaaa100003,aaaa100004,
 	offset(10 000, findnsols(10, X, gen_atom(X), Xs)),
 	!.
 
+test(bagof_group, all(K-L == [a-[1,3],b-[2]])) :-
+	bagof(V, member(K-V, [a-1,b-2,a-3]), L).
+test(bagof_variant, all(K-L =@= [f(_)-[1,3],f(x)-[2]])) :-
+	bagof(V, variant_key(K, V), L).
+test(bagof_shared, L =@= [X-1,X-3]) :-
+	bagof(K-V, shared_key(K, V, _X), L).
+test(setof_group, all(K-L == [a-[1,2],b-[2]])) :-
+	setof(V, member(K-V, [a-2,b-2,a-1,a-2]), L).
+
+variant_key(f(_), 1).
+variant_key(f(x), 2).
+variant_key(f(_), 3).
+
+shared_key(X, 1, X).
+shared_key(b, 2, c).
+shared_key(X, 3, X).
+
 gen_atom(A) :-
 	between(1, infinite, X),
 	atom_concat(aaaa, X, A).
@@ -45,6 +45,7 @@ test_db :-
 	run_tests([ assert,
 		    retract,
 		    retractall,
+		    batch,
 		    dynamic,
 		    protect,
 		    res_compiler
@@ -159,6 +160,86 @@ test(type, error(permission_error(modify, static_procedure, _))) :-
 :- end_tests(retractall).
 
 
+:- begin_tests(batch).
+
+:- dynamic
+	b/2, c/1.
+
+clear_batch :-
+	retractall(b(_,_)),
+	retractall(c(_)).
+
+test(assertz, [cleanup(clear_batch), L == [1-a,2-b,3-c]]) :-
+	assertz_list([b(1,a), b(2,b), (b(3,X) :- X = c)]),
+	findall(K-V, b(K,V), L).
+test(asserta, [cleanup(clear_batch), L == [3,2,1,0]]) :-
+	assertz(c(0)),
+	asserta_list([c(1), c(2), c(3)]),
+	findall(X, c(X), L).
+test(mixed, [cleanup(clear_batch), L == [1-a,2-b]-[1,2]]) :-
+	assertz_list([b(1,a), c(1), test_db:b(2,b), c(2)]),
+	findall(K-V, b(K,V), Bs),
+	findall(X, c(X), Cs),
+	L = Bs-Cs.
+test(atomic, [cleanup(clear_batch), L == []]) :-
+	catch(assertz_list([b(1,a), atom_length(a,1)]), E, true),
+	subsumes_term(error(permission_error(modify, static_procedure, _), _),
+		      E),
+	findall(K, b(K,_), L).
+test(type, error(type_error(list, _))) :-
+	assertz_list([b(1,a)|_]).
+test(atomic_dynamic, [ setup(abolish(batch_undefined/1)),
+		       fail
+		     ]) :-
+	catch(assertz_list([batch_undefined(1), atom_length(a,1)]), _, true),
+	predicate_property(batch_undefined(_), dynamic).
+test(index, [cleanup(clear_batch), X == 500]) :-
+	assertz(b(0,0)),
+	b(0,_),				% create index
+	numlist(1, 1000, L),
+	maplist([K,b(K,K)]>>true, L, Facts),
+	assertz_list(Facts),
+	b(500, X).
+test(retract, [cleanup(clear_batch), L == [2,3]-[b,c]]) :-
+	assertz_list([b(1,a), b(1,a), b(2,b), b(3,c)]),
+	retract_list([b(1,a), b(1,V)]),
+	V == a,
+	findall(K, b(K,_), Ks),
+	findall(X, b(_,X), Xs),
+	L = Ks-Xs.
+test(retract_fail, [cleanup(clear_batch), L == [1,2]]) :-
+	assertz_list([b(1,a), b(2,b)]),
+	\+ retract_list([b(1,a), b(1,a)]),
+	\+ retract_list([b(1,a), b(3,_)]),
+	findall(K, b(K,_), L).
+test(retract_rule, [cleanup(clear_batch), B == (X = c)]) :-
+	assertz_list([(b(3,X) :- X = c), c(1)]),
+	retract_list([(b(3,X) :- B), c(1)]),
+	\+ c(_).
+test(retract_concurrent, [cleanup(clear_batch), Sorted == All]) :-
+	numlist(1, 1000, All),
+	forall(member(X, All), assertz(c(X))),
+	findall(Id, ( between(1, 2, _),
+		      thread_create(( consume_pairs(Xs), thread_exit(Xs) ),
+				    Id, [])
+		    ), Ids),
+	maplist([Id,Xs]>>thread_join(Id, exited(Xs)), Ids, Lists),
+	append(Lists, Consumed),
+	msort(Consumed, Sorted).
+test(view, [cleanup(clear_batch), L == [1,2]]) :-
+	assertz_list([c(1), c(2)]),
+	findall(X, ( c(X), assertz_list([c(3)]) ), L).
+
+consume_pairs(Xs) :-
+	(   retract_list([c(X), c(Y)])
+	->  Xs = [X,Y|T],
+	    consume_pairs(T)
+	;   Xs = []
+	).
+
+:- end_tests(batch).
+
+
 :- begin_tests(dynamic).
 
 test(make_dynamic, [true, cleanup(abolish(Name, 1))]) :-
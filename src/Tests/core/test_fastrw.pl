@@ -45,7 +45,8 @@ serizalization
 */
 
 test_fastrw :-
-	run_tests([ fastrw
+	run_tests([ fastrw,
+		    fast_term_file
 		  ]).
 
 term(int, 0).
@@ -102,3 +103,195 @@ test(error, error(permission_error(fast_serialize, blob, S))) :-
 	    close(S)).
 
 :- end_tests(fastrw).
+
+:- begin_tests(fast_term_file, [sto(rational_trees)]).
+
+write_terms(File, Mode, Terms) :-
+	setup_call_cleanup(
+	    fast_term_file_open(File, Mode, H),
+	    maplist(fast_term_file_write(H), Terms),
+	    fast_term_file_close(H)).
+
+read_terms(File, Terms) :-
+	setup_call_cleanup(
+	    fast_term_file_open(File, read, H),
+	    findall(T, fast_term_file_read(H, _, T), Terms),
+	    fast_term_file_close(H)).
+
+with_tmp_file(File, Goal) :-
+	tmp_file(ftf, File),
+	call_cleanup(Goal,
+		     catch(delete_file(File), _, true)).
+
+sum_part(H) :-
+	aggregate_all(sum(T), fast_term_file_read(H, _, T), Sum),
+	thread_exit(Sum).
+
+test(roundtrip) :-
+	findall(T, term(_,T), L),
+	with_tmp_file(File,
+		      ( write_terms(File, write, L),
+			read_terms(File, L2)
+		      )),
+	maplist(=@=, L, L2).
+test(random_access, [Count,T5,TL] == [101,f(5),f(101)]) :-
+	numlist(1, 101, Is),
+	maplist([I,f(I)]>>true, Is, Terms),
+	with_tmp_file(File,
+		      ( write_terms(File, write, Terms),
+			setup_call_cleanup(
+			    fast_term_file_open(File, read, H),
+			    ( fast_term_file_count(H, Count),
+			      fast_term_file_read(H, 5, T5),
+			      fast_term_file_read(H, Count, TL),
+			      \+ fast_term_file_read(H, 0, _),
+			      \+ fast_term_file_read(H, 102, _)
+			    ),
+			    fast_term_file_close(H))
+		      )).
+test(append, [Terms == [a,b,c,d], Count == 4]) :-
+	with_tmp_file(File,
+		      ( write_terms(File, write, [a,b]),
+			write_terms(File, append, []),
+			write_terms(File, append, [c]),
+			write_terms(File, append, [d]),
+			read_terms(File, Terms),
+			setup_call_cleanup(
+			    fast_term_file_open(File, read, H),
+			    fast_term_file_count(H, Count),
+			    fast_term_file_close(H))
+		      )).
+test(snapshot, [Before-After == [a]-[a,b]]) :-
+	with_tmp_file(File,
+		      ( write_terms(File, write, [a]),
+			setup_call_cleanup(
+			    fast_term_file_open(File, read, H),
+			    ( write_terms(File, append, [b]),
+			      findall(T, fast_term_file_read(H, _, T), Before)
+			    ),
+			    fast_term_file_close(H)),
+			read_terms(File, After)
+		      )).
+test(threads, Sum == 500500) :-
+	numlist(1, 1000, Is),
+	with_tmp_file(File,
+		      ( write_terms(File, write, Is),
+			setup_call_cleanup(
+			    fast_term_file_open(File, read, H),
+			    ( findall(Id,
+				      ( between(1, 4, _),
+					thread_create(sum_part(H), Id, [])
+				      ), Ids),
+			      maplist(thread_join, Ids, Results)
+			    ),
+			    fast_term_file_close(H))
+		      )),
+	maplist([exited(S),S]>>true, Results, Sums),
+	sum_list(Sums, Sum0),
+	Sum is Sum0 // 4.
+
+test(closed, error(existence_error(fast_term_file, H))) :-
+	with_tmp_file(File,
+		      ( write_terms(File, write, [a]),
+			fast_term_file_open(File, read, H),
+			fast_term_file_close(H)
+		      )),
+	fast_term_file_count(H, _).
+test(mode, error(permission_error(write, fast_term_file, _))) :-
+	with_tmp_file(File,
+		      ( write_terms(File, write, [a]),
+			setup_call_cleanup(
+			    fast_term_file_open(File, read, H),
+			    fast_term_file_write(H, b),
+			    fast_term_file_close(H))
+		      )).
+test(recover, [Terms-Count == [a,b,d]-3]) :-
+	with_tmp_file(File,
+		      ( write_terms(File, write, [a,b]),
+			write_terms(File, append, [c]),
+			size_file(File, Size),
+			Keep is Size-1,		% writer died before the footer
+			truncate_file(File, Keep),
+			read_terms(File, [a,b]),
+			write_terms(File, append, [d]),
+			read_terms(File, Terms),
+			setup_call_cleanup(
+			    fast_term_file_open(File, read, H),
+			    fast_term_file_count(H, Count),
+			    fast_term_file_close(H))
+		      )).
+test(no_footer, Terms == []) :-
+	with_tmp_file(File,
+		      ( write_terms(File, write, [a]),
+			truncate_file(File, 12),
+			read_terms(File, Terms)
+		      )).
+test(no_index, error(syntax_error(fast_term_file_index))) :-
+	with_tmp_file(File,
+		      ( write_terms(File, write, [a,b]),
+			size_file(File, Size),
+			Offset is Size-40,	% count field of the footer
+			patch_file(File, Offset, 0),
+			fast_term_file_open(File, read, _)
+		      )).
+test(rewrite, [Before-After == [a]-[b]]) :-
+	with_tmp_file(File,
+		      ( write_terms(File, write, [a]),
+			setup_call_cleanup(
+			    fast_term_file_open(File, read, H),
+			    ( write_terms(File, write, [b]),
+			      findall(T, fast_term_file_read(H, _, T), Before)
+			    ),
+			    fast_term_file_close(H)),
+			read_terms(File, After)
+		      )).
+test(same_thread, error(permission_error(open, source_sink, File))) :-
+	with_tmp_file(File,
+		      setup_call_cleanup(
+			  fast_term_file_open(File, append, H),
+			  fast_term_file_open(File, append, _),
+			  fast_term_file_close(H))).
+test(append_threads, [Count-Sum == 400-20100]) :-
+	numlist(1, 200, Is),
+	with_tmp_file(File,
+		      ( findall(Id,
+				( between(1, 2, _),
+				  thread_create(write_terms(File, append, Is),
+						Id, [])
+				), Ids),
+			maplist(thread_join, Ids, _),
+			read_terms(File, Terms),
+			length(Terms, Count),
+			sum_list(Terms, Sum0),
+			Sum is Sum0/2
+		      )).
+
+%!	truncate_file(+File, +Size)
+%!	patch_file(+File, +Offset, +Byte)
+
+truncate_file(File, Size) :-
+	read_file_bytes(File, Bytes0),
+	length(Bytes, Size),
+	append(Bytes, _, Bytes0),
+	write_file_bytes(File, Bytes).
+
+patch_file(File, Offset, Byte) :-
+	read_file_bytes(File, Bytes0),
+	length(Before, Offset),
+	append(Before, [_|After], Bytes0),
+	append(Before, [Byte|After], Bytes),
+	write_file_bytes(File, Bytes).
+
+read_file_bytes(File, Bytes) :-
+	setup_call_cleanup(
+	    open(File, read, In, [type(binary)]),
+	    read_stream_to_codes(In, Bytes),
+	    close(In)).
+
+write_file_bytes(File, Bytes) :-
+	setup_call_cleanup(
+	    open(File, write, Out, [type(binary)]),
+	    maplist(put_byte(Out), Bytes),
+	    close(Out)).
+
+:- end_tests(fast_term_file).
@@ -47,7 +47,9 @@ test_gc :-
 		    gc_crash,
 		    gc_crash2,
 		    gc_mark,
-		    agc
+		    agc,
+		    mmap_stacks,
+		    generational_gc
 		  ]).
 
 :- module_transparent
@@ -289,3 +291,85 @@ test(usercall, A == Ok) :-
 	atom_concat(abcd, efgh, Ok).
 
 :- end_tests(agc).
+:- begin_tests(mmap_stacks, [condition(current_prolog_flag(mmap_stacks, true))]).
+
+grow(N) :-
+	numlist(1, N, L),
+	length(L, N2),
+	N2 == N.
+
+test(grow) :-
+	trim_stacks,
+	grow(1 000 000),
+	deep(100 000).
+test(trim, Used == Used1) :-
+	\+ \+ grow(1 000 000),
+	garbage_collect,
+	statistics(globalused, Used),
+	trim_stacks,
+	statistics(globalused, Used1),
+	grow(1 000 000).
+
+deep(0) :- !.
+deep(N) :-
+	N2 is N - 1,
+	deep(N2),
+	true.
+
+:- end_tests(mmap_stacks).
+
+:- begin_tests(generational_gc,
+	       [ condition(current_prolog_flag(generational_gc, true))
+	       ]).
+
+churn(0) :- !.
+churn(N) :-
+	numlist(1, 1000, L),
+	sum_list(L, _),
+	N2 is N - 1,
+	churn(N2).
+
+numlists([], _).
+numlists([H|T], I) :-
+	numlist(1, I, H),
+	I2 is I + 1,
+	numlists(T, I2).
+
+test(young, Y1 > Y0) :-
+	statistics(young_collections, Y0),
+	numlist(1, 100 000, Old),
+	length(Vars, 100),
+	functor(Term, f, 100),
+	between(1, 2, _),
+	churn(5 000),
+	numlists(Vars, 1),			% bind old variables
+	forall(between(1, 100, I), (numlist(1, I, L), setarg(I, Term, L))),
+	churn(5 000),
+	numlists(Vars, 1),
+	Term =.. [f|Args],
+	numlists(Args, 1),
+	numlist(1, 100 000, Old),
+	statistics(young_collections, Y1),
+	!.
+test(young_result, [Y1 > Y0, Term == Expected]) :-
+	numlist(1, 50 000, Old),
+	length(Vars, 100),
+	Term =.. [f|Vars],
+	between(1, 2, _),
+	statistics(young_collections, Y0),
+	churn(5 000),
+	numlists(Vars, 1),			% old variables refer to young data
+	churn(5 000),
+	statistics(young_collections, Y1),
+	length(Lists, 100),
+	numlists(Lists, 1),
+	Expected =.. [f|Lists],
+	numlist(1, 50 000, Old2),
+	Old == Old2,
+	!.
+test(full, Y1 == Y0) :-
+	statistics(young_collections, Y0),
+	garbage_collect,
+	statistics(young_collections, Y1).
+
+:- end_tests(generational_gc).
@@ -40,7 +40,8 @@
 :- use_module(library(debug)).
 
 test_jit :-
-	run_tests([ jit
+	run_tests([ jit,
+		    range
 		  ]).
 
 /** <module> Test unit for Just-In-Time indexing
@@ -187,3 +188,78 @@ test(depth_exceeded, nondet) :-
 	p2(a(b(c(d(e(f(g(h(2))))))))).
 
 :- end_tests(jit).
+
+:- begin_tests(range).
+
+:- dynamic
+	r/2.
+
+fill(N) :-
+	forall(between(1, N, I),
+	       ( K is (I*7919) mod N,
+		 assertz(r(K, I))
+	       )).
+
+keys(Low, High, Keys) :-
+	findall(K, clause_range(r(K,_), 1, Low, High), Keys).
+
+test(int, [cleanup(retractall(r(_,_))), Keys == [10,11,12,13,14]]) :-
+	fill(1000),
+	keys(10, 14, Keys).
+test(float, [cleanup(retractall(r(_,_))), Keys == [1,1.5,2]]) :-
+	assertz(r(3, a)),
+	assertz(r(1.5, b)),
+	assertz(r(2, c)),
+	assertz(r(1, d)),
+	assertz(r(2.5e10, e)),
+	keys(1, 2.0, Keys).
+test(atom, [cleanup(retractall(r(_,_))), Keys == [b,ba,c]]) :-
+	forall(member(K, [d,c,a,ba,b]), assertz(r(K, x))),
+	keys(b, c, Keys).
+test(mixed, [cleanup(retractall(r(_,_))), Keys == [2,a,b]]) :-
+	forall(member(K, [b,"s",f(x),2,a,1,z]), assertz(r(K, x))),
+	keys(2, b, Keys).
+test(var, [cleanup(retractall(r(_,_))), Keys == [5,3,4,4]]) :-
+	assertz(r(1, x)),
+	assertz((r(K, y) :- K = 4)),
+	assertz(r(5, x)),
+	assertz((r(K, z) :- K = 7)),
+	assertz(r(_, w)),
+	assertz((r(K, v) :- between(2, 4, K), K \== 2)),
+	keys(3, 5, Keys0),
+	Keys0 = [5|Rest],
+	msort(Rest, RestSorted),
+	Keys = [5|RestSorted].
+test(update, [cleanup(retractall(r(_,_))), Keys == [10,11,13,14,15,15]]) :-
+	fill(100),
+	keys(10, 14, _),
+	retract(r(12, _)),
+	assertz(r(15, x)),
+	assertz(r(11.0, x)),
+	retract(r(11.0, _)),
+	keys(10, 15, Keys).
+test(retract_all, [cleanup(retractall(r(_,_))), Keys == [1]]) :-
+	fill(100),
+	keys(0, 100, _),
+	retractall(r(_,_)),
+	keys(0, 100, []),
+	assertz(r(1, x)),
+	keys(0, 100, Keys).
+test(property, [cleanup(retractall(r(_,_))), Entries >= 100]) :-
+	fill(100),
+	keys(0, 10, _),
+	predicate_property(r(_,_), indexed(Indexed)),
+	memberchk(single(1)-ordered(Entries, _), Indexed).
+test(arg2, [cleanup(retractall(r(_,_))), Keys == [1,2,3]]) :-
+	fill(10),
+	findall(I, clause_range(r(_,I), 2, 1, 3), Keys).
+test(bound, [cleanup(retractall(r(_,_))), Vs == [b]]) :-
+	assertz(r(1, a)),
+	assertz(r(2, b)),
+	findall(V, clause_range(r(2,V), 1, 0, 10), Vs).
+test(error, [error(type_error(number, f(x)))]) :-
+	clause_range(r(_,_), 1, f(x), 3).
+test(error, [error(domain_error(argument, 3))]) :-
+	clause_range(r(_,_), 3, 1, 3).
+
+:- end_tests(range).
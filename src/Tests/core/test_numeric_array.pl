@@ -0,0 +1,218 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_numeric_array, [test_numeric_array/0]).
+:- use_module(library(plunit)).
+
+/** <module> Test numeric arrays
+
+This module is a Unit test for the numeric array built-ins.
+
+@author	Jan Wielemaker
+*/
+
+test_numeric_array :-
+	run_tests([ numeric_array
+		  ]).
+
+:- set_prolog_flag(optimise, true).
+
+array_sum(A, S) :-
+	S is sum(A).
+
+array_dot_max(A, B, X) :-
+	X is dot(A, B) + max(A) - min(B).
+
+:- set_prolog_flag(optimise, false).
+
+:- begin_tests(numeric_array).
+
+test(create, T == integer) :-
+	numeric_array([1,2,3], A),
+	numeric_array_type(A, T).
+test(create, T == float) :-
+	numeric_array([1,2.0,3], A),
+	numeric_array_type(A, T).
+test(create, L == [1.0,2.0]) :-
+	numeric_array(float, [1,2], A),
+	numeric_array_to_list(A, L).
+test(create, error(type_error(integer, 2.5))) :-
+	numeric_array(integer, [1,2.5], _).
+test(create, error(type_error(number, a))) :-
+	numeric_array([1,a], _).
+test(create, error(instantiation_error)) :-
+	numeric_array([1|_], _).
+test(create, error(representation_error(int64_t))) :-
+	X is 1<<70,
+	numeric_array([X], _).
+test(create, error(domain_error(numeric_array_type, byte))) :-
+	numeric_array(byte, [], _).
+test(create, error(evaluation_error(undefined))) :-
+	NaN is nan,
+	numeric_array([1.0,NaN], _).
+test(is_array) :-
+	numeric_array([], A),
+	is_numeric_array(A),
+	\+ is_numeric_array(foo).
+test(to_list, L == [1,-2,4611686018427387904]) :-
+	X is 1<<62,
+	numeric_array([1,-2,X], A),
+	numeric_array_to_list(A, L).
+test(to_list, L == [0.5,-1.5]) :-
+	numeric_array([0.5,-1.5], A),
+	numeric_array_to_list(A, L).
+test(to_list, L == []) :-
+	numeric_array([], A),
+	numeric_array_to_list(A, L).
+test(size, N == 3) :-
+	numeric_array([1,2,3], A),
+	numeric_array_size(A, N).
+test(type, error(type_error(numeric_array, foo))) :-
+	numeric_array_size(foo, _).
+test(get, X == 20) :-
+	numeric_array([10,20,30], A),
+	numeric_array_get(A, 2, X).
+test(get, fail) :-
+	numeric_array([10,20,30], A),
+	numeric_array_get(A, 4, _).
+test(slice, L == [20,30]) :-
+	numeric_array([10,20,30,40], A),
+	numeric_array_slice(A, 2, 2, S),
+	numeric_array_to_list(S, L).
+test(slice, fail) :-
+	numeric_array([10,20,30,40], A),
+	numeric_array_slice(A, 4, 2, _).
+test(sum, S == 5050) :-
+	numlist(1, 100, L),
+	numeric_array(L, A),
+	numeric_array_sum(A, S).
+test(sum, S =:= 4.5) :-
+	numeric_array([1.5,1.0,2.0], A),
+	numeric_array_sum(A, S).
+test(sum, S == Big) :-
+	Max is 1<<62,
+	Big is 4*Max,
+	numeric_array([Max,Max,Max,Max], A),
+	numeric_array_sum(A, S).
+test(dot, D == 32) :-
+	numeric_array([1,2,3], A),
+	numeric_array([4,5,6], B),
+	numeric_array_dot(A, B, D).
+test(dot, D == Big) :-
+	X is 1<<40,
+	Big is 2*X*X,
+	numeric_array([X,X], A),
+	numeric_array_dot(A, A, D).
+test(dot, D =:= 11.0) :-
+	numeric_array([1,2], A),
+	numeric_array([3.0,4.0], B),
+	numeric_array_dot(A, B, D).
+test(dot, error(domain_error(same_size, _))) :-
+	numeric_array([1,2], A),
+	numeric_array([1,2,3], B),
+	numeric_array_dot(A, B, _).
+test(min_max, Min-Max == -3-7) :-
+	numeric_array([4,-3,7,0], A),
+	numeric_array_min(A, Min),
+	numeric_array_max(A, Max).
+test(min_max, fail) :-
+	numeric_array([], A),
+	numeric_array_max(A, _).
+test(scale, L == [2,-4,6]) :-
+	numeric_array([1,-2,3], A),
+	numeric_array_scale(A, 2, S),
+	numeric_array_to_list(S, L).
+test(scale, L == [0.5,1.0]) :-
+	numeric_array([1,2], A),
+	numeric_array_scale(A, 0.5, S),
+	numeric_array_to_list(S, L).
+test(scale, error(evaluation_error(int_overflow))) :-
+	X is 1<<62,
+	numeric_array([1,X], A),
+	numeric_array_scale(A, 2, _).
+test(scale, error(evaluation_error(int_overflow))) :-
+	X is 2**70,
+	numeric_array([0,1], A),
+	numeric_array_scale(A, X, _).
+test(scale, T-L == integer-[0,0]) :-
+	X is 2**70,
+	numeric_array([0,0], A),
+	numeric_array_scale(A, X, S),
+	numeric_array_type(S, T),
+	numeric_array_to_list(S, L).
+test(scale, error(evaluation_error(undefined))) :-
+	Inf is inf,
+	numeric_array([Inf], A),
+	numeric_array_scale(A, 0.0, _).
+test(add, error(evaluation_error(float_overflow))) :-
+	numeric_array([1.0e308], A),
+	numeric_array_add(A, A, _).
+test(add, L == [5,7,9]) :-
+	numeric_array([1,2,3], A),
+	numeric_array([4,5,6], B),
+	numeric_array_add(A, B, S),
+	numeric_array_to_list(S, L).
+test(add, L == [1.5,3.0]) :-
+	numeric_array([1,2], A),
+	numeric_array([0.5,1.0], B),
+	numeric_array_add(A, B, S),
+	numeric_array_to_list(S, L).
+test(add, error(evaluation_error(int_overflow))) :-
+	X is (1<<63)-1,
+	numeric_array([X], A),
+	numeric_array_add(A, A, _).
+test(sort, L == [-3,0,4,4,7]) :-
+	numeric_array([4,-3,7,0,4], A),
+	numeric_array_sort(A, S),
+	numeric_array_to_list(S, L).
+test(sort, L == [-1.5,0.0,2.5]) :-
+	numeric_array([2.5,-1.5,0.0], A),
+	numeric_array_sort(A, S),
+	numeric_array_to_list(S, L).
+test(arith, X == 6) :-
+	numeric_array([1,2,3], A),
+	X is sum(A).
+test(arith, X == 6) :-
+	numeric_array([1,2,3], A),
+	array_sum(A, X).
+test(arith, X == 16) :-
+	numeric_array([1,2,3], A),
+	array_dot_max(A, A, X).
+test(arith, error(evaluation_error(undefined))) :-
+	numeric_array([], A),
+	_ is max(A).
+test(arith, error(type_error(numeric_array, [1,2]))) :-
+	_ is sum([1,2]).
+
+:- end_tests(numeric_array).
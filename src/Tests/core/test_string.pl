@@ -44,7 +44,8 @@ This module is a Unit test for predicates that manage string objects.
 */
 
 test_string :-
-	run_tests([ string
+	run_tests([ string,
+		    read_string
 		  ]).
 
 :- begin_tests(string).
@@ -84,3 +85,85 @@ test(string_upper, L == "ABC") :-
 	string_upper("aBc", L).
 
 :- end_tests(string).
+
+:- begin_tests(read_string).
+
+test(read_all, S == Text) :-
+	long_text(Text),
+	read_from(Text, [], In),
+	call_cleanup(read_string(In, _, S), close(In)).
+test(read_len, S == Expected) :-
+	long_text(Text),
+	sub_string(Text, 0, 1500, _, Expected),
+	read_from(Text, [], In),
+	call_cleanup(read_string(In, 1500, S), close(In)).
+test(read_lines, Lines == Expected) :-
+	long_text(Text),
+	split_string(Text, "\n", "", Expected),
+	read_from(Text, [], In),
+	call_cleanup(read_lines(In, Lines), close(In)).
+test(pad, Fields == ["a", "b", "", "c"]) :-
+	read_from("  a, b ,, c", [], In),
+	call_cleanup(read_fields(In, Fields), close(In)).
+test(crlf, S == Expected) :-
+	read_from("a\u00e9\r\nb\r\n", [newline(dos)], In),
+	call_cleanup(read_string(In, _, S), close(In)),
+	read_from("a\u00e9\r\nb\r\n", [newline(dos)], In2),
+	call_cleanup(read_stream_to_codes(In2, Codes), close(In2)),
+	string_codes(Expected, Codes).
+test(position, Pos == Expected) :-
+	long_text(Text),
+	read_from(Text, [], In),
+	call_cleanup(( read_string(In, 2000, _),
+		       stream_pos(In, Pos)
+		     ),
+		     close(In)),
+	read_from(Text, [], In2),
+	call_cleanup(( length(Codes, 2000),
+		       maplist(get_code(In2), Codes),
+		       stream_pos(In2, Expected)
+		     ),
+		     close(In2)).
+
+stream_pos(In, pos(Chars, Bytes, Line, LinePos)) :-
+	character_count(In, Chars),
+	byte_count(In, Bytes),
+	line_count(In, Line),
+	line_position(In, LinePos).
+
+long_text(Text) :-
+	numlist(1, 3000, L),
+	maplist(line, L, Lines),
+	atomic_list_concat(Lines, Text0),
+	atom_string(Text0, Text).
+
+line(I, Line) :-
+	(   I mod 3 =:= 0
+	->  Line = '\u00e9\u4e2d\n'
+	;   Line = 'x\n'
+	).
+
+read_from(Text, Options, In) :-
+	tmp_file_stream(utf8, File, Out),
+	write(Out, Text),
+	close(Out),
+	open(File, read, In, [encoding(utf8)|Options]),
+	delete_file(File).
+
+read_lines(In, Lines) :-
+	read_string(In, "\n", "", Sep, Line),
+	(   Sep == -1
+	->  Lines = [Line]
+	;   Lines = [Line|Rest],
+	    read_lines(In, Rest)
+	).
+
+read_fields(In, Fields) :-
+	read_string(In, ",", " ", Sep, Field),
+	(   Sep == -1
+	->  Fields = [Field]
+	;   Fields = [Field|Rest],
+	    read_fields(In, Rest)
+	).
+
+:- end_tests(read_string).
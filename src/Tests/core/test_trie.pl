@@ -104,5 +104,46 @@ test(delete, Keys == [aap,mies]) :-
 	assertion(N==n),
 	findall(K, trie_gen(T, K, _), Keys0),
 	sort(Keys0, Keys).
+test(compact, Props == [compact(1), hashed(0)]) :-
+	trie_new(T),
+	forall(between(1, 16, I), trie_insert(T, I, v(I))),
+	forall(between(1, 16, I), trie_lookup(T, I, v(I))),
+	findall(P, (member(P, [compact(_), hashed(_)]),
+		    '$trie_property'(T, P)), Props).
+test(compact_to_hashed, Props == [compact(0), hashed(1)]) :-
+	trie_new(T),
+	forall(between(1, 17, I), trie_insert(T, I, v(I))),
+	forall(between(1, 17, I), trie_lookup(T, I, v(I))),
+	findall(P, (member(P, [compact(_), hashed(_)]),
+		    '$trie_property'(T, P)), Props).
+test(compact_delete, Keys == [1,2,4]) :-
+	trie_new(T),
+	forall(between(1, 4, I), trie_insert(T, I, v(I))),
+	trie_delete(T, 3, V),
+	assertion(V == v(3)),
+	findall(K, trie_gen(T, K, _), Keys0),
+	sort(Keys0, Keys).
+test(compact_gen_insert, Keys == [1,2,3,f(1),f(2),f(3)]) :-
+	trie_new(T),
+	forall(between(1, 3, I), trie_insert(T, I, v)),
+	forall(trie_gen(T, K, _), trie_insert(T, f(K), v)),
+	findall(K, trie_gen(T, K, _), Keys0),
+	sort(Keys0, Keys).
+test(compact_threads, Count == 8000) :-
+	trie_new(T),
+	findall(Id,
+		( between(1, 4, K),
+		  thread_create(insert_lookup(T, K), Id, [])
+		), Ids),
+	maplist(thread_join, Ids, Status),
+	assertion(maplist(==(true), Status)),
+	aggregate_all(count, trie_gen(T, _, _), Count).
+
+insert_lookup(T, K) :-
+	forall(between(1, 2000, J),
+	       ( trie_insert(T, f(J,K), J),
+		 forall(between(1, 4, K2),
+			ignore(trie_lookup(T, f(J,K2), _)))
+	       )).
 
 :- end_tests(trie).
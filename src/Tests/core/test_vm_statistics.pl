@@ -0,0 +1,104 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+                              VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+:- module(test_vm_statistics,
+	  [ test_vm_statistics/0
+	  ]).
+:- use_module(library(plunit)).
+:- use_module(library(lists)).
+
+test_vm_statistics :-
+	run_tests([ vm_statistics
+		  ]).
+
+/** <module> Test VM instruction statistics
+
+These tests only run if the system is configured with
+-DVMI_STATISTICS=ON.
+*/
+
+:- begin_tests(vm_statistics,
+	       [ condition(current_predicate(system:vm_statistics/1))
+	       ]).
+
+loop(N) :-
+	(   N > 0
+	->  N1 is N-1,
+	    loop(N1)
+	;   true
+	).
+
+counts(Name, Count) :-
+	vm_statistics(Stats),
+	memberchk(instructions(Instrs), Stats),
+	(   memberchk(vmi(Name, Count, _), Instrs)
+	->  true
+	;   Count = 0
+	).
+
+test(count) :-
+	counts(i_depart, C0),
+	loop(1000),
+	counts(i_depart, C1),
+	assertion(C1-C0 >= 1000).
+test(format, Clock \== none) :-
+	vm_statistics(Stats),
+	memberchk(clock(Clock), Stats),
+	memberchk(instructions(Instrs), Stats),
+	memberchk(pairs(Pairs), Stats),
+	assertion(Instrs = [vmi(_,_,_)|_]),
+	assertion(Pairs = [pair(_,_,_)|_]),
+	Instrs = [vmi(_,Max,_)|_],
+	assertion(\+ ( member(vmi(_,C,_), Instrs), C > Max )).
+test(pairs) :-
+	loop(1000),
+	vm_statistics(Stats),
+	memberchk(pairs(Pairs), Stats),
+	assertion(( member(pair(a_add_fc, Next, C), Pairs),
+		    C >= 1000,
+		    atom(Next)
+		  )).
+test(reset) :-
+	loop(1000),
+	reset_vm_statistics,
+	counts(i_depart, C),
+	assertion(C < 100).
+test(thread, condition(current_prolog_flag(threads, true))) :-
+	counts(i_depart, C0),
+	thread_create(loop(1000), Id, []),
+	thread_join(Id, true),
+	counts(i_depart, C1),
+	assertion(C1-C0 >= 1000).
+
+:- end_tests(vm_statistics).
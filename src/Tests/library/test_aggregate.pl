@@ -148,5 +148,18 @@ test(aggregate_all, Max == 3) :-
 	aggregate_all(r(max(A)), member(A,List), r(Max)).
 test(e_vars, all(X == [1,2,3,4,5])) :-
 	aggregate(r(sum(0)), Y^(between(1, 5, X), Y=1), _).
+test(group_count, all(M-C == [0-3,1-4,2-3])) :-
+	aggregate(count, X^(between(1, 10, X), M is X mod 3), C).
+test(group_set, all(K-S == [a-[1,2],b-[3]])) :-
+	aggregate(set(V), member(K-V, [a-2,b-3,a-1,a-2]), S).
+test(group_term, all(K-R == [a-r(3,5,[2,1,2],max(2,x)), b-r(1,3,[3],max(3,y))])) :-
+	aggregate(r(count, sum(V), bag(V), max(V,W)),
+		  member(K-V-W, [a-2-x,b-3-y,a-1-z,a-2-v]), R).
+test(group_witness, all(W-S =@= [f(_)-[1,2],g(_,B,B)-[3]])) :-
+	aggregate(set(X), witness(W, X), S).
+
+witness(f(_), 2).
+witness(g(_,C,C), 3).
+witness(f(_), 1).
 
 :- end_tests(aggregate).
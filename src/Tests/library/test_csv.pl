@@ -35,7 +35,10 @@
 :- use_module(library(plunit)).
 
 test_csv :-
-	run_tests([ csv_read_file_row ]).
+	run_tests([ csv_read_file_row,
+		    csv_read_row,
+		    csv_write
+		  ]).
 
 :- begin_tests(csv_read_file_row, []).
 :- use_module(library(csv)).
@@ -116,4 +119,85 @@ test(quoted_crlf_ignored) :-
            row('c2_2"',c3)
          ].
 
-:- end_tests(csv_read_file_row).
\ No newline at end of file
+:- end_tests(csv_read_file_row).
+:- begin_tests(csv_read_row, []).
+:- use_module(library(csv)).
+
+string_rows(String, Rows, Options) :-
+	csv_options(Record, Options),
+	setup_call_cleanup(
+	    open_string(String, In),
+	    read_rows(In, Rows, Record),
+	    close(In)).
+
+read_rows(In, Rows, Record) :-
+	csv_read_row(In, Row, Record),
+	(   Row == end_of_file
+	->  Rows = []
+	;   Rows = [Row|More],
+	    read_rows(In, More, Record)
+	).
+
+test(convert, Rows == [row(a, 42, 1.5, ''), row('4x', -3, 'x y', 'A')]) :-
+	string_rows("a,42,1.5,\n4x,-3,x y,A", Rows, []).
+test(no_convert, Rows == [row('42', '1.5')]) :-
+	string_rows("42,1.5\n", Rows, [convert(false)]).
+test(strings, Rows == [row("a", 42, "")]) :-
+	string_rows("a,42,\r\n", Rows, [strings(true)]).
+test(case, Rows == [row(abc, 'x y', 1)]) :-
+	string_rows("AbC,X Y,1\n", Rows, [case(down)]).
+test(case_up_strings, Rows == [row("ABC", 1)]) :-
+	string_rows("abc,1\n", Rows, [case(up), strings(true)]).
+test(wide, Rows == [row('\x2200\', 'a\x3b1\')]) :-
+	string_rows("\x2200\,a\x3b1\\n", Rows, []).
+test(quoted, Rows == [row('a,b', 'x "y"', 'l1\nl2', '')]) :-
+	string_rows("\"a,b\",\"x \"\"y\"\"\",\"l1\nl2\",\"\"\n", Rows, []).
+test(separator, Rows == [row(a, 'b,c')]) :-
+	string_rows("a;b,c\n", Rows, [separator(0';)]).
+test(strip, Rows == [row(a, 'b c', ' q ')]) :-
+	string_rows(" a ,\tb c\t, \" q \" \n", Rows, [strip(true)]).
+test(end_of_record, Rows == [row(a), row(b), row(c), row(d)]) :-
+	string_rows("a\nb\r\nc\rd", Rows, []).
+test(arity, error(domain_error(row_arity(2), 1))) :-
+	string_rows("a,b\nc\n", _, [arity(2)]).
+test(match_arity, Rows == [row(a, b), row(c)]) :-
+	string_rows("a,b\nc\n", Rows, [match_arity(false)]).
+test(unterminated, error(syntax_error(end_of_file_in_csv_field))) :-
+	string_rows("a,\"b\n", _, []).
+test(junk, error(syntax_error(csv_separator_expected))) :-
+	string_rows("\"a\"b\n", _, []).
+test(skip_header, Rows == [row(a, b)]) :-
+	setup_call_cleanup(
+	    open_string("# comment\n# more\n\na,b\n", In),
+	    csv_read_stream(In, Rows, [skip_header('#')]),
+	    close(In)).
+test(dcg, Rows == [row("a", 1, "q,\nr")]) :-
+	phrase(csv(Rows, [strings(true)]), `a,1,"q,\nr"\n`).
+
+:- end_tests(csv_read_row).
+
+:- begin_tests(csv_write, []).
+:- use_module(library(csv)).
+
+write_string(Rows, String, Options) :-
+	with_output_to(string(String),
+		       ( current_output(Out),
+			 csv_write_stream(Out, Rows, Options))).
+
+test(write, S == "a,1,2.5,[],\"b,c\",\"x \"\"y\"\"\"\r\n") :-
+	write_string([row(a, 1, 2.5, [], 'b,c', "x \"y\"")], S, []).
+test(write_sep, S == "a;b,c\r\n\"d;e\"\r\n") :-
+	write_string([row(a, 'b,c'), row('d;e')], S, [separator(0';)]).
+test(type, error(type_error(atomic, f(x)))) :-
+	write_string([row(f(x))], _, []).
+test(round_trip, Rows == Rows0) :-
+	Rows0 = [ row(a, 'b c', 'l1\nl2', 42, -1.5, '"q"', '\x2200\'),
+		  row('', x, y, z, 1, 2, 3)
+		],
+	write_string(Rows0, S, []),
+	setup_call_cleanup(
+	    open_string(S, In),
+	    csv_read_stream(In, Rows, []),
+	    close(In)).
+
+:- end_tests(csv_write).
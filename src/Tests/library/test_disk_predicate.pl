@@ -0,0 +1,138 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_disk_predicate, [test_disk_predicate/0]).
+:- use_module(library(plunit)).
+:- use_module(library(disk_predicate)).
+
+/** <module> Test disk based predicates
+*/
+
+test_disk_predicate :-
+	run_tests([ disk_predicate
+		  ]).
+
+:- begin_tests(disk_predicate).
+
+with_db(PI, Goal) :-
+	tmp_file(ddb, File),
+	setup_call_cleanup(
+	    disk_predicate(PI, File),
+	    Goal,
+	    ( disk_predicate_detach(PI),
+	      delete_db(File))).
+
+delete_db(File) :-
+	atom_concat(File, '.idx', Index),
+	catch(delete_file(File), _, true),
+	catch(delete_file(Index), _, true).
+
+add_facts(N) :-
+	forall(between(1, N, I),
+	       ( K is I mod 10,
+		 disk_assertz(ddb_fact(K, I)))).
+
+test(assert, Xs == [3,13,23]) :-
+	with_db(ddb_fact/2,
+		( add_facts(25),
+		  findall(X, ddb_fact(3, X), Xs))).
+test(types, Xs == [a, 1, "s", 1.5, f(x), [], [a], any]) :-
+	with_db(ddb_fact/2,
+		( forall(member(K, [a, 1, "s", 1.5, f(x), [], [a]]),
+			 disk_assertz(ddb_fact(K, K))),
+		  disk_assertz(ddb_fact(_, any)),
+		  findall(X,
+			  ( member(K, [a, 1, "s", 1.5, f(_), [], [_]]),
+			    ddb_fact(K, X),
+			    X \== any
+			  ; ddb_fact(zz, X)
+			  ),
+			  Xs))).
+test(unbound_first, Xs == [x(1),y(2),x(3)]) :-
+	with_db(ddb_fact/2,
+		( disk_assertz(ddb_fact(1, x(1))),
+		  disk_assertz(ddb_fact(_, y(2))),
+		  disk_assertz(ddb_fact(3, x(3))),
+		  findall(X, ddb_fact(_, X), Xs))).
+test(retract, [Count,Xs] == [23,[13]]) :-
+	with_db(ddb_fact/2,
+		( add_facts(25),
+		  disk_retract(ddb_fact(3, 3)),
+		  disk_retractall(ddb_fact(3, 23)),
+		  findall(X, ddb_fact(3, X), Xs),
+		  disk_predicate_count(ddb_fact/2, Count))).
+test(static, error(permission_error(modify, static_procedure, _))) :-
+	with_db(ddb_fact/2,
+		assertz(ddb_fact(1,2))).
+test(reopen, [C,Xs] == [25,[7,17]]) :-
+	tmp_file(ddb, File),
+	call_cleanup(
+	    ( disk_predicate(ddb_fact/2, File),
+	      add_facts(25),
+	      disk_predicate_detach(ddb_fact/2),
+	      disk_predicate(ddb_fact/2, File),
+	      disk_predicate_count(ddb_fact/2, C),
+	      findall(X, ddb_fact(7, X), Xs),
+	      disk_predicate_detach(ddb_fact/2)
+	    ),
+	    delete_db(File)).
+test(rebuild, [C,Xs] == [25,[7,17]]) :-
+	tmp_file(ddb, File),
+	atom_concat(File, '.idx', Index),
+	call_cleanup(
+	    ( disk_predicate(ddb_fact/2, File),
+	      add_facts(25),
+	      disk_predicate_detach(ddb_fact/2),
+	      delete_file(Index),
+	      disk_predicate(ddb_fact/2, File),
+	      disk_predicate_count(ddb_fact/2, C),
+	      findall(X, ddb_fact(7, X), Xs),
+	      disk_predicate_detach(ddb_fact/2)
+	    ),
+	    delete_db(File)).
+test(grow_index, Xs == [4999]) :-
+	with_db(ddb_fact/2,
+		( forall(between(1, 5000, I),
+			 disk_assertz(ddb_fact(I, I))),
+		  findall(X, ddb_fact(4999, X), Xs))).
+test(other_predicate, error(permission_error(open, disk_db, _))) :-
+	tmp_file(ddb, File),
+	call_cleanup(
+	    ( disk_predicate(ddb_fact/2, File),
+	      disk_predicate_detach(ddb_fact/2),
+	      disk_predicate(ddb_other/1, File)
+	    ),
+	    delete_db(File)).
+
+:- end_tests(disk_predicate).
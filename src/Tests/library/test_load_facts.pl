@@ -0,0 +1,136 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_load_facts, [test_load_facts/0]).
+:- use_module(library(plunit)).
+:- use_module(library(load_facts)).
+
+/** <module> Test bulk loading of fact files
+*/
+
+test_load_facts :-
+	run_tests([ load_facts
+		  ]).
+
+:- begin_tests(load_facts).
+
+:- dynamic
+	lf_fact/2,
+	lf_rule/1,
+	lf_directive/1,
+	lf_dcg/2,
+	lf_expanded/1,
+	syntax_error/0.
+
+load_text(Text, Options) :-
+	tmp_file_stream(utf8, File, Out),
+	write(Out, Text),
+	close(Out),
+	call_cleanup(load_facts(File, Options),
+		     delete_file(File)).
+
+cleanup :-
+	retractall(lf_fact(_,_)),
+	retractall(lf_rule(_)),
+	retractall(lf_directive(_)),
+	retractall(lf_dcg(_,_)),
+	retractall(lf_expanded(_)).
+
+test(facts, [ L == [1-a, 2-"s", 3-1.5, 4-f([x,y]), 5-'\u00e9'],
+	      cleanup(cleanup)
+	    ]) :-
+	load_text("lf_fact(1, a).\n\c
+		   lf_fact(2, \"s\").\n\c
+		   lf_fact(3, 1.5).\n\c
+		   lf_fact(4, f([x,y])).\n\c
+		   lf_fact(5, '\\u00e9').\n", []),
+	findall(K-V, lf_fact(K, V), L).
+test(many, [ N == 5000,
+	     cleanup(cleanup)
+	   ]) :-
+	with_output_to(string(Text),
+		       forall(between(1, 5000, I),
+			      format("lf_fact(~d, ~q).~n", [I, f(I)]))),
+	load_text(Text, []),
+	predicate_property(lf_fact(_,_), number_of_clauses(N)),
+	lf_fact(4711, f(4711)).
+test(mixed, [ L == [f-1, r-x, d-done, c-[b]],
+	      cleanup(cleanup)
+	    ]) :-
+	load_text("lf_fact(1, a).\n\c
+		   lf_rule(X) :- X = x.\n\c
+		   :- assertz(test_load_facts:lf_directive(done)).\n\c
+		   lf_dcg --> [b].\n\c
+		   lf_fact(_, b).\n", [module(test_load_facts)]),
+	findall(f-K, lf_fact(K, a), L1),
+	findall(r-X, lf_rule(X), L2),
+	findall(d-X, lf_directive(X), L3),
+	findall(c-X, lf_dcg(X, []), L4),
+	append([L1,L2,L3,L4], L),
+	lf_fact(Any, b),
+	var(Any).
+test(syntax_error, [ L-Errors == [1,3]-1,
+		     cleanup(cleanup)
+		   ]) :-
+	setup_call_cleanup(
+	    asserta((user:thread_message_hook(error(syntax_error(_),_),
+					      error, _) :-
+			assertz(syntax_error)), Ref),
+	    load_text("lf_fact(1, a).\n\c
+		       lf_fact(2, a a).\n\c
+		       lf_fact(3, a).\n", []),
+	    erase(Ref)),
+	findall(K, lf_fact(K, _), L),
+	aggregate_all(count, retract(syntax_error), Errors).
+test(module, [ L == [a],
+	       cleanup(retractall(test_load_facts_m:lf_fact(_,_)))
+	     ]) :-
+	load_text("lf_fact(1, a).\n", [module(test_load_facts_m)]),
+	findall(V, test_load_facts_m:lf_fact(_, V), L),
+	\+ lf_fact(_, _).
+test(expand, [ L == [a],
+	       cleanup(cleanup)
+	     ]) :-
+	load_text("lf_fact(1, a).\n",
+		  [ module(test_load_facts_x),
+		    expand(true)
+		  ]),
+	findall(V, test_load_facts_x:lf_expanded(V), L).
+
+:- multifile
+	test_load_facts_x:term_expansion/2.
+
+test_load_facts_x:term_expansion(lf_fact(_, V), lf_expanded(V)).
+
+:- end_tests(load_facts).
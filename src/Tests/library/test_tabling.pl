@@ -73,7 +73,11 @@ test_tabling :-
 		    moded_tabling_path,
 						% tests requiring sub components
 		    mode_components1,
-		    mode_components2
+		    mode_components2,
+						% shared tables
+		    tabling_shared,
+						% incremental tabling
+		    tabling_incremental
 		  ]).
 
 		 /*******************************
@@ -1257,6 +1261,129 @@ test(component, [X == 2, nondet]) :-
 :- end_tests(mode_components2).
 
 
+:- begin_tests(tabling_shared, [cleanup(abolish_all_tables)]).
+
+:- table
+    sconn/2 as shared,
+    (sp/1, sq/1) as shared,
+    sblock/1 as shared.
+
+sconn(X, Y) :- sconn(X, Z), sedge(Z, Y).
+sconn(X, Y) :- sedge(X, Y).
+
+sedge(X, Y) :- between(1, 50, X), Y is X+1.
+sedge(50, 1).
+
+sp(X) :- sq(X).
+sp(1).
+sq(X) :- sp(X).
+sq(2).
+
+sblock(1) :-
+    thread_get_message(go).
+
+count_sconn(Count) :-
+    aggregate_all(count, sconn(_,_), Count).
+
+count_sconn_loop(N, Counts) :-
+    findall(C, (between(1, N, _), count_sconn(C)), Counts).
+
+abolish_loop(N) :-
+    forall(between(1, N, _),
+	   ( catch(abolish_shared_tables, error(permission_error(_,_,_),_),
+		   true),
+	     garbage_collect_atoms
+	   )).
+
+wait_for_table(Goal) :-
+    between(1, 500, _),
+    (   current_table(Goal, _)
+    ->  !
+    ;   sleep(0.01),
+	fail
+    ).
+
+test(threads, Counts == [2550,2550,2550,2550]) :-
+    findall(Id, ( between(1, 4, _),
+		  thread_create(count_sconn(_), Id, [])
+		), Ids),
+    maplist(thread_join, Ids),
+    findall(C, (between(1, 4, _), count_sconn(C)), Counts).
+test(current_table, true) :-
+    count_sconn(_),
+    current_table(test_tabling:sconn(_,_), _).
+test(mutual, L == [1,2]) :-
+    thread_create(findall(X, sp(X), _), Id, []),
+    findall(X, sq(X), L0),
+    thread_join(Id),
+    msort(L0, L).
+test(abolish_reading, Counts == [2550,2550,2550,2550,2550]) :-
+    thread_create(count_sconn_loop(5, Counts), Id, []),
+    abolish_loop(20),
+    thread_join(Id, exited(Counts0)),
+    Counts = Counts0.
+test(destroy_incomplete, error(permission_error(abolish, table, _))) :-
+    thread_create(sblock(_), Id, []),
+    call_cleanup(
+	( wait_for_table(test_tabling:sblock(_)),
+	  abolish_table_subgoals(sblock(_))
+	),
+	( thread_send_message(Id, go),
+	  thread_join(Id)
+	)).
+
+:- end_tests(tabling_shared).
+
+
+:- begin_tests(tabling_incremental, [cleanup(abolish_all_tables)]).
+
+:- table
+    iconn/2 as incremental,
+    ip/1 as incremental,
+    ierr/1 as incremental.
+:- dynamic
+    iedge/2 as incremental,
+    iq/1 as incremental.
+
+iconn(X, Y) :- iconn(X, Z), iedge(Z, Y).
+iconn(X, Y) :- iedge(X, Y).
+
+iedge(a, b).
+iedge(b, c).
+
+ip(X) :- iconn(a, X), \+ iq(X).
+
+ierr(X) :- iq(X), throw(ierr(X)).
+
+reachable(L) :-
+    findall(Y, iconn(a, Y), L0),
+    msort(L0, L).
+
+test(assert, [L0-L == [b,c]-[b,c,d], cleanup(retractall(iedge(c,_)))]) :-
+    reachable(L0),
+    assertz(iedge(c, d)),
+    reachable(L).
+test(retract, [L0-L == [b,c]-[b], cleanup(assertz(iedge(b,c)))]) :-
+    reachable(L0),
+    retract(iedge(b, c)),
+    reachable(L).
+test(transitive, [L0-L == [b,c]-[b], cleanup(retractall(iq(_)))]) :-
+    findall(X, ip(X), L1),
+    assertz(iq(c)),
+    findall(X, ip(X), L),
+    msort(L1, L0).
+test(property, true) :-
+    predicate_property(iedge(_,_), incremental).
+test(current, [W0-W == []-[], cleanup(retractall(iq(_)))]) :-
+    reachable(_),
+    nb_getval('$tbl_current', W0),
+    assertz(iq(1)),
+    catch(ierr(_), ierr(1), true),
+    nb_getval('$tbl_current', W).
+
+:- end_tests(tabling_incremental).
+
+
 		 /*******************************
 		 *	      COMMON		*
 		 *******************************/
@@ -57,6 +57,56 @@ test(concur, true) :-
 	forall(between(0, 20, _),
 	       (   concurrent(2, [X=1,Y=2], []),
 		   ground(X-Y))).
+test(nested, true(X-Y==1-2)) :-
+	concurrent(2, [concurrent(2, [X=1,Y=2], [])], []).
+test(options, true(X-Y==1-2)) :-
+	concurrent(2, [X=1,Y=2], [stack_limit(100 000 000)]).
+test(pool, true([A,B]==[3,4])) :-
+	concurrent(2, [A=3, B = 4], [pool(true)]).
+test(pool, fail) :-
+	concurrent(2, [_A=3, fail, _B = 4], [pool(true)]).
+test(pool, throws(x)) :-
+	concurrent(2, [_A=3, throw(x), _B = 4], [pool(true)]).
+test(pool_nested, true(Inner == [Outer,Outer])) :-
+	concurrent(2, [ ( thread_self(Outer),
+			  concurrent(2, [thread_self(A), thread_self(B)],
+				     [pool(true)]),
+			  Inner = [A,B]
+			)
+		      ], [pool(true)]).
+test(fresh_threads, true(Seen == [])) :-
+	concurrent(2, [assertz(scratch(1)), assertz(scratch(2))], []),
+	concurrent(2, [findall(X, scratch(X), L1),
+		       findall(X, scratch(X), L2)], []),
+	append(L1, L2, Seen).
+test(maplist, true(L2==[1,4,9,16,25,36,49,64,81,100])) :-
+	numlist(1, 10, L1),
+	concurrent_maplist(square, L1, L2).
+test(maplist, fail) :-
+	numlist(1, 1000, L),
+	concurrent_maplist(>(1000), L).
+
+square(X, Y) :- Y is X*X.
+
+:- thread_local scratch/1.
+
+:- dynamic running/1.
+
+test(cancel_wait, true(Running == [])) :-
+	\+ concurrent(2, [(sleep(0.1), fail), slow_job(a)], []),
+	findall(X, running(X), Running).
+test(cancel_wait, [throws(x), cleanup(retractall(running(_)))]) :-
+	call_cleanup(concurrent(2, [(sleep(0.1), throw(x)), slow_job(b)], []),
+		     assertion(\+ running(b))).
+test(cancel_wait, true(Running == [])) :-
+	\+ concurrent(2, [(sleep(0.1), fail), slow_job(c)], [pool(true)]),
+	findall(X, running(X), Running).
+
+slow_job(Id) :-
+	setup_call_cleanup(
+	    assertz(running(Id)),
+	    sleep(10),
+	    retractall(running(Id))).
 
 test(first, true(X==1)) :-
 	first_solution(X, [X=1,X=1], []).
@@ -0,0 +1,81 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(queue_index,
+	  [ queue_index/0
+	  ]).
+:- use_module(library(debug)).
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Test selective receives on a  message   queue  indexed  on an argument.
+Messages with the same key must be received in FIFO order and messages
+that are variables may match any pattern.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+queue_index :-
+	queue_index(10000).
+
+queue_index(N) :-
+	message_queue_create(Q, [index(1)]),
+	assertion(message_queue_property(Q, index(1))),
+	forall(between(1, N, I),
+	       thread_send_message(Q, reply(I, I))),
+	thread_send_message(Q, reply(1, again)),
+	thread_send_message(Q, _),
+	thread_send_message(Q, reply(2, again)),
+	forall(between(1, N, I),
+	       ( I1 is N+1-I,
+		 thread_get_message(Q, reply(I1, X)),
+		 assertion(X == I1)
+	       )),
+	thread_get_message(Q, reply(2, A)),
+	assertion(var(A)),
+	thread_get_message(Q, reply(2, B)),
+	assertion(B == again),
+	thread_get_message(Q, reply(_, C)),
+	assertion(C == again),
+	assertion(message_queue_property(Q, size(0))),
+	thread_self(Me),
+	thread_create(waiter(Q, Me), Id, []),
+	thread_get_message(waiting),
+	thread_send_message(Q, reply(7, no)),
+	thread_send_message(Q, reply(42, yes)),
+	thread_join(Id, true),
+	thread_get_message(Q, reply(7, no)),
+	message_queue_destroy(Q).
+
+waiter(Q, Parent) :-
+	thread_send_message(Parent, waiting),
+	thread_get_message(Q, reply(42, X)),
+	assertion(X == yes).
@@ -0,0 +1,93 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, University of Amsterdam
+                         VU University Amsterdam
+		         CWI, Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_agc_mark,
+          [ test_agc_mark/0
+          ]).
+
+/** <module> Test marking atoms of other threads
+
+Atom-gc asks running threads to mark their own stacks at a safe point and
+scans threads that are blocked itself.  This test runs AGC while some
+threads create atoms and another thread is waiting for a message, after
+which all threads verify that the atoms they reference are intact.
+*/
+
+test_agc_mark :-
+    statistics(agc_mark_time, M0),
+    thread_create(waiter, Waiter, []),
+    length(Workers, 4),
+    maplist(thread_create(worker(100)), Workers),
+    forall(between(1, 50, _), garbage_collect_atoms),
+    maplist(thread_join_true, Workers),
+    thread_send_message(Waiter, check),
+    thread_join_true(Waiter),
+    statistics(agc_mark_time, M1),
+    statistics(agc_sweep_time, S),
+    statistics(agc_max_pause, P),
+    M1 > M0,
+    float(S),
+    float(P).
+
+thread_join_true(Id) :-
+    thread_join(Id, Status),
+    Status == true.
+
+waiter :-
+    thread_self(Me),
+    gen_atoms(Me, 1000, Atoms),
+    thread_get_message(check),
+    check_atoms(Me, Atoms, 1).
+
+worker(0) :- !.
+worker(N) :-
+    gen_atoms(N, 1000, Atoms),
+    check_atoms(N, Atoms, 1),
+    N2 is N - 1,
+    worker(N2).
+
+gen_atoms(Prefix, Count, Atoms) :-
+    numlist(1, Count, Is),
+    maplist(gen_atom(Prefix), Is, Atoms).
+
+gen_atom(Prefix, I, Atom) :-
+    format(atom(Atom), 'agc_mark_~w_~w', [Prefix, I]).
+
+check_atoms(_, [], _).
+check_atoms(Prefix, [H|T], I) :-
+    format(atom(H), 'agc_mark_~w_~w', [Prefix, I]),
+    I2 is I + 1,
+    check_atoms(Prefix, T, I2).
@@ -0,0 +1,120 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, University of Amsterdam
+                         VU University Amsterdam
+		         CWI, Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_jiti_background,
+          [ test_jiti_background/0
+          ]).
+
+/** <module> Test creating clause indexes in the background
+
+Indexes for large predicates are built by a background thread.  This
+test lowers the threshold, starts several threads that query the
+predicate on its second argument while the index is being built and
+adds clauses at the same time.  All answers must be correct and the
+index must finally include the added clauses.  A second test retracts
+clauses and runs clause garbage collection during the build.
+*/
+
+:- dynamic
+    fact/2.
+
+test_jiti_background :-
+    current_prolog_flag(jiti_background, Old),
+    setup_call_cleanup(
+        set_prolog_flag(jiti_background, 10000),
+        ( test,
+          test_retract
+        ),
+        set_prolog_flag(jiti_background, Old)).
+
+test :-
+    retractall(fact(_,_)),
+    statistics(indexes_background, B0),
+    forall(between(1, 50000, I),
+           ( K is I mod 100,
+             assertz(fact(K, I))
+           )),
+    length(Readers, 4),
+    maplist(thread_create(reader(0, 200)), Readers),
+    forall(between(50001, 50200, I),
+           assertz(fact(new, I))),
+    maplist(thread_join_true, Readers),
+    wait_for_index(100),
+    statistics(indexes_background, B1),
+    B1 > B0,
+    forall(between(50001, 50200, I),
+           fact(new, I)),
+    aggregate_all(count, fact(new, _), 200).
+
+test_retract :-
+    retractall(fact(_,_)),
+    garbage_collect_clauses,
+    forall(between(1, 50000, I),
+           ( K is I mod 100,
+             assertz(fact(K, I))
+           )),
+    length(Readers, 2),
+    maplist(thread_create(reader(1000, 200)), Readers),
+    forall(between(1, 1000, I),
+           retract(fact(_, I))),
+    garbage_collect_clauses,
+    maplist(thread_join_true, Readers),
+    wait_for_index(100),
+    \+ fact(_, 500),
+    fact(7, 1007),
+    aggregate_all(count, fact(_, _), 49000).
+
+reader(_, 0) :- !.
+reader(Low, N) :-
+    I is Low + 1 + random(50000-Low),
+    K is I mod 100,
+    findall(X, fact(X, I), [K]),
+    N2 is N - 1,
+    reader(Low, N2).
+
+wait_for_index(_) :-
+    predicate_property(fact(_,_), indexed(Indexes)),
+    memberchk(single(2)-_, Indexes),
+    !.
+wait_for_index(N) :-
+    N > 0,
+    sleep(0.05),
+    N2 is N - 1,
+    wait_for_index(N2).
+
+thread_join_true(Id) :-
+    thread_join(Id, Status),
+    Status == true.
@@ -0,0 +1,117 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, University of Amsterdam
+                         VU University Amsterdam
+		         CWI, Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_load_threads,
+          [ test_load_threads/0
+          ]).
+:- use_module(library(lists)).
+
+/** <module> Test loading a list of files using multiple threads
+
+Creates a set of module files that share a common dependency and a
+pair of mutually dependent modules and loads them using the threads(N)
+option of load_files/2.  All modules must be loaded exactly once and the
+mutually dependent modules must not deadlock.
+*/
+
+test_load_threads :-
+    tmp_file(load_threads, Dir),
+    make_directory(Dir),
+    call_cleanup(test(Dir), remove_dir(Dir)).
+
+test(Dir) :-
+    create_files(Dir, Files),
+    load_files(Files, [threads(4), silent(true)]),
+    forall(between(1, 8, I),
+           ( format(atom(M), 'lt_~w', [I]),
+             M:value(I, 200)
+           )),
+    lt_common:count(1),
+    lt_a:lt_a_value(b),
+    lt_b:lt_b_value(a).
+
+create_files(Dir, [FA,FB|Files]) :-
+    dir_file(Dir, 'lt_common.pl', FC),
+    write_file(FC,
+               [ (:- module(lt_common, [count/1])),
+                 (:- dynamic(loaded/0)),
+                 (:- assertz(loaded)),
+                 (count(N) :- aggregate_all(count, loaded, N))
+               ]),
+    dir_file(Dir, 'lt_a.pl', FA),
+    dir_file(Dir, 'lt_b.pl', FB),
+    % The exports of lt_a and lt_b are imported before they are defined.
+    % Use names that are not defined in `user` by other tests.
+    write_file(FA,
+               [ (:- module(lt_a, [lt_a_value/1])),
+                 (:- use_module(lt_b)),
+                 (lt_a_value(X) :- lt_b_name(X))
+               ]),
+    write_file(FB,
+               [ (:- module(lt_b, [lt_b_value/1, lt_b_name/1])),
+                 (:- use_module(lt_a)),
+                 (lt_b_value(X) :- X = a),
+                 lt_b_name(b)
+               ]),
+    findall(F,
+            ( between(1, 8, I),
+              format(atom(M), 'lt_~w', [I]),
+              file_name_extension(M, pl, Base),
+              dir_file(Dir, Base, F),
+              findall(value(I, J), between(1, 200, J), Facts),
+              write_file(F,
+                         [ (:- module(M, [])),
+                           (:- use_module(lt_common))
+                         | Facts
+                         ])
+            ),
+            Files).
+
+write_file(File, Terms) :-
+    setup_call_cleanup(
+        open(File, write, Out),
+        forall(member(T, Terms),
+               portray_clause(Out, T)),
+        close(Out)).
+
+dir_file(Dir, Base, File) :-
+    atomic_list_concat([Dir, /, Base], File).
+
+remove_dir(Dir) :-
+    atom_concat(Dir, '/*', Pattern),
+    expand_file_name(Pattern, Files),
+    maplist(delete_file, Files),
+    delete_directory(Dir).
@@ -0,0 +1,114 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, University of Amsterdam
+                         VU University Amsterdam
+		         CWI, Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+:- module(test_prof_sample,
+          [ test_prof_sample/0
+          ]).
+:- use_module(library(lists)).
+:- use_module(library(prolog_sampler)).
+
+/** <module> Test the sampling profiler
+
+Runs a busy and a blocked thread while the sampler is active and
+verifies that the samples include the busy predicate and the blocked
+thread and that the collapsed stack output is well formed.
+*/
+
+test_prof_sample :-
+    sampler_reset,
+    sampler_start([rate(200)]),
+    call_cleanup(run_worker, sampler_stop),
+    sampler_samples(Samples),
+    assertion(( member(sample(prof_sample_worker, Stack, Count), Samples),
+                memberchk(test_prof_sample:spin/1, Stack),
+                Count > 0
+              )),
+    assertion(( member(sample(prof_sample_blocked, BStack, BCount), Samples),
+                memberchk(test_prof_sample:blocked/0, BStack),
+                BCount > 1
+              )),
+    with_output_to(string(Text), sampler_collapsed(current_output, [])),
+    split_string(Text, "\n", "", Lines0),
+    exclude(==(""), Lines0, Lines),
+    assertion(Lines \== []),
+    forall(member(Line, Lines), assertion(collapsed_line(Line))),
+    assertion(( member(Line, Lines),
+                sub_string(Line, 0, _, _, "prof_sample_worker;")
+              )),
+    sampler_start([]),
+    catch(sampler_start([]), E, true),
+    sampler_stop,
+    assertion(subsumes_term(error(permission_error(start, sampler, _), _), E)),
+    sampler_reset,
+    sampler_samples(Empty),
+    assertion(Empty == []).
+
+run_worker :-
+    thread_create(blocked, Blocked, [alias(prof_sample_blocked)]),
+    thread_create(spin(0), Id, [alias(prof_sample_worker)]),
+    thread_join(Id, Status),
+    thread_send_message(Blocked, done),
+    thread_join(Blocked, BStatus),
+    assertion(Status == true),
+    assertion(BStatus == true).
+
+blocked :-
+    thread_get_message(done),
+    true.
+
+%   Spin for at least 0.5 seconds CPU time, such that we get samples
+%   regardless of the system load.
+
+spin(N) :-
+    thread_statistics(prof_sample_worker, cputime, T),
+    T > 0.5,
+    N > 1000,
+    !.
+spin(N) :-
+    X is N*N,
+    X >= 0,
+    N1 is N+1,
+    spin(N1).
+
+collapsed_line(Line) :-
+    split_string(Line, " ", "", Parts),
+    last(Parts, CountS),
+    number_string(Count, CountS),
+    integer(Count),
+    Count > 0,
+    sub_string(Line, B, _, _, ";"),
+    B > 0,
+    !.
@@ -66,6 +66,19 @@ test(anonymous) :-
 	assertion(current_blob(Id, thread)),
 	thread_join(Id, Status),
 	assertion(Status == true).
+test(stack_space, S1 == S0) :-
+	statistics(stack, S0),
+	forall(between(1, 3, _),
+	       ( thread_create(big_stacks, Id, []),
+		 thread_join(Id, Status),
+		 assertion(Status == true)
+	       )),
+	statistics(stack, S1).
+
+big_stacks :-
+	numlist(1, 1 000 000, L),
+	length(L, _),
+	garbage_collect.
 
 :- end_tests(thread_create).
 
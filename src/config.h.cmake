@@ -86,6 +86,7 @@
 #cmakedefine HAVE_LIBUNWIND @HAVE_LIBUNWIND@
 #cmakedefine HAVE_LIBWINMM @HAVE_LIBWINMM@
 #cmakedefine HAVE_LIBWSOCK32 @HAVE_LIBWSOCK32@
+#cmakedefine HAVE_LINUX_PERF_EVENT_H @HAVE_LINUX_PERF_EVENT_H@
 #cmakedefine HAVE_LOCALECONV @HAVE_LOCALECONV@
 #cmakedefine HAVE_LOCALE_H @HAVE_LOCALE_H@
 #cmakedefine HAVE_LOCALTIME_R @HAVE_LOCALTIME_R@
@@ -224,6 +225,7 @@
 #cmakedefine O_PLMT @O_PLMT@
 #cmakedefine O_SHARED_KERNEL @O_SHARED_KERNEL@
 #cmakedefine O_SIGPROF_PROFILE @O_SIGPROF_PROFILE@
+#cmakedefine O_VMI_STATISTICS @O_VMI_STATISTICS@
 #cmakedefine PACKAGE_BUGREPORT @PACKAGE_BUGREPORT@
 #cmakedefine PACKAGE_NAME @PACKAGE_NAME@
 #cmakedefine PACKAGE_STRING @PACKAGE_STRING@
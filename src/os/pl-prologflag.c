@@ -826,6 +826,10 @@ set_prolog_flag_unlocked(term_t key, term_t value, int flags)
 #endif
       if ( k == ATOM_table_space )
 	LD->tabling.node_pool.limit = (size_t)i;
+#ifdef O_PLMT
+      else if ( k == ATOM_jiti_background )
+	GD->thread.index.background_min = (size_t)i;
+#endif
       else if ( k == ATOM_stack_limit )
       { if ( !set_stack_limit((size_t)i) )
 	  return FALSE;
@@ -1338,11 +1342,22 @@ initPrologFlags(void)
   setPrologFlag("unload_foreign_libraries", FT_BOOL, FALSE, 0);
   setPrologFlag("gc",	  FT_BOOL,	       TRUE,  PLFLAG_GC);
   setPrologFlag("trace_gc",  FT_BOOL,	       FALSE, PLFLAG_TRACE_GC);
+  setPrologFlag("generational_gc", FT_BOOL,    TRUE,  PLFLAG_GENERATIONAL_GC);
 #ifdef O_ATOMGC
   setPrologFlag("agc_margin",FT_INTEGER,	       GD->atoms.margin);
 #endif
   setPrologFlag("table_space", FT_INTEGER, LD->tabling.node_pool.limit);
+#ifdef O_PLMT
+  setPrologFlag("jiti_background", FT_INTEGER,
+		GD->thread.index.background_min);
+#endif
   setPrologFlag("stack_limit", FT_INTEGER, LD->stacks.limit);
+#ifdef O_MMAP_STACKS
+  setPrologFlag("mmap_stacks", FT_BOOL|FF_READONLY,
+		LD->stacks.vm.base != NULL, 0);
+#else
+  setPrologFlag("mmap_stacks", FT_BOOL|FF_READONLY, FALSE, 0);
+#endif
 #if defined(HAVE_DLOPEN) || defined(HAVE_SHL_LOAD) || defined(EMULATE_DLOPEN)
   setPrologFlag("open_shared_object",	  FT_BOOL|FF_READONLY, TRUE, 0);
   setPrologFlag("shared_object_extension",	  FT_ATOM|FF_READONLY, SO_EXT);
@@ -1170,6 +1170,160 @@ out:
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Sread_codes() reads at most `max` code points from `s` into `buf` and
+returns the number of codes read, 0 at end-of-file or -1 on an error. If
+`nstop` > 0, reading stops after a code  that appears in `stop`, such
+that the input after it is left untouched. The call blocks only if there
+is no input buffered, i.e., it may return less than `max` codes before
+end-of-file.
+
+For the ISO Latin 1, ASCII and UTF-8  encodings, the codes are decoded
+directly from the buffer and  the  position   is  updated  once for the
+decoded run.  Runs of 8 printable  ASCII   bytes  are tested and copied
+as a unit if there are no stop codes. Anything that is not trivial, such
+as a multibyte sequence that crosses the  buffer boundary, a malformed
+sequence or a \r in DOS text mode, is handed to Sgetcode().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define ONES8	 ((uint64_t)0x0101010101010101)
+#define HIGHS8	 ((uint64_t)0x8080808080808080)
+#define PLAIN8(w) ( (((w) | ((w) - ONES8*('\r'+1))) & HIGHS8) == 0 )
+
+static inline int
+is_stop_code(int c, const int *stop, size_t nstop)
+{ size_t i;
+
+  for(i=0; i<nstop; i++)
+  { if ( stop[i] == c )
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+static size_t
+S__decode_buffer(IOSTREAM *s, int *buf, size_t max,
+		 const int *stop, size_t nstop, int *stopped)
+{ const unsigned char *in  = (const unsigned char *)s->bufp;
+  const unsigned char *end = (const unsigned char *)s->limitp;
+  const unsigned char *in0 = in;
+  int *out = buf;
+  int *eout = buf+max;
+  int enc = s->encoding;
+  int skip_cr = ( (s->flags&SIO_TEXT) && s->newline != SIO_NL_POSIX );
+  IOPOS *p = s->position;
+
+  while( in < end && out < eout )
+  { int c = in[0];
+
+    if ( nstop == 0 && enc != ENC_OCTET && enc != ENC_ISO_LATIN_1 )
+    { while( end-in >= 8 && eout-out >= 8 )
+      { uint64_t w;
+
+	memcpy(&w, in, sizeof(w));
+	if ( !PLAIN8(w) )
+	  break;
+	out[0] = in[0]; out[1] = in[1]; out[2] = in[2]; out[3] = in[3];
+	out[4] = in[4]; out[5] = in[5]; out[6] = in[6]; out[7] = in[7];
+	in += 8;
+	out += 8;
+	if ( p )
+	  p->linepos += 8;
+      }
+      if ( in == end || out == eout )
+	break;
+      c = in[0];
+    }
+
+    if ( c & 0x80 )
+    { int extra, i;
+
+      if ( enc == ENC_ASCII )
+	break;
+      if ( enc == ENC_UTF8 )
+      { if ( (extra = UTF8_FBN(c)) < 0 || end-in <= extra )
+	  break;
+	c = UTF8_FBV(c, extra);
+	for(i=1; i<=extra; i++)
+	{ if ( !ISUTF8_CB(in[i]) )
+	    goto out;
+	  c = (c<<6)+(in[i]&0x3f);
+	}
+	in += extra;
+      }
+    } else if ( c == '\r' && skip_cr )
+    { break;
+    }
+
+    in++;
+    *out++ = c;
+    if ( p )
+      update_linepos(s, c);
+    if ( nstop && is_stop_code(c, stop, nstop) )
+    { *stopped = TRUE;
+      break;
+    }
+  }
+
+out:
+  if ( s->tee && s->tee->magic == SIO_MAGIC )
+  { int *o;
+
+    for(o=buf; o<out; o++)
+      Sputcode(*o, s->tee);
+  }
+  if ( p )
+  { p->byteno += in-in0;
+    p->charno += out-buf;
+  }
+  s->bufp = (char*)in;
+
+  return out-buf;
+}
+
+
+ssize_t
+Sread_codes(IOSTREAM *s, int *buf, size_t max, const int *stop, size_t nstop)
+{ size_t n = 0;
+  int stopped = FALSE;
+
+  while( n < max )
+  { int c;
+
+    switch(s->encoding)
+    { case ENC_OCTET:
+      case ENC_ISO_LATIN_1:
+      case ENC_ASCII:
+      case ENC_UTF8:
+	if ( s->bufp < s->limitp )
+	{ n += S__decode_buffer(s, buf+n, max-n, stop, nstop, &stopped);
+	  if ( stopped || n == max )
+	    return n;
+	}
+	break;
+      default:
+	break;
+    }
+
+    if ( n > 0 && s->bufp >= s->limitp )
+      break;				/* do not block */
+
+    if ( (c = Sgetcode(s)) == EOF )
+    { if ( Sferror(s) )
+	return -1;
+      break;
+    }
+    buf[n++] = c;
+    if ( nstop && is_stop_code(c, stop, nstop) )
+      break;
+  }
+
+  return n;
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 peek needs to keep track of the actual bytes processed because not doing
 so might lead to an  incorrect  byte-count   in  the  position term. The
@@ -107,7 +107,6 @@ problem.
 #endif
 #endif
 
-static int		ar_minus(Number n1, Number n2, Number r);
 static int		mul64(int64_t x, int64_t y, int64_t *r);
 static int		notLessThanZero(const char *f, int a, Number n);
 static int		mustBePositive(const char *f, int a, Number n);
@@ -765,6 +764,11 @@ valueExpression(term_t expr, number *result ARG_LD)
 	    goto error;
 	  break;
 	}
+	if ( isNumericArrayFunction(term->definition) )
+	{ if ( !valueNumericArrayFunction(p, n PASS_LD) )
+	    goto error;
+	  break;
+	}
 
 	if ( arity == 0 )
 	{ functor = term->definition;
@@ -833,6 +837,18 @@ valueExpression(term_t expr, number *result ARG_LD)
 	{ case 1:
 	  { int rc;
 	    number *a0 = topOfSegStack(&arg_stack);
+	    ArithFloatF ff;
+
+	    if ( a0->type == V_FLOAT &&
+		 (ff = GD->arith.float_functions[indexFunctor(functor)]) )
+	    { double fv = (*ff)(a0->value.f);
+
+	      if ( isfinite(fv) )
+	      { a0->value.f = fv;
+		*n = *a0;
+		break;
+	      }
+	    }
 
 	    rc = (*f)(a0, n);
 	    clearNumber(a0);
@@ -1222,7 +1238,7 @@ pl_ar_add(Number n1, Number n2, Number r)
 }
 
 
-static int
+int
 ar_minus(Number n1, Number n2, Number r)
 { if ( !same_type_numbers(n1, n2) )
     return FALSE;
@@ -2340,7 +2356,7 @@ ar_rdiv(Number n1, Number n2, Number r)
 #endif /*O_GMP*/
 
 
-static int
+int
 ar_divide(Number n1, Number n2, Number r)
 { GET_LD
 
@@ -3717,6 +3733,47 @@ static const ar_funcdef ar_funcdefs[] = {
 
 #undef ADD
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Float kernels for unary functions. If the   argument of A_FUNC1 is a float
+and the function has a kernel, the  VM   calls  the kernel directly. The
+result is only used if it is a  normal   float;  otherwise the VM calls
+the full function to raise the appropriate error.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static double
+f_u_minus(double f)
+{ return -f;
+}
+
+static double
+f_u_plus(double f)
+{ return f;
+}
+
+typedef struct
+{ functor_t	functor;
+  ArithFloatF	function;
+} ar_floatdef;
+
+static const ar_floatdef ar_floatdefs[] = {
+  { FUNCTOR_minus1,	f_u_minus },
+  { FUNCTOR_plus1,	f_u_plus },
+  { FUNCTOR_abs1,	fabs },
+  { FUNCTOR_sqrt1,	sqrt },
+  { FUNCTOR_sin1,	sin },
+  { FUNCTOR_cos1,	cos },
+  { FUNCTOR_tan1,	tan },
+  { FUNCTOR_asin1,	asin },
+  { FUNCTOR_acos1,	acos },
+  { FUNCTOR_atan1,	atan },
+  { FUNCTOR_sinh1,	sinh },
+  { FUNCTOR_cosh1,	cosh },
+  { FUNCTOR_tanh1,	tanh },
+  { FUNCTOR_exp1,	exp },
+  { FUNCTOR_log1,	log },
+  { FUNCTOR_log101,	log10 }
+};
+
 static size_t
 registerFunction(functor_t f, ArithF func)
 { size_t index = indexFunctor(f);
@@ -3729,20 +3786,29 @@ registerFunction(functor_t f, ArithF func)
 
       GD->arith.functions = allocHeapOrHalt(size*sizeof(ArithF));
       memset(GD->arith.functions, 0, size*sizeof(ArithF));
+      GD->arith.float_functions = allocHeapOrHalt(size*sizeof(ArithFloatF));
+      memset(GD->arith.float_functions, 0, size*sizeof(ArithFloatF));
       GD->arith.functions_allocated = size;
     } else
     { size_t size = GD->arith.functions_allocated*2;
       ArithF *new = allocHeapOrHalt(size*sizeof(ArithF));
+      ArithFloatF *fnew = allocHeapOrHalt(size*sizeof(ArithFloatF));
       size_t half = GD->arith.functions_allocated*sizeof(ArithF);
+      size_t fhalf = GD->arith.functions_allocated*sizeof(ArithFloatF);
       ArithF *old = GD->arith.functions;
+      ArithFloatF *fold = GD->arith.float_functions;
 
       DEBUG(0, Sdprintf("Re-sized function-table to %ld\n", (long)size));
 
       memcpy(new, old, half);
       memset(addPointer(new,half), 0, half);
+      memcpy(fnew, fold, fhalf);
+      memset(addPointer(fnew,fhalf), 0, fhalf);
       GD->arith.functions = new;
+      GD->arith.float_functions = fnew;
       GD->arith.functions_allocated = size;
       freeHeap(old, half);
+      freeHeap(fold, fhalf);
     }
   }
 
@@ -3759,6 +3825,15 @@ registerBuiltinFunctions()
 
   for(d = ar_funcdefs, n=0; n<size; n++, d++)
     registerFunction(d->functor, d->function);
+
+  size = sizeof(ar_floatdefs)/sizeof(ar_floatdef);
+  for(n=0; n<size; n++)
+  { size_t index = indexFunctor(ar_floatdefs[n].functor);
+
+    assert(index < GD->arith.functions_allocated &&
+	   GD->arith.functions[index]);
+    GD->arith.float_functions[index] = ar_floatdefs[n].function;
+  }
 }
 
 
@@ -3782,7 +3857,10 @@ cleanupArith(void)
 
   if ( GD->arith.functions )
   { freeHeap(GD->arith.functions, GD->arith.functions_allocated*sizeof(ArithF));
+    freeHeap(GD->arith.float_functions,
+	     GD->arith.functions_allocated*sizeof(ArithFloatF));
     GD->arith.functions = 0;
+    GD->arith.float_functions = 0;
     GD->arith.functions_allocated = 0;
   }
 }
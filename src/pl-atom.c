@@ -194,6 +194,16 @@ Note that threads can mark their atoms and continue execution because:
       AGC is running, we are ok, because this is merely the same issue
       as atoms living on the stack.  TBD: redesign the structures such
       that they can safely be walked.
+
+As threads may continue while  AGC  is   running,  the  stacks of other
+threads need not be scanned by the collector.  markAtomsOnThreadStacks()
+asks each thread to mark its own  stacks   at  the next safe point using
+SIG_ATOM_MARK and only scans threads that do not respond in time itself.
+Likewise, collectAtoms() only holds L_REHASH_ATOMS  for a chunk of atoms
+at a time, so threads that  need  to   rehash  the  atom  table are not
+blocked for the duration of  the  sweep.  The  time  spent  in both
+phases and the longest time a thread  spent marking its stacks are
+available from statistics/2.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 static int	rehashAtoms(void);
@@ -930,14 +940,26 @@ destroyAtom(Atom a, Atom **buckets)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+collectAtoms() sweeps the atom array.  Invalidating an atom must be done
+while holding L_REHASH_ATOMS, but we  release   the  lock every
+AGC_SWEEP_CHUNK atoms to allow other threads to rehash the table.  Atoms
+created after we passed them are  simply   not  considered  by this
+collection.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define AGC_SWEEP_CHUNK 4096
+
 static size_t
 collectAtoms(void)
 { size_t reclaimed = 0;
   size_t unregistered = 0;
   size_t index;
   int i, last=FALSE;
+  int chunk = 0;
   Atom temp, next, prev = NULL;	 /* = NULL to keep compiler happy */
 
+  PL_LOCK(L_REHASH_ATOMS);
   for(index=GD->atoms.builtin, i=MSB(index); !last; i++)
   { size_t upto = (size_t)2<<i;
     size_t high = GD->atoms.highest;
@@ -952,6 +974,12 @@ collectAtoms(void)
     { Atom a = b + index;
       unsigned int ref = a->references;
 
+      if ( ++chunk == AGC_SWEEP_CHUNK )
+      { PL_UNLOCK(L_REHASH_ATOMS);
+	chunk = 0;
+	PL_LOCK(L_REHASH_ATOMS);
+      }
+
       if ( !ATOM_IS_VALID(ref) )
       { continue;
       }
@@ -992,6 +1020,7 @@ collectAtoms(void)
   if ( buckets )
     PL_free(buckets);
   maybe_free_atom_tables();
+  PL_UNLOCK(L_REHASH_ATOMS);
 
   GD->atoms.unregistered = GD->atoms.non_garbage = unregistered;
 
@@ -1003,7 +1032,8 @@ collectAtoms(void)
 pl_garbage_collect_atoms() realised the atom   garbage  collector (AGC).
 
 Issues around the design of the atom  garbage collector are explained at
-the start of this file.
+the start of this file.  The mark and  sweep times are wall times, while
+agc_time is the CPU time of the thread running AGC.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 foreign_t
@@ -1011,7 +1041,7 @@ pl_garbage_collect_atoms(void)
 { GET_LD
   int64_t oldcollected;
   int verbose = truePrologFlag(PLFLAG_TRACE_GC) && !LD->in_print_message;
-  double t;
+  double t, t0, t1;
   sigset_t set;
   size_t reclaimed;
   int rc = TRUE;
@@ -1031,24 +1061,26 @@ pl_garbage_collect_atoms(void)
     }
   }
 
-  PL_LOCK(L_REHASH_ATOMS);
   blockSignals(&set);
   t = CpuTime(CPU_USER);
+  t0 = WallTime();
   unmarkAtoms();
   markAtomsOnStacks(LD);
 #ifdef O_PLMT
-  forThreadLocalDataUnsuspended(markAtomsOnStacks, 0);
+  markAtomsOnThreadStacks();
   markAtomsMessageQueues();
 #endif
+  t1 = WallTime();
+  GD->atoms.mark_time += t1 - t0;
   oldcollected = GD->atoms.collected;
   reclaimed = collectAtoms();
   GD->atoms.collected += reclaimed;
   ATOMIC_SUB(&GD->statistics.atoms, reclaimed);
+  GD->atoms.sweep_time += WallTime() - t1;
   t = CpuTime(CPU_USER) - t;
   GD->atoms.gc_time += t;
   GD->atoms.gc++;
   unblockSignals(&set);
-  PL_UNLOCK(L_REHASH_ATOMS);
 
   if ( verbose )
     rc = printMessage(ATOM_informational,
@@ -35,6 +35,7 @@
 
 /*#define O_DEBUG 1*/
 #include "pl-incl.h"
+#include "pl-hash.h"
 
 #undef LD
 #define LD LOCAL_LD
@@ -120,8 +121,11 @@ clear_mem_pool(mem_pool *mp)
 
 #define FINDALL_MAGIC	0x37ac78fe
 
+typedef struct agg_table *AggTable;
+
 typedef struct findall_bag
 { struct findall_bag *parent;		/* parent bag */
+  AggTable	groups;			/* '$new_group_bag'/1 */
   int		magic;			/* FINDALL_MAGIC */
   int		suspended;		/* Used for findnsols/4  */
   size_t	suspended_solutions;	/* Already handed out solutions */
@@ -133,10 +137,9 @@ typedef struct findall_bag
 } findall_bag;
 
 
-static
-PRED_IMPL("$new_findall_bag", 0, new_findall_bag, 0)
-{ PRED_LD
-  findall_bag *bag;
+static findall_bag *
+new_findall_bag(ARG1_LD)
+{ findall_bag *bag;
 
   if ( !LD->bags.bags )			/* outer one */
   { if ( !LD->bags.default_bag )
@@ -152,9 +155,10 @@ PRED_IMPL("$new_findall_bag", 0, new_findall_bag, 0)
   }
 
   if ( !bag )
-    return PL_no_memory();
+    return NULL;
 
   bag->magic		   = FINDALL_MAGIC;
+  bag->groups		   = NULL;
   bag->suspended	   = FALSE;
   bag->suspended_solutions = 0;
   bag->solutions	   = 0;
@@ -166,6 +170,17 @@ PRED_IMPL("$new_findall_bag", 0, new_findall_bag, 0)
   MemoryBarrier();
   LD->bags.bags = bag;
 
+  return bag;
+}
+
+
+static
+PRED_IMPL("$new_findall_bag", 0, new_findall_bag, 0)
+{ PRED_LD
+
+  if ( !new_findall_bag(PASS_LD1) )
+    return PL_no_memory();
+
   return TRUE;
 }
 
@@ -332,6 +347,680 @@ PRED_IMPL("$suspend_findall_bag", 0, suspend_findall_bag, PL_FA_NONDETERMINISTIC
 }
 
 
+		 /*******************************
+		 *     GROUPED AGGREGATION	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+'$new_group_bag'(+Op) creates a bag  that   aggregates  the solutions per
+_witness_ while they are produced.  '$add_group_bag'(+Witness, +Value)
+finds the group of Witness in a hash table and updates its accumulators.
+Memory usage is thus proportional to the number of groups, except for
+the bag and set operations that must keep the values.
+
+Groups are keyed on the record of the   witness. As records number the
+variables in order of appearance, witnesses that are variants share a
+group. This is the same grouping that   bagof/3 obtains by binding the
+variables of all witnesses using bind_bagof_keys/2.
+
+Op is one of count, sum, max, min, max_witness, min_witness, bag or set,
+or term(MinNeeded, Functor, Ops) as used by library(aggregate), in which
+case Value is a term Functor(V1, ...) with a value for each operation.
+The result for a group is built the same way.
+
+Values kept for bag, set, max_witness and min_witness may share variables
+with the witness.  If the witness is not ground they are stored as
+Witness-Value, and the witness is unified with the key of the group when
+the result is collected.  Ground set elements are stored once.
+
+All records that are kept live in the memory pool of the bag and are
+pushed on the answer stack, such that markAtomsFindall() marks them.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+typedef enum
+{ AGG_COUNT = 0,
+  AGG_SUM,
+  AGG_MAX,
+  AGG_MIN,
+  AGG_MAX_WITNESS,
+  AGG_MIN_WITNESS,
+  AGG_BAG,
+  AGG_SET
+} agg_op;
+
+typedef struct rec_cell
+{ Record	record;
+  struct rec_cell *next;
+} rec_cell;
+
+typedef struct agg_value
+{ int		has_number;		/* number is initialised */
+  number	number;			/* sum, max or min */
+  int64_t	count;			/* count */
+  Record	witness;		/* max_witness and min_witness */
+  rec_cell     *head;			/* bag and set */
+  rec_cell     *tail;
+} agg_value;
+
+typedef struct agg_group
+{ Record	key;			/* record of the witness */
+  struct agg_group *next;		/* next in creation order */
+  agg_value	values[1];		/* value per operation */
+} agg_group;
+
+typedef struct agg_entry
+{ unsigned int	hash;			/* hash of record */
+  void	       *owner;			/* NULL or agg_value of set */
+  Record	record;			/* key or set element */
+  agg_group    *group;			/* group if owner is NULL */
+} agg_entry;
+
+struct agg_table
+{ functor_t	functor;		/* term(_,F,Ops): result functor */
+  int		nops;			/* # operations */
+  agg_op       *ops;			/* operations */
+  agg_entry   **entries;		/* hash table */
+  size_t	size;			/* size of the table */
+  size_t	count;			/* # entries */
+  agg_group    *head;			/* groups in creation order */
+  agg_group    *tail;
+  size_t	ngroups;		/* # groups */
+  char	       *scratch;		/* record buffer for lookups */
+  size_t	scratch_size;
+};
+
+#define AGG_INITIAL_SIZE 64
+
+
+static int
+get_agg_op(term_t t, agg_op *op)
+{ GET_LD
+  atom_t a;
+
+  if ( PL_get_atom(t, &a) )
+  { if ( a == ATOM_count )
+      *op = AGG_COUNT;
+    else if ( a == ATOM_sum )
+      *op = AGG_SUM;
+    else if ( a == ATOM_max )
+      *op = AGG_MAX;
+    else if ( a == ATOM_min )
+      *op = AGG_MIN;
+    else if ( a == ATOM_max_witness )
+      *op = AGG_MAX_WITNESS;
+    else if ( a == ATOM_min_witness )
+      *op = AGG_MIN_WITNESS;
+    else if ( a == ATOM_bag )
+      *op = AGG_BAG;
+    else if ( a == ATOM_set )
+      *op = AGG_SET;
+    else
+      goto error;
+
+    return TRUE;
+  }
+
+error:
+  return PL_domain_error("aggregate_operation", t);
+}
+
+
+static AggTable
+new_agg_table(findall_bag *bag, term_t spec ARG_LD)
+{ AggTable t;
+  term_t tail = 0, head = 0;
+  atom_t name = 0;
+  size_t nops = 1, i;
+
+  if ( PL_is_functor(spec, FUNCTOR_term3) )
+  { term_t a = PL_new_term_ref();
+    intptr_t len;
+
+    _PL_get_arg(2, spec, a);
+    if ( !PL_get_atom_ex(a, &name) )
+      return NULL;
+    tail = PL_new_term_ref();
+    head = PL_new_term_ref();
+    _PL_get_arg(3, spec, tail);
+    if ( (len=lengthList(tail, TRUE)) < 0 )
+      return NULL;
+    nops = len;
+  }
+
+  if ( !(t = alloc_mem_pool(&bag->records, sizeof(*t))) ||
+       !(t->ops = alloc_mem_pool(&bag->records, nops*sizeof(agg_op))) )
+  { PL_no_memory();
+    return NULL;
+  }
+  memset(t->ops, 0, nops*sizeof(agg_op));
+  t->nops         = (int)nops;
+  t->functor      = name ? PL_new_functor(name, nops) : 0;
+  t->count        = 0;
+  t->head         = t->tail = NULL;
+  t->ngroups      = 0;
+  t->scratch      = NULL;
+  t->scratch_size = 0;
+  t->size         = AGG_INITIAL_SIZE;
+  if ( !(t->entries = PL_malloc(t->size*sizeof(*t->entries))) )
+    return NULL;
+  memset(t->entries, 0, t->size*sizeof(*t->entries));
+  bag->groups = t;			/* free_agg_table() on failure */
+
+  if ( name )
+  { for(i=0; PL_get_list(tail, head, tail); i++)
+    { if ( !get_agg_op(head, &t->ops[i]) )
+	return NULL;
+    }
+  } else if ( !get_agg_op(spec, &t->ops[0]) )
+  { return NULL;
+  }
+
+  return t;
+}
+
+
+static void
+free_agg_table(AggTable t)
+{ agg_group *g;
+  int i;
+
+  for(g=t->head; g; g=g->next)
+  { for(i=0; i<t->nops; i++)
+    { if ( g->values[i].has_number )
+	clearNumber(&g->values[i].number);
+    }
+  }
+  PL_free(t->entries);
+  if ( t->scratch )
+    free(t->scratch);
+}
+
+
+static void *
+alloc_scratch(void *ctx, size_t bytes)
+{ AggTable t = ctx;
+
+  if ( bytes > t->scratch_size )
+  { char *p = realloc(t->scratch, bytes);
+
+    if ( !p )
+      return NULL;
+    t->scratch = p;
+    t->scratch_size = bytes;
+  }
+
+  return t->scratch;
+}
+
+
+static unsigned int
+hash_record(Record r)
+{ return MurmurHashAligned2(r, r->size, MURMUR_SEED);
+}
+
+
+static int
+same_record(Record r1, Record r2)
+{ return r1->size == r2->size && memcmp(r1, r2, r1->size) == 0;
+}
+
+
+static agg_entry **
+find_entry(AggTable t, void *owner, Record r, unsigned int hash)
+{ size_t mask = t->size-1;
+  size_t i;
+
+  for(i=hash&mask;; i=(i+1)&mask)
+  { agg_entry *e = t->entries[i];
+
+    if ( !e ||
+	 (e->hash == hash && e->owner == owner && same_record(e->record, r)) )
+      return &t->entries[i];
+  }
+}
+
+
+static int
+grow_agg_table(AggTable t)
+{ size_t i, osize = t->size;
+  agg_entry **old = t->entries;
+  agg_entry **new;
+
+  if ( !(new = PL_malloc(osize*2*sizeof(*new))) )
+    return FALSE;
+  memset(new, 0, osize*2*sizeof(*new));
+  t->entries = new;
+  t->size = osize*2;
+
+  for(i=0; i<osize; i++)
+  { agg_entry *e = old[i];
+
+    if ( e )
+      *find_entry(t, e->owner, e->record, e->hash) = e;
+  }
+  PL_free(old);
+
+  return TRUE;
+}
+
+
+/* Copy the scratch record r into the pool and register it */
+
+static Record
+keep_record(findall_bag *bag, Record r)
+{ Record copy;
+
+  if ( !(copy = alloc_mem_pool(&bag->records, r->size)) )
+    return NULL;
+  memcpy(copy, r, r->size);
+  if ( !pushRecordSegStack(&bag->answers, copy) )
+    return NULL;
+  bag->gsize += copy->gsize;
+
+  return copy;
+}
+
+
+static Record
+compile_record(findall_bag *bag, term_t t ARG_LD)
+{ Record r;
+
+  if ( !(r = compileTermToHeap__LD(t, alloc_record, bag,
+				   R_NOLOCK PASS_LD)) ||
+       !pushRecordSegStack(&bag->answers, r) )
+    return NULL;
+  bag->gsize += r->gsize;
+
+  return r;
+}
+
+
+static agg_entry *
+add_entry(findall_bag *bag, agg_entry **slot, void *owner, Record r,
+	  unsigned int hash)
+{ AggTable t = bag->groups;
+  agg_entry *e;
+
+  if ( !(e = alloc_mem_pool(&bag->records, sizeof(*e))) )
+    return NULL;
+  e->hash   = hash;
+  e->owner  = owner;
+  e->record = r;
+  e->group  = NULL;
+  *slot = e;
+  if ( ++t->count*2 > t->size && !grow_agg_table(t) )
+    return NULL;
+
+  return e;
+}
+
+
+static agg_group *
+lookup_group(findall_bag *bag, term_t witness ARG_LD)
+{ AggTable t = bag->groups;
+  Record r;
+  unsigned int hash;
+  agg_entry **slot, *e;
+  agg_group *g;
+  size_t size;
+  int i;
+
+  if ( !(r = compileTermToHeap__LD(witness, alloc_scratch, t,
+				   R_NOLOCK PASS_LD)) )
+    return NULL;
+  hash = hash_record(r);
+  slot = find_entry(t, NULL, r, hash);
+  if ( *slot )
+    return (*slot)->group;
+
+  size = sizeof(*g) + (t->nops-1)*sizeof(agg_value);
+  if ( !(g = alloc_mem_pool(&bag->records, size)) ||
+       !(r = keep_record(bag, r)) ||
+       !(e = add_entry(bag, slot, NULL, r, hash)) )
+    return NULL;
+  memset(g, 0, size);
+  g->key = r;
+  e->group = g;
+  for(i=0; i<t->nops; i++)
+  { if ( t->ops[i] == AGG_SUM )
+    { g->values[i].has_number = TRUE;
+      g->values[i].number.type = V_INTEGER;
+      g->values[i].number.value.i = 0;
+    }
+  }
+  if ( t->tail )
+    t->tail->next = g;
+  else
+    t->head = g;
+  t->tail = g;
+  t->ngroups++;
+
+  return g;
+}
+
+
+static int
+add_cell(findall_bag *bag, agg_value *v, Record r)
+{ rec_cell *c;
+
+  if ( !(c = alloc_mem_pool(&bag->records, sizeof(*c))) )
+    return FALSE;
+  c->record = r;
+  c->next = NULL;
+  if ( v->tail )
+    v->tail->next = c;
+  else
+    v->head = c;
+  v->tail = c;
+
+  return TRUE;
+}
+
+
+/* Add a set element.  Ground elements are added only once */
+
+static int
+add_set_element(findall_bag *bag, agg_value *v, term_t value ARG_LD)
+{ AggTable t = bag->groups;
+  Record r;
+
+  if ( !(r = compileTermToHeap__LD(value, alloc_scratch, t,
+				   R_NOLOCK PASS_LD)) )
+    return FALSE;
+  if ( r->nvars == 0 )
+  { unsigned int hash = hash_record(r);
+    agg_entry **slot = find_entry(t, v, r, hash);
+
+    if ( *slot )
+      return TRUE;
+    return ( (r = keep_record(bag, r)) &&
+	     add_entry(bag, slot, v, r, hash) &&
+	     add_cell(bag, v, r) );
+  }
+
+  return ( (r = keep_record(bag, r)) &&
+	   add_cell(bag, v, r) );
+}
+
+
+static int
+agg_step(findall_bag *bag, agg_group *g, agg_op op, agg_value *v,
+	 term_t witness, term_t value ARG_LD)
+{ term_t kept = value;
+  number n;
+  int rc = TRUE;
+
+  switch(op)
+  { case AGG_BAG:
+    case AGG_SET:
+    case AGG_MAX_WITNESS:
+    case AGG_MIN_WITNESS:
+      if ( g->key->nvars > 0 )
+      { if ( !(kept = PL_new_term_ref()) ||
+	     !PL_cons_functor(kept, FUNCTOR_minus2, witness, value) )
+	  return FALSE;
+      }
+      break;
+    default:
+      break;
+  }
+
+  switch(op)
+  { case AGG_COUNT:
+      v->count++;
+      return TRUE;
+    case AGG_BAG:
+    { Record r = compile_record(bag, kept PASS_LD);
+
+      return r && add_cell(bag, v, r);
+    }
+    case AGG_SET:
+      return add_set_element(bag, v, kept PASS_LD);
+    case AGG_MAX_WITNESS:
+    case AGG_MIN_WITNESS:
+    { term_t x = PL_new_term_ref();
+
+      if ( !PL_is_functor(value, FUNCTOR_minus2) )
+	return PL_type_error("pair", value);
+      _PL_get_arg(1, value, x);
+      if ( !valueExpression(x, &n PASS_LD) )
+	return FALSE;
+      if ( !v->has_number ||
+	   ( op == AGG_MAX_WITNESS ? cmpNumbers(&n, &v->number) == CMP_GREATER
+				   : cmpNumbers(&n, &v->number) == CMP_LESS ) )
+      { Record r = compile_record(bag, kept PASS_LD);
+
+	if ( !r )
+	{ rc = FALSE;
+	} else
+	{ if ( v->has_number )
+	    clearNumber(&v->number);
+	  cpNumber(&v->number, &n);
+	  v->has_number = TRUE;
+	  v->witness = r;
+	}
+      }
+      clearNumber(&n);
+      return rc;
+    }
+    case AGG_SUM:
+    case AGG_MAX:
+    case AGG_MIN:
+    { number r;
+
+      if ( !valueExpression(value, &n PASS_LD) )
+	return FALSE;
+      if ( op == AGG_SUM )
+      { if ( (rc=pl_ar_add(&v->number, &n, &r)) )
+	{ clearNumber(&v->number);
+	  cpNumber(&v->number, &r);
+	  clearNumber(&r);
+	}
+      } else if ( !v->has_number ||
+		  ( op == AGG_MAX ? cmpNumbers(&v->number, &n) == CMP_LESS
+				  : cmpNumbers(&v->number, &n) == CMP_GREATER ) )
+      { if ( v->has_number )
+	  clearNumber(&v->number);
+	cpNumber(&v->number, &n);
+	v->has_number = TRUE;
+      }
+      clearNumber(&n);
+      return rc;
+    }
+  }
+
+  assert(0);
+  return FALSE;
+}
+
+
+/** '$new_group_bag'(+Op)
+ *
+ * Create a bag that aggregates solutions per witness.  Must be destroyed
+ * using '$destroy_findall_bag'/0.
+ */
+
+static
+PRED_IMPL("$new_group_bag", 1, new_group_bag, 0)
+{ PRED_LD
+  findall_bag *bag;
+
+  if ( !(bag = new_findall_bag(PASS_LD1)) )
+    return PL_no_memory();
+  if ( !new_agg_table(bag, A1 PASS_LD) )
+    return PL_exception(0) ? FALSE : PL_no_memory();
+
+  return TRUE;
+}
+
+
+/** '$add_group_bag'(+Witness, +Value)
+ *
+ * Add a solution to the group of Witness.  Always fails, unless there is
+ * an error.
+ */
+
+static
+PRED_IMPL("$add_group_bag", 2, add_group_bag, 0)
+{ PRED_LD
+  findall_bag *bag = current_bag(PASS_LD1);
+  AggTable t;
+  agg_group *g;
+
+  if ( !bag || !(t=bag->groups) )
+    return PL_error(NULL, 0, "not a group bag",
+		    ERR_PERMISSION, ATOM_append, ATOM_bag, A1);
+
+  if ( !(g = lookup_group(bag, A1 PASS_LD)) )
+    return PL_exception(0) ? FALSE : PL_no_memory();
+
+  if ( t->functor )
+  { term_t a = PL_new_term_ref();
+    int i;
+
+    if ( !PL_is_functor(A2, t->functor) )
+      return PL_type_error("aggregate_row", A2);
+    for(i=0; i<t->nops; i++)
+    { _PL_get_arg(i+1, A2, a);
+      if ( !agg_step(bag, g, t->ops[i], &g->values[i], A1, a PASS_LD) )
+	goto error;
+    }
+  } else if ( !agg_step(bag, g, t->ops[0], &g->values[0], A1, A2 PASS_LD) )
+    goto error;
+
+  if ( bag->gsize + t->ngroups*3 > globalStackLimit()/sizeof(word) )
+    return outOfStack(&LD->stacks.global, STACK_OVERFLOW_RAISE);
+
+  return FALSE;
+
+error:
+  return PL_exception(0) ? FALSE : PL_no_memory();
+}
+
+
+/* Copy a value record to the global stack.  If the key of the group
+   is not ground, the record holds Witness-Value.
+*/
+
+static int
+copy_value(agg_group *g, Record r, term_t key, term_t value ARG_LD)
+{ int rc;
+
+  if ( g->key->nvars == 0 )
+    return (rc=copyRecordToGlobal(value, r, ALLOW_GC PASS_LD)) == TRUE
+	   ? TRUE : raiseStackOverflow(rc);
+  else
+  { term_t pair = PL_new_term_ref();
+    term_t w = PL_new_term_ref();
+
+    if ( (rc=copyRecordToGlobal(pair, r, ALLOW_GC PASS_LD)) != TRUE )
+      return raiseStackOverflow(rc);
+    _PL_get_arg(1, pair, w);
+    _PL_get_arg(2, pair, value);
+    return PL_unify(w, key);
+  }
+}
+
+
+static int
+unify_agg_value(agg_group *g, agg_op op, agg_value *v,
+		term_t key, term_t result ARG_LD)
+{ switch(op)
+  { case AGG_COUNT:
+      return PL_unify_int64(result, v->count);
+    case AGG_SUM:
+    case AGG_MAX:
+    case AGG_MIN:
+      return PL_unify_number(result, &v->number);
+    case AGG_MAX_WITNESS:
+    case AGG_MIN_WITNESS:
+    { term_t pair = PL_new_term_ref();
+      term_t m = PL_new_term_ref();
+      term_t w = PL_new_term_ref();
+
+      if ( !copy_value(g, v->witness, key, pair PASS_LD) ||
+	   !PL_put_number(m, &v->number) )
+	return FALSE;
+      _PL_get_arg(2, pair, w);
+      return PL_unify_term(result,
+			   PL_FUNCTOR, op == AGG_MAX_WITNESS ? FUNCTOR_max2
+							     : FUNCTOR_min2,
+			     PL_TERM, m,
+			     PL_TERM, w);
+    }
+    case AGG_BAG:
+    case AGG_SET:
+    { term_t tail = PL_copy_term_ref(result);
+      term_t head = PL_new_term_ref();
+      term_t value = PL_new_term_ref();
+      rec_cell *c;
+
+      for(c=v->head; c; c=c->next)
+      { if ( !copy_value(g, c->record, key, value PASS_LD) ||
+	     !PL_unify_list(tail, head, tail) ||
+	     !PL_unify(head, value) )
+	  return FALSE;
+      }
+      return PL_unify_nil(tail);
+    }
+  }
+
+  assert(0);
+  return FALSE;
+}
+
+
+/** '$collect_group_bag'(-Groups)
+ *
+ * Groups is a list Witness-Result with a pair for each group in the order
+ * in which the groups were created.  The elements of a set are not
+ * sorted.
+ */
+
+static
+PRED_IMPL("$collect_group_bag", 1, collect_group_bag, 0)
+{ PRED_LD
+  findall_bag *bag = current_bag(PASS_LD1);
+  AggTable t = bag->groups;
+  term_t tail = PL_copy_term_ref(A1);
+  term_t head = PL_new_term_ref();
+  term_t key = PL_new_term_ref();
+  term_t result = PL_new_term_ref();
+  term_t arg = PL_new_term_ref();
+  agg_group *g;
+  int rc;
+
+  assert(t);
+  for(g=t->head; g; g=g->next)
+  { if ( (rc=copyRecordToGlobal(key, g->key, ALLOW_GC PASS_LD)) != TRUE )
+      return raiseStackOverflow(rc);
+    PL_put_variable(result);
+    if ( t->functor )
+    { int i;
+
+      if ( !PL_unify_functor(result, t->functor) )
+	return FALSE;
+      for(i=0; i<t->nops; i++)
+      { _PL_get_arg(i+1, result, arg);
+	if ( !unify_agg_value(g, t->ops[i], &g->values[i],
+			      key, arg PASS_LD) )
+	  return FALSE;
+      }
+    } else if ( !unify_agg_value(g, t->ops[0], &g->values[0],
+				 key, result PASS_LD) )
+    { return FALSE;
+    }
+    if ( !PL_unify_list(tail, head, tail) ||
+	 !PL_unify_term(head, PL_FUNCTOR, FUNCTOR_minus2,
+			        PL_TERM, key,
+			        PL_TERM, result) )
+      return FALSE;
+  }
+
+  return PL_unify_nil(tail);
+}
+
+
 static
 PRED_IMPL("$destroy_findall_bag", 0, destroy_findall_bag, 0)
 { PRED_LD
@@ -350,6 +1039,10 @@ PRED_IMPL("$destroy_findall_bag", 0, destroy_findall_bag, 0)
 #endif
 
   bag->magic = 0;
+  if ( bag->groups )
+  { free_agg_table(bag->groups);
+    bag->groups = NULL;
+  }
   clearSegStack(&bag->answers);
   clear_mem_pool(&bag->records);
   if ( bag != LD->bags.default_bag )
@@ -396,4 +1089,7 @@ BeginPredDefs(bag)
   PRED_DEF("$collect_findall_bag", 2, collect_findall_bag, 0)
   PRED_DEF("$destroy_findall_bag", 0, destroy_findall_bag, 0)
   PRED_DEF("$suspend_findall_bag", 0, suspend_findall_bag, PL_FA_NONDETERMINISTIC)
+  PRED_DEF("$new_group_bag",       1, new_group_bag,       0)
+  PRED_DEF("$add_group_bag",       2, add_group_bag,       0)
+  PRED_DEF("$collect_group_bag",   1, collect_group_bag,   0)
 EndPredDefs
@@ -1109,6 +1109,7 @@ forwards void	orVars(VarTable, VarTable);
 forwards int	compileListFF(word arg, compileInfo *ci ARG_LD);
 forwards bool	compileSimpleAddition(Word, compileInfo * ARG_LD);
 #if O_COMPILE_ARITH
+forwards int	arrayArithExpression(Word arg ARG_LD);
 forwards int	compileArith(Word, compileInfo * ARG_LD);
 forwards bool	compileArithArgument(Word, compileInfo * ARG_LD);
 #endif
@@ -2121,7 +2122,9 @@ try_fast_condition(CompileInfo ci, size_t tc_or)
       case A_FUNC2:
       case A_FUNC:
       case A_ADD:
+      case A_SUB:
       case A_MUL:
+      case A_DIV:
       case A_LT:
       case A_LE:
       case A_GT:
@@ -2604,7 +2607,8 @@ A non-void variable. Create a I_USERCALL0 instruction for it.
 	   compileSimpleAddition(arg, ci PASS_LD) )
 	succeed;
 #if O_COMPILE_ARITH
-      if ( truePrologFlag(PLFLAG_OPTIMISE) )
+      if ( truePrologFlag(PLFLAG_OPTIMISE) &&
+	   !arrayArithExpression(arg PASS_LD) )
 	 return compileArith(arg, ci PASS_LD);
 #endif
     }
@@ -2834,6 +2838,33 @@ are tagged using the functor ARITH_F. See registerArithFunctors().
 Returns one of TRUE or *_OVERFLOW
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+arrayArithExpression() is true if the  arithmetic   goal  arg  uses one of
+the functions on numeric arrays (see  pl-numarray.c). These functions do
+not evaluate their arguments, so such goals are not compiled.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+arrayArithExpression(Word arg ARG_LD)
+{ deRef(arg);
+
+  if ( isTerm(*arg) )
+  { functor_t fdef = functorTerm(*arg);
+    size_t n, ar = arityFunctor(fdef);
+    Word a = argTermP(*arg, 0);
+
+    if ( isNumericArrayFunction(fdef) )
+      return TRUE;
+    for(n=0; n<ar; n++, a++)
+    { if ( arrayArithExpression(a PASS_LD) )
+	return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+
 static int
 compileArith(Word arg, compileInfo *ci ARG_LD)
 { code a_func;
@@ -3009,10 +3040,18 @@ compileArithArgument(Word arg, compileInfo *ci ARG_LD)
     { Output_0(ci, A_ADD);
       succeed;
     }
+    if ( fdef == FUNCTOR_minus2 )
+    { Output_0(ci, A_SUB);
+      succeed;
+    }
     if ( fdef == FUNCTOR_star2 )
     { Output_0(ci, A_MUL);
       succeed;
     }
+    if ( fdef == FUNCTOR_divide2 )
+    { Output_0(ci, A_DIV);
+      succeed;
+    }
 
     switch(ar)
     { case 0:	Output_1(ci, A_FUNC0, index); break;
@@ -3823,6 +3862,183 @@ PRED_IMPL("asserta", 2, asserta2, PL_FA_TRANSPARENT)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+assert_terms() implements assertz_list/1,  asserta_list/1 and the C API
+PL_assert_list(). All clauses are compiled  first. If this succeeds they
+are added using assertProcedures(),  which   adds  consecutive clauses
+for the same predicate under a  single   lock  and makes all of them
+visible in the same generation.  If  a   clause  cannot  be compiled,
+nothing is added and no predicate is  made dynamic. As assert_term(),
+clauses that are handled by the module's hook are not added.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define HOOKED_CLAUSE ((Clause)-1)
+
+static Clause
+compile_dynamic_clause(term_t term, Module module, ClauseRef where,
+		       Procedure *procp ARG_LD)
+{ term_t tmp  = PL_new_term_refs(3);
+  term_t head = tmp+1;
+  term_t body = tmp+2;
+  Clause clause = NULL;
+  Procedure proc;
+  Definition def;
+  Module mhead;
+  functor_t fdef;
+  Word h, b;
+
+  if ( !PL_strip_module_ex(term, &module, tmp) )
+    goto out;
+  mhead = module;
+  if ( !get_head_and_body_clause(tmp, head, body, &mhead PASS_LD) ||
+       !get_head_functor(head, &fdef, 0 PASS_LD) )
+    goto out;
+  if ( !(proc = isCurrentProcedure(fdef, mhead)) )
+  { if ( checkModifySystemProc(fdef) )
+      proc = lookupProcedure(fdef, mhead);
+    if ( !proc )
+      goto out;
+  }
+
+  def = getProcDefinition(proc);
+  if ( false(def, P_DYNAMIC) && isDefinedProcedure(proc) )
+  { PL_error(NULL, 0, NULL, ERR_MODIFY_STATIC_PROC, proc);
+    goto out;
+  }
+
+  h = valTermRef(head);
+  b = valTermRef(body);
+  deRef(h);
+  deRef(b);
+
+#ifdef O_PROLOG_HOOK
+  if ( mhead->hook && isDefinedProcedure(mhead->hook) )
+  { fid_t fid = PL_open_foreign_frame();
+    term_t t = PL_new_term_ref();
+    int rval;
+    functor_t f = (where == CL_START ? FUNCTOR_asserta1 : FUNCTOR_assert1);
+
+    if ( *b == ATOM_true )
+      PL_unify_term(t,
+		    PL_FUNCTOR, f,
+		      PL_TERM, head);
+    else
+      PL_unify_term(t,
+		    PL_FUNCTOR, f,
+		      PL_FUNCTOR, FUNCTOR_prove2,
+		        PL_TERM, head,
+		        PL_TERM, body);
+
+    rval = PL_call_predicate(mhead, PL_Q_NORMAL, mhead->hook, t);
+
+    PL_discard_foreign_frame(fid);
+    if ( rval )
+    { clause = HOOKED_CLAUSE;
+      goto out;
+    }
+  }
+#else
+  (void)where;
+#endif /*O_PROLOG_HOOK*/
+
+  if ( compileClause(&clause, h, b, proc, module, 0 PASS_LD) != TRUE )
+    clause = NULL;
+  else
+    *procp = proc;
+
+out:
+  PL_reset_term_refs(tmp);
+  return clause;
+}
+
+
+int
+assert_terms(term_t list, Module module, ClauseRef where ARG_LD)
+{ term_t tail = PL_new_term_ref();
+  term_t head = PL_new_term_ref();
+  tmp_buffer procs, clauses;
+  size_t count;
+  int rc = TRUE;
+
+  if ( !PL_strip_module_ex(list, &module, tail) ||
+       lengthList(tail, TRUE) < 0 )
+    return FALSE;
+
+  initBuffer(&procs);
+  initBuffer(&clauses);
+  while( PL_get_list(tail, head, tail) )
+  { Procedure proc;
+    Clause clause;
+
+    if ( !(clause = compile_dynamic_clause(head, module, where,
+					   &proc PASS_LD)) )
+    { rc = FALSE;
+      break;
+    }
+    if ( clause == HOOKED_CLAUSE )
+      continue;
+    addBuffer(&procs, proc, Procedure);
+    addBuffer(&clauses, clause, Clause);
+  }
+
+  count = entriesBuffer(&clauses, Clause);
+  if ( rc )
+  { Procedure *pp = baseBuffer(&procs, Procedure);
+    size_t i;
+
+    for(i=0; i<count; i++)		/* make undefined predicates dynamic */
+    { Definition def = getProcDefinition(pp[i]);
+
+      if ( false(def, P_DYNAMIC) && !setDynamicDefinition(def, TRUE) )
+      { rc = FALSE;
+	break;
+      }
+    }
+  }
+
+  if ( rc )
+  { assertProcedures(baseBuffer(&procs, Procedure),
+		     baseBuffer(&clauses, Clause),
+		     count, where PASS_LD);
+  } else
+  { Clause *cp = baseBuffer(&clauses, Clause);
+    size_t i;
+
+    for(i=0; i<count; i++)
+      freeClause(cp[i]);
+  }
+  discardBuffer(&procs);
+  discardBuffer(&clauses);
+
+  return rc;
+}
+
+
+static
+PRED_IMPL("assertz_list", 1, assertz_list, PL_FA_TRANSPARENT)
+{ PRED_LD
+
+  return assert_terms(A1, NULL, CL_END PASS_LD);
+}
+
+
+static
+PRED_IMPL("asserta_list", 1, asserta_list, PL_FA_TRANSPARENT)
+{ PRED_LD
+
+  return assert_terms(A1, NULL, CL_START PASS_LD);
+}
+
+
+int
+PL_assert_list(term_t clauses, module_t module, int flags)
+{ GET_LD
+
+  return assert_terms(clauses, module,
+		      (flags&PL_ASSERTA) ? CL_START : CL_END PASS_LD);
+}
+
+
 /** '$record_clause'(+Term, +Owner, +Source)
     '$record_clause'(+Term, +Owner, +Source, -Ref)
 
@@ -5066,9 +5282,15 @@ decompileBody(decompileInfo *di, code end, Code until ARG_LD)
       case A_ADD:
 			    BUILD_TERM(FUNCTOR_plus2);
 			    continue;
+      case A_SUB:
+			    BUILD_TERM(FUNCTOR_minus2);
+			    continue;
       case A_MUL:
 			    BUILD_TERM(FUNCTOR_star2);
 			    continue;
+      case A_DIV:
+			    BUILD_TERM(FUNCTOR_divide2);
+			    continue;
       case A_FUNC0:
       case A_FUNC1:
       case A_FUNC2:
@@ -7228,6 +7450,8 @@ BeginPredDefs(comp)
   PRED_DEF("assert",  2, assertz2, META)
   PRED_DEF("assertz", 2, assertz2, META)
   PRED_DEF("asserta", 2, asserta2, META)
+  PRED_DEF("assertz_list", 1, assertz_list, META)
+  PRED_DEF("asserta_list", 1, asserta_list, META)
   PRED_DEF("redefine_system_predicate", 1, redefine_system_predicate, META)
   PRED_DEF("compile_predicates",  1, compile_predicates, META)
   PRED_DEF("$predefine_foreign",  1, predefine_foreign, PL_FA_TRANSPARENT)
@@ -0,0 +1,548 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "pl-incl.h"
+#include "os/pl-ctype.h"
+
+#undef LD
+#define LD LOCAL_LD
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Native support for library(csv).  '$csv_read_row'/3 reads a single CSV
+record from a stream and '$csv_write_row'/3 writes one. Both take the
+compiled options of library(csv), i.e., the csv_options/N record.  We
+access this record by argument position, so the CSV_OPT_* constants
+below must be kept consistent with the record declaration in csv.pl.
+
+The reader is a simple state machine over Sgetcode().  Field text is
+collected in a tmp_buffer that holds ISO Latin-1 text until we find a
+code point above 0xff, after which it is promoted to pl_wchar_t.  As the
+buffer is reused for all fields, reading a row only requires memory for
+the longest field and the resulting row term.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define CSV_OPT_SEPARATOR	1
+#define CSV_OPT_STRIP		2
+#define CSV_OPT_IGNORE_QUOTES	3
+#define CSV_OPT_CONVERT		4
+#define CSV_OPT_CASE		5
+#define CSV_OPT_FUNCTOR		6
+#define CSV_OPT_STRINGS		10
+
+#define CSV_CASE_PRESERVE	0
+#define CSV_CASE_DOWN		1
+#define CSV_CASE_UP		2
+
+#define CSV_SEPARATOR		0	/* field ended by the separator */
+#define CSV_END_OF_RECORD	1	/* field ended by newline or EOF */
+#define CSV_ERROR		(-1)
+
+typedef struct csv_options
+{ int		separator;		/* field separator */
+  int		strip;			/* strip leading and trailing blanks */
+  int		ignore_quotes;		/* " is a normal character */
+  int		convert;		/* convert fields to numbers */
+  int		case_conv;		/* CSV_CASE_* */
+  int		strings;		/* create strings rather than atoms */
+  atom_t	functor;		/* functor for the row */
+} csv_options;
+
+typedef struct csv_field
+{ tmp_buffer	buffer;			/* text of the field */
+  size_t	length;			/* # code points in buffer */
+  int		wide;			/* buffer holds pl_wchar_t */
+} csv_field;
+
+
+static int
+get_csv_options(term_t record, csv_options *opts ARG_LD)
+{ atom_t name, a;
+  size_t arity;
+  term_t arg = PL_new_term_ref();
+
+  if ( !PL_get_name_arity(record, &name, &arity) ||
+       name != ATOM_csv_options || arity < CSV_OPT_STRINGS )
+    return PL_type_error("csv_options", record);
+
+  _PL_get_arg(CSV_OPT_SEPARATOR, record, arg);
+  if ( !PL_get_char_ex(arg, &opts->separator, FALSE) )
+    return FALSE;
+  _PL_get_arg(CSV_OPT_STRIP, record, arg);
+  if ( !PL_get_bool_ex(arg, &opts->strip) )
+    return FALSE;
+  _PL_get_arg(CSV_OPT_IGNORE_QUOTES, record, arg);
+  if ( !PL_get_bool_ex(arg, &opts->ignore_quotes) )
+    return FALSE;
+  _PL_get_arg(CSV_OPT_CONVERT, record, arg);
+  if ( !PL_get_bool_ex(arg, &opts->convert) )
+    return FALSE;
+  _PL_get_arg(CSV_OPT_STRINGS, record, arg);
+  if ( !PL_get_bool_ex(arg, &opts->strings) )
+    return FALSE;
+
+  _PL_get_arg(CSV_OPT_CASE, record, arg);
+  if ( !PL_get_atom_ex(arg, &a) )
+    return FALSE;
+  if ( a == ATOM_preserve )
+    opts->case_conv = CSV_CASE_PRESERVE;
+  else if ( a == ATOM_down )
+    opts->case_conv = CSV_CASE_DOWN;
+  else if ( a == ATOM_up )
+    opts->case_conv = CSV_CASE_UP;
+  else
+    return PL_domain_error("case", arg);
+
+  _PL_get_arg(CSV_OPT_FUNCTOR, record, arg);
+  if ( !PL_get_atom_ex(arg, &opts->functor) )
+    return FALSE;
+
+  return TRUE;
+}
+
+
+		 /*******************************
+		 *	      FIELDS		*
+		 *******************************/
+
+static void
+init_field(csv_field *f)
+{ initBuffer(&f->buffer);
+  f->length = 0;
+  f->wide = FALSE;
+}
+
+
+static void
+empty_field(csv_field *f)
+{ emptyBuffer(&f->buffer);
+  f->length = 0;
+  f->wide = FALSE;
+}
+
+
+/* Convert the buffer from ISO Latin-1 to pl_wchar_t in place.  We
+   copy from the end as the wide text is larger than the original.
+*/
+
+static void
+promote_field(csv_field *f)
+{ size_t i;
+  const unsigned char *s;
+  pl_wchar_t *w;
+
+  if ( !allocFromBuffer(&f->buffer, f->length*(sizeof(pl_wchar_t)-1)) )
+    outOfCore();
+  s = baseBuffer(&f->buffer, unsigned char);
+  w = baseBuffer(&f->buffer, pl_wchar_t);
+  for(i=f->length; i-- > 0; )
+    w[i] = s[i];
+  f->wide = TRUE;
+}
+
+
+static inline void
+add_code(csv_field *f, int c)
+{ if ( !f->wide )
+  { if ( c <= 0xff )
+    { addBuffer(&f->buffer, (char)c, char);
+      f->length++;
+      return;
+    }
+    promote_field(f);
+  }
+  addBuffer(&f->buffer, (pl_wchar_t)c, pl_wchar_t);
+  f->length++;
+}
+
+
+static void
+truncate_field(csv_field *f, size_t len)
+{ f->length = len;
+  if ( f->wide )
+    seekBuffer(&f->buffer, len, pl_wchar_t);
+  else
+    seekBuffer(&f->buffer, len, char);
+}
+
+
+static void
+case_field(csv_field *f, int down)
+{ size_t i = 0;
+
+  if ( !f->wide )
+  { unsigned char *s = baseBuffer(&f->buffer, unsigned char);
+
+    for(; i<f->length; i++)
+    { wint_t c = down ? towlower(s[i]) : towupper(s[i]);
+
+      if ( c > 0xff )
+      { promote_field(f);
+	break;
+      }
+      s[i] = (unsigned char)c;
+    }
+  }
+
+  if ( f->wide )
+  { pl_wchar_t *w = baseBuffer(&f->buffer, pl_wchar_t);
+
+    for(; i<f->length; i++)
+      w[i] = down ? towlower(w[i]) : towupper(w[i]);
+  }
+}
+
+
+/* Try to convert the field into a number using the same rules as
+   name/2.
+*/
+
+static int
+field_number(csv_field *f, term_t t ARG_LD)
+{ unsigned char *s, *q;
+  number n;
+  strnumstat rc;
+  int found = FALSE;
+  AR_CTX;
+
+  addBuffer(&f->buffer, EOS, char);
+  s = baseBuffer(&f->buffer, unsigned char);
+  AR_BEGIN();
+  if ( (rc=str_number(s, &q, &n, FALSE)) == NUM_OK )
+  { if ( q == s+f->length )
+      found = TRUE;
+    else
+      clearNumber(&n);
+  }
+  AR_END();
+  seekBuffer(&f->buffer, f->length, char);
+
+  if ( found )
+  { int rc2 = PL_unify_number(t, &n);
+
+    clearNumber(&n);
+    return rc2;
+  }
+
+  return -1;
+}
+
+
+static int
+field_value(csv_field *f, term_t t, const csv_options *opts ARG_LD)
+{ PL_chars_t text;
+
+  if ( opts->convert && !f->wide && f->length > 0 )
+  { int rc = field_number(f, t PASS_LD);
+
+    if ( rc >= 0 )
+      return rc;
+  }
+
+  if ( opts->case_conv != CSV_CASE_PRESERVE )
+    case_field(f, opts->case_conv == CSV_CASE_DOWN);
+
+  text.text.t    = baseBuffer(&f->buffer, char);
+  text.length    = f->length;
+  text.encoding  = f->wide ? ENC_WCHAR : ENC_ISO_LATIN_1;
+  text.storage   = PL_CHARS_HEAP;
+  text.canonical = !f->wide;
+
+  return PL_unify_text(t, 0, &text, opts->strings ? PL_STRING : PL_ATOM);
+}
+
+
+		 /*******************************
+		 *	       READING		*
+		 *******************************/
+
+static int
+end_of_field(IOSTREAM *in, int c, const csv_options *opts)
+{ if ( c == opts->separator )
+    return CSV_SEPARATOR;
+
+  switch(c)
+  { case '\r':
+      if ( Speekcode(in) == '\n' )
+	(void)Sgetcode(in);
+      /*FALLTHROUGH*/
+    case '\n':
+      return CSV_END_OF_RECORD;
+    case -1:
+      if ( Sferror(in) )
+	return CSV_ERROR;
+      return CSV_END_OF_RECORD;
+    default:
+      PL_syntax_error("csv_separator_expected", in);
+      return CSV_ERROR;
+  }
+}
+
+
+static inline int
+is_csv_blank(int c)
+{ return c == ' ' || c == '\t';
+}
+
+
+/* Read a field into f.  Returns CSV_SEPARATOR, CSV_END_OF_RECORD or
+   CSV_ERROR.  In the latter case an exception may be pending, or the
+   stream is in error state.
+*/
+
+static int
+read_field(IOSTREAM *in, csv_field *f, const csv_options *opts)
+{ int c = Sgetcode(in);
+
+  empty_field(f);
+  if ( opts->strip )
+  { while( is_csv_blank(c) )
+      c = Sgetcode(in);
+  }
+
+  if ( c == '"' && !opts->ignore_quotes )
+  { for(;;)
+    { c = Sgetcode(in);
+
+      if ( c == '"' )
+      { if ( (c=Sgetcode(in)) != '"' )
+	  break;
+      } else if ( c == -1 )
+      { if ( !Sferror(in) )
+	  PL_syntax_error("end_of_file_in_csv_field", in);
+	return CSV_ERROR;
+      }
+      add_code(f, c);
+    }
+
+    if ( opts->strip )
+    { while( is_csv_blank(c) )
+	c = Sgetcode(in);
+    }
+  } else
+  { size_t keep = 0;
+
+    while( c != opts->separator && c != '\n' && c != '\r' && c != -1 )
+    { add_code(f, c);
+      if ( !is_csv_blank(c) )
+	keep = f->length;
+      c = Sgetcode(in);
+    }
+
+    if ( opts->strip )
+      truncate_field(f, keep);
+  }
+
+  return end_of_field(in, c, opts);
+}
+
+
+static int
+read_row(IOSTREAM *in, term_t row, const csv_options *opts ARG_LD)
+{ term_t list = PL_new_term_ref();
+  term_t tail = PL_copy_term_ref(list);
+  term_t head = PL_new_term_ref();
+  term_t argv;
+  csv_field field;
+  size_t i, arity = 0;
+  int rc;
+
+  init_field(&field);
+  do
+  { if ( (rc=read_field(in, &field, opts)) == CSV_ERROR ||
+	 !PL_unify_list(tail, head, tail) ||
+	 !field_value(&field, head, opts PASS_LD) )
+    { discardBuffer(&field.buffer);
+      return FALSE;
+    }
+    arity++;
+  } while(rc == CSV_SEPARATOR);
+  discardBuffer(&field.buffer);
+
+  if ( !PL_unify_nil(tail) ||
+       !(argv = PL_new_term_refs(arity)) )
+    return FALSE;
+  for(i=0; i<arity; i++)
+    PL_get_list(list, argv+i, list);
+
+  return ( PL_cons_functor_v(head, PL_new_functor(opts->functor, arity),
+			     argv) &&
+	   PL_unify(row, head) );
+}
+
+
+/** '$csv_read_row'(+Stream, -Row, +Options)
+ *
+ * Read the next record from Stream.  Options is the compiled options
+ * record of library(csv).  Row is unified with `end_of_file` if the
+ * end of the input is reached.
+ */
+
+static
+PRED_IMPL("$csv_read_row", 3, csv_read_row, 0)
+{ PRED_LD
+  csv_options opts;
+  IOSTREAM *in;
+  int rc;
+
+  if ( !get_csv_options(A3, &opts PASS_LD) ||
+       !getTextInputStream(A1, &in) )
+    return FALSE;
+
+  if ( Speekcode(in) == -1 )
+  { if ( Sferror(in) )
+      return streamStatus(in);
+    rc = PL_unify_atom(A2, ATOM_end_of_file);
+  } else
+  { rc = read_row(in, A2, &opts PASS_LD);
+  }
+
+  if ( Sferror(in) )
+    return streamStatus(in);
+  PL_release_stream(in);
+
+  return rc;
+}
+
+
+		 /*******************************
+		 *	       WRITING		*
+		 *******************************/
+
+static int
+needs_quotes(const PL_chars_t *text, const csv_options *opts)
+{ size_t i;
+
+  for(i=0; i<text->length; i++)
+  { int c = ( text->encoding == ENC_ISO_LATIN_1
+		? text->text.t[i]&0xff
+		: text->text.w[i] );
+
+    if ( c == '"' || c == '\n' || c == '\r' || c == opts->separator )
+      return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+static int
+write_field(IOSTREAM *out, term_t t, const csv_options *opts ARG_LD)
+{ PL_chars_t text;
+  int quote;
+  size_t i;
+
+  if ( PL_get_text(t, &text, CVT_ATOM|CVT_STRING) )
+    quote = needs_quotes(&text, opts);
+  else if ( PL_get_nil(t) )
+    return Sfputs("[]", out) < 0 ? FALSE : TRUE;
+  else if ( PL_get_text(t, &text, CVT_NUMBER) )
+    quote = FALSE;
+  else
+    return PL_type_error("atomic", t);
+
+  if ( quote && Sputcode('"', out) < 0 )
+    return FALSE;
+  for(i=0; i<text.length; i++)
+  { int c = ( text.encoding == ENC_ISO_LATIN_1
+		? text.text.t[i]&0xff
+		: text.text.w[i] );
+
+    if ( c == '"' && Sputcode(c, out) < 0 )
+      return FALSE;
+    if ( Sputcode(c, out) < 0 )
+      return FALSE;
+  }
+  if ( quote && Sputcode('"', out) < 0 )
+    return FALSE;
+
+  return TRUE;
+}
+
+
+static int
+write_row(IOSTREAM *out, term_t row, const csv_options *opts ARG_LD)
+{ term_t arg = PL_new_term_ref();
+  size_t i, arity;
+  atom_t name;
+
+  if ( !PL_get_name_arity(row, &name, &arity) )
+    return PL_type_error("callable", row);
+
+  for(i=1; i<=arity; i++)
+  { _PL_get_arg(i, row, arg);
+    if ( i > 1 && Sputcode(opts->separator, out) < 0 )
+      return FALSE;
+    if ( !write_field(out, arg, opts PASS_LD) )
+      return FALSE;
+  }
+
+  return ( Sputcode('\r', out) >= 0 &&	/* RFC 4180 demands \r\n */
+	   Sputcode('\n', out) >= 0 );
+}
+
+
+/** '$csv_write_row'(+Stream, +Row, +Options)
+ *
+ * Write Row as a CSV record to Stream.
+ */
+
+static
+PRED_IMPL("$csv_write_row", 3, csv_write_row, 0)
+{ PRED_LD
+  csv_options opts;
+  IOSTREAM *out;
+  int rc;
+
+  if ( !get_csv_options(A3, &opts PASS_LD) ||
+       !getTextOutputStream(A1, &out) )
+    return FALSE;
+
+  rc = write_row(out, A2, &opts PASS_LD);
+
+  if ( Sferror(out) )
+    return streamStatus(out);
+  PL_release_stream(out);
+
+  return rc;
+}
+
+
+		 /*******************************
+		 *      PUBLISH PREDICATES	*
+		 *******************************/
+
+BeginPredDefs(csv)
+  PRED_DEF("$csv_read_row",  3, csv_read_row,  0)
+  PRED_DEF("$csv_write_row", 3, csv_write_row, 0)
+EndPredDefs
@@ -0,0 +1,1350 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "pl-incl.h"
+#include "pl-hash.h"
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+#ifndef MAP_FAILED
+#define MAP_FAILED ((void *)-1)
+#endif
+
+#undef LD
+#define LD LOCAL_LD
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A disk database holds the facts of a single predicate in a file that is
+mapped into memory.  Pages are loaded by the OS when they are accessed,
+so the size of the database is not limited by the available memory and
+opening a cleanly closed database does not read it.  The database
+consists of two files:
+
+  - The _data_ file <File> holds a header followed by the facts.  Each
+    fact is an _entry_ of four 64-bit words followed by the fact in the
+    fast_write/2 record format, padded to 8 bytes:
+
+	length	length of the record
+	key	hash of the first argument or 0 if it is unbound
+	next	offset of the next entry with the same key or 0
+	flags	DDB_ERASED if the fact was retracted
+
+  - The _index_ file <File>.idx is an open hash table that maps a key
+    to the first and last entry of its chain.  Facts whose first
+    argument is unbound form a separate chain whose head and tail are
+    in the index header.  The header also holds the committed end of
+    the data.
+
+All numbers are in native byte order.  Keys are computed from the text
+of atoms, strings and numbers and the name and arity of compounds, so
+they do not depend on the process.
+
+Adding a fact appends the entry to the data file using write(), links
+it from the tail of its chain and finally advances the committed end.
+Readers take a snapshot of the committed end and ignore entries beyond
+it, which allows them to run without locks.  A retracted fact is only
+flagged; it disappears from running enumerations and its space is not
+reused.
+
+The index header holds a `clean` flag that is cleared while the
+database is open.  If a database is opened that was not closed cleanly,
+the index is rebuilt by scanning the data file, which is truncated after
+the last valid entry.  When the index fills up it is rebuilt into a new
+file that replaces the old one.  Old mappings are kept until the database
+is closed because concurrent readers may still use them.
+
+The data file is locked using fcntl(), so a database can only be opened
+by one process at a time.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#ifdef HAVE_MMAP
+
+#define DDB_MAGIC		"SWIPLDD1"
+#define DDB_INDEX_MAGIC		"SWIPLDI1"
+#define DDB_BYTE_ORDER		((uint64_t)0x0102030405060708)
+#define DDB_ERASED		0x1
+
+					/* data header (words) */
+#define DH_MAGIC		0
+#define DH_BYTE_ORDER		1
+#define DH_ARITY		2
+#define DH_NAME_LENGTH		3
+#define DH_SIZE			4
+
+					/* entry (words) */
+#define E_LENGTH		0
+#define E_KEY			1
+#define E_NEXT			2
+#define E_FLAGS			3
+#define E_SIZE			4
+
+					/* index header (words) */
+#define IH_MAGIC		0
+#define IH_BYTE_ORDER		1
+#define IH_SLOTS		2
+#define IH_USED			3
+#define IH_COUNT		4
+#define IH_DATA_END		5
+#define IH_VAR_HEAD		6
+#define IH_VAR_TAIL		7
+#define IH_CLEAN		8
+#define IH_SIZE			16
+
+					/* index slot (words) */
+#define S_KEY			0
+#define S_HEAD			1
+#define S_TAIL			2
+#define S_SIZE			3
+
+#define DDB_INITIAL_SLOTS	4096
+#define DDB_MIN_MAP		((size_t)1<<20)
+
+#define ALIGN8(n)		(((n)+7)&~(uint64_t)7)
+#define ENTRY_SIZE(len)		(E_SIZE*8+ALIGN8(len))
+
+typedef struct ddb_map
+{ char	       *base;			/* start of the mapping */
+  size_t	size;			/* size of the mapping */
+  struct ddb_map *next;			/* next retired mapping */
+} ddb_map;
+
+typedef struct disk_db
+{ atom_t	symbol;			/* <disk_db>(%p) */
+  int		closed;			/* '$disk_db_close'/1 called */
+  int		references;		/* # active users */
+  int		unclean;		/* never mark the index clean */
+  functor_t	functor;		/* predicate stored */
+  char	       *path;			/* data file */
+  int		fd;			/* data file descriptor */
+  int		ifd;			/* index file descriptor */
+  char	       *data;			/* mapped data file */
+  size_t	data_map_size;		/* size of the data mapping */
+  uint64_t	data_start;		/* offset of the first entry */
+  uint64_t     *index;			/* mapped index file */
+  size_t	index_size;		/* size of the index file */
+  ddb_map      *retired;		/* mappings that may still be used */
+#ifdef O_PLMT
+  simpleMutex	lock;			/* serialize writers */
+#endif
+} disk_db;
+
+#ifdef O_PLMT
+#define LOCK_DDB(f)	simpleMutexLock(&(f)->lock)
+#define UNLOCK_DDB(f)	simpleMutexUnlock(&(f)->lock)
+#else
+#define LOCK_DDB(f)	(void)0
+#define UNLOCK_DDB(f)	(void)0
+#endif
+
+#define ENTRY(base, off)	((uint64_t*)((base)+(off)))
+#define SLOT(index, i)		(&(index)[IH_SIZE+(i)*S_SIZE])
+
+static void	free_disk_db(disk_db *f);
+
+
+static int
+ddb_corrupt(const char *msg)
+{ return PL_syntax_error(msg, NULL);
+}
+
+
+		 /*******************************
+		 *	       BLOB		*
+		 *******************************/
+
+static int
+write_disk_db(IOSTREAM *s, atom_t aref, int flags)
+{ disk_db *f = PL_blob_data(aref, NULL, NULL);
+  (void)flags;
+
+  Sfprintf(s, "<disk_db>(%p)", f);
+  return TRUE;
+}
+
+
+static void
+acquire_disk_db(atom_t aref)
+{ disk_db *f = PL_blob_data(aref, NULL, NULL);
+
+  f->symbol = aref;
+}
+
+
+static int
+release_disk_db(atom_t aref)
+{ disk_db *f = PL_blob_data(aref, NULL, NULL);
+
+  free_disk_db(f);
+#ifdef O_PLMT
+  simpleMutexDelete(&f->lock);
+#endif
+  free(f);
+
+  return TRUE;
+}
+
+
+static int
+save_disk_db(atom_t aref, IOSTREAM *fd)
+{ disk_db *f = PL_blob_data(aref, NULL, NULL);
+  (void)fd;
+
+  return PL_warning("Cannot save reference to <disk_db>(%p)", f);
+}
+
+
+static atom_t
+load_disk_db(IOSTREAM *fd)
+{ (void)fd;
+
+  return PL_new_atom("<disk_db>");
+}
+
+
+static PL_blob_t disk_db_blob =
+{ PL_BLOB_MAGIC,
+  PL_BLOB_NOCOPY,
+  "disk_db",
+  release_disk_db,
+  NULL,
+  write_disk_db,
+  acquire_disk_db,
+  save_disk_db,
+  load_disk_db
+};
+
+
+static int
+get_disk_db(term_t t, disk_db **fp)
+{ void *p;
+  PL_blob_t *type;
+
+  if ( PL_get_blob(t, &p, NULL, &type) && type == &disk_db_blob )
+  { *fp = p;
+    return TRUE;
+  }
+
+  PL_type_error("disk_db", t);
+  return FALSE;
+}
+
+
+static void
+release_handle(disk_db *f)
+{ if ( ATOMIC_DEC(&f->references) == 0 )
+    free_disk_db(f);
+}
+
+
+/* Get the handle and register us as a user.  Must be followed by
+   release_handle().
+*/
+
+static int
+acquire_handle(term_t t, disk_db **fp)
+{ disk_db *f;
+
+  if ( !get_disk_db(t, &f) )
+    return FALSE;
+
+  for(;;)
+  { int refs = f->references;
+
+    if ( refs == 0 )			/* freed; do not revive */
+      return PL_existence_error("disk_db", t);
+    if ( COMPARE_AND_SWAP(&f->references, refs, refs+1) )
+      break;
+  }
+  if ( f->closed )
+  { release_handle(f);
+    return PL_existence_error("disk_db", t);
+  }
+
+  *fp = f;
+  return TRUE;
+}
+
+
+		 /*******************************
+		 *	       KEYS		*
+		 *******************************/
+
+static uint64_t
+hash_bytes(const void *data, size_t len, unsigned int tag)
+{ uint64_t h1 = MurmurHashAligned2(data, len, MURMUR_SEED^tag);
+  uint64_t h2 = MurmurHashAligned2(data, len, ~MURMUR_SEED^tag);
+
+  return (h1<<32)|h2;
+}
+
+
+/* Compute the key for the first argument of fact.  Returns 0 if the
+   argument is unbound and (uint64_t)-1 if the argument cannot be
+   stored, which implies it cannot match.
+*/
+
+static uint64_t
+first_arg_key(term_t fact ARG_LD)
+{ term_t a;
+  size_t arity, len;
+  atom_t name;
+  char *s;
+  double f;
+  uint64_t key;
+
+  if ( !PL_get_name_arity(fact, NULL, &arity) || arity == 0 )
+    return 0;
+  a = PL_new_term_ref();
+  _PL_get_arg(1, fact, a);
+
+  switch(PL_term_type(a))
+  { case PL_VARIABLE:
+      return 0;
+    case PL_NIL:
+      key = hash_bytes("[]", 2, 'n');
+      break;
+    case PL_ATOM:
+      if ( !PL_get_nchars(a, &len, &s, CVT_ATOM|REP_UTF8|BUF_DISCARDABLE) )
+	return (uint64_t)-1;
+      key = hash_bytes(s, len, 'a');
+      break;
+    case PL_STRING:
+      if ( !PL_get_nchars(a, &len, &s, CVT_STRING|REP_UTF8|BUF_DISCARDABLE) )
+	return (uint64_t)-1;
+      key = hash_bytes(s, len, 's');
+      break;
+    case PL_INTEGER:
+      if ( !PL_get_nchars(a, &len, &s, CVT_INTEGER|BUF_DISCARDABLE) )
+	return (uint64_t)-1;
+      key = hash_bytes(s, len, 'i');
+      break;
+    case PL_FLOAT:
+      if ( !PL_get_float(a, &f) )
+	return (uint64_t)-1;
+      key = hash_bytes(&f, sizeof(f), 'f');
+      break;
+    case PL_TERM:
+    case PL_LIST_PAIR:
+    case PL_DICT:
+      if ( !PL_get_name_arity(a, &name, &arity) ||
+	   !PL_put_atom(a, name) ||
+	   !PL_get_nchars(a, &len, &s, CVT_ATOM|REP_UTF8|BUF_DISCARDABLE) )
+	return (uint64_t)-1;
+      key = hash_bytes(s, len, 'c') ^ (uint64_t)arity;
+      break;
+    default:
+      return (uint64_t)-1;
+  }
+
+  if ( key == 0 || key == (uint64_t)-1 )
+    key = 1;
+
+  return key;
+}
+
+
+		 /*******************************
+		 *	      MAPPING		*
+		 *******************************/
+
+/* Keep a replaced mapping until the handle is freed because readers
+   may still use it.  If there is no memory to record it, the mapping
+   is leaked.
+*/
+
+static void
+retire_map(disk_db *f, void *base, size_t size)
+{ ddb_map *m;
+
+  if ( (m = malloc(sizeof(*m))) )
+  { m->base = base;
+    m->size = size;
+    m->next = f->retired;
+    f->retired = m;
+  }
+}
+
+
+/* Make sure the data mapping covers at least `need` bytes.  The mapping
+   is larger than the file, which allows appending without remapping.
+*/
+
+static int
+map_data(disk_db *f, uint64_t need)
+{ size_t size = f->data_map_size ? f->data_map_size : DDB_MIN_MAP;
+  char *base;
+
+  if ( f->data && need <= f->data_map_size )
+    return TRUE;
+
+  while( size < need )
+    size *= 2;
+  base = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, f->fd, 0);
+  if ( base == MAP_FAILED )
+    return FALSE;
+
+  if ( f->data )
+    retire_map(f, f->data, f->data_map_size);
+  MemoryBarrier();
+  f->data_map_size = size;
+  f->data = base;
+
+  return TRUE;
+}
+
+
+static char *
+index_path(const char *path, const char *ext)
+{ size_t len = strlen(path);
+  char *s;
+
+  if ( (s = malloc(len+strlen(ext)+1)) )
+  { memcpy(s, path, len);
+    strcpy(s+len, ext);
+  }
+
+  return s;
+}
+
+
+/* Create a new empty index with nslots slots in file path and map it.
+   Returns the mapping or NULL, leaving errno.
+*/
+
+static uint64_t *
+create_index(const char *path, uint64_t nslots, int *fdp, size_t *sizep)
+{ size_t size = (IH_SIZE+nslots*S_SIZE)*8;
+  uint64_t *index;
+  int fd;
+
+  if ( (fd=open(path, O_RDWR|O_CREAT|O_TRUNC|O_BINARY, 0666)) < 0 )
+    return NULL;
+  if ( ftruncate(fd, size) != 0 ||
+       (index = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0))
+	 == MAP_FAILED )
+  { int eno = errno;
+
+    close(fd);
+    errno = eno;
+    return NULL;
+  }
+
+  memcpy(&index[IH_MAGIC], DDB_INDEX_MAGIC, 8);
+  index[IH_BYTE_ORDER] = DDB_BYTE_ORDER;
+  index[IH_SLOTS] = nslots;
+  *fdp = fd;
+  *sizep = size;
+
+  return index;
+}
+
+
+static uint64_t *
+lookup_slot(uint64_t *index, uint64_t key)
+{ uint64_t mask = index[IH_SLOTS]-1;
+  uint64_t i;
+
+  for(i=key&mask;; i=(i+1)&mask)
+  { uint64_t *slot = SLOT(index, i);
+
+    if ( slot[S_KEY] == key || slot[S_KEY] == 0 )
+      return slot;
+  }
+}
+
+
+/* Replace the index by one with nslots slots.  Must be called with the
+   lock held.
+*/
+
+static int
+resize_index(disk_db *f, uint64_t nslots)
+{ char *tmp = index_path(f->path, ".idx.tmp");
+  char *idx = index_path(f->path, ".idx");
+  uint64_t *old = f->index;
+  uint64_t *new;
+  uint64_t i, n = old[IH_SLOTS];
+  size_t size;
+  int fd, rc = FALSE;
+
+  if ( !tmp || !idx )
+  { errno = ENOMEM;
+    goto out;
+  }
+  if ( !(new = create_index(tmp, nslots, &fd, &size)) )
+    goto out;
+
+  for(i=0; i<n; i++)
+  { uint64_t *from = SLOT(old, i);
+
+    if ( from[S_KEY] )
+    { uint64_t *to = lookup_slot(new, from[S_KEY]);
+
+      to[S_KEY]  = from[S_KEY];
+      to[S_HEAD] = from[S_HEAD];
+      to[S_TAIL] = from[S_TAIL];
+    }
+  }
+  new[IH_USED]     = old[IH_USED];
+  new[IH_COUNT]    = old[IH_COUNT];
+  new[IH_DATA_END] = old[IH_DATA_END];
+  new[IH_VAR_HEAD] = old[IH_VAR_HEAD];
+  new[IH_VAR_TAIL] = old[IH_VAR_TAIL];
+  new[IH_CLEAN]    = 0;
+
+  if ( rename(tmp, idx) != 0 )
+  { int eno = errno;
+
+    munmap(new, size);
+    close(fd);
+    unlink(tmp);
+    errno = eno;
+    goto out;
+  }
+
+  retire_map(f, old, f->index_size);
+  close(f->ifd);
+  MemoryBarrier();
+  f->ifd = fd;
+  f->index_size = size;
+  f->index = new;
+  rc = TRUE;
+
+out:
+  free(tmp);
+  free(idx);
+  return rc;
+}
+
+
+		 /*******************************
+		 *	   OPEN/REBUILD		*
+		 *******************************/
+
+static int
+lock_file(int fd)
+{
+#ifdef FCNTL_LOCKS
+  struct flock buf;
+
+  memset(&buf, 0, sizeof(buf));
+  buf.l_whence = SEEK_SET;
+  buf.l_type   = F_WRLCK;
+
+  return fcntl(fd, F_SETLK, &buf) == 0;
+#else
+  (void)fd;
+  return TRUE;
+#endif
+}
+
+
+static int
+write_bytes(int fd, uint64_t offset, const char *buf, size_t len)
+{ if ( lseek(fd, (off_t)offset, SEEK_SET) == (off_t)-1 )
+    return FALSE;
+
+  while( len > 0 )
+  { ssize_t n = write(fd, buf, len);
+
+    if ( n < 0 )
+    { if ( errno == EINTR )
+	continue;
+      return FALSE;
+    }
+    buf += n;
+    len -= n;
+  }
+
+  return TRUE;
+}
+
+
+/* Create the header of a new data file */
+
+static int
+init_data(disk_db *f)
+{ atom_t name = nameFunctor(f->functor);
+  PL_chars_t txt;
+  uint64_t hdr[DH_SIZE];
+  tmp_buffer b;
+  int rc;
+
+  if ( !get_atom_text(name, &txt) ||
+       !PL_mb_text(&txt, REP_UTF8) )
+    return FALSE;
+
+  initBuffer(&b);
+  memcpy(&hdr[DH_MAGIC], DDB_MAGIC, 8);
+  hdr[DH_BYTE_ORDER]  = DDB_BYTE_ORDER;
+  hdr[DH_ARITY]	      = arityFunctor(f->functor);
+  hdr[DH_NAME_LENGTH] = txt.length;
+  addMultipleBuffer(&b, hdr, sizeof(hdr), char);
+  addMultipleBuffer(&b, txt.text.t, txt.length, char);
+  while( sizeOfBuffer(&b)%8 )
+    addBuffer(&b, 0, char);
+  PL_free_text(&txt);
+
+  f->data_start = sizeOfBuffer(&b);
+  rc = write_bytes(f->fd, 0, baseBuffer(&b, char), sizeOfBuffer(&b));
+  discardBuffer(&b);
+
+  return rc;
+}
+
+
+/* Check the header of an existing data file */
+
+static int
+check_data(disk_db *f, uint64_t size, term_t file)
+{ uint64_t *hdr = (uint64_t*)f->data;
+  atom_t name;
+
+  if ( size < DH_SIZE*8 ||
+       memcmp(&hdr[DH_MAGIC], DDB_MAGIC, 8) != 0 ||
+       hdr[DH_BYTE_ORDER] != DDB_BYTE_ORDER ||
+       hdr[DH_NAME_LENGTH] > size - DH_SIZE*8 )
+    return ddb_corrupt("disk_db_header");
+
+  f->data_start = DH_SIZE*8 + ALIGN8(hdr[DH_NAME_LENGTH]);
+  if ( f->data_start > size )
+    return ddb_corrupt("disk_db_header");
+  if ( !(name = PL_new_atom_mbchars(REP_UTF8, (size_t)hdr[DH_NAME_LENGTH],
+				    f->data+DH_SIZE*8)) )
+    return FALSE;
+  PL_unregister_atom(name);
+  if ( name != nameFunctor(f->functor) ||
+       hdr[DH_ARITY] != arityFunctor(f->functor) )
+    return PL_permission_error("open", "disk_db", file);
+
+  return TRUE;
+}
+
+
+/* Return the size of the valid entry at off or 0 */
+
+static uint64_t
+valid_entry(disk_db *f, uint64_t off, uint64_t end)
+{ uint64_t *e = ENTRY(f->data, off);
+  uint64_t len, size;
+
+  if ( end - off < E_SIZE*8 )
+    return 0;
+  len = e[E_LENGTH];
+  if ( len == 0 || len > end - off - E_SIZE*8 ||
+       (e[E_FLAGS] & ~(uint64_t)DDB_ERASED) ||
+       !is_external((char*)&e[E_SIZE], (size_t)len) )
+    return 0;
+  size = ENTRY_SIZE(len);
+
+  return size <= end - off ? size : 0;
+}
+
+
+static int
+link_entry(disk_db *f, uint64_t off, uint64_t key)
+{ uint64_t *index = f->index;
+  uint64_t *head, *tail;
+
+  if ( key )
+  { uint64_t *slot = lookup_slot(index, key);
+
+    if ( !slot[S_KEY] )
+    { if ( (index[IH_USED]+1)*2 > index[IH_SLOTS] )
+      { if ( !resize_index(f, index[IH_SLOTS]*2) )
+	  return FALSE;
+	index = f->index;
+	slot = lookup_slot(index, key);
+      }
+      slot[S_KEY] = key;
+      index[IH_USED]++;
+    }
+    head = &slot[S_HEAD];
+    tail = &slot[S_TAIL];
+  } else
+  { head = &index[IH_VAR_HEAD];
+    tail = &index[IH_VAR_TAIL];
+  }
+
+  if ( *tail )
+    ENTRY(f->data, *tail)[E_NEXT] = off;
+  else
+    *head = off;
+  *tail = off;
+
+  return TRUE;
+}
+
+
+/* Rebuild the index from the data file, truncating the file after the
+   last valid entry.
+*/
+
+static int
+rebuild_index(disk_db *f, uint64_t size)
+{ char *idx = index_path(f->path, ".idx");
+  uint64_t off;
+  int rc = FALSE;
+
+  if ( !idx )
+  { errno = ENOMEM;
+    return FALSE;
+  }
+  if ( f->index )
+  { munmap(f->index, f->index_size);
+    close(f->ifd);
+    f->index = NULL;
+  }
+  if ( !(f->index = create_index(idx, DDB_INITIAL_SLOTS,
+				 &f->ifd, &f->index_size)) )
+    goto out;
+
+  for(off=f->data_start; off<size; )
+  { uint64_t esize = valid_entry(f, off, size);
+    uint64_t *e;
+
+    if ( !esize )
+    { if ( ftruncate(f->fd, off) != 0 )
+	goto out;
+      break;
+    }
+    e = ENTRY(f->data, off);
+    e[E_NEXT] = 0;
+    if ( !(e[E_FLAGS]&DDB_ERASED) )
+    { if ( !link_entry(f, off, e[E_KEY]) )
+	goto out;
+      f->index[IH_COUNT]++;
+    }
+    off += esize;
+  }
+  f->index[IH_DATA_END] = off;
+  rc = TRUE;
+
+out:
+  free(idx);
+  return rc;
+}
+
+
+/* Open an existing index.  Returns FALSE if it does not exist or cannot
+   be used.
+*/
+
+static int
+open_index(disk_db *f, uint64_t size)
+{ char *idx = index_path(f->path, ".idx");
+  struct stat buf;
+  uint64_t *index;
+  int fd;
+
+  if ( !idx )
+    return FALSE;
+  fd = open(idx, O_RDWR|O_BINARY);
+  free(idx);
+  if ( fd < 0 )
+    return FALSE;
+  if ( fstat(fd, &buf) != 0 || buf.st_size < IH_SIZE*8 ||
+       (index = mmap(NULL, buf.st_size, PROT_READ|PROT_WRITE, MAP_SHARED,
+		     fd, 0)) == MAP_FAILED )
+  { close(fd);
+    return FALSE;
+  }
+
+  if ( memcmp(&index[IH_MAGIC], DDB_INDEX_MAGIC, 8) != 0 ||
+       index[IH_BYTE_ORDER] != DDB_BYTE_ORDER ||
+       index[IH_SLOTS] == 0 ||
+       (index[IH_SLOTS]&(index[IH_SLOTS]-1)) != 0 ||
+       (uint64_t)buf.st_size != (IH_SIZE+index[IH_SLOTS]*S_SIZE)*8 ||
+       index[IH_CLEAN] != 1 ||
+       index[IH_DATA_END] != size )
+  { munmap(index, buf.st_size);
+    close(fd);
+    return FALSE;
+  }
+
+  f->index = index;
+  f->index_size = buf.st_size;
+  f->ifd = fd;
+
+  return TRUE;
+}
+
+
+/* Open the database.  Returns FALSE with errno set on an I/O error and
+   -1 if an exception is raised.
+*/
+
+static int
+open_disk_db(disk_db *f, term_t file)
+{ struct stat buf;
+  uint64_t size;
+
+  if ( (f->fd=open(f->path, O_RDWR|O_CREAT|O_BINARY, 0666)) < 0 )
+    return FALSE;
+  if ( !lock_file(f->fd) )
+  { PL_permission_error("lock", "file", file);
+    return -1;
+  }
+  if ( fstat(f->fd, &buf) != 0 )
+    return FALSE;
+
+  if ( (size=buf.st_size) == 0 )
+  { if ( !init_data(f) )
+      return FALSE;
+    size = f->data_start;
+  }
+  if ( !map_data(f, size) )
+    return FALSE;
+  if ( !check_data(f, size, file) )
+    return -1;
+
+  if ( !open_index(f, size) && !rebuild_index(f, size) )
+    return FALSE;
+  f->index[IH_CLEAN] = 0;
+  if ( msync(f->index, IH_SIZE*8, MS_SYNC) != 0 )
+    return FALSE;
+
+  return TRUE;
+}
+
+
+static int
+sync_disk_db(disk_db *f)
+{ int rc = TRUE;
+
+  if ( f->fd >= 0 && fsync(f->fd) != 0 )
+    rc = FALSE;
+  if ( f->index && msync(f->index, f->index_size, MS_SYNC) != 0 )
+    rc = FALSE;
+
+  return rc;
+}
+
+
+/* Close the database, marking the index clean if it is consistent with
+   the data.  Must be safe to call twice: one time because the handle
+   was closed and one time due to atom-GC.
+*/
+
+static void
+free_disk_db(disk_db *f)
+{ ddb_map *m, *next;
+
+  if ( f->index )
+  { if ( sync_disk_db(f) && !f->unclean )
+    { f->index[IH_CLEAN] = 1;
+      msync(f->index, IH_SIZE*8, MS_SYNC);
+    }
+    munmap(f->index, f->index_size);
+    close(f->ifd);
+    f->index = NULL;
+  }
+  if ( f->data )
+  { munmap(f->data, f->data_map_size);
+    f->data = NULL;
+  }
+  for(m=f->retired; m; m=next)
+  { next = m->next;
+    munmap(m->base, m->size);
+    free(m);
+  }
+  f->retired = NULL;
+  if ( f->fd >= 0 )
+  { close(f->fd);			/* also releases the lock */
+    f->fd = -1;
+  }
+  if ( f->path )
+  { free(f->path);
+    f->path = NULL;
+  }
+}
+
+
+		 /*******************************
+		 *	  ADD AND ERASE		*
+		 *******************************/
+
+static int
+check_fact(disk_db *f, term_t fact)
+{ GET_LD
+  functor_t fd;
+
+  if ( !PL_get_functor(fact, &fd) )
+    return PL_type_error("callable", fact);
+  if ( fd != f->functor )
+    return PL_domain_error("disk_db_fact", fact);
+
+  return TRUE;
+}
+
+
+/* Append fact.  Returns FALSE with errno set on an I/O error and -1 if
+   an exception is raised.
+*/
+
+static int
+add_fact(disk_db *f, term_t fact ARG_LD)
+{ uint64_t key = first_arg_key(fact PASS_LD);
+  uint64_t hdr[E_SIZE];
+  uint64_t off, size;
+  static const char pad[8] = {0};
+  char *rec;
+  size_t len;
+  tmp_buffer b;
+  int rc = TRUE;
+
+  if ( !(rec = PL_record_external(fact, &len)) )
+    return -1;
+  if ( key == (uint64_t)-1 )		/* unstorable; cannot happen */
+    key = 1;
+
+  hdr[E_LENGTH] = len;
+  hdr[E_KEY]	= key;
+  hdr[E_NEXT]	= 0;
+  hdr[E_FLAGS]	= 0;
+  size = ENTRY_SIZE(len);
+  initBuffer(&b);
+  addMultipleBuffer(&b, hdr, sizeof(hdr), char);
+  addMultipleBuffer(&b, rec, len, char);
+  addMultipleBuffer(&b, pad, size-sizeof(hdr)-len, char);
+  PL_erase_external(rec);
+
+  LOCK_DDB(f);
+  off = f->index[IH_DATA_END];
+  if ( !write_bytes(f->fd, off, baseBuffer(&b, char), (size_t)size) )
+  { int eno = errno;
+
+    if ( ftruncate(f->fd, off) != 0 )
+      (void)0;				/* nothing we can do */
+    errno = eno;
+    rc = FALSE;
+  } else if ( !map_data(f, off+size) ||
+	      !link_entry(f, off, key) )
+  { rc = FALSE;
+  } else
+  { f->index[IH_COUNT]++;
+    MemoryBarrier();
+    f->index[IH_DATA_END] = off+size;
+  }
+  UNLOCK_DDB(f);
+  discardBuffer(&b);
+
+  return rc;
+}
+
+
+static int
+erase_fact(disk_db *f, uint64_t off)
+{ int rc = FALSE;
+
+  LOCK_DDB(f);
+  if ( off >= f->data_start && off < f->index[IH_DATA_END] && off%8 == 0 )
+  { uint64_t *e = ENTRY(f->data, off);
+
+    if ( !(e[E_FLAGS]&DDB_ERASED) )
+    { e[E_FLAGS] |= DDB_ERASED;
+      f->index[IH_COUNT]--;
+      rc = TRUE;
+    }
+  }
+  UNLOCK_DDB(f);
+
+  return rc;
+}
+
+
+		 /*******************************
+		 *	    ENUMERATION		*
+		 *******************************/
+
+typedef struct ddb_enum
+{ uint64_t	end;			/* snapshot of the committed end */
+  uint64_t	pos;			/* next entry (scan or key chain) */
+  uint64_t	vpos;			/* next entry on the var chain */
+  int		scan;			/* scan all entries */
+} ddb_enum;
+
+
+static uint64_t
+chain_next(disk_db *f, uint64_t off, uint64_t end)
+{ uint64_t next = ENTRY(f->data, off)[E_NEXT];
+
+  return next < end ? next : 0;
+}
+
+
+/* Return the offset of the next candidate or 0 if there are no more */
+
+static uint64_t
+next_candidate(disk_db *f, ddb_enum *e)
+{ for(;;)
+  { uint64_t off;
+
+    if ( e->scan )
+    { if ( e->pos >= e->end )
+	return 0;
+      off = e->pos;
+      e->pos += ENTRY_SIZE(ENTRY(f->data, off)[E_LENGTH]);
+    } else if ( e->pos && (!e->vpos || e->pos < e->vpos) )
+    { off = e->pos;
+      e->pos = chain_next(f, off, e->end);
+    } else if ( e->vpos )
+    { off = e->vpos;
+      e->vpos = chain_next(f, off, e->end);
+    } else
+    { return 0;
+    }
+
+    if ( !(ENTRY(f->data, off)[E_FLAGS]&DDB_ERASED) )
+      return off;
+  }
+}
+
+
+static int
+more_candidates(ddb_enum *e)
+{ return e->scan ? e->pos < e->end : (e->pos || e->vpos);
+}
+
+
+/* Initialise the enumeration.  Returns FALSE if no fact can match */
+
+static int
+init_enum(disk_db *f, term_t head, ddb_enum *e ARG_LD)
+{ uint64_t key = first_arg_key(head PASS_LD);
+  uint64_t *index = f->index;
+
+  if ( key == (uint64_t)-1 )
+    return FALSE;
+
+  memset(e, 0, sizeof(*e));
+  e->end = index[IH_DATA_END];
+  MemoryBarrier();
+  if ( key == 0 )
+  { e->scan = TRUE;
+    e->pos = f->data_start;
+  } else
+  { uint64_t *slot = lookup_slot(index, key);
+
+    if ( slot[S_KEY] && slot[S_HEAD] < e->end )
+      e->pos = slot[S_HEAD];
+    if ( index[IH_VAR_HEAD] < e->end )
+      e->vpos = index[IH_VAR_HEAD];
+  }
+
+  return TRUE;
+}
+
+
+		 /*******************************
+		 *	    PREDICATES		*
+		 *******************************/
+
+/** '$disk_db_open'(+File, +Name/Arity, -Handle)
+ *
+ * Open or create the disk database for Name/Arity in File.
+ */
+
+static
+PRED_IMPL("$disk_db_open", 3, disk_db_open, 0)
+{ char *path;
+  functor_t fd;
+  disk_db *f;
+  int rc;
+
+  if ( !PL_get_file_name(A1, &path, 0) ||
+       !get_functor(A2, &fd, NULL, 0, GF_PROCEDURE|GP_NOT_QUALIFIED) )
+    return FALSE;
+
+  if ( !(f = malloc(sizeof(*f))) )
+    return PL_no_memory();
+  memset(f, 0, sizeof(*f));
+  f->references = 1;
+  f->functor = fd;
+  f->fd = -1;
+  f->ifd = -1;
+#ifdef O_PLMT
+  simpleMutexInit(&f->lock);
+#endif
+
+  if ( !(f->path = strdup(path)) )
+  { PL_no_memory();
+    rc = -1;
+  } else
+    rc = open_disk_db(f, A1);
+
+  if ( rc == TRUE )
+    return PL_unify_blob(A3, f, sizeof(*f), &disk_db_blob);
+
+  if ( !rc )
+    PL_error(NULL, 0, MSG_ERRNO, ERR_FILE_OPERATION,
+	     ATOM_open, ATOM_file, A1);
+  f->unclean = TRUE;			/* do not mark a failed open clean */
+  free_disk_db(f);
+#ifdef O_PLMT
+  simpleMutexDelete(&f->lock);
+#endif
+  free(f);
+
+  return FALSE;
+}
+
+
+/** '$disk_db_close'(+Handle)
+ *
+ * Close the database.  The files are synced and the index is marked
+ * clean as soon as no thread uses the handle.
+ */
+
+static
+PRED_IMPL("$disk_db_close", 1, disk_db_close, 0)
+{ disk_db *f;
+
+  if ( !get_disk_db(A1, &f) )
+    return FALSE;
+
+  if ( COMPARE_AND_SWAP(&f->closed, FALSE, TRUE) )
+    release_handle(f);
+
+  return TRUE;
+}
+
+
+/** '$disk_db_assert'(+Handle, +Fact)
+ *
+ * Append Fact to the database.
+ */
+
+static
+PRED_IMPL("$disk_db_assert", 2, disk_db_assert, 0)
+{ PRED_LD
+  disk_db *f;
+  int rc;
+
+  if ( !acquire_handle(A1, &f) )
+    return FALSE;
+  if ( (rc=check_fact(f, A2)) )
+  { if ( (rc=add_fact(f, A2 PASS_LD)) == -1 )
+      rc = FALSE;
+    else if ( !rc )
+      rc = PL_error(NULL, 0, MSG_ERRNO, ERR_FILE_OPERATION,
+		    ATOM_write, ATOM_file, A1);
+  }
+  release_handle(f);
+
+  return rc;
+}
+
+
+/** '$disk_db_erase'(+Handle, +Ref)
+ *
+ * Erase the fact Ref as obtained from '$disk_db_clause'/3.  Fails if the
+ * fact was already erased.
+ */
+
+static
+PRED_IMPL("$disk_db_erase", 2, disk_db_erase, 0)
+{ disk_db *f;
+  int64_t off;
+  int rc;
+
+  if ( !PL_get_int64_ex(A2, &off) ||
+       !acquire_handle(A1, &f) )
+    return FALSE;
+  rc = erase_fact(f, (uint64_t)off);
+  release_handle(f);
+
+  return rc;
+}
+
+
+/** '$disk_db_clause'(+Handle, ?Head, -Ref)
+ *
+ * Enumerate the facts that unify with Head.  Ref is a reference for
+ * '$disk_db_erase'/2.  Facts added after the call started are not
+ * enumerated.
+ */
+
+static
+PRED_IMPL("$disk_db_clause", 3, disk_db_clause, PL_FA_NONDETERMINISTIC)
+{ PRED_LD
+  disk_db *f;
+  ddb_enum e0, *e;
+  uint64_t off;
+  term_t tmp;
+  fid_t fid;
+  int rc = FALSE;
+
+  switch( CTX_CNTRL )
+  { case FRG_FIRST_CALL:
+      if ( !acquire_handle(A1, &f) )
+	return FALSE;
+      if ( !PL_is_variable(A2) && !check_fact(f, A2) )
+      { release_handle(f);
+	return FALSE;
+      }
+      e = &e0;
+      if ( !init_enum(f, A2, e PASS_LD) )
+      { release_handle(f);
+	return FALSE;
+      }
+      break;
+    case FRG_REDO:
+      e = CTX_PTR;
+      if ( !acquire_handle(A1, &f) )
+      { freeForeignState(e, sizeof(*e));
+	return FALSE;
+      }
+      break;
+    case FRG_CUTTED:
+      e = CTX_PTR;
+      freeForeignState(e, sizeof(*e));
+      return TRUE;
+    default:
+      return TRUE;
+  }
+
+  if ( PL_is_variable(A2) )
+  { functor_t fd = f->functor;
+
+    if ( !PL_unify_functor(A2, fd) )
+      goto out;
+  }
+
+  if ( !(tmp = PL_new_term_ref()) ||
+       !(fid = PL_open_foreign_frame()) )
+    goto out;
+  while( (off=next_candidate(f, e)) )
+  { uint64_t *entry = ENTRY(f->data, off);
+
+    if ( PL_recorded_external((char*)&entry[E_SIZE], tmp) &&
+	 PL_unify(A2, tmp) &&
+	 PL_unify_int64(A3, (int64_t)off) )
+    { PL_close_foreign_frame(fid);
+      if ( more_candidates(e) )
+      { if ( e == &e0 )
+	{ e = allocForeignState(sizeof(*e));
+	  *e = e0;
+	}
+	release_handle(f);
+	ForeignRedoPtr(e);
+      }
+      rc = TRUE;
+      goto out;
+    }
+    if ( PL_exception(0) )
+      break;
+    PL_rewind_foreign_frame(fid);
+  }
+  PL_close_foreign_frame(fid);
+
+out:
+  if ( e != &e0 )
+    freeForeignState(e, sizeof(*e));
+  release_handle(f);
+  return rc;
+}
+
+
+/** '$disk_db_count'(+Handle, -Count)
+ *
+ * Count is the number of facts in the database.
+ */
+
+static
+PRED_IMPL("$disk_db_count", 2, disk_db_count, 0)
+{ disk_db *f;
+  int rc;
+
+  if ( !acquire_handle(A1, &f) )
+    return FALSE;
+  rc = PL_unify_uint64(A2, f->index[IH_COUNT]);
+  release_handle(f);
+
+  return rc;
+}
+
+
+/** '$disk_db_sync'(+Handle)
+ *
+ * Flush the data and index to disk.
+ */
+
+static
+PRED_IMPL("$disk_db_sync", 1, disk_db_sync, 0)
+{ disk_db *f;
+  int rc;
+
+  if ( !acquire_handle(A1, &f) )
+    return FALSE;
+  LOCK_DDB(f);
+  rc = sync_disk_db(f);
+  UNLOCK_DDB(f);
+  release_handle(f);
+
+  if ( !rc )
+    return PL_error(NULL, 0, MSG_ERRNO, ERR_FILE_OPERATION,
+		    ATOM_write, ATOM_file, A1);
+
+  return TRUE;
+}
+
+#endif /*HAVE_MMAP*/
+
+		 /*******************************
+		 *      PUBLISH PREDICATES	*
+		 *******************************/
+
+BeginPredDefs(diskdb)
+#ifdef HAVE_MMAP
+  PRED_DEF("$disk_db_open",   3, disk_db_open,   0)
+  PRED_DEF("$disk_db_close",  1, disk_db_close,  0)
+  PRED_DEF("$disk_db_assert", 2, disk_db_assert, 0)
+  PRED_DEF("$disk_db_erase",  2, disk_db_erase,  0)
+  PRED_DEF("$disk_db_clause", 3, disk_db_clause, PL_FA_NONDETERMINISTIC)
+  PRED_DEF("$disk_db_count",  2, disk_db_count,  0)
+  PRED_DEF("$disk_db_sync",   1, disk_db_sync,   0)
+#endif
+EndPredDefs
@@ -142,10 +142,6 @@ static const PL_extension foreigns[] = {
   FRG("$visible",		2, pl_visible,		  NOTRACE),
   FRG("$debuglevel",		2, pl_debuglevel,		0),
 
-#if COUNTING
-  FRG("$count",			0, pl_count,			0),
-#endif /* COUNTING */
-
   FRG("prolog_current_frame",	1, pl_prolog_current_frame,	0),
 
   FRG("dwim_match",		3, pl_dwim_match,		0),
@@ -390,6 +386,11 @@ DECL_PLIST(tabling);
 DECL_PLIST(mutex);
 DECL_PLIST(zip);
 DECL_PLIST(cbtrace);
+DECL_PLIST(vmstat);
+DECL_PLIST(csv);
+DECL_PLIST(fastfile);
+DECL_PLIST(diskdb);
+DECL_PLIST(numarray);
 
 void
 initBuildIns(void)
@@ -457,6 +458,11 @@ initBuildIns(void)
   REG_PLIST(mutex);
   REG_PLIST(zip);
   REG_PLIST(cbtrace);
+  REG_PLIST(vmstat);
+  REG_PLIST(csv);
+  REG_PLIST(fastfile);
+  REG_PLIST(diskdb);
+  REG_PLIST(numarray);
 
 #define LOOKUPPROC(name) \
 	{ GD->procedures.name = lookupProcedure(FUNCTOR_ ## name, m); \
@@ -500,6 +506,9 @@ initBuildIns(void)
   PL_meta_predicate(PL_predicate("assertz",          2, "system"), ":-");
   PL_meta_predicate(PL_predicate("retract",          1, "system"), ":");
   PL_meta_predicate(PL_predicate("retractall",       1, "system"), ":");
+  PL_meta_predicate(PL_predicate("assertz_list",     1, "system"), ":");
+  PL_meta_predicate(PL_predicate("asserta_list",     1, "system"), ":");
+  PL_meta_predicate(PL_predicate("retract_list",     1, "system"), ":");
   PL_meta_predicate(PL_predicate("clause",           2, "system"), ":?");
 
   PL_meta_predicate(PL_predicate("format",           2, "system"), "+:");
@@ -0,0 +1,1013 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "pl-incl.h"
+#include "pl-zip.h"			/* Sopen_mapped_file() */
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+#undef LD
+#define LD LOCAL_LD
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A fast term file is a file of  terms   in  the  fast_write/2 format with
+an index that provides random access. The layout is
+
+    <header> <records> <index> <footer> [<records> <index> <footer>]*
+
+The header is the 8 byte FTF_MAGIC.  Each session that writes to the file
+adds a _segment_ holding the records, an index with the 64-bit offset of
+each record and a footer. All integers are stored little-endian:
+
+    count	# records in this segment
+    total	# records in the file up to and including this segment
+    index	offset of the index of this segment
+    previous	offset of the footer of the previous segment or 0
+    magic	FTF_INDEX_MAGIC
+
+Appending never modifies existing data. This implies that readers that
+opened (mapped) the file before the append keep a consistent view. The
+writer holds an exclusive fcntl() lock on the file, so concurrent writers
+from different processes are serialized.  fcntl() locks do not exclude
+handles of the same process, so writers also register the file in the
+process-wide list `writers`.  A writer of another thread waits; opening
+a second writer from the same thread raises a permission error.
+
+Mode `write` does not truncate the file because readers may have it
+mapped.  It writes a new file <file>.tmp and renames this over <file>
+when the handle is closed.  Writers that waited for the lock check that
+the file was not replaced while waiting.
+
+If a writer dies before writing the footer, the file ends in a partial
+segment.  Readers and appenders scan back to the last valid footer.
+Appending leaves the partial segment in place as the data of the
+previous segment is located through the index.
+
+Readers map the file into memory using  Sopen_mapped_file() and read
+terms directly from the mapping. Reading does not lock and is thread
+safe. The handle is reference counted such that closing it while other
+threads are reading is safe.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define FTF_MAGIC		"SWIPLFT1"
+#define FTF_INDEX_MAGIC		"SWIPLFTI"
+#define FTF_MAGIC_LEN		8
+#define FTF_FOOTER_SIZE		(4*8+FTF_MAGIC_LEN)
+
+#define FTF_READ		0
+#define FTF_WRITE		1
+
+typedef struct ftf_segment
+{ uint64_t	first;			/* 0-based index of first record */
+  uint64_t	count;			/* # records */
+  uint64_t	index;			/* offset of the index */
+} ftf_segment;
+
+typedef struct fast_term_file
+{ atom_t	symbol;			/* <fast_term_file>(%p) */
+  int		mode;			/* FTF_READ or FTF_WRITE */
+  int		closed;			/* fast_term_file_close/1 called */
+  int		references;		/* # active users */
+  uint64_t	count;			/* # records in the file */
+					/* reader */
+  IOSTREAM     *mapped;			/* Sopen_mapped_file() stream */
+  char	       *data;			/* file content */
+  size_t	size;			/* size of the file */
+  ftf_segment  *segments;		/* segments, ordered by first */
+  size_t	nsegments;		/* # segments */
+					/* writer */
+  IOSTREAM     *out;			/* output stream */
+  uint64_t	offset;			/* offset of next record */
+  uint64_t	previous;		/* footer of the previous segment */
+  tmp_buffer	offsets;		/* offsets of the new records */
+  int		lock_fd;		/* locked file if not `out` */
+  char	       *path;			/* file to replace (mode write) */
+  char	       *tmp_path;		/* file we write (mode write) */
+  struct ftf_writer *writer;		/* entry in `writers` */
+#ifdef O_PLMT
+  simpleMutex	lock;			/* serialize writers */
+#endif
+} fast_term_file;
+
+#ifdef O_PLMT
+#define LOCK_FTF(f)	simpleMutexLock(&(f)->lock)
+#define UNLOCK_FTF(f)	simpleMutexUnlock(&(f)->lock)
+#else
+#define LOCK_FTF(f)	(void)0
+#define UNLOCK_FTF(f)	(void)0
+#endif
+
+typedef struct ftf_writer
+{ dev_t		device;			/* identity of the file */
+  ino_t		inode;
+  int		thread;			/* thread that opened it */
+  struct ftf_writer *next;
+} ftf_writer;
+
+static ftf_writer *writers;		/* files open for writing */
+
+static int	close_fast_term_file(fast_term_file *f);
+
+
+static uint64_t
+get_u64(const char *s)
+{ const unsigned char *p = (const unsigned char *)s;
+  uint64_t v = 0;
+  int i;
+
+  for(i=7; i>=0; i--)
+    v = (v<<8)|p[i];
+
+  return v;
+}
+
+
+static void
+put_u64(char *s, uint64_t v)
+{ int i;
+
+  for(i=0; i<8; i++)
+  { s[i] = (char)(v&0xff);
+    v >>= 8;
+  }
+}
+
+
+static int
+ftf_corrupt(const char *msg)
+{ return PL_syntax_error(msg, NULL);
+}
+
+
+		 /*******************************
+		 *	       BLOB		*
+		 *******************************/
+
+static int
+write_fast_term_file(IOSTREAM *s, atom_t aref, int flags)
+{ fast_term_file *f = PL_blob_data(aref, NULL, NULL);
+  (void)flags;
+
+  Sfprintf(s, "<fast_term_file>(%p)", f);
+  return TRUE;
+}
+
+
+static void
+acquire_fast_term_file(atom_t aref)
+{ fast_term_file *f = PL_blob_data(aref, NULL, NULL);
+
+  f->symbol = aref;
+}
+
+
+static void
+free_fast_term_file(fast_term_file *f)
+{ if ( f->mapped )
+    Sclose(f->mapped);
+  else if ( f->data )
+    free(f->data);
+  f->mapped = NULL;
+  f->data = NULL;
+  if ( f->segments )
+  { free(f->segments);
+    f->segments = NULL;
+  }
+}
+
+
+static int
+release_fast_term_file(atom_t aref)
+{ fast_term_file *f = PL_blob_data(aref, NULL, NULL);
+
+  if ( f->mode == FTF_WRITE )
+    close_fast_term_file(f);
+  free_fast_term_file(f);
+#ifdef O_PLMT
+  simpleMutexDelete(&f->lock);
+#endif
+  free(f);
+
+  return TRUE;
+}
+
+
+static int
+save_fast_term_file(atom_t aref, IOSTREAM *fd)
+{ fast_term_file *f = PL_blob_data(aref, NULL, NULL);
+  (void)fd;
+
+  return PL_warning("Cannot save reference to <fast_term_file>(%p)", f);
+}
+
+
+static atom_t
+load_fast_term_file(IOSTREAM *fd)
+{ (void)fd;
+
+  return PL_new_atom("<fast_term_file>");
+}
+
+
+static PL_blob_t fast_term_file_blob =
+{ PL_BLOB_MAGIC,
+  PL_BLOB_NOCOPY,
+  "fast_term_file",
+  release_fast_term_file,
+  NULL,
+  write_fast_term_file,
+  acquire_fast_term_file,
+  save_fast_term_file,
+  load_fast_term_file
+};
+
+
+static int
+get_fast_term_file(term_t t, fast_term_file **fp)
+{ void *p;
+  PL_blob_t *type;
+
+  if ( PL_get_blob(t, &p, NULL, &type) && type == &fast_term_file_blob )
+  { *fp = p;
+    return TRUE;
+  }
+
+  PL_type_error("fast_term_file", t);
+  return FALSE;
+}
+
+
+static void
+release_handle(fast_term_file *f)
+{ if ( ATOMIC_DEC(&f->references) == 0 )
+    free_fast_term_file(f);
+}
+
+
+/* Get the handle and register us as a user.  Must be followed by
+   release_handle().
+*/
+
+static int
+acquire_handle(term_t t, int mode, fast_term_file **fp)
+{ fast_term_file *f;
+
+  if ( !get_fast_term_file(t, &f) )
+    return FALSE;
+
+  for(;;)
+  { int refs = f->references;
+
+    if ( refs == 0 )			/* freed; do not revive */
+      return PL_existence_error("fast_term_file", t);
+    if ( COMPARE_AND_SWAP(&f->references, refs, refs+1) )
+      break;
+  }
+  if ( f->closed )
+  { release_handle(f);
+    return PL_existence_error("fast_term_file", t);
+  }
+  if ( mode != f->mode )
+  { release_handle(f);
+    return PL_permission_error(mode == FTF_READ ? "read" : "write",
+			       "fast_term_file", t);
+  }
+
+  *fp = f;
+  return TRUE;
+}
+
+
+		 /*******************************
+		 *	      READING		*
+		 *******************************/
+
+static int
+read_file_data(fast_term_file *f, const char *path)
+{ IOSTREAM *s;
+
+  if ( (s=Sopen_mapped_file(path)) )
+  { f->mapped = s;
+    f->data   = s->buffer;
+    f->size   = s->limitp - s->buffer;
+  } else if ( (s=Sopen_file(path, "rbr")) )
+  { tmp_buffer b;
+    char buf[4096];
+    size_t n;
+
+    initBuffer(&b);
+    while( (n=Sfread(buf, 1, sizeof(buf), s)) > 0 )
+      addMultipleBuffer(&b, buf, n, char);
+    if ( Sferror(s) )
+    { discardBuffer(&b);
+      Sclose(s);
+      return FALSE;
+    }
+    Sclose(s);
+
+    f->size = sizeOfBuffer(&b);
+    if ( !(f->data = malloc(f->size ? f->size : 1)) )
+    { discardBuffer(&b);
+      errno = ENOMEM;
+      return FALSE;
+    }
+    memcpy(f->data, baseBuffer(&b, char), f->size);
+    discardBuffer(&b);
+  } else
+  { return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+/* Check the footer p that is located at offset in the file and fill
+   the segment.  Returns the offset of the previous footer or
+   (uint64_t)-1 if the footer is invalid.
+*/
+
+static uint64_t
+check_footer(const char *p, uint64_t offset, ftf_segment *seg,
+	     uint64_t *total)
+{ uint64_t count    = get_u64(p);
+  uint64_t index    = get_u64(p+16);
+  uint64_t previous = get_u64(p+24);
+
+  *total = get_u64(p+8);
+  if ( memcmp(p+32, FTF_INDEX_MAGIC, FTF_MAGIC_LEN) != 0 ||
+       index < FTF_MAGIC_LEN || index > offset ||
+       (offset-index)/8 != count || (offset-index)%8 != 0 ||
+       count > *total ||
+       previous >= index || (previous && previous < FTF_MAGIC_LEN) )
+    return (uint64_t)-1;
+
+  seg->first = *total - count;
+  seg->count = count;
+  seg->index = index;
+
+  return previous;
+}
+
+
+/* Read the segments, starting at the footer at offset.  Returns -1 if
+   the footers do not form a valid chain.
+*/
+
+static int
+read_segments(fast_term_file *f, uint64_t offset)
+{ uint64_t total = 0, last = offset;
+  tmp_buffer b;
+  size_t i, n;
+  ftf_segment *segs;
+
+  initBuffer(&b);
+  for(;;)
+  { ftf_segment seg;
+    uint64_t previous, t;
+
+    if ( (previous=check_footer(f->data+offset, offset, &seg, &t))
+	   == (uint64_t)-1 ||
+	 (!isEmptyBuffer(&b) &&
+	  t != baseBuffer(&b, ftf_segment)[entriesBuffer(&b, ftf_segment)-1]
+		.first) )
+    { discardBuffer(&b);
+      return -1;
+    }
+    if ( isEmptyBuffer(&b) )
+      total = t;
+    addBuffer(&b, seg, ftf_segment);
+    if ( !previous )
+    { if ( seg.first != 0 )
+      { discardBuffer(&b);
+	return -1;
+      }
+      break;
+    }
+    offset = previous;
+  }
+
+  n = entriesBuffer(&b, ftf_segment);
+  if ( !(segs = malloc(n*sizeof(*segs))) )
+  { discardBuffer(&b);
+    return PL_no_memory();
+  }
+  for(i=0; i<n; i++)			/* segments were found last first */
+    segs[i] = baseBuffer(&b, ftf_segment)[n-i-1];
+  discardBuffer(&b);
+
+  f->segments  = segs;
+  f->nsegments = n;
+  f->count     = total;
+  f->previous  = last;
+
+  return TRUE;
+}
+
+
+/* Read the index of the file.  If the file does not end in a footer, a
+   writer died and we scan back for the last complete segment.  If there
+   is none, the file is empty.
+*/
+
+static int
+read_index(fast_term_file *f)
+{ uint64_t end;
+
+  if ( f->size < FTF_MAGIC_LEN ||
+       memcmp(f->data, FTF_MAGIC, FTF_MAGIC_LEN) != 0 )
+    return ftf_corrupt("fast_term_file_magic");
+
+  for(end = f->size; end >= FTF_MAGIC_LEN+FTF_FOOTER_SIZE; end--)
+  { if ( memcmp(f->data+end-FTF_MAGIC_LEN,
+		FTF_INDEX_MAGIC, FTF_MAGIC_LEN) == 0 )
+    { int rc = read_segments(f, end-FTF_FOOTER_SIZE);
+
+      if ( rc != -1 )
+	return rc;
+      if ( end == f->size )		/* complete, but invalid */
+	return ftf_corrupt("fast_term_file_index");
+    }
+  }
+
+  f->count    = 0;
+  f->previous = 0;
+
+  return TRUE;
+}
+
+
+static ftf_segment *
+find_segment(fast_term_file *f, uint64_t i)
+{ size_t lo = 0, hi = f->nsegments;
+
+  while( hi-lo > 1 )
+  { size_t m = (lo+hi)/2;
+
+    if ( f->segments[m].first <= i )
+      lo = m;
+    else
+      hi = m;
+  }
+
+  return &f->segments[lo];
+}
+
+
+/* Unify t with the i-th (0-based) term of the file */
+
+static int
+get_term(fast_term_file *f, uint64_t i, term_t t ARG_LD)
+{ ftf_segment *seg = find_segment(f, i);
+  uint64_t j = i - seg->first;
+  const char *index = f->data + seg->index;
+  uint64_t start = get_u64(index+j*8);
+  uint64_t end = j+1 < seg->count ? get_u64(index+(j+1)*8) : seg->index;
+  term_t tmp;
+
+  if ( start < FTF_MAGIC_LEN || start >= end || end > seg->index ||
+       !is_external(f->data+start, (size_t)(end-start)) )
+    return ftf_corrupt("fast_term_file_record");
+
+  return ( (tmp=PL_new_term_ref()) &&
+	   PL_recorded_external(f->data+start, tmp) &&
+	   PL_unify(t, tmp) );
+}
+
+
+		 /*******************************
+		 *	      WRITING		*
+		 *******************************/
+
+static int
+lock_file(int fd)
+{
+#ifdef FCNTL_LOCKS
+  struct flock buf;
+
+  memset(&buf, 0, sizeof(buf));
+  buf.l_whence = SEEK_SET;
+  buf.l_type   = F_WRLCK;
+
+  while( fcntl(fd, F_SETLKW, &buf) != 0 )
+  { if ( errno == EINTR )
+    { if ( PL_handle_signals() < 0 )
+	return FALSE;
+      continue;
+    }
+    return FALSE;
+  }
+#else
+  (void)fd;
+#endif
+
+  return TRUE;
+}
+
+
+/* Register that f writes the file described by buf.  Waits while a
+   handle of another thread writes the file.  Returns -1 if an exception
+   is raised.
+*/
+
+static int
+register_writer(fast_term_file *f, const struct stat *buf, term_t file)
+{ for(;;)
+  { ftf_writer *w;
+    int owner = 0;
+
+    PL_LOCK(L_FILE);
+    for(w=writers; w; w=w->next)
+    { if ( w->device == buf->st_dev && w->inode == buf->st_ino )
+      { owner = w->thread;
+	break;
+      }
+    }
+    if ( !w && (w=malloc(sizeof(*w))) )
+    { w->device = buf->st_dev;
+      w->inode  = buf->st_ino;
+      w->thread = PL_thread_self();
+      w->next   = writers;
+      writers   = w;
+      f->writer = w;
+    }
+    PL_UNLOCK(L_FILE);
+
+    if ( f->writer )
+      return TRUE;
+    if ( !w )
+    { PL_no_memory();
+      return -1;
+    }
+    if ( owner == PL_thread_self() )
+    { PL_permission_error("open", "source_sink", file);
+      return -1;
+    }
+    if ( !Pause(0.01) || PL_handle_signals() < 0 )
+      return -1;
+  }
+}
+
+
+static void
+unregister_writer(fast_term_file *f)
+{ ftf_writer *w, **p;
+
+  if ( !(w=f->writer) )
+    return;
+
+  PL_LOCK(L_FILE);
+  for(p=&writers; *p; p=&(*p)->next)
+  { if ( *p == w )
+    { *p = w->next;
+      break;
+    }
+  }
+  PL_UNLOCK(L_FILE);
+  f->writer = NULL;
+  free(w);
+}
+
+
+/* Find the end of the file we append to.  The file is locked.
+*/
+
+static int
+read_append_position(fast_term_file *f, const char *path)
+{ int rc;
+
+  if ( !read_file_data(f, path) )
+    return FALSE;
+  rc = read_index(f) ? TRUE : -1;
+  free_fast_term_file(f);
+
+  return rc;
+}
+
+
+/* Release all resources of a writer that is not (or no longer) open.
+*/
+
+static void
+discard_writer(fast_term_file *f)
+{ if ( f->tmp_path )			/* not renamed */
+    remove(f->tmp_path);
+  if ( f->lock_fd >= 0 )
+  { close(f->lock_fd);			/* also releases the lock */
+    f->lock_fd = -1;
+  }
+  if ( f->tmp_path )
+  { free(f->tmp_path);
+    f->tmp_path = NULL;
+  }
+  if ( f->path )
+  { free(f->path);
+    f->path = NULL;
+  }
+  unregister_writer(f);
+}
+
+
+/* Open the file for writing.  Returns FALSE with errno set on an I/O
+   error and -1 if an exception is raised.
+*/
+
+static int
+open_writer(fast_term_file *f, const char *path, int append, term_t file)
+{ int fd, rc;
+  struct stat buf, pbuf;
+  uint64_t size;
+
+  for(;;)
+  { if ( (fd=open(path, O_RDWR|O_CREAT|O_BINARY, 0666)) < 0 )
+      return FALSE;
+    if ( fstat(fd, &buf) != 0 )
+      goto ioerror;
+    if ( (rc=register_writer(f, &buf, file)) != TRUE )
+    { close(fd);
+      return rc;
+    }
+    if ( !lock_file(fd) || stat(path, &pbuf) != 0 )
+      goto ioerror;
+    if ( pbuf.st_dev == buf.st_dev && pbuf.st_ino == buf.st_ino )
+      break;
+    unregister_writer(f);		/* replaced while we waited */
+    close(fd);
+  }
+  f->lock_fd = fd;
+
+  if ( append )
+  { size = pbuf.st_size;
+    if ( size > 0 && (rc=read_append_position(f, path)) != TRUE )
+    { discard_writer(f);
+      return rc;
+    }
+    if ( lseek(fd, 0, SEEK_END) == (off_t)-1 )
+      goto ioerror;
+  } else
+  { size = 0;
+    if ( !(f->path = strdup(path)) ||
+	 !(f->tmp_path = malloc(strlen(path)+5)) )
+    { discard_writer(f);
+      PL_no_memory();
+      return -1;
+    }
+    strcpy(f->tmp_path, path);
+    strcat(f->tmp_path, ".tmp");
+    if ( (fd=open(f->tmp_path, O_WRONLY|O_CREAT|O_TRUNC|O_BINARY, 0666)) < 0 )
+      goto ioerror;
+  }
+
+  if ( !(f->out = Sfdopen(fd, "wb")) )
+  { if ( fd != f->lock_fd )
+      close(fd);
+    goto ioerror;
+  }
+  if ( fd == f->lock_fd )
+    f->lock_fd = -1;			/* closed with f->out */
+  f->out->encoding = ENC_OCTET;
+
+  if ( size == 0 )
+  { if ( Sfwrite(FTF_MAGIC, 1, FTF_MAGIC_LEN, f->out) != FTF_MAGIC_LEN )
+    { int eno = errno;
+
+      Sclose(f->out);
+      f->out = NULL;
+      discard_writer(f);
+      errno = eno;
+      return FALSE;
+    }
+    size = FTF_MAGIC_LEN;
+  }
+  f->offset = size;
+
+  return TRUE;
+
+ioerror:
+  { int eno = errno;
+
+    if ( f->lock_fd < 0 )
+      close(fd);
+    discard_writer(f);
+    errno = eno;
+    return FALSE;
+  }
+}
+
+
+static int
+write_term(fast_term_file *f, term_t t)
+{ char *rec;
+  size_t len;
+  int rc;
+
+  if ( !(rec = PL_record_external(t, &len)) )
+    return FALSE;
+
+  LOCK_FTF(f);
+  if ( !f->out )			/* closed by another thread */
+  { errno = EBADF;
+    rc = FALSE;
+  } else if ( (rc = (Sfwrite(rec, 1, len, f->out) == len)) )
+  { addBuffer(&f->offsets, f->offset, uint64_t);
+    f->offset += len;
+    f->count++;
+  }
+  UNLOCK_FTF(f);
+  PL_erase_external(rec);
+
+  return rc;
+}
+
+
+/* Write the index and footer and close the file.  May be called twice:
+   one time explicitly and one time due to atom-GC.
+*/
+
+static int
+close_fast_term_file(fast_term_file *f)
+{ IOSTREAM *out;
+  int rc = 0;
+
+  LOCK_FTF(f);
+  if ( (out=f->out) )
+  { uint64_t *offsets = baseBuffer(&f->offsets, uint64_t);
+    size_t i, n = entriesBuffer(&f->offsets, uint64_t);
+    uint64_t index = f->offset;
+    char buf[FTF_FOOTER_SIZE];
+
+    f->out = NULL;
+    for(i=0; i<n && rc == 0; i++)
+    { put_u64(buf, offsets[i]);
+      if ( Sfwrite(buf, 1, 8, out) != 8 )
+	rc = -1;
+    }
+    put_u64(buf,    n);
+    put_u64(buf+8,  f->count);
+    put_u64(buf+16, index);
+    put_u64(buf+24, f->previous);
+    memcpy(buf+32, FTF_INDEX_MAGIC, FTF_MAGIC_LEN);
+    if ( rc == 0 && Sfwrite(buf, 1, sizeof(buf), out) != sizeof(buf) )
+      rc = -1;
+    if ( rc == 0 && f->tmp_path &&	/* on disk before we replace */
+	 (Sflush(out) != 0 || fsync(Sfileno(out)) != 0) )
+      rc = -1;
+    if ( Sclose(out) != 0 )		/* releases the lock if appending */
+      rc = -1;
+    if ( rc == 0 && f->tmp_path )
+    { if ( rename(f->tmp_path, f->path) == 0 )
+      { free(f->tmp_path);
+	f->tmp_path = NULL;
+      } else
+	rc = -1;
+    }
+    discardBuffer(&f->offsets);
+    discard_writer(f);
+  }
+  UNLOCK_FTF(f);
+
+  return rc;
+}
+
+
+		 /*******************************
+		 *	    PREDICATES		*
+		 *******************************/
+
+/** fast_term_file_open(+File, +Mode, -Handle)
+ *
+ * Open a fast term file.  Mode is one of `read`, `write` or `append`.
+ */
+
+static
+PRED_IMPL("fast_term_file_open", 3, fast_term_file_open, 0)
+{ PRED_LD
+  char *path;
+  atom_t mode;
+  fast_term_file *f;
+  int rc;
+
+  if ( !PL_get_file_name(A1, &path, 0) ||
+       !PL_get_atom_ex(A2, &mode) )
+    return FALSE;
+  if ( mode != ATOM_read && mode != ATOM_write && mode != ATOM_append )
+    return PL_domain_error("io_mode", A2);
+
+  if ( !(f = malloc(sizeof(*f))) )
+    return PL_no_memory();
+  memset(f, 0, sizeof(*f));
+  f->references = 1;
+#ifdef O_PLMT
+  simpleMutexInit(&f->lock);
+#endif
+
+  if ( mode == ATOM_read )
+  { f->mode = FTF_READ;
+    if ( (rc=read_file_data(f, path)) )
+      rc = read_index(f) ? TRUE : -1;
+  } else
+  { f->mode = FTF_WRITE;
+    f->lock_fd = -1;
+    initBuffer(&f->offsets);
+    rc = open_writer(f, path, mode == ATOM_append, A1);
+  }
+
+  if ( rc == TRUE )
+    return PL_unify_blob(A3, f, sizeof(*f), &fast_term_file_blob);
+
+  if ( !rc )
+    PL_error(NULL, 0, MSG_ERRNO, ERR_FILE_OPERATION,
+	     ATOM_open, ATOM_file, A1);
+  free_fast_term_file(f);
+#ifdef O_PLMT
+  simpleMutexDelete(&f->lock);
+#endif
+  free(f);
+
+  return FALSE;
+}
+
+
+/** fast_term_file_close(+Handle)
+ *
+ * Close the handle.  If the handle was opened for writing, write the
+ * index.
+ */
+
+static
+PRED_IMPL("fast_term_file_close", 1, fast_term_file_close, 0)
+{ fast_term_file *f;
+
+  if ( !get_fast_term_file(A1, &f) )
+    return FALSE;
+
+  if ( COMPARE_AND_SWAP(&f->closed, FALSE, TRUE) )
+  { if ( f->mode == FTF_WRITE && close_fast_term_file(f) != 0 )
+    { release_handle(f);
+      return PL_error(NULL, 0, MSG_ERRNO, ERR_FILE_OPERATION,
+		      ATOM_close, ATOM_file, A1);
+    }
+    release_handle(f);
+  }
+
+  return TRUE;
+}
+
+
+/** fast_term_file_write(+Handle, +Term)
+ *
+ * Append Term to a fast term file opened for writing.
+ */
+
+static
+PRED_IMPL("fast_term_file_write", 2, fast_term_file_write, 0)
+{ fast_term_file *f;
+  int rc;
+
+  if ( !acquire_handle(A1, FTF_WRITE, &f) )
+    return FALSE;
+  if ( !(rc=write_term(f, A2)) && !PL_exception(0) )
+    rc = PL_error(NULL, 0, MSG_ERRNO, ERR_FILE_OPERATION,
+		  ATOM_write, ATOM_file, A1);
+  release_handle(f);
+
+  return rc;
+}
+
+
+/** fast_term_file_count(+Handle, -Count)
+ *
+ * Count is the number of terms in the file.
+ */
+
+static
+PRED_IMPL("fast_term_file_count", 2, fast_term_file_count, 0)
+{ fast_term_file *f;
+
+  if ( !get_fast_term_file(A1, &f) )
+    return FALSE;
+  if ( f->closed )
+    return PL_existence_error("fast_term_file", A1);
+
+  return PL_unify_uint64(A2, f->count);
+}
+
+
+/** fast_term_file_read(+Handle, ?Index, -Term)
+ *
+ * Term is the Index-th (1-based) term of the file.  If Index is unbound,
+ * enumerate all terms on backtracking.
+ */
+
+static
+PRED_IMPL("fast_term_file_read", 3, fast_term_file_read,
+	  PL_FA_NONDETERMINISTIC)
+{ PRED_LD
+  fast_term_file *f;
+  uint64_t i;
+  int rc = FALSE;
+  fid_t fid;
+
+  switch( CTX_CNTRL )
+  { case FRG_FIRST_CALL:
+    { int64_t n;
+
+      if ( PL_is_variable(A2) )
+      { i = 0;
+	break;
+      }
+      if ( !PL_get_int64_ex(A2, &n) )
+	return FALSE;
+      if ( !acquire_handle(A1, FTF_READ, &f) )
+	return FALSE;
+      if ( n >= 1 && (uint64_t)n <= f->count )
+	rc = get_term(f, n-1, A3 PASS_LD);
+      release_handle(f);
+      return rc;
+    }
+    case FRG_REDO:
+      i = (uint64_t)CTX_INT;
+      break;
+    case FRG_CUTTED:
+    default:
+      return TRUE;
+  }
+
+  if ( !acquire_handle(A1, FTF_READ, &f) )
+    return FALSE;
+  if ( !(fid = PL_open_foreign_frame()) )
+    goto out;
+  for(; i<f->count; i++)
+  { if ( PL_unify_uint64(A2, i+1) &&
+	 get_term(f, i, A3 PASS_LD) )
+    { PL_close_foreign_frame(fid);
+      if ( i+1 < f->count )
+      { release_handle(f);
+	ForeignRedoInt(i+1);
+      }
+      rc = TRUE;
+      goto out;
+    }
+    if ( PL_exception(0) )
+      break;
+    PL_rewind_foreign_frame(fid);
+  }
+  PL_close_foreign_frame(fid);
+
+out:
+  release_handle(f);
+  return rc;
+}
+
+
+		 /*******************************
+		 *      PUBLISH PREDICATES	*
+		 *******************************/
+
+BeginPredDefs(fastfile)
+  PRED_DEF("fast_term_file_open",  3, fast_term_file_open,  0)
+  PRED_DEF("fast_term_file_close", 1, fast_term_file_close, 0)
+  PRED_DEF("fast_term_file_write", 2, fast_term_file_write, 0)
+  PRED_DEF("fast_term_file_count", 2, fast_term_file_count, 0)
+  PRED_DEF("fast_term_file_read",  3, fast_term_file_read,
+	   PL_FA_NONDETERMINISTIC)
+EndPredDefs
@@ -58,7 +58,6 @@ COMMON(void)		freezeGlobal(ARG1_LD);
 COMMON(int)		gvar_value__LD(atom_t name, Word p ARG_LD);
 
 /* pl-wam.c */
-COMMON(word)		pl_count(void);
 COMMON(void)		TrailAssignment__LD(Word p ARG_LD);
 COMMON(void)		do_undo(mark *m);
 COMMON(Definition)	getProcDefinition__LD(Definition def ARG_LD);
@@ -117,7 +116,9 @@ COMMON(void)		_PL_debug_unregister_atom(atom_t a,
 COMMON(int)		ar_compare(Number n1, Number n2, int what);
 COMMON(int)		ar_compare_eq(Number n1, Number n2);
 COMMON(int)		pl_ar_add(Number n1, Number n2, Number r);
+COMMON(int)		ar_minus(Number n1, Number n2, Number r);
 COMMON(int)		ar_mul(Number n1, Number n2, Number r);
+COMMON(int)		ar_divide(Number n1, Number n2, Number r);
 COMMON(word)		pl_current_arithmetic_function(term_t f, control_t h);
 COMMON(void)		initArith(void);
 COMMON(void)		cleanupArith(void);
@@ -151,6 +152,8 @@ COMMON(int)		compileClause(Clause *cp, Word head, Word body,
 				      term_t warnings ARG_LD);
 COMMON(Clause)		assert_term(term_t term, ClauseRef where, atom_t owner,
 				    SourceLoc loc ARG_LD);
+COMMON(int)		assert_terms(term_t list, Module module,
+				     ClauseRef where ARG_LD);
 COMMON(void)		forAtomsInClause(Clause clause, void (func)(atom_t a));
 COMMON(Code)		stepDynPC(Code PC, const code_info *ci);
 COMMON(bool)		decompileHead(Clause clause, term_t head);
@@ -189,6 +192,8 @@ COMMON(ClauseRef)	nextClause__LD(ClauseChoice chp, Word argv, LocalFrame fr,
 				       Definition def ARG_LD);
 COMMON(int)		addClauseToIndexes(Definition def, Clause cl,
 					   ClauseRef where);
+COMMON(void)		addClausesToIndexes(Definition def, Clause *clauses,
+					    size_t count, ClauseRef where);
 COMMON(void)		delClauseFromIndex(Definition def, Clause cl);
 COMMON(void)		cleanClauseIndexes(Definition def, ClauseList cl,
 					   gen_t active);
@@ -200,6 +205,12 @@ COMMON(void)		deleteIndexes(ClauseList cl, int isnew);
 COMMON(int)		checkClauseIndexSizes(Definition def, int nindexable);
 COMMON(void)		checkClauseIndexes(Definition def);
 COMMON(void)		listIndexGenerations(Definition def, gen_t gen);
+COMMON(void)		freeOrderedIndexes(Definition def);
+#ifdef O_PLMT
+COMMON(void)		cancelIndexJobs(Definition def);
+COMMON(void)		stopIndexWorker(void);
+COMMON(void)		markIndexBuilder(ARG1_LD);
+#endif
 
 /* pl-dwim.c */
 COMMON(word)		pl_dwim_match(term_t a1, term_t a2, term_t mm);
@@ -501,11 +512,17 @@ COMMON(void)		setMetapredicateMask(Definition def, arg_info *args);
 COMMON(int)		isTransparentMetamask(Definition def, arg_info *args);
 COMMON(ClauseRef)	assertProcedure(Procedure proc, Clause clause,
 					ClauseRef where ARG_LD);
+COMMON(void)		assertProcedures(Procedure *procs, Clause *clauses,
+					 size_t count, ClauseRef where ARG_LD);
 COMMON(bool)		abolishProcedure(Procedure proc, Module module);
 COMMON(bool)		retractClauseDefinition(Definition def, Clause clause);
+COMMON(int)		retractClauses(Definition *defs, Clause *clauses,
+				       size_t count ARG_LD);
+COMMON(int)		retract_terms(term_t list, Module module ARG_LD);
 COMMON(void)		unallocClause(Clause c);
 COMMON(void)		freeClause(Clause c);
 COMMON(void)		lingerClauseRef(ClauseRef c);
+COMMON(void)		releaseClause(Clause cl);
 COMMON(ClauseRef)	newClauseRef(Clause cl, word key);
 COMMON(size_t)		removeClausesPredicate(Definition def,
 					       int sfindex, int fromfile);
@@ -597,6 +614,7 @@ COMMON(bool)		unifyKey(term_t key, word val);
 COMMON(int)		getKeyEx(term_t key, word *k ARG_LD);
 COMMON(word)		pl_term_complexity(term_t t, term_t mx, term_t count);
 COMMON(void)		markAtomsRecord(Record record);
+COMMON(int)		is_external(const char *rec, size_t len);
 
 /* pl-rl.c */
 COMMON(void)		install_rl(void);
@@ -629,6 +647,12 @@ COMMON(int)		set_stack_limit(size_t limit);
 COMMON(void *)		stack_malloc(size_t size);
 COMMON(void *)		stack_realloc(void *old, size_t size);
 COMMON(void)		stack_free(void *mem);
+#ifdef O_MMAP_STACKS
+COMMON(int)		resize_vm_stacks(size_t gsize, size_t lsize, size_t tsize,
+					 Word *gb, LocalFrame *lb, TrailEntry *tb
+					 ARG_LD);
+COMMON(void)		cleanupStackCache(void);
+#endif
 COMMON(const char *)	signal_name(int sig);
 
 /* pl-sys.c */
@@ -793,3 +817,8 @@ COMMON(int)	is_variant_ptr(Word p1, Word p2 ARG_LD);
 
 /* pl-version.h */
 COMMON(void)	setGITVersion(void);
+
+/* pl-numarray.c */
+COMMON(void)	initNumericArrays(void);
+COMMON(int)	isNumericArrayFunction(functor_t f);
+COMMON(int)	valueNumericArrayFunction(Word p, Number r ARG_LD);
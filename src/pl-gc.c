@@ -141,7 +141,7 @@ char tmp[256];				/* for calling print_val(), etc. */
 static inline void
 recordMark__LD(Word p ARG_LD)
 { if ( DEBUGGING(CHK_SECURE) )
-  { if ( (char*)p < (char*)lBase )
+  { if ( (char*)p < (char*)lBase && p >= LD->gc._young_base )
     { assert(onStack(global, p));
       *LD->gc._mark_top++ = p;		/* = mark_top */
     }
@@ -261,6 +261,8 @@ static int		check_marked(const char *s);
 #define local_frames	   (LD->gc._local_frames)
 #define choice_count	   (LD->gc._choice_count)
 #define start_map	   (LD->gc._start_map)
+#define young_base	   (LD->gc._young_base)
+#define young_trail	   (LD->gc._young_trail)
 #if O_DEBUG
 #define trailtops_marked   (LD->gc._trailtops_marked)
 #define mark_base	   (LD->gc._mark_base)
@@ -516,6 +518,27 @@ isGlobalRef(word w)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Generational collection. If young_base is above gBase, only the part of
+the global stack above young_base is  collected.  The old cells below it
+are neither marked nor moved, so marking stops at references into the old
+generation and such references are  not   inserted  in relocation chains.
+See young_generation() for the conditions  under  which this is safe and
+mark_remembered_set() for handling references from old to young cells.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static inline int
+is_old(Word p ARG_LD)
+{ return p < young_base && p >= gBase;
+}
+
+
+static inline int
+isYoungRef(word w ARG_LD)
+{ return storage(w) == STG_GLOBAL && !is_old(val_ptr(w) PASS_LD);
+}
+
+
 static inline size_t
 offset_word(word m)
 { size_t offset;
@@ -656,6 +679,8 @@ mark_variable(Word start ARG_LD)
   if ( onStackArea(local, start) )
   { markLocal(start);
     total_marked--;			/* do not count local stack cell */
+  } else if ( is_old(start PASS_LD) )
+  { total_marked--;			/* nor old cells from the trail */
   }
   current = start;
   mark_first(current);
@@ -671,6 +696,8 @@ forward:				/* Go into the tree */
   { case TAG_REFERENCE:
     { next = unRef(val);		/* address pointing to */
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
+      if ( is_old(next PASS_LD) )	/* old generation is not collected */
+	BACKWARD;
       needsRelocation(current);
       if ( is_first(next) )		/* ref to choice point. we will */
         BACKWARD;			/* get there some day anyway */
@@ -686,6 +713,8 @@ forward:				/* Go into the tree */
     { DEBUG(CHK_SECURE, assert(storage(val) == STG_GLOBAL));
       next = valPtr2(val, STG_GLOBAL);
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
+      if ( is_old(next PASS_LD) )
+	BACKWARD;
       needsRelocation(current);
       if ( is_marked(next) )
 	BACKWARD;			/* term has already been marked */
@@ -704,6 +733,8 @@ forward:				/* Go into the tree */
       DEBUG(CHK_SECURE, assert(storage(val) == STG_GLOBAL));
       next = valPtr2(val, STG_GLOBAL);
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
+      if ( is_old(next PASS_LD) )
+	BACKWARD;
       needsRelocation(current);
       if ( is_marked(next) )
 	BACKWARD;			/* term has already been marked */
@@ -735,6 +766,8 @@ forward:				/* Go into the tree */
 
       DEBUG(CHK_SECURE, assert(storage(val) == STG_GLOBAL));
       DEBUG(CHK_SECURE, assert(onStack(global, next)));
+      if ( is_old(next PASS_LD) )
+	BACKWARD;
       needsRelocation(current);
       if ( is_marked(next) )		/* can be referenced from multiple */
         BACKWARD;			/* places */
@@ -1315,12 +1348,12 @@ early_reset_vars(mark *m, Word top, GCTrailEntry te ARG_LD)
 	te--;
 	te->address = 0;
 	trailcells_deleted += 2;
-      } else if ( is_marked(tard) )
+      } else if ( is_marked(tard) || is_old(tard PASS_LD) )
       { Word gp = val_ptr(te->address);
 
 	assert(onGlobal(gp));
 	assert(!is_first(gp));
-	if ( !is_marked(gp) )
+	if ( !is_marked(gp) && !is_old(gp PASS_LD) )
 	{ DEBUG(MSG_GC_ASSIGNMENTS_MARK,
 		char b1[64]; char b2[64]; char b3[64];
 		Sdprintf("Marking assignment at %s (%s --> %s)\n",
@@ -1364,7 +1397,7 @@ early_reset_vars(mark *m, Word top, GCTrailEntry te ARG_LD)
       } else if ( tard > gKeep && tard < gMax )
       { te->address = 0;
 	trailcells_deleted++;
-      } else if ( !is_marked(tard) )
+      } else if ( !is_marked(tard) && !is_old(tard PASS_LD) )
       { DEBUG(MSG_GC_RESET,
 	      char b1[64]; char b2[64];
 	      Sdprintf("Early reset at %s (%s)\n",
@@ -2230,12 +2263,41 @@ cmp_address(const void *vp1, const void *vp2)
 #endif
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The only way an old cell can  refer   to  a young one is by an assignment
+after the choicepoint that  defines  young_base   was  created.  As this
+choicepoint is still alive, all such   assignments are trailed above its
+trail mark, so the trail is our  remembered   set.  We  mark the current
+value of these cells before anything else, so early_reset_vars() always
+sees young data reachable from the old generation as marked.  The marked
+old cells are unmarked and relocated by sweep_remembered_set().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+mark_remembered_set(ARG1_LD)
+{ GCTrailEntry te = (GCTrailEntry)tTop - 1;
+
+  for( ; te >= (GCTrailEntry)young_trail; te-- )
+  { if ( te->address &&
+	 ttag(te->address) != TAG_TRAILVAL &&
+	 storage(te->address) == STG_GLOBAL )
+    { Word p = val_ptr(te->address);
+
+      if ( is_old(p PASS_LD) && !is_marked(p) )
+	mark_variable(p PASS_LD);
+    }
+  }
+}
+
+
 static void
 mark_phase(vm_state *state)
 { GET_LD
   total_marked = 0;
 
   DEBUG(CHK_SECURE, check_marked("Before mark_term_refs()"));
+  if ( young_base > gBase )
+    mark_remembered_set(PASS_LD1);
   mark_term_refs();
   mark_stacks(state);
 
@@ -2573,6 +2635,10 @@ sweep_global_mark(Word *m ARG_LD)
 
   DEBUG(CHK_SECURE, assert(onStack(local, m)));
   gm = *m;
+  if ( gm < young_base )		/* old generation: does not move */
+  { *m = (Word)consPtr(gm, STG_GLOBAL);	/* as update_relocation_chain() */
+    return;
+  }
   if ( is_marked_or_first(gm-1) )
     goto done;				/* quit common easy case */
 
@@ -2649,8 +2715,10 @@ sweep_foreign()
       {	unmark(sp);
 	if ( isGlobalRef(get_value(sp)) )
 	{ processLocal(sp);
-	  check_relocation(sp);
-	  into_relocation_chain(sp, STG_LOCAL PASS_LD);
+	  if ( isYoungRef(get_value(sp) PASS_LD) )
+	  { check_relocation(sp);
+	    into_relocation_chain(sp, STG_LOCAL PASS_LD);
+	  }
 	}
       }
     }
@@ -2721,7 +2789,7 @@ sweep_trail(void)
   GCTrailEntry te = (GCTrailEntry)tTop - 1;
 
   for( ; te >= (GCTrailEntry)tBase; te-- )
-  { if ( te->address )
+  { if ( te->address && !is_old(val_ptr(te->address) PASS_LD) )
     {
 #ifdef O_DESTRUCTIVE_ASSIGNMENT
       if ( ttag(te->address) == TAG_TRAILVAL )
@@ -2740,6 +2808,34 @@ sweep_trail(void)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Unmark the old cells marked by mark_remembered_set() and insert those that
+refer to young data in the relocation chains.   This must be done before
+any scan relies on the marked cell below young_base.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+sweep_remembered_set(ARG1_LD)
+{ GCTrailEntry te = (GCTrailEntry)tTop - 1;
+
+  for( ; te >= (GCTrailEntry)tBase; te-- )
+  { if ( te->address &&
+	 ttag(te->address) != TAG_TRAILVAL &&
+	 storage(te->address) == STG_GLOBAL )
+    { Word p = val_ptr(te->address);
+
+      if ( is_old(p PASS_LD) && is_marked(p) )
+      { unmark(p);
+	if ( isYoungRef(get_value(p) PASS_LD) )
+	{ check_relocation(p);
+	  into_relocation_chain(p, STG_GLOBAL PASS_LD);
+	}
+      }
+    }
+  }
+}
+
+
 
 static void
 sweep_frame(LocalFrame fr, int slots ARG_LD)
@@ -2751,8 +2847,10 @@ sweep_frame(LocalFrame fr, int slots ARG_LD)
     { unmark(sp);
       if ( isGlobalRef(get_value(sp)) )
       { processLocal(sp);
-	check_relocation(sp);
-	into_relocation_chain(sp, STG_LOCAL PASS_LD);
+	if ( isYoungRef(get_value(sp) PASS_LD) )
+	{ check_relocation(sp);
+	  into_relocation_chain(sp, STG_LOCAL PASS_LD);
+	}
       }
     } else
     { if ( isGlobalRef(*sp) )
@@ -2823,8 +2921,10 @@ sweep_new_arguments(vm_state *state ARG_LD)
       unmark(sp);
       if ( isGlobalRef(get_value(sp)) )
       { processLocal(sp);
-	check_relocation(sp);
-	into_relocation_chain(sp, STG_LOCAL PASS_LD);
+	if ( isYoungRef(get_value(sp) PASS_LD) )
+	{ check_relocation(sp);
+	  into_relocation_chain(sp, STG_LOCAL PASS_LD);
+	}
       }
     }
   }
@@ -2918,7 +3018,7 @@ is_downward_ref(Word p ARG_LD)
 
       DEBUG(CHK_SECURE, assert(d >= gBase));
 
-      return d < p;
+      return d < p && d >= young_base;
     }
   }
 
@@ -2960,7 +3060,8 @@ check_marked(const char *s)
   Word current;
   intptr_t cells = 0;
 
-  for( current = gBase; current < gTop; current += (offset_cell(current)+1) )
+  for( current = young_base; current < gTop;
+       current += (offset_cell(current)+1) )
   { cells++;
     if ( is_marked(current) )
     { m += (offset_cell(current)+1);
@@ -3027,7 +3128,7 @@ downskip_combine_garbage(Word current, Word dest ARG_LD)
     }
   }
 
-  return make_gc_hole(gBase, top_gc);
+  return make_gc_hole(young_base, top_gc);
 }
 
 
@@ -3035,7 +3136,7 @@ static void
 compact_global(void)
 { GET_LD
   Word dest, current;
-  Word base = gBase, top;
+  Word base = young_base, top;
 #if O_DEBUG
   Word *v = mark_top;
 #endif
@@ -3093,8 +3194,8 @@ compact_global(void)
 	});
 
   if ( dest != base )
-    sysError("Mismatch in down phase: dest = %p, gBase = %p\n",
-	     dest, gBase);
+    sysError("Mismatch in down phase: dest = %p, base = %p\n",
+	     dest, base);
   if ( relocation_cells != relocated_cells )
   { DEBUG(CHK_SECURE, printNotRelocated());
     sysError("After down phase: relocation_cells = %ld; relocated_cells = %ld",
@@ -3107,7 +3208,7 @@ compact_global(void)
 
   dest = base;
   top = gTop;
-  for(current = gBase; current < top; )
+  for(current = base; current < top; )
   { if ( is_marked(current) )
     { intptr_t l, n;
 
@@ -3146,9 +3247,9 @@ compact_global(void)
     }
   }
 
-  if ( dest != gBase + total_marked )
-    sysError("Mismatch in up phase: dest = %p, gBase+total_marked = %p\n",
-	     dest, gBase + total_marked );
+  if ( dest != base + total_marked )
+    sysError("Mismatch in up phase: dest = %p, base+total_marked = %p\n",
+	     dest, base + total_marked );
 
   DEBUG(CHK_SECURE,
 	{ Word p = dest;		/* clear top of stack */
@@ -3166,6 +3267,10 @@ collect_phase(vm_state *state, Word *saved_bar_at)
 
   DEBUG(CHK_SECURE, check_marked("Start collect"));
 
+  if ( young_base > gBase )		/* see sweep_global_mark() */
+  { sweep_remembered_set(PASS_LD1);
+    ldomark(young_base-1);
+  }
   DEBUG(MSG_GC_PROGRESS, Sdprintf("Sweeping foreign references\n"));
   sweep_foreign();
   DEBUG(MSG_GC_PROGRESS, Sdprintf("Sweeping trail stack\n"));
@@ -3178,6 +3283,8 @@ collect_phase(vm_state *state, Word *saved_bar_at)
   }
   DEBUG(MSG_GC_PROGRESS, Sdprintf("Compacting global stack\n"));
   compact_global();
+  if ( young_base > gBase )
+    unmark(young_base-1);
 
   unsweep_foreign(PASS_LD1);
   unsweep_stacks(state PASS_LD);
@@ -3939,6 +4046,70 @@ gcEnsureSpace(vm_state *state ARG_LD)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+young_generation() decides on the  part  of   the  global  stack that is
+collected and returns its bottom.  The   old generation is the area below
+the youngest choicepoint whose  mark  lies  within   the  data  that was
+already present after the previous collection. Such data is likely to be
+long lived. Collecting only above this mark is safe because:
+
+  - Binding or assigning a cell below the mark of a living choicepoint
+    is trailed above the trail mark of this choicepoint, so the trail
+    holds all references from old to young cells.
+  - Non-backtrackable assignments (nb_setarg/3, nb_setval/2, exceptions)
+    freeze the global stack.  We demand the frozen bar to be below the
+    mark, so the (copied) values of such assignments are old.
+
+We do a full collection on explicit request (garbage_collect/0), after
+GC_MAX_YOUNG young collections, if there is no suitable choicepoint, if
+the young generation is empty or if the  stacks use more than half of
+the stack limit.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define GC_MAX_YOUNG 8			/* Max young collections between full */
+
+static Word
+young_generation(vm_state *state ARG_LD)
+{ LocalFrame fr = state->frame;
+  Choice ch = state->choice;
+  size_t used = usedStack(global) + usedStack(local) + usedStack(trail);
+
+  if ( !truePrologFlag(PLFLAG_GENERATIONAL_GC) ||
+       LD->gc.full_requested ||
+       LD->gc.young_count >= GC_MAX_YOUNG ||
+       LD->gc.old_size == 0 ||
+       used > LD->stacks.limit/2 )
+    return gBase;
+
+  while( fr )
+  { QueryFrame qf;
+
+    for( ; ch; ch = ch->parent )
+    { Word base = ch->mark.globaltop;
+
+      if ( (size_t)((char*)base - (char*)gBase) <= LD->gc.old_size )
+      { if ( base > gBase && base < gTop &&
+	     LD->mark_bar >= base &&
+	     (!LD->frozen_bar || LD->frozen_bar <= base) )
+	{ young_trail = ch->mark.trailtop;
+	  return base;
+	}
+
+	return gBase;
+      }
+    }
+
+    while( fr->parent )
+      fr = fr->parent;
+    qf = queryOfFrame(fr);
+    fr = qf->saved_environment;
+    ch = qf->saved_bfr;
+  }
+
+  return gBase;
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 garbageCollect() returns one of TRUE (ok),   FALSE (blocked or exception
 in printMessage()) or *_OVERFLOW if the   local  stack cannot accomodate
@@ -4013,6 +4184,7 @@ garbageCollect(void)
 
   gc_status.active = TRUE;
 
+  young_base = young_generation(&state PASS_LD);
   if ( (no_mark_bar=(LD->mark_bar == NO_MARK_BAR)) )
     LD->mark_bar = gTop;		/* otherwise we cannot relocate */
 
@@ -4063,10 +4235,17 @@ garbageCollect(void)
   tag_trail(PASS_LD1);
   mark_phase(&state);
   tgar = trailcells_deleted * sizeof(struct trail_entry);
-  ggar = (gTop - gBase - total_marked) * sizeof(word);
+  ggar = (gTop - young_base - total_marked) * sizeof(word);
   gc_status.global_gained += ggar;
   gc_status.trail_gained  += tgar;
   gc_status.collections++;
+  if ( young_base > gBase )
+  { gc_status.young_collections++;
+    gc_status.young_gained += ggar;
+    LD->gc.young_count++;
+  } else
+  { LD->gc.young_count = 0;
+  }
 
   DEBUG(MSG_GC_PROGRESS, Sdprintf("Compacting trail\n"));
   compact_trail();
@@ -4090,6 +4269,11 @@ garbageCollect(void)
 
   t = ThreadCPUTime(LD, CPU_USER) - t;
   gc_status.time += t;
+  if ( young_base > gBase )
+    gc_status.young_time += t;
+  young_base = NULL;
+  LD->gc.old_size = usedStack(global);
+  LD->gc.full_requested = FALSE;
   LD->stacks.global.gced_size = usedStack(global);
   LD->stacks.trail.gced_size  = usedStack(trail);
   gc_status.global_left      += usedStack(global);
@@ -4137,7 +4321,7 @@ garbageCollect(void)
 
 word
 pl_garbage_collect(term_t d)
-{
+{ GET_LD
 #if O_DEBUG
   int ol = GD->debug_level;
   int nl;
@@ -4148,6 +4332,7 @@ pl_garbage_collect(term_t d)
     GD->debug_level = nl;
   }
 #endif
+  LD->gc.full_requested = TRUE;
   garbageCollect();
 #if O_DEBUG
   GD->debug_level = ol;
@@ -4928,6 +5113,31 @@ grow_stacks(size_t l, size_t g, size_t t ARG_LD)
 	    gBase--;
 	  });
 
+#ifdef O_MMAP_STACKS
+    if ( LD->stacks.vm.base )		/* reserved stacks; see pl-setup.c */
+    { if ( resize_vm_stacks(gsize, lsize, tsize, &gb, &lb, &tb PASS_LD) )
+      { if ( g )
+	  LD->shift_status.global_shifts++;
+	if ( l )
+	  LD->shift_status.local_shifts++;
+	if ( t )
+	  LD->shift_status.trail_shifts++;
+      } else
+      { if ( g )
+	  fatal = (Stack)&LD->stacks.global;
+	else if ( l )
+	  fatal = (Stack)&LD->stacks.local;
+	else
+	  fatal = (Stack)&LD->stacks.trail;
+
+	gsize = sizeStack(global);
+	lsize = sizeStack(local);
+	tsize = sizeStack(trail);
+      }
+      t = g = l = FALSE;		/* done */
+    }
+#endif
+
     if ( t )
     { void *nw;
 
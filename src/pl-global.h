@@ -69,6 +69,7 @@ typedef struct
     code virgin[3];			/* S_VIRGIN */
     code undef[3];			/* S_UNDEF */
     code dynamic[3];			/* S_DYNAMIC */
+    code incr_dynamic[3];		/* S_INCR_DYNAMIC */
     code thread_local[3];		/* S_THREAD_LOCAL */
     code multifile[3];			/* S_MULTIFILE */
     code staticp[3];			/* S_STATIC */
@@ -148,6 +149,7 @@ struct PL_global_data
     struct
     { int	created;		/* # created hash tables */
       int	destroyed;		/* # destroyed hash tables */
+      int	background;		/* # created by the index builder */
     } indexes;
 #ifdef O_PLMT
     int		threads_created;	/* # threads created */
@@ -179,6 +181,7 @@ struct PL_global_data
 
   struct
   { ArithF     *functions;		/* index --> function */
+    ArithFloatF *float_functions;	/* index --> float kernel */
     size_t	functions_allocated;	/* Size of above array */
   } arith;
 
@@ -201,6 +204,10 @@ struct PL_global_data
     int64_t	collected;		/* # collected atoms */
     size_t	unregistered;		/* # candidate GC atoms */
     double	gc_time;		/* Time spent on atom-gc */
+    double	mark_time;		/* Wall time marking atoms */
+    double	sweep_time;		/* Wall time sweeping atoms */
+    double	max_pause;		/* Longest thread pause by atom-gc */
+    int		mark_generation;	/* Current atom-gc marking round */
     PL_agc_hook_t gc_hook;		/* Current hook */
 #endif
     atom_t     *for_code[256];		/* code --> one-char-atom */
@@ -211,6 +218,12 @@ struct PL_global_data
   { Table	breakpoints;		/* Breakpoint table */
   } comp;
 
+  struct
+  { struct trie *variant_table;		/* Shared variant --> table */
+    trie_allocation_pool node_pool;	/* Node allocation pool for tries */
+    int		active;			/* # shared tables being computed */
+  } tabling;
+
   struct
   { ExtensionCell _ext_head;		/* head of registered extensions */
     ExtensionCell _ext_tail;		/* tail of this chain */
@@ -357,7 +370,21 @@ struct PL_global_data
     struct
     { pthread_mutex_t	mutex;
       pthread_cond_t	cond;
+      struct index_job *jobs;		/* Queued background index builds */
+      Definition	building;	/* Predicate indexed in background */
+      gen_t		generation;	/* Generation of the build */
+      size_t		background_min;	/* Flag jiti_background */
+      pthread_t		worker;		/* Background index builder */
+      int		worker_state;	/* IDX_WORKER_* */
     } index;
+    struct
+    { pthread_mutex_t	mutex;		/* Guards shared variant table */
+      pthread_cond_t	cond;		/* Signalled on shared completion */
+    } tabling;
+    struct
+    { pthread_mutex_t	mutex;		/* Guards atom-gc marking round */
+      pthread_cond_t	cond;		/* Signalled if a thread marked */
+    } agc;
   } thread;
 #endif /*O_PLMT*/
 
@@ -507,9 +534,16 @@ struct PL_local_data
     double	time_at_last_tick;	/* Time at last statistics tick */
     double	time_at_start;		/* Time at last start */
     double	time;			/* recorded CPU time */
+#ifdef O_PLMT
+    unsigned int sample_pending;	/* Sampler ticks not yet recorded */
+#endif
   } profile;
 #endif /* O_PROFILE */
 
+#ifdef O_VMI_STATISTICS
+  struct vmi_statistics *vmi_statistics; /* VMI counters (pl-vmstat.c) */
+#endif
+
   struct
   { Module	typein;			/* module for type in goals */
     Module	source;			/* module we are reading clauses in */
@@ -518,6 +552,12 @@ struct PL_local_data
   struct
   { intptr_t	generator;		/* See PL_atom_generator() */
     atom_t	unregistering;		/* See PL_unregister_atom() */
+#ifdef O_ATOMGC
+    int		mark_request;		/* Atom-gc round that asked us to mark */
+    int		marked;			/* Last atom-gc round we marked */
+    int64_t	mark_inferences;	/* Inferences when asked to mark */
+    double	mark_pause;		/* Time it took to mark our stacks */
+#endif
   } atoms;
 
   struct
@@ -556,6 +596,7 @@ struct PL_local_data
   { struct tbl_component *component;    /* active component */
     struct trie *variant_table;		/* Variant --> table */
     trie_allocation_pool node_pool;	/* Node allocation pool for tries */
+    struct trie *shared_wait;		/* Shared table we are waiting for */
     int	has_scheduling_component;	/* A leader was created */
   } tabling;
 
@@ -675,6 +716,11 @@ struct PL_local_data
     sigset_t saved_sigmask;		/* Saved signal mask */
     int64_t inferences;			/* #inferences at last GC */
     pl_gc_status_t	status;		/* Garbage collection status */
+    Word _young_base;			/* Bottom of the collected area */
+    TrailEntry _young_trail;		/* Remembered set starts here */
+    size_t old_size;			/* Global stack in use after last GC */
+    int young_count;			/* Young collections since full GC */
+    int full_requested;			/* Next GC must be a full one */
 #ifdef O_CALL_RESIDUE
     int			marked_attvars;	/* do not GC attvars */
 #endif
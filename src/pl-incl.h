@@ -145,6 +145,9 @@ handy for it someone wants to add a data type to the system.
       Use GNU gmp library for infinite precision arthmetic
   O_MITIGATE_SPECTRE
       Reduce spectre security risc.  Currently reduces timer resolution.
+  O_MMAP_STACKS
+      Reserve address space for the Prolog stacks using mmap() such
+      that growing the stacks does not move them.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 #define O_COMPILE_OR		1
@@ -182,6 +185,9 @@ handy for it someone wants to add a data type to the system.
 #ifdef HAVE_GMP_H
 #define O_GMP			1
 #endif
+#if defined(HAVE_MMAP) && SIZEOF_VOIDP == 8 && !defined(__WINDOWS__)
+#define O_MMAP_STACKS		1
+#endif
 #ifdef __WINDOWS__
 #define NOTTYCONTROL           TRUE
 #define O_DDE 1
@@ -667,6 +673,7 @@ typedef code *			Code;		/* pointer to byte codes */
 typedef int			Char;		/* char that can pass EOF */
 typedef word			(*Func)();	/* foreign functions */
 typedef int			(*ArithF)();	/* arithmetic function */
+typedef double			(*ArithFloatF)(double); /* float kernel */
 
 typedef struct atom *		Atom;		/* atom */
 typedef struct functor *	Functor;	/* complex term */
@@ -836,6 +843,7 @@ with one operation, it turns out to be faster as well.
 
 /* Flags on predicates (packed in unsigned int */
 
+#define P_INCREMENTAL		(0x00000001) /* Incremental tabling dependency */
 #define P_CLAUSABLE		(0x00000002) /* Clause/2 always works */
 #define P_QUASI_QUOTATION_SYNTAX (0x00000004) /* {|Type||Quasi Quote|} */
 #define P_NON_TERMINAL		(0x00000008) /* Grammar rule (Name//Arity) */
@@ -1369,6 +1377,7 @@ struct clause_bucket
 #define MAXINDEXARG    254
 #define MAXINDEXDEPTH    7
 #define END_INDEX_POS  255
+#define JITI_BACKGROUND_MIN 100000	/* default for flag jiti_background */
 
 typedef unsigned char iarg_t;		/* index argument */
 
@@ -1405,8 +1414,11 @@ struct definition
   } impl;
   unsigned int  flags;			/* booleans (P_*) */
   unsigned int  shared;			/* #procedures sharing this def */
+  unsigned int  bg_indexing;		/* Background index job pending */
   struct linger_list  *lingering;	/* Assocated lingering objects */
+  struct ordered_index *ordered;	/* Ordered (range) indexes */
   gen_t		last_modified;		/* Generation I was last modified */
+  struct idg_node *tabling;		/* Incremental dependency graph node */
 #ifdef O_PROF_PENTIUM
   int		prof_index;		/* index in profiling */
   char	       *prof_name;		/* name in profiling */
@@ -1919,6 +1931,12 @@ typedef struct
 #endif
 #define SIG_CLAUSE_GC	  (SIG_PROLOG_OFFSET+3)
 #define SIG_PLABORT	  (SIG_PROLOG_OFFSET+4)
+#if defined(O_ATOMGC) && defined(O_PLMT)
+#define SIG_ATOM_MARK	  (SIG_PROLOG_OFFSET+5)
+#endif
+#if defined(O_PROFILE) && defined(O_PLMT)
+#define SIG_PROF_SAMPLE	  (SIG_PROLOG_OFFSET+6)
+#endif
 
 
 		 /*******************************
@@ -1993,6 +2011,13 @@ typedef struct
   struct STACK(Word)	   global;	/* local (environment) stack */
   struct STACK(TrailEntry) trail;	/* trail stack */
   struct STACK(Word *)	   argument;	/* argument stack */
+#ifdef O_MMAP_STACKS
+  struct
+  { char   *base;			/* Reserved address space (or NULL) */
+    size_t  size;			/* Size of each region */
+    size_t  committed[3];		/* Committed global, local, trail */
+  } vm;					/* See allocStacks() */
+#endif
 } pl_stacks_t;
 
 #define tBase	(LD->stacks.trail.base)
@@ -2193,6 +2218,9 @@ typedef struct
   int64_t	global_left;		/* global stack bytes left after GC */
   int64_t	trail_left;		/* trail stack bytes left after GC */
   double	time;			/* time spent in collections */
+  long		young_collections;	/* # young generation collections */
+  int64_t	young_gained;		/* global bytes collected by these */
+  double	young_time;		/* time spent in young collections */
 } pl_gc_status_t;
 
 
@@ -2347,6 +2375,7 @@ typedef struct debuginfo
 #define PLFLAG_ERROR_AMBIGUOUS_STREAM_PAIR 0x04000000
 #define PLFLAG_GCTHREAD		    0x08000000 /* Do atom/clause GC in a thread */
 #define PLFLAG_MITIGATE_SPECTRE	    0x10000000 /* Mitigate spectre attacks */
+#define PLFLAG_GENERATIONAL_GC	    0x20000000 /* Collect young generation */
 
 typedef struct
 { unsigned int flags;		/* Fast access to some boolean Prolog flags */
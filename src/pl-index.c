@@ -104,6 +104,11 @@ static Code	skipToTerm(Clause clause, const iarg_t *position);
 static void	unalloc_index_array(void *p);
 static void	wait_for_index(const ClauseIndex ci);
 static void	completed_index(ClauseIndex ci);
+#ifdef O_PLMT
+static int	queueIndexJob(Definition def, hash_hints *hints);
+#endif
+static void	addClauseToOrderedIndexes(Definition def, Clause cl);
+static void	deleteClauseFromOrderedIndexes(Definition def);
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Compute the index in the hash-array from   a machine word and the number
@@ -399,6 +404,10 @@ iargsName(const iarg_t args[MAX_MULTI_INDEX], char *buf)
 firstClause() finds the first applicable   clause  and leave information
 for finding the next clause in chp.
 
+Indexes that are incomplete  (being  filled   by  another  thread)  are
+ignored, i.e., we never wait for an index  to become available but use
+the access path we would have used without it.
+
 TBD:
   - non-indexable predicates must use a different supervisor
   - Predicates needing reindexing should use a different supervisor
@@ -421,7 +430,6 @@ first_clause_guarded(Word argv, size_t argc, ClauseList clist,
   if ( unlikely(argc > MAXINDEXARG) )
     argc = MAXINDEXARG;
 
-retry:
   if ( (cip=clist->clause_indexes) )
   { ClauseIndex best_index = NULL;
 
@@ -429,7 +437,7 @@ retry:
     { ClauseIndex ci = *cip;
       word k;
 
-      if ( ISDEADCI(ci) )
+      if ( ISDEADCI(ci) || ci->incomplete )
 	continue;
 
       if ( (k=indexKeyFromArgv(ci, argv PASS_LD)) )
@@ -458,7 +466,8 @@ retry:
 				  PL_thread_self(),
 				  iargsName(hints.args, NULL)));
 
-	  if ( (ci=hashDefinition(clist, &hints, ctx)) )
+	  if ( (ci=hashDefinition(clist, &hints, ctx)) &&
+	       !ci->incomplete )
 	  { chp->key = indexKeyFromArgv(ci, argv PASS_LD);
 	    assert(chp->key);
 	    best_index = ci;
@@ -466,11 +475,6 @@ retry:
 	}
       }
 
-      if ( best_index->incomplete )
-      { wait_for_index(best_index);
-	goto retry;
-      }
-
       hi = hashIndex(chp->key, best_index->buckets);
       chp->cref = best_index->entries[hi].head;
       return nextClauseFromBucket(best_index, argv, ctx PASS_LD);
@@ -497,12 +501,10 @@ retry:
        bestHash(argv, argc, clist, 0.0, &hints, ctx PASS_LD) )
   { ClauseIndex ci;
 
-    if ( (ci=hashDefinition(clist, &hints, ctx)) )
+    if ( (ci=hashDefinition(clist, &hints, ctx)) &&
+	 !ci->incomplete )
     { int hi;
 
-      while ( ci->incomplete )
-	wait_for_index(ci);
-
       chp->key = indexKeyFromArgv(ci, argv PASS_LD);
       assert(chp->key);
       hi = hashIndex(chp->key, ci->buckets);
@@ -1380,6 +1382,8 @@ deleteActiveClauseFromIndexes(Definition def, Clause cl)
 { ClauseIndex *cip;
 
   shrunkpow2(def);
+  if ( def->ordered )
+    deleteClauseFromOrderedIndexes(def);
 
   if ( (cip=def->impl.clauses.clause_indexes) )
   { for(; *cip; cip++)
@@ -1485,6 +1489,8 @@ the definition locked.
 int
 addClauseToIndexes(Definition def, Clause clause, ClauseRef where)
 { addClauseToListIndexes(def, &def->impl.clauses, clause, where);
+  if ( def->ordered )
+    addClauseToOrderedIndexes(def, clause);
   reconsider_index(def);
 
   DEBUG(CHK_SECURE, checkDefinition(def));
@@ -1492,6 +1498,59 @@ addClauseToIndexes(Definition def, Clause clause, ClauseRef where)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+addClausesToIndexes() is the batch  version   of  addClauseToIndexes(),
+called by assertProcedures() after count   clauses  have been added to
+the clause list. An index that would have  to be resized while adding
+the batch is deleted once, so the next call creates it with the right
+size over all clauses instead of resizing it halfway.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+addClausesToIndexes(Definition def, Clause *clauses, size_t count,
+		    ClauseRef where)
+{ ClauseList cl = &def->impl.clauses;
+  ClauseIndex *cip;
+  size_t i;
+
+  if ( (cip=cl->clause_indexes) )
+  { for(; *cip; cip++)
+    { ClauseIndex ci = *cip;
+
+      if ( ISDEADCI(ci) )
+	continue;
+
+      while ( ci->incomplete )
+	wait_for_index(ci);
+
+      if ( ci->size + count >= ci->resize_above )
+      { deleteIndexP(def, cl, cip);
+      } else
+      { for(i=0; i<count; i++)
+	  addClauseToIndex(ci, clauses[i], where);
+      }
+    }
+  }
+
+  if ( def->ordered )
+  { for(i=0; i<count; i++)
+      addClauseToOrderedIndexes(def, clauses[i]);
+  }
+
+  if ( true(def, P_DYNAMIC) )		/* see reconsider_index() */
+  { size_t nc = cl->number_of_clauses;
+    size_t oc = nc - count;
+
+    if ( nc > 0 && (oc == 0 || MSB(nc) != MSB(oc)) )
+    { clear(def, P_SHRUNKPOW2);
+      clearTriedIndexes(def);
+    }
+  }
+
+  DEBUG(CHK_SECURE, checkDefinition(def));
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 Called from unlinkClause(), which is called for retracting a clause from
 a dynamic predicate which is not  referenced   and  has  few clauses. In
@@ -1565,13 +1624,61 @@ Create a hash-index on def  for  arg.   We  compute  the  hash unlocked,
 checking at the end that nobody  messed   with  the clause list. If that
 happened anyway, we retry. At the end,   we  lock the definition and add
 the new index to the indexes of the predicate.
+
+If the clause list is large, the  index   is  not  created by the caller
+but handed to the background index builder (see below) and this function
+returns NULL. The caller must then  use   the  access path it would have
+used without the new index.
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
 static ClauseIndex
-hashDefinition(ClauseList clist, hash_hints *hints, IndexContext ctx)
+existingIndex(ClauseList clist, const iarg_t *args)
+{ ClauseIndex *cip;
+
+  if ( (cip=clist->clause_indexes) )
+  { for(; *cip; cip++)
+    { ClauseIndex cio = *cip;
+
+      if ( ISDEADCI(cio) )
+	continue;
+
+      if ( memcmp(cio->args, args, sizeof(cio->args)) == 0 )
+	return cio;
+    }
+  }
+
+  return NULL;
+}
+
+
+/* Predicate must be locked.  Unlocks it */
+
+static ClauseIndex
+fillIndex(ClauseList clist, hash_hints *hints, IndexContext ctx)
 { ClauseRef cref;
   ClauseIndex ci;
-  ClauseIndex *cip;
+
+  ci = newClauseIndexTable(hints->args, hints, ctx);
+  insertIndex(ctx->predicate, clist, ci);
+  UNLOCKDEF(ctx->predicate);
+
+  for(cref = clist->first_clause; cref; cref = cref->next)
+  { if ( false(cref->value.clause, CL_ERASED) )
+      addClauseToIndex(ci, cref->value.clause, CL_END);
+  }
+
+  ci->resize_above = ci->size*2;
+  ci->resize_below = ci->size/4;
+
+  completed_index(ci);
+
+  return ci;
+}
+
+
+static ClauseIndex
+hashDefinition(ClauseList clist, hash_hints *hints, IndexContext ctx)
+{ ClauseIndex ci;
 
   DEBUG(MSG_JIT, Sdprintf("[%d] hashDefinition(%s, %s, %d) (%s)\n",
 			  PL_thread_self(),
@@ -1586,39 +1693,352 @@ hashDefinition(ClauseList clist, hash_hints *hints, IndexContext ctx)
 #endif
 
   canonicalHap(hints->args);
+#ifdef O_PLMT
+  if ( ctx->depth == 0 && ctx->predicate->bg_indexing )
+    return NULL;			/* being built; do not lock */
+#endif
   LOCKDEF(ctx->predicate);
-  if ( (cip=clist->clause_indexes) )
-  { for(; *cip; cip++)
-    { ClauseIndex cio = *cip;
+  if ( (ci=existingIndex(clist, hints->args)) )
+  { UNLOCKDEF(ctx->predicate);
+    DEBUG(MSG_JIT, Sdprintf("[%d] already created\n", PL_thread_self()));
+    return ci;
+  }
+#ifdef O_PLMT
+  if ( ctx->depth == 0 &&
+       ( ctx->predicate->bg_indexing ||
+	 ( GD->thread.index.background_min &&
+	   clist->number_of_clauses >= GD->thread.index.background_min &&
+	   queueIndexJob(ctx->predicate, hints) ) ) )
+  { UNLOCKDEF(ctx->predicate);
+    return NULL;
+  }
+#endif
 
-      if ( ISDEADCI(cio) )
-	continue;
+  return fillIndex(clist, hints, ctx);
+}
 
-      if ( memcmp(cio->args, hints->args, sizeof(cio->args)) == 0 )
-      { UNLOCKDEF(ctx->predicate);
-	DEBUG(MSG_JIT, Sdprintf("[%d] already created\n", PL_thread_self()));
-	return cio;
-      }
-    }
+
+#ifdef O_PLMT
+
+		 /*******************************
+		 *     BACKGROUND INDEXING	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Creating an index for  a  predicate  with   millions  of  clauses  takes
+seconds. Doing so in the thread that  needs   the  index is fine, but if
+other threads call the predicate  while  the   index  is  incomplete they
+would have to wait  for  it.  Therefore   indexes  for  clause  lists of
+at least `jiti_background` clauses are   created  by a dedicated (native)
+thread. Callers continue using the   existing,  less selective, access
+path until the index is ready.
+
+The builder creates the  index  without   the  predicate  lock  and *not*
+linked to the predicate. As  the  builder   does  not  see the updates
+that  happen  meanwhile,  it  verifies  under   the  lock  that  only
+clauses were added to the end. It  adds these to the index and installs
+it using insertIndex(), which makes the index   visible  to all threads
+at once. Any other change  (asserta/1,   retract,  clause  GC, reload)
+is detected by comparing the first clause,  the number of (erased)
+clauses and the clause GC count. In that   case the index is discarded
+and created the old way: it is inserted as incomplete and then filled.
+In that case new callers ignore  the   incomplete  index, while updates
+to the clause list wait for it.
+
+From queueing the job until it  is   finished  the predicate is flagged
+`bg_indexing`. As long as this flag  is   set,  hashDefinition() on the
+predicate returns NULL without taking any  lock, so callers keep using
+their old access path at full speed.
+
+The builder plays the role of a   thread  that acquired the predicate.
+Under GD->thread.index.mutex  it  publishes  the   predicate  and  the
+generation at which the build started. predicates_in_use() reports the
+predicate, which keeps the clause references   we walk alive, and clause
+GC marks the generation using markIndexBuilder(),  which keeps it from
+removing clauses erased after the build started.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define IDX_WORKER_NONE    0		/* Not started */
+#define IDX_WORKER_RUNNING 1		/* Processing jobs */
+#define IDX_WORKER_STOP    2		/* Asked to stop */
+
+#define IDX_BG_RETRIES     2		/* Retries for a changed clause list */
+#define IDX_BG_CHECK	   4096		/* Check for stop every N clauses */
+
+typedef struct index_job
+{ Definition	    predicate;		/* Predicate to index */
+  hash_hints	    hints;		/* Index to create */
+  int		    retries;		/* # times the clause list changed */
+  struct index_job *next;		/* Next in queue */
+} index_job;
+
+static void *indexWorker(void *closure);
+
+/* Called with the predicate locked and no job pending for it.  Lock
+   order is L_PREDICATE, then GD->thread.index.mutex.
+*/
+
+static int
+queueIndexJob(Definition def, hash_hints *hints)
+{ index_job *job, **jp;
+  int rc = TRUE;
+
+  if ( GD->bootsession || GD->cleaning != CLN_NORMAL )
+    return FALSE;
+
+  pthread_mutex_lock(&GD->thread.index.mutex);
+  if ( GD->thread.index.worker_state == IDX_WORKER_NONE )
+  { pthread_attr_t attr;
+
+    pthread_attr_init(&attr);
+    if ( pthread_create(&GD->thread.index.worker, &attr,
+			indexWorker, NULL) == 0 )
+      GD->thread.index.worker_state = IDX_WORKER_RUNNING;
+    pthread_attr_destroy(&attr);
+  }
+  if ( GD->thread.index.worker_state != IDX_WORKER_RUNNING )
+  { rc = FALSE;
+    goto out;
   }
-  ci = newClauseIndexTable(hints->args, hints, ctx);
-  insertIndex(ctx->predicate, clist, ci);
-  UNLOCKDEF(ctx->predicate);
 
-  for(cref = clist->first_clause; cref; cref = cref->next)
+  for(jp = &GD->thread.index.jobs; *jp; jp = &(*jp)->next)
+    ;
+
+  job = allocHeapOrHalt(sizeof(*job));
+  memset(job, 0, sizeof(*job));
+  job->predicate = def;
+  job->hints     = *hints;
+  *jp = job;
+  def->bg_indexing = TRUE;
+  pthread_cond_broadcast(&GD->thread.index.cond);
+  DEBUG(MSG_JIT, Sdprintf("[%d] queued index %s for %s\n",
+			  PL_thread_self(),
+			  iargsName(hints->args, NULL),
+			  predicateName(def)));
+
+out:
+  pthread_mutex_unlock(&GD->thread.index.mutex);
+
+  return rc;
+}
+
+
+static int
+bg_index_stop(void)
+{ return GD->thread.index.worker_state != IDX_WORKER_RUNNING;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Build an index for job. Returns TRUE if the job is completed and FALSE if
+the clause list changed while building.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+buildIndexBackground(index_job *job)
+{ Definition def = job->predicate;
+  ClauseList clist = &def->impl.clauses;
+  hash_hints *hints = &job->hints;
+  index_context ctx;
+  ClauseRef first, last = NULL, cref;
+  unsigned int erased;
+  int64_t cgc_count;
+  size_t seen = 0;
+  ClauseIndex ci;
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.predicate   = def;
+  ctx.position[0] = END_INDEX_POS;
+
+  LOCKDEF(def);
+  if ( existingIndex(clist, hints->args) ||
+       !(first = clist->first_clause) )
+  { def->bg_indexing = FALSE;
+    UNLOCKDEF(def);
+    return TRUE;
+  }
+  if ( job->retries > IDX_BG_RETRIES )
+  { DEBUG(MSG_JIT, Sdprintf("Creating index for %s in place\n",
+			    predicateName(def)));
+    def->bg_indexing = FALSE;
+    fillIndex(clist, hints, &ctx);
+    return TRUE;
+  }
+  erased = clist->erased_clauses;
+  cgc_count = GD->clauses.cgc_count;
+  UNLOCKDEF(def);
+
+  ci = newClauseIndexTable(hints->args, hints, &ctx);
+  for(cref = first; cref; cref = cref->next)
   { if ( false(cref->value.clause, CL_ERASED) )
       addClauseToIndex(ci, cref->value.clause, CL_END);
+    last = cref;
+    if ( ++seen % IDX_BG_CHECK == 0 && bg_index_stop() )
+    { unallocClauseIndexTable(ci);
+      return TRUE;
+    }
+  }
+
+  LOCKDEF(def);
+  if ( clist->first_clause == first &&
+       clist->erased_clauses == erased &&
+       GD->clauses.cgc_count == cgc_count &&
+       !GD->clauses.cgc_active &&
+       !existingIndex(clist, hints->args) )
+  { for(cref = last->next; cref; cref = cref->next)
+    { if ( false(cref->value.clause, CL_ERASED) )
+	addClauseToIndex(ci, cref->value.clause, CL_END);
+      seen++;
+    }
+
+    if ( seen == (size_t)clist->number_of_clauses + clist->erased_clauses )
+    { ci->resize_above = ci->size*2;
+      ci->resize_below = ci->size/4;
+      ci->incomplete   = FALSE;
+      insertIndex(def, clist, ci);
+      def->bg_indexing = FALSE;
+      UNLOCKDEF(def);
+      ATOMIC_INC(&GD->statistics.indexes.background);
+      DEBUG(MSG_JIT, Sdprintf("Installed background index %s for %s\n",
+			      iargsName(hints->args, NULL),
+			      predicateName(def)));
+      return TRUE;
+    }
+  }
+  UNLOCKDEF(def);
+
+  DEBUG(MSG_JIT, Sdprintf("Clauses of %s changed while indexing\n",
+			  predicateName(def)));
+  unallocClauseIndexTable(ci);
+  job->retries++;
+
+  return FALSE;
+}
+
+
+static void *
+indexWorker(void *closure)
+{ (void)closure;
+
+#ifdef HAVE_SIGPROCMASK
+{ sigset_t set;
+  allSignalMask(&set);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+}
+#endif
+  set_os_thread_name_from_charp("index");
+
+  pthread_mutex_lock(&GD->thread.index.mutex);
+  while ( GD->thread.index.worker_state == IDX_WORKER_RUNNING )
+  { index_job *job;
+
+    if ( !(job=GD->thread.index.jobs) )
+    { pthread_cond_wait(&GD->thread.index.cond, &GD->thread.index.mutex);
+      continue;
+    }
+
+    GD->thread.index.jobs       = job->next;
+    GD->thread.index.building   = job->predicate;
+    GD->thread.index.generation = global_generation();
+    pthread_mutex_unlock(&GD->thread.index.mutex);
+
+    if ( buildIndexBackground(job) || bg_index_stop() )
+    { freeHeap(job, sizeof(*job));
+      job = NULL;
+    }
+
+    pthread_mutex_lock(&GD->thread.index.mutex);
+    GD->thread.index.building = NULL;
+    if ( job )				/* retry at the end of the queue */
+    { index_job **jp;
+
+      for(jp = &GD->thread.index.jobs; *jp; jp = &(*jp)->next)
+	;
+      job->next = NULL;
+      *jp = job;
+    }
+    pthread_cond_broadcast(&GD->thread.index.cond);
   }
+  pthread_mutex_unlock(&GD->thread.index.mutex);
 
-  ci->resize_above = ci->size*2;
-  ci->resize_below = ci->size/4;
+  return NULL;
+}
 
-  completed_index(ci);
 
-  return ci;
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+cancelIndexJobs() is called  before  def  is   destroyed.  It  removes
+pending jobs for def and waits if def is being indexed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+cancelIndexJobs(Definition def)
+{ index_job **jp;
+
+  if ( GD->thread.index.worker_state == IDX_WORKER_NONE )
+    return;
+
+  pthread_mutex_lock(&GD->thread.index.mutex);
+  for(jp = &GD->thread.index.jobs; *jp; )
+  { index_job *job = *jp;
+
+    if ( job->predicate == def )
+    { *jp = job->next;
+      freeHeap(job, sizeof(*job));
+    } else
+      jp = &job->next;
+  }
+  while ( GD->thread.index.building == def )
+    pthread_cond_wait(&GD->thread.index.cond, &GD->thread.index.mutex);
+  pthread_mutex_unlock(&GD->thread.index.mutex);
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+markIndexBuilder() is called by clause  GC   after  marking the Prolog
+threads. It marks the predicate  being   indexed  in the background at
+the generation at which the build started.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+markIndexBuilder(ARG1_LD)
+{ pthread_mutex_lock(&GD->thread.index.mutex);
+  if ( GD->thread.index.building )
+    cgcActivatePredicate__LD(GD->thread.index.building,
+			     GD->thread.index.generation PASS_LD);
+  pthread_mutex_unlock(&GD->thread.index.mutex);
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+stopIndexWorker() is called on halt.   It   stops  the builder, waiting
+for it to abandon the current job, and discards the pending jobs.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+stopIndexWorker(void)
+{ index_job *job, *next;
+
+  pthread_mutex_lock(&GD->thread.index.mutex);
+  if ( GD->thread.index.worker_state != IDX_WORKER_RUNNING )
+  { pthread_mutex_unlock(&GD->thread.index.mutex);
+    return;
+  }
+  GD->thread.index.worker_state = IDX_WORKER_STOP;
+  pthread_cond_broadcast(&GD->thread.index.cond);
+  pthread_mutex_unlock(&GD->thread.index.mutex);
+
+  pthread_join(GD->thread.index.worker, NULL);
+
+  for(job = GD->thread.index.jobs; job; job = next)
+  { next = job->next;
+    freeHeap(job, sizeof(*job));
+  }
+  GD->thread.index.jobs = NULL;
+}
+
+#endif /*O_PLMT*/
+
+
 static ClauseIndex *
 copyIndex(ClauseIndex *org, int extra)
 { ClauseIndex *ncip;
@@ -2583,6 +3003,580 @@ bestHash(Word av, size_t ac, ClauseList clist, float min_speedup,
 }
 
 
+		 /*******************************
+		 *	  ORDERED INDEXES	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+An ordered index supports range queries  (clause_range/4) on an argument
+that holds numbers or atoms. It is  created   on  the first range query
+on the argument and consists of two   sorted  arrays of (key, clause)
+pairs: a large `main` run and a  small `recent` run.
+
+Keys are ordered as in the standard order   of terms, except that numbers
+are compared as doubles. The index  thus   selects  a superset of clauses
+that may be in range and the caller  verifies the actual argument. Clauses
+where the argument is not indexable   (variable, big integer) are always
+candidates and kept in `others`. Clauses  where the argument is a string
+or compound are never in the range of two numbers or atoms and are not
+indexed at all.
+
+The index holds a reference (cl->references)  to each clause, so clauses
+are not reclaimed while in the index. Clauses  added to the predicate are
+appended by addClauseToIndexes() to the   unsorted  `pending` run. The
+next range query sorts these and merges them   into `recent`. If recent
+grows beyond 1/16th of main it is merged into main, which keeps the cost
+of adding clauses amortized constant.  Erased   clauses  remain  in the
+index until they make up half of it, after which they are purged.
+
+All administration is protected by LOCKDEF().   A query collects the
+candidate clauses with the  predicate  locked,   adds  a  reference to
+them and builds the result  list  after   unlocking.  The costly sort of
+the pending clauses is done outside the lock while `merging` is set,
+which makes other queries on this index wait.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define OK_NUMBER 0			/* Key is a number */
+#define OK_ATOM   1			/* Key is an atom */
+#define OK_OTHER  2			/* Always a candidate */
+#define OK_NONE   3			/* Never a candidate */
+
+typedef union ordered_value
+{ double	f;			/* OK_NUMBER */
+  atom_t	a;			/* OK_ATOM */
+} ordered_value;
+
+typedef struct ordered_key
+{ ordered_value	v;			/* Key value */
+  unsigned int	type;			/* OK_* */
+} ordered_key;
+
+typedef struct ordered_entry
+{ ordered_value	v;			/* Key value */
+  Clause	clause;			/* Clause with this key */
+  unsigned int	type;			/* OK_* */
+  unsigned int	seq;			/* Keep clause order for equal keys */
+} ordered_entry;
+
+typedef struct ordered_run
+{ size_t	count;			/* # entries */
+  size_t	allocated;		/* Allocated entries */
+  ordered_entry *entries;		/* The entries */
+} ordered_run;
+
+typedef struct ordered_index
+{ struct ordered_index *next;		/* Next index of the predicate */
+  unsigned int	arg;			/* Indexed argument (1-based) */
+  unsigned int	seq;			/* Sequence number generator */
+  unsigned	merging : 1;		/* Sorting pending clauses */
+  size_t	erased;			/* # erased since last purge */
+  ordered_run	main;			/* Bulk of the sorted entries */
+  ordered_run	recent;			/* Recently merged sorted entries */
+  ordered_run	pending;		/* Unsorted entries */
+  size_t	nothers;		/* # always-candidate clauses */
+  size_t	oallocated;		/* Allocated others */
+  Clause       *others;			/* Always-candidate clauses */
+} ordered_index;
+
+
+static int
+orderedKeyFromClause(Clause cl, unsigned int arg, ordered_entry *e)
+{ Code PC = cl->codes;
+
+  if ( arg > 1 )
+    PC = skipArgs(PC, arg-1);
+
+  for(;;)
+  { code c = decode(*PC++);
+
+#if O_DEBUGGER
+  again:
+#endif
+    switch(c)
+    { case H_ATOM:
+	e->v.a = (atom_t)*PC;
+	return e->type = OK_ATOM;
+      case H_NIL:
+	e->v.a = ATOM_nil;
+	return e->type = OK_ATOM;
+      case H_SMALLINT:
+	e->v.f = (double)valInt((word)*PC);
+	return e->type = OK_NUMBER;
+#if SIZEOF_VOIDP == 4
+      case H_INT64:
+      { int64_t val;
+
+	memcpy(&val, PC, sizeof(val));
+	e->v.f = (double)val;
+	return e->type = OK_NUMBER;
+      }
+#endif
+      case H_INTEGER:
+	e->v.f = (double)(intptr_t)*PC;
+	return e->type = OK_NUMBER;
+      case H_FLOAT:
+	memcpy(&e->v.f, PC, sizeof(double));
+	return e->type = OK_NUMBER;
+      case H_FUNCTOR:
+      case H_RFUNCTOR:
+      case H_LIST:
+      case H_RLIST:
+      case H_LIST_FF:
+      case H_STRING:
+	return e->type = OK_NONE;
+      case I_NOP:
+	continue;
+#ifdef O_DEBUGGER
+      case D_BREAK:
+	c = decode(replacedBreak(PC-1));
+	goto again;
+#endif
+      default:				/* variables, H_MPZ */
+	return e->type = OK_OTHER;
+    }
+  }
+}
+
+
+static int
+compare_ordered_key(const ordered_entry *e, const ordered_key *k)
+{ if ( e->type != k->type )
+    return e->type < k->type ? CMP_LESS : CMP_GREATER;
+  if ( e->type == OK_NUMBER )
+    return e->v.f < k->v.f ? CMP_LESS : e->v.f == k->v.f ? CMP_EQUAL
+							 : CMP_GREATER;
+  return e->v.a == k->v.a ? CMP_EQUAL : compareAtoms(e->v.a, k->v.a);
+}
+
+
+static int
+compare_ordered_entries(const void *p1, const void *p2)
+{ const ordered_entry *e1 = p1;
+  const ordered_entry *e2 = p2;
+  ordered_key k;
+  int rc;
+
+  k.type = e2->type;
+  k.v    = e2->v;
+  if ( (rc=compare_ordered_key(e1, &k)) != CMP_EQUAL )
+    return rc;
+
+  return e1->seq < e2->seq ? CMP_LESS : CMP_GREATER;
+}
+
+
+static void
+reserveOrderedRun(ordered_run *run, size_t extra)
+{ if ( run->count+extra > run->allocated )
+  { size_t na = run->allocated ? run->allocated*2 : 16;
+    ordered_entry *ne;
+
+    while ( na < run->count+extra )
+      na *= 2;
+    ne = allocHeapOrHalt(na*sizeof(*ne));
+    if ( run->count )
+      memcpy(ne, run->entries, run->count*sizeof(*ne));
+    if ( run->entries )
+      freeHeap(run->entries, run->allocated*sizeof(*ne));
+    run->entries   = ne;
+    run->allocated = na;
+  }
+}
+
+
+static void
+freeOrderedRun(ordered_run *run)
+{ size_t i;
+
+  for(i=0; i<run->count; i++)
+    releaseClause(run->entries[i].clause);
+  if ( run->entries )
+    freeHeap(run->entries, run->allocated*sizeof(*run->entries));
+  memset(run, 0, sizeof(*run));
+}
+
+
+/* Merge the sorted entries `add` into `run`, working from the end */
+
+static void
+mergeOrderedRun(ordered_run *run, const ordered_entry *add, size_t nadd)
+{ ordered_entry *out, *old;
+  const ordered_entry *new = add+nadd;
+
+  reserveOrderedRun(run, nadd);
+  out = run->entries + run->count + nadd;
+  old = run->entries + run->count;
+
+  while ( new > add )
+  { if ( old > run->entries &&
+	 compare_ordered_entries(&old[-1], &new[-1]) == CMP_GREATER )
+      *--out = *--old;
+    else
+      *--out = *--new;
+  }
+  run->count += nadd;
+}
+
+
+static void
+addPendingEntry(ordered_index *oi, Clause cl)
+{ ordered_entry e;
+
+  if ( orderedKeyFromClause(cl, oi->arg, &e) == OK_NONE )
+    return;
+
+  ATOMIC_INC(&cl->references);
+  e.clause = cl;
+  e.seq    = oi->seq++;
+  reserveOrderedRun(&oi->pending, 1);
+  oi->pending.entries[oi->pending.count++] = e;
+}
+
+
+/* Called from addClauseToIndexes() with the predicate locked */
+
+static void
+addClauseToOrderedIndexes(Definition def, Clause cl)
+{ ordered_index *oi;
+
+  for(oi=def->ordered; oi; oi=oi->next)
+    addPendingEntry(oi, cl);
+}
+
+
+/* Called from deleteActiveClauseFromIndexes() with the predicate locked */
+
+static void
+deleteClauseFromOrderedIndexes(Definition def)
+{ ordered_index *oi;
+
+  for(oi=def->ordered; oi; oi=oi->next)
+    oi->erased++;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+mergeOrderedIndex() adds the sorted entries `add`   to oi. The predicate
+is locked. Entries of type OK_OTHER are  moved to `others`, the others
+are merged into `recent`, which is merged into `main` if it gets too
+large.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+mergeOrderedIndex(ordered_index *oi, ordered_entry *add, size_t nadd)
+{ size_t i, o;
+
+  for(i=o=0; i<nadd; i++)
+  { if ( add[i].type == OK_OTHER )
+    { if ( oi->nothers == oi->oallocated )
+      { size_t na = oi->oallocated ? oi->oallocated*2 : 16;
+	Clause *no = allocHeapOrHalt(na*sizeof(*no));
+
+	if ( oi->nothers )
+	  memcpy(no, oi->others, oi->nothers*sizeof(*no));
+	if ( oi->others )
+	  freeHeap(oi->others, oi->oallocated*sizeof(*no));
+	oi->others     = no;
+	oi->oallocated = na;
+      }
+      oi->others[oi->nothers++] = add[i].clause;
+    } else
+    { add[o++] = add[i];
+    }
+  }
+
+  mergeOrderedRun(&oi->recent, add, o);
+  if ( oi->recent.count*16 > oi->main.count )
+  { mergeOrderedRun(&oi->main, oi->recent.entries, oi->recent.count);
+    oi->recent.count = 0;
+  }
+}
+
+
+static void
+purgeOrderedRun(ordered_run *run)
+{ size_t i, o;
+
+  for(i=o=0; i<run->count; i++)
+  { Clause cl = run->entries[i].clause;
+
+    if ( true(cl, CL_ERASED) )
+      releaseClause(cl);
+    else
+      run->entries[o++] = run->entries[i];
+  }
+  run->count = o;
+}
+
+
+/* Remove erased clauses from the index. The predicate is locked. */
+
+static void
+purgeOrderedIndex(ordered_index *oi)
+{ size_t i, o;
+
+  purgeOrderedRun(&oi->main);
+  purgeOrderedRun(&oi->recent);
+  for(i=o=0; i<oi->nothers; i++)
+  { Clause cl = oi->others[i];
+
+    if ( true(cl, CL_ERASED) )
+      releaseClause(cl);
+    else
+      oi->others[o++] = cl;
+  }
+  oi->nothers = o;
+
+  oi->erased = 0;
+}
+
+
+static void
+freeOrderedIndex(ordered_index *oi)
+{ size_t i;
+
+  freeOrderedRun(&oi->main);
+  freeOrderedRun(&oi->recent);
+  freeOrderedRun(&oi->pending);
+  for(i=0; i<oi->nothers; i++)
+    releaseClause(oi->others[i]);
+  if ( oi->others )
+    freeHeap(oi->others, oi->oallocated*sizeof(*oi->others));
+  freeHeap(oi, sizeof(*oi));
+}
+
+
+/* Called from destroyDefinition(); def is no longer referenced */
+
+void
+freeOrderedIndexes(Definition def)
+{ ordered_index *oi, *next;
+
+  for(oi=def->ordered; oi; oi=next)
+  { next = oi->next;
+    freeOrderedIndex(oi);
+  }
+  def->ordered = NULL;
+}
+
+
+#ifdef O_PLMT
+static void
+wait_for_ordered_index(ordered_index *oi)
+{ pthread_mutex_lock(&GD->thread.index.mutex);
+  while ( oi->merging )
+    pthread_cond_wait(&GD->thread.index.cond, &GD->thread.index.mutex);
+  pthread_mutex_unlock(&GD->thread.index.mutex);
+}
+#endif
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+lockOrderedIndex() locks def and returns   the  up-to-date ordered index
+for argument arg, creating the index if needed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static ordered_index *
+lockOrderedIndex(Definition def, unsigned int arg)
+{ ordered_index *oi;
+
+  LOCKDEF(def);
+  for(;;)
+  { for(oi=def->ordered; oi; oi=oi->next)
+    { if ( oi->arg == arg )
+	break;
+    }
+
+    if ( !oi )
+    { ClauseRef cref;
+
+      oi = allocHeapOrHalt(sizeof(*oi));
+      memset(oi, 0, sizeof(*oi));
+      oi->arg  = arg;
+      for(cref=def->impl.clauses.first_clause; cref; cref=cref->next)
+      { if ( false(cref->value.clause, CL_ERASED) )
+	  addPendingEntry(oi, cref->value.clause);
+      }
+      oi->next = def->ordered;
+      def->ordered = oi;
+      ATOMIC_INC(&GD->statistics.indexes.created);
+    }
+
+#ifdef O_PLMT
+    if ( oi->merging )
+    { UNLOCKDEF(def);
+      wait_for_ordered_index(oi);
+      LOCKDEF(def);
+      continue;
+    }
+#endif
+
+    if ( oi->pending.count )
+    { ordered_run add = oi->pending;
+
+      memset(&oi->pending, 0, sizeof(oi->pending));
+      oi->merging = TRUE;
+      UNLOCKDEF(def);
+      qsort(add.entries, add.count, sizeof(*add.entries),
+	    compare_ordered_entries);
+      LOCKDEF(def);
+      mergeOrderedIndex(oi, add.entries, add.count);
+      freeHeap(add.entries, add.allocated*sizeof(*add.entries));
+#ifdef O_PLMT
+      pthread_mutex_lock(&GD->thread.index.mutex);
+      oi->merging = FALSE;
+      pthread_cond_broadcast(&GD->thread.index.cond);
+      pthread_mutex_unlock(&GD->thread.index.mutex);
+#else
+      oi->merging = FALSE;
+#endif
+      continue;				/* more may be pending */
+    }
+
+    break;
+  }
+
+  if ( oi->erased*2 > oi->main.count+oi->recent.count+oi->nothers )
+    purgeOrderedIndex(oi);
+
+  return oi;
+}
+
+
+static int
+get_ordered_key(term_t t, ordered_key *k)
+{ GET_LD
+
+  if ( PL_is_number(t) )
+  { if ( !PL_get_float(t, &k->v.f) )	/* unbounded integer */
+    { number n;
+
+      PL_get_number(t, &n);
+      k->v.f = ar_sign_i(&n) < 0 ? -HUGE_VAL : HUGE_VAL;
+      clearNumber(&n);
+    }
+    k->type = OK_NUMBER;
+    return TRUE;
+  }
+  if ( PL_get_atom(t, &k->v.a) )
+  { k->type = OK_ATOM;
+    return TRUE;
+  }
+
+  return PL_type_error("number", t);
+}
+
+
+/* First entry of run that is not below k */
+
+static size_t
+ordered_lower_bound(const ordered_run *run, const ordered_key *k)
+{ size_t lo = 0, hi = run->count;
+
+  while ( lo < hi )
+  { size_t m = lo + (hi-lo)/2;
+
+    if ( compare_ordered_key(&run->entries[m], k) == CMP_LESS )
+      lo = m+1;
+    else
+      hi = m;
+  }
+
+  return lo;
+}
+
+
+static void
+add_candidate(Buffer b, Clause cl, gen_t gen)
+{ GET_LD
+
+  if ( visibleClause(cl, gen) )
+  { ATOMIC_INC(&cl->references);
+    addBuffer(b, cl, Clause);
+  }
+}
+
+
+/** '$clause_range'(:Head, +Arg, +Low, +High, -Refs) is det.
+
+Refs is a list of references to  the   clauses  of  Head that may have
+their Arg-th argument in the range [Low,High].   Clauses with a key are
+returned in ascending order, followed by   the clauses where Arg cannot
+be indexed in clause order.
+*/
+
+static
+PRED_IMPL("$clause_range", 5, clause_range, PL_FA_TRANSPARENT)
+{ PRED_LD
+  Procedure proc;
+  Definition def;
+  int arg;
+  ordered_key low, high;
+  ordered_index *oi;
+  tmp_buffer buf;
+  Clause *clauses;
+  size_t i, n, m, r;
+  gen_t gen;
+  term_t tail = PL_copy_term_ref(A5);
+  term_t head = PL_new_term_ref();
+  int rc = TRUE;
+
+  if ( !get_procedure(A1, &proc, 0, GP_FIND) )
+    return FALSE;
+  def = getProcDefinition(proc);
+  if ( true(def, P_FOREIGN) )
+    return PL_error(NULL, 0, NULL, ERR_PERMISSION_PROC,
+		    ATOM_access, ATOM_private_procedure, proc);
+  if ( !PL_get_integer_ex(A2, &arg) )
+    return FALSE;
+  if ( arg < 1 || arg > (int)def->functor->arity )
+    return PL_domain_error("argument", A2);
+  if ( !get_ordered_key(A3, &low) ||
+       !get_ordered_key(A4, &high) )
+    return FALSE;
+
+  initBuffer(&buf);
+  oi = lockOrderedIndex(def, arg);
+  gen = global_generation();
+  m = ordered_lower_bound(&oi->main, &low);
+  r = ordered_lower_bound(&oi->recent, &low);
+  for(;;)
+  { ordered_entry *e;
+
+    if ( m < oi->main.count )
+    { e = &oi->main.entries[m];
+      if ( r < oi->recent.count &&
+	   compare_ordered_entries(e, &oi->recent.entries[r]) == CMP_GREATER )
+	e = &oi->recent.entries[r++];
+      else
+	m++;
+    } else if ( r < oi->recent.count )
+    { e = &oi->recent.entries[r++];
+    } else
+      break;
+
+    if ( compare_ordered_key(e, &high) == CMP_GREATER )
+      break;
+    add_candidate((Buffer)&buf, e->clause, gen);
+  }
+  for(i=0; i<oi->nothers; i++)
+    add_candidate((Buffer)&buf, oi->others[i], gen);
+  UNLOCKDEF(def);
+
+  clauses = baseBuffer(&buf, Clause);
+  n = entriesBuffer(&buf, Clause);
+  for(i=0; i<n; i++)
+  { if ( rc )
+      rc = ( PL_unify_list(tail, head, tail) &&
+	     PL_unify_clref(head, clauses[i]) );
+    releaseClause(clauses[i]);
+  }
+  discardBuffer(&buf);
+
+  return rc && PL_unify_nil(tail);
+}
+
+
 		 /*******************************
 		 *  PREDICATE PROPERTY SUPPORT	*
 		 *******************************/
@@ -2716,20 +3710,50 @@ add_deep_indexes(ClauseIndex ci, term_t head, term_t tail ARG_LD)
 }
 
 
+static int
+unify_ordered_indexes(Definition def, term_t head, term_t tail, int *found)
+{ GET_LD
+  ordered_index *oi;
+  int rc = TRUE;
+
+  LOCKDEF(def);
+  for(oi=def->ordered; rc && oi; oi=oi->next)
+  { size_t entries = ( oi->main.count + oi->recent.count +
+		       oi->pending.count + oi->nothers );
+    size_t bytes = ( sizeof(*oi) +
+		     ( oi->main.allocated + oi->recent.allocated +
+		       oi->pending.allocated ) * sizeof(ordered_entry) +
+		     oi->oallocated*sizeof(*oi->others) );
+
+    (*found)++;
+    rc = ( PL_unify_list(tail, head, tail) &&
+	   PL_unify_term(head,
+			 PL_FUNCTOR, FUNCTOR_minus2,
+			   PL_FUNCTOR, FUNCTOR_single1,
+			     PL_INT, (int)oi->arg,
+			   PL_FUNCTOR, FUNCTOR_ordered2,
+			     PL_INT64, (int64_t)entries,
+			     PL_INT64, (int64_t)bytes) );
+  }
+  UNLOCKDEF(def);
+
+  return rc;
+}
+
+
 bool
 unify_index_pattern(Procedure proc, term_t value)
 { GET_LD
   Definition def = getProcDefinition__LD(proc->definition PASS_LD);
   ClauseIndex *cip;
+  term_t tail = PL_copy_term_ref(value);
+  term_t head = PL_new_term_ref();
   int rc = FALSE;
   int found = 0;
 
   acquire_def(def);
   if ( (cip=def->impl.clauses.clause_indexes) )
-  { term_t tail = PL_copy_term_ref(value);
-    term_t head = PL_new_term_ref();
-
-    for(; *cip; cip++)
+  { for(; *cip; cip++)
     { ClauseIndex ci = *cip;
 
       if ( ISDEADCI(ci) )
@@ -2744,9 +3768,12 @@ unify_index_pattern(Procedure proc, term_t value)
 	  goto out;
       }
     }
-
-    rc = found && PL_unify_nil(tail);
   }
+  if ( def->ordered && !unify_ordered_indexes(def, head, tail, &found) )
+    goto out;
+
+  rc = found && PL_unify_nil(tail);
+
 out:
   release_def(def);
 
@@ -2759,4 +3786,5 @@ out:
 		 *******************************/
 
 BeginPredDefs(index)
+  PRED_DEF("$clause_range", 5, clause_range, PL_FA_TRANSPARENT)
 EndPredDefs
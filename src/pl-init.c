@@ -656,6 +656,11 @@ parseCommandLineOptions(int argc0, char **argv0, char **argvleft, int compile)
 	    GD->options.nothreads = TRUE;
 	} else
 	  return -1;
+      } else if ( (rc=is_bool_opt(s, "mmap_stacks", &b)) )
+      { if ( rc == TRUE )
+	  GD->options.nommapstacks = !b;
+	else
+	  return -1;
       } else if ( (rc=is_bool_opt(s, "tty", &b)) )
       { if ( rc == TRUE )
 	{ if ( b )
@@ -1077,6 +1082,9 @@ usage(void)
     "    --home=DIR               Use DIR as SWI-Prolog home\n",
     "    --stack_limit=size[BKMG] Specify maximum size of Prolog stacks\n",
     "    --table_space=size[BKMG] Specify maximum size of SLG tables\n",
+#ifdef O_MMAP_STACKS
+    "    --mmap_stacks[=bool]     Do (not) reserve address space for stacks\n",
+#endif
     "    --pldoc[=port]           Start PlDoc server [at port]\n",
 #ifdef __WINDOWS__
     "    --win_app	          Behave as Windows application\n",
@@ -1315,6 +1323,9 @@ emergency:
 
   if ( reclaim_memory )
   { freeStacks(PASS_LD1);
+#ifdef O_MMAP_STACKS
+    cleanupStackCache();
+#endif
 #ifdef O_PLMT
     cleanupLocalDefinitions(LD);
 #endif
@@ -70,6 +70,7 @@ typedef struct
   bool		silent;			/* -q: quiet operation */
   bool		traditional;		/* --traditional: no version 7 exts */
   bool		nothreads;		/* --no-threads */
+  bool		nommapstacks;		/* --no-mmap_stacks */
 #ifdef __WINDOWS__
   bool		win_app;		/* --win_app: be Windows application */
 #endif
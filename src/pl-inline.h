@@ -603,6 +603,31 @@ popArgvArithStack(int n ARG_LD)
   }
 }
 
+/* floatArgs() is true if n1 and n2 are  both   floats  or one is a float
+   and the other a small integer, i.e., the  result of a binary operation
+   on them is a float.  Both values are stored as double in f1 and f2.
+*/
+
+static inline int
+floatArgs(Number n1, Number n2, double *f1, double *f2)
+{ if ( n1->type == V_FLOAT )
+  { *f1 = n1->value.f;
+    if ( n2->type == V_FLOAT )
+      *f2 = n2->value.f;
+    else if ( n2->type == V_INTEGER )
+      *f2 = (double)n2->value.i;
+    else
+      return FALSE;
+    return TRUE;
+  } else if ( n2->type == V_FLOAT && n1->type == V_INTEGER )
+  { *f1 = (double)n1->value.i;
+    *f2 = n2->value.f;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
 		 /*******************************
 		 *	      THREADS		*
 		 *******************************/
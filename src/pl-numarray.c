@@ -0,0 +1,1166 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "pl-incl.h"
+#include <math.h>
+
+#undef LD
+#define LD LOCAL_LD
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+A numeric array is a blob holding a   contiguous vector of 64-bit integers
+or doubles. Compared to a list of  numbers   it  uses 8 bytes per element
+and the elements are accessed without dereferencing and unboxing, which
+makes bulk operations such as sum/1 and dot/2 run in tight C loops.
+
+Arrays are immutable: operations create a   new array. The memory of an
+array is reclaimed by atom garbage collection. As with other blobs that
+are not unique, arrays are compared by identity.
+
+The loops of the bulk operations avoid   data dependencies between the
+iterations (using multiple accumulators   and  deferring overflow checks
+to the end), so the C compiler can vectorise them.
+
+Arithmetic on integer arrays is exact:  sums   and  dot products that do
+not fit in 64 bits are computed again  using the generic number routines,
+producing big integers. Operations that  produce   an  array raise an
+int_overflow evaluation error if an element does not fit in 64 bits.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define NA_INTEGER	1
+#define NA_FLOAT	2
+
+typedef struct numeric_array
+{ atom_t	symbol;			/* <numeric_array>(%p) */
+  int		type;			/* NA_INTEGER or NA_FLOAT */
+  size_t	size;			/* # elements */
+  union
+  { int64_t    *i;			/* NA_INTEGER data */
+    double     *f;			/* NA_FLOAT data */
+  } data;
+} numeric_array;
+
+#define B31 ((uint64_t)1<<31)
+
+
+		 /*******************************
+		 *	       BLOB		*
+		 *******************************/
+
+static int
+write_numeric_array(IOSTREAM *s, atom_t aref, int flags)
+{ numeric_array *a = PL_blob_data(aref, NULL, NULL);
+  (void)flags;
+
+  Sfprintf(s, "<numeric_array>(%p)", a);
+  return TRUE;
+}
+
+
+static void
+acquire_numeric_array(atom_t aref)
+{ numeric_array *a = PL_blob_data(aref, NULL, NULL);
+
+  a->symbol = aref;
+}
+
+
+static int
+release_numeric_array(atom_t aref)
+{ numeric_array *a = PL_blob_data(aref, NULL, NULL);
+
+  free(a);
+
+  return TRUE;
+}
+
+
+static void
+save_uint64(uint64_t v, IOSTREAM *fd)
+{ int i;
+
+  for(i=0; i<8; i++, v >>= 8)
+    Sputc((int)(v&0xff), fd);
+}
+
+
+static int
+load_uint64(IOSTREAM *fd, uint64_t *vp)
+{ uint64_t v = 0;
+  int i;
+
+  for(i=0; i<8; i++)
+  { int c = Sgetc(fd);
+
+    if ( c == EOF )
+      return FALSE;
+    v |= (uint64_t)c << (i*8);
+  }
+
+  *vp = v;
+  return TRUE;
+}
+
+
+/* Arrays are saved as the type, the size and the elements, all in
+   little-endian byte order.
+*/
+
+static int
+save_numeric_array(atom_t aref, IOSTREAM *fd)
+{ numeric_array *a = PL_blob_data(aref, NULL, NULL);
+  size_t i;
+
+  Sputc(a->type, fd);
+  save_uint64(a->size, fd);
+  for(i=0; i<a->size; i++)
+  { uint64_t v;
+
+    memcpy(&v, &a->data.i[i], sizeof(v));
+    save_uint64(v, fd);
+  }
+
+  return TRUE;
+}
+
+
+static numeric_array *alloc_array(int type, size_t size);
+static PL_blob_t numeric_array_blob;
+
+static atom_t
+load_numeric_array(IOSTREAM *fd)
+{ int type = Sgetc(fd);
+  uint64_t size;
+  numeric_array *a;
+  size_t i;
+  int new;
+
+  if ( (type != NA_INTEGER && type != NA_FLOAT) ||
+       !load_uint64(fd, &size) ||
+       !(a = alloc_array(type, (size_t)size)) )
+    fatalError("Corrupt numeric array in saved state");
+
+  for(i=0; i<a->size; i++)
+  { uint64_t v;
+
+    if ( !load_uint64(fd, &v) )
+      fatalError("Corrupt numeric array in saved state");
+    memcpy(&a->data.i[i], &v, sizeof(v));
+  }
+
+  return lookupBlob((const char*)a, sizeof(*a), &numeric_array_blob, &new);
+}
+
+
+static PL_blob_t numeric_array_blob =
+{ PL_BLOB_MAGIC,
+  PL_BLOB_NOCOPY,
+  "numeric_array",
+  release_numeric_array,
+  NULL,
+  write_numeric_array,
+  acquire_numeric_array,
+  save_numeric_array,
+  load_numeric_array
+};
+
+
+/* Allocate an array.  The header and data are allocated as one block.
+   Returns NULL if there is not enough memory, without raising an
+   exception.
+*/
+
+static numeric_array *
+alloc_array(int type, size_t size)
+{ numeric_array *a;
+
+  if ( size > (SIZE_MAX-sizeof(*a))/sizeof(int64_t) ||
+       !(a = malloc(sizeof(*a) + size*sizeof(int64_t))) )
+    return NULL;
+
+  a->symbol = 0;
+  a->type   = type;
+  a->size   = size;
+  a->data.i = (int64_t*)(a+1);
+
+  return a;
+}
+
+
+static numeric_array *
+new_array(int type, size_t size)
+{ numeric_array *a;
+
+  if ( !(a=alloc_array(type, size)) )
+    PL_resource_error("memory");
+
+  return a;
+}
+
+
+static int
+unify_array(term_t t, numeric_array *a)
+{ return PL_unify_blob(t, a, sizeof(*a), &numeric_array_blob);
+}
+
+
+static int
+get_array_word(Word p, numeric_array **ap ARG_LD)
+{ deRef(p);
+
+  if ( isAtom(*p) && atomValue(*p)->type == &numeric_array_blob )
+  { *ap = (numeric_array*)atomValue(*p)->name;
+    return TRUE;
+  }
+
+  if ( canBind(*p) )
+    PL_error(NULL, 0, NULL, ERR_INSTANTIATION);
+  else
+    PL_error(NULL, 0, NULL, ERR_TYPE,
+	     ATOM_numeric_array, pushWordAsTermRef(p));
+  popTermRef();
+
+  return FALSE;
+}
+
+
+static int
+get_array(term_t t, numeric_array **ap ARG_LD)
+{ return get_array_word(valTermRef(t), ap PASS_LD);
+}
+
+
+static int
+same_size(numeric_array *a1, numeric_array *a2, Word p2 ARG_LD)
+{ if ( a1->size == a2->size )
+    return TRUE;
+
+  PL_error(NULL, 0, NULL, ERR_DOMAIN, ATOM_same_size, pushWordAsTermRef(p2));
+  popTermRef();
+
+  return FALSE;
+}
+
+
+		 /*******************************
+		 *	      KERNELS		*
+		 *******************************/
+
+/* The value of an integer sum computed as the sum of the high and low
+   32-bit halves.  hi and lo cannot overflow for less than 2^31 elements.
+   Returns FALSE if the value does not fit in 64 bits.
+*/
+
+static int
+int_halves_value(int64_t hi, uint64_t lo, int64_t *vp)
+{ hi += (int64_t)(lo >> 32);
+  lo &= 0xffffffff;
+
+  if ( hi >= -(int64_t)B31 && hi < (int64_t)B31 )
+  { *vp = (int64_t)(((uint64_t)hi << 32) | lo);
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+
+static int
+add_number(Number acc, Number n)
+{ number r;
+  int rc = pl_ar_add(acc, n, &r);
+
+  clearNumber(acc);
+  clearNumber(n);
+  if ( rc )
+    *acc = r;
+
+  return rc;
+}
+
+
+static int
+sum_int(const int64_t *a, size_t n, Number r)
+{ size_t i;
+
+  if ( n < B31 )
+  { int64_t hi = 0;
+    uint64_t lo = 0;
+
+    for(i=0; i<n; i++)
+    { hi += a[i] >> 32;
+      lo += (uint64_t)a[i] & 0xffffffff;
+    }
+
+    if ( int_halves_value(hi, lo, &r->value.i) )
+    { r->type = V_INTEGER;
+      return TRUE;
+    }
+  }
+
+  r->type = V_INTEGER;			/* does not fit: use big integers */
+  r->value.i = 0;
+  for(i=0; i<n; i++)
+  { number e;
+
+    e.type = V_INTEGER;
+    e.value.i = a[i];
+    if ( !add_number(r, &e) )
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+static double
+sum_float(const double *a, size_t n)
+{ double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+  size_t i;
+
+  for(i=0; i+4 <= n; i += 4)
+  { s0 += a[i];
+    s1 += a[i+1];
+    s2 += a[i+2];
+    s3 += a[i+3];
+  }
+  for(; i<n; i++)
+    s0 += a[i];
+
+  return (s0+s1)+(s2+s3);
+}
+
+
+static int
+array_sum(numeric_array *a, Number r)
+{ if ( a->type == NA_INTEGER )
+    return sum_int(a->data.i, a->size, r);
+
+  r->type = V_FLOAT;
+  r->value.f = sum_float(a->data.f, a->size);
+
+  return check_float(r->value.f);
+}
+
+
+static int
+dot_int(const int64_t *a, const int64_t *b, size_t n, Number r)
+{ size_t i;
+
+  if ( n < B31 )
+  { int64_t hi = 0;
+    uint64_t lo = 0;
+    uint64_t big = 0;
+
+    for(i=0; i<n; i++)
+    { int64_t p = (int64_t)((uint64_t)a[i]*(uint64_t)b[i]);
+
+      big |= ((uint64_t)a[i]+B31) | ((uint64_t)b[i]+B31);
+      hi += p >> 32;
+      lo += (uint64_t)p & 0xffffffff;
+    }
+
+    if ( !(big>>32) && int_halves_value(hi, lo, &r->value.i) )
+    { r->type = V_INTEGER;
+      return TRUE;
+    }
+  }
+
+  r->type = V_INTEGER;			/* large elements or result */
+  r->value.i = 0;
+  for(i=0; i<n; i++)
+  { number e1, e2, p;
+    int rc;
+
+    e1.type = e2.type = V_INTEGER;
+    e1.value.i = a[i];
+    e2.value.i = b[i];
+    rc = ar_mul(&e1, &e2, &p);
+    clearNumber(&e1);
+    clearNumber(&e2);
+    if ( !rc || !add_number(r, &p) )
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+
+static double
+dot_float(const double *a, const double *b, size_t n)
+{ double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+  size_t i;
+
+  for(i=0; i+4 <= n; i += 4)
+  { s0 += a[i]*b[i];
+    s1 += a[i+1]*b[i+1];
+    s2 += a[i+2]*b[i+2];
+    s3 += a[i+3]*b[i+3];
+  }
+  for(; i<n; i++)
+    s0 += a[i]*b[i];
+
+  return (s0+s1)+(s2+s3);
+}
+
+
+static double
+elem_float(numeric_array *a, size_t i)
+{ return a->type == NA_FLOAT ? a->data.f[i] : (double)a->data.i[i];
+}
+
+
+static int
+array_dot(numeric_array *a, numeric_array *b, Number r)
+{ if ( a->type == NA_INTEGER && b->type == NA_INTEGER )
+    return dot_int(a->data.i, b->data.i, a->size, r);
+
+  r->type = V_FLOAT;
+  if ( a->type == NA_FLOAT && b->type == NA_FLOAT )
+  { r->value.f = dot_float(a->data.f, b->data.f, a->size);
+  } else
+  { double s = 0.0;
+    size_t i;
+
+    for(i=0; i<a->size; i++)
+      s += elem_float(a, i)*elem_float(b, i);
+    r->value.f = s;
+  }
+
+  return check_float(r->value.f);
+}
+
+
+/* Minimum (max=FALSE) or maximum of the elements. Fails if the array is
+   empty.
+*/
+
+static int
+array_min_max(numeric_array *a, int max, Number r)
+{ size_t i, n = a->size;
+
+  if ( n == 0 )
+    return FALSE;
+
+  if ( a->type == NA_INTEGER )
+  { const int64_t *d = a->data.i;
+    int64_t m = d[0];
+
+    if ( max )
+    { for(i=1; i<n; i++)
+	m = d[i] > m ? d[i] : m;
+    } else
+    { for(i=1; i<n; i++)
+	m = d[i] < m ? d[i] : m;
+    }
+    r->type = V_INTEGER;
+    r->value.i = m;
+  } else
+  { const double *d = a->data.f;
+    double m = d[0];
+
+    if ( max )
+    { for(i=1; i<n; i++)
+	m = d[i] > m ? d[i] : m;
+    } else
+    { for(i=1; i<n; i++)
+	m = d[i] < m ? d[i] : m;
+    }
+    r->type = V_FLOAT;
+    r->value.f = m;
+  }
+
+  return TRUE;
+}
+
+
+/* Check the result of a float operation.  x-x is NaN for infinite
+   and NaN values, so the sum of these is NaN if any element is not
+   finite.  Only in that case we scan again to tell NaN (undefined)
+   from infinite (overflow).
+*/
+
+static int
+check_float_array(const double *d, size_t n)
+{ double chk = 0.0;
+  size_t i;
+
+  for(i=0; i<n; i++)
+    chk += d[i]-d[i];
+
+  if ( isnan(chk) )
+  { for(i=0; i<n; i++)
+    { if ( isnan(d[i]) )
+	return PL_error(NULL, 0, NULL, ERR_AR_UNDEF);
+    }
+    return PL_error(NULL, 0, NULL, ERR_AR_OVERFLOW);
+  }
+
+  return TRUE;
+}
+
+
+static numeric_array *
+array_scale(numeric_array *a, Number k)
+{ numeric_array *r;
+  size_t i, n = a->size;
+
+  if ( a->type == NA_INTEGER && k->type == V_MPZ )
+  { for(i=0; i<n; i++)			/* only zeros can be scaled */
+    { if ( a->data.i[i] != 0 )
+      { PL_error(NULL, 0, NULL, ERR_EVALUATION, ATOM_int_overflow);
+	return NULL;
+      }
+    }
+    if ( (r = new_array(NA_INTEGER, n)) )
+      memset(r->data.i, 0, n*sizeof(int64_t));
+  } else if ( a->type == NA_INTEGER && k->type == V_INTEGER )
+  { const int64_t *d = a->data.i;
+    int64_t f = k->value.i;
+    int64_t *o;
+
+    if ( f != 0 && n > 0 )		/* check for overflow */
+    { int64_t min = d[0], max = d[0];
+      uint64_t limit = (uint64_t)PLMAXINT / (f < 0 ? -(uint64_t)f : (uint64_t)f);
+
+      for(i=1; i<n; i++)
+      { min = d[i] < min ? d[i] : min;
+	max = d[i] > max ? d[i] : max;
+      }
+      if ( (max > 0 && (uint64_t)max > limit) ||
+	   (min < 0 && -(uint64_t)min > limit) )
+      { PL_error(NULL, 0, NULL, ERR_EVALUATION, ATOM_int_overflow);
+	return NULL;
+      }
+    }
+
+    if ( !(r = new_array(NA_INTEGER, n)) )
+      return NULL;
+    o = r->data.i;
+    for(i=0; i<n; i++)
+      o[i] = d[i]*f;
+  } else
+  { double f;
+    double *o;
+
+    if ( !promoteToFloatNumber(k) ||
+	 !(r = new_array(NA_FLOAT, n)) )
+      return NULL;
+    f = k->value.f;
+    o = r->data.f;
+    if ( a->type == NA_FLOAT )
+    { const double *d = a->data.f;
+
+      for(i=0; i<n; i++)
+	o[i] = d[i]*f;
+    } else
+    { const int64_t *d = a->data.i;
+
+      for(i=0; i<n; i++)
+	o[i] = (double)d[i]*f;
+    }
+    if ( !check_float_array(o, n) )
+    { free(r);
+      return NULL;
+    }
+  }
+
+  return r;
+}
+
+
+static numeric_array *
+array_add(numeric_array *a, numeric_array *b)
+{ numeric_array *r;
+  size_t i, n = a->size;
+
+  if ( a->type == NA_INTEGER && b->type == NA_INTEGER )
+  { const int64_t *d1 = a->data.i;
+    const int64_t *d2 = b->data.i;
+    int64_t *o;
+    int64_t ovf = 0;
+
+    if ( !(r = new_array(NA_INTEGER, n)) )
+      return NULL;
+    o = r->data.i;
+    for(i=0; i<n; i++)
+    { int64_t s = (int64_t)((uint64_t)d1[i] + (uint64_t)d2[i]);
+
+      ovf |= (d1[i]^s) & (d2[i]^s);	/* sign differs from both */
+      o[i] = s;
+    }
+    if ( ovf < 0 )
+    { free(r);
+      PL_error(NULL, 0, NULL, ERR_EVALUATION, ATOM_int_overflow);
+      return NULL;
+    }
+  } else
+  { double *o;
+
+    if ( !(r = new_array(NA_FLOAT, n)) )
+      return NULL;
+    o = r->data.f;
+    if ( a->type == NA_FLOAT && b->type == NA_FLOAT )
+    { const double *d1 = a->data.f;
+      const double *d2 = b->data.f;
+
+      for(i=0; i<n; i++)
+	o[i] = d1[i]+d2[i];
+    } else
+    { for(i=0; i<n; i++)
+	o[i] = elem_float(a, i)+elem_float(b, i);
+    }
+    if ( !check_float_array(o, n) )
+    { free(r);
+      return NULL;
+    }
+  }
+
+  return r;
+}
+
+
+static int
+compare_int64(const void *p1, const void *p2)
+{ int64_t i1 = *(const int64_t*)p1;
+  int64_t i2 = *(const int64_t*)p2;
+
+  return i1 < i2 ? -1 : i1 > i2 ? 1 : 0;
+}
+
+
+static int
+compare_double(const void *p1, const void *p2)
+{ double f1 = *(const double*)p1;
+  double f2 = *(const double*)p2;
+
+  return f1 < f2 ? -1 : f1 > f2 ? 1 : 0;
+}
+
+
+		 /*******************************
+		 *	    CONVERSION		*
+		 *******************************/
+
+/* Store the number at p as element i of a.  Raises an exception and
+   returns FALSE if p is not a number or does not fit.  NaN is not
+   accepted as it has no place in the order of the elements.
+*/
+
+static int
+put_element(numeric_array *a, size_t i, Word p ARG_LD)
+{ number n;
+  int rc = TRUE;
+
+  deRef(p);
+  if ( a->type == NA_INTEGER && isTaggedInt(*p) )
+  { a->data.i[i] = valInt(*p);
+    return TRUE;
+  }
+  if ( a->type == NA_FLOAT && isFloat(*p) )
+  { double f = valFloat(*p);
+
+    if ( isnan(f) )
+      return PL_error(NULL, 0, NULL, ERR_AR_UNDEF);
+    a->data.f[i] = f;
+    return TRUE;
+  }
+  if ( !isNumber(*p) )
+  { if ( canBind(*p) )
+      PL_error(NULL, 0, NULL, ERR_INSTANTIATION);
+    else
+      PL_error(NULL, 0, NULL, ERR_TYPE, ATOM_number, pushWordAsTermRef(p));
+    popTermRef();
+    return FALSE;
+  }
+
+  get_number(*p, &n PASS_LD);
+  if ( a->type == NA_FLOAT )
+  { if ( (rc=promoteToFloatNumber(&n)) )
+      a->data.f[i] = n.value.f;
+  } else
+  { switch(n.type)
+    { case V_INTEGER:
+	a->data.i[i] = n.value.i;
+	break;
+      case V_FLOAT:
+      case V_MPQ:
+	rc = PL_error(NULL, 0, NULL, ERR_TYPE,
+		      ATOM_integer, pushWordAsTermRef(p));
+	popTermRef();
+	break;
+      default:
+	rc = PL_error(NULL, 0, NULL, ERR_REPRESENTATION, ATOM_int64_t);
+    }
+  }
+  clearNumber(&n);
+
+  return rc;
+}
+
+
+/* Create an array from a proper list of numbers.  If type is 0, the
+   array is a float array if the list contains a float and an integer
+   array otherwise.
+*/
+
+static int
+list_to_array(term_t list, int type, numeric_array **ap ARG_LD)
+{ Word l = valTermRef(list);
+  Word tail, p;
+  intptr_t len = skip_list(l, &tail PASS_LD);
+  numeric_array *a;
+  size_t i;
+
+  if ( !isNil(*tail) )
+  { if ( canBind(*tail) )
+      return PL_error(NULL, 0, NULL, ERR_INSTANTIATION);
+    return PL_type_error("list", list);
+  }
+
+  if ( !type )
+  { type = NA_INTEGER;
+    p = l;
+    deRef(p);
+    while( isList(*p) )
+    { Word h = HeadList(p);
+
+      deRef(h);
+      if ( isFloat(*h) )
+      { type = NA_FLOAT;
+	break;
+      }
+      p = TailList(p);
+      deRef(p);
+    }
+  }
+
+  if ( !(a = new_array(type, len)) )
+    return FALSE;
+
+  p = l;
+  deRef(p);
+  for(i=0; isList(*p); i++)
+  { if ( !put_element(a, i, HeadList(p) PASS_LD) )
+    { free(a);
+      return FALSE;
+    }
+    p = TailList(p);
+    deRef(p);
+  }
+
+  *ap = a;
+  return TRUE;
+}
+
+
+static int
+array_to_list(numeric_array *a, term_t list ARG_LD)
+{ size_t i, n = a->size;
+  size_t cell = (a->type == NA_FLOAT ? 2+WORDS_PER_DOUBLE : 2+WORDS_PER_INT64);
+  term_t tmp;
+  Word l;
+
+  if ( n == 0 )
+    return PL_unify_nil(list);
+
+  if ( !(tmp = PL_new_term_ref()) )
+    return FALSE;
+  if ( !hasGlobalSpace(n*(3+cell)) )
+  { int rc;
+
+    if ( (rc=ensureGlobalSpace(n*(3+cell), ALLOW_GC)) != TRUE )
+      return raiseStackOverflow(rc);
+  }
+
+  l = gTop;
+  gTop += n*3;
+  for(i=0; i<n; i++)
+  { Word c = &l[i*3];
+
+    c[0] = FUNCTOR_dot2;
+    if ( a->type == NA_FLOAT )
+      put_double(&c[1], a->data.f[i], ALLOW_CHECKED PASS_LD);
+    else
+      put_int64(&c[1], a->data.i[i], 0 PASS_LD);
+    c[2] = (i+1 < n ? consPtr(&c[3], TAG_COMPOUND|STG_GLOBAL) : ATOM_nil);
+  }
+  *valTermRef(tmp) = consPtr(l, TAG_COMPOUND|STG_GLOBAL);
+
+  return PL_unify(list, tmp);
+}
+
+
+static int
+get_type(term_t t, int *type ARG_LD)
+{ atom_t a;
+
+  if ( !PL_get_atom_ex(t, &a) )
+    return FALSE;
+  if ( a == ATOM_integer )
+    *type = NA_INTEGER;
+  else if ( a == ATOM_float )
+    *type = NA_FLOAT;
+  else
+    return PL_domain_error("numeric_array_type", t);
+
+  return TRUE;
+}
+
+
+static int
+unify_new_array(term_t t, numeric_array *a)
+{ if ( !a )
+    return FALSE;
+
+  return unify_array(t, a);
+}
+
+
+		 /*******************************
+		 *	    ARITHMETIC		*
+		 *******************************/
+
+/* True if f is an arithmetic function on numeric arrays.  The arguments
+   of these functions are not evaluated.  See valueExpression().
+*/
+
+int
+isNumericArrayFunction(functor_t f)
+{ return ( f == FUNCTOR_sum1 ||
+	   f == FUNCTOR_dot_product2 ||
+	   f == FUNCTOR_min1 ||
+	   f == FUNCTOR_max1 );
+}
+
+
+/* Evaluate the array function term at p, which is dereferenced.
+*/
+
+int
+valueNumericArrayFunction(Word p, Number r ARG_LD)
+{ functor_t f = functorTerm(*p);
+  Word args = argTermP(*p, 0);
+  numeric_array *a, *b;
+
+  if ( !get_array_word(&args[0], &a PASS_LD) )
+    return FALSE;
+
+  if ( f == FUNCTOR_sum1 )
+  { return array_sum(a, r);
+  } else if ( f == FUNCTOR_dot_product2 )
+  { return ( get_array_word(&args[1], &b PASS_LD) &&
+	     same_size(a, b, &args[1] PASS_LD) &&
+	     array_dot(a, b, r) );
+  } else
+  { int max = (f == FUNCTOR_max1);
+
+    if ( !array_min_max(a, max, r) )
+      return PL_error(max ? "max" : "min", 1, NULL, ERR_AR_UNDEF);
+    return TRUE;
+  }
+}
+
+
+		 /*******************************
+		 *	    PREDICATES		*
+		 *******************************/
+
+/** numeric_array(+List, -Array)
+ *  numeric_array(+Type, +List, -Array)
+ */
+
+static
+PRED_IMPL("numeric_array", 2, numeric_array, 0)
+{ PRED_LD
+  numeric_array *a;
+
+  return ( list_to_array(A1, 0, &a PASS_LD) &&
+	   unify_array(A2, a) );
+}
+
+
+static
+PRED_IMPL("numeric_array", 3, numeric_array, 0)
+{ PRED_LD
+  numeric_array *a;
+  int type = 0;
+
+  return ( get_type(A1, &type PASS_LD) &&
+	   list_to_array(A2, type, &a PASS_LD) &&
+	   unify_array(A3, a) );
+}
+
+
+static
+PRED_IMPL("is_numeric_array", 1, is_numeric_array, 0)
+{ PL_blob_t *type;
+
+  return PL_is_blob(A1, &type) && type == &numeric_array_blob;
+}
+
+
+static
+PRED_IMPL("numeric_array_to_list", 2, numeric_array_to_list, 0)
+{ PRED_LD
+  numeric_array *a;
+
+  return ( get_array(A1, &a PASS_LD) &&
+	   array_to_list(a, A2 PASS_LD) );
+}
+
+
+static
+PRED_IMPL("numeric_array_size", 2, numeric_array_size, 0)
+{ PRED_LD
+  numeric_array *a;
+
+  return ( get_array(A1, &a PASS_LD) &&
+	   PL_unify_uint64(A2, a->size) );
+}
+
+
+static
+PRED_IMPL("numeric_array_type", 2, numeric_array_type, 0)
+{ PRED_LD
+  numeric_array *a;
+
+  return ( get_array(A1, &a PASS_LD) &&
+	   PL_unify_atom(A2, a->type == NA_FLOAT ? ATOM_float : ATOM_integer) );
+}
+
+
+/** numeric_array_get(+Array, +Index, -Value)
+ *
+ * Value is the Index-th (1-based) element of Array.
+ */
+
+static
+PRED_IMPL("numeric_array_get", 3, numeric_array_get, 0)
+{ PRED_LD
+  numeric_array *a;
+  int64_t i;
+
+  if ( !get_array(A1, &a PASS_LD) ||
+       !PL_get_int64_ex(A2, &i) )
+    return FALSE;
+  if ( i < 1 || (uint64_t)i > a->size )
+    return FALSE;
+
+  if ( a->type == NA_FLOAT )
+    return PL_unify_float(A3, a->data.f[i-1]);
+  else
+    return PL_unify_int64(A3, a->data.i[i-1]);
+}
+
+
+/** numeric_array_slice(+Array, +Start, +Length, -Slice)
+ */
+
+static
+PRED_IMPL("numeric_array_slice", 4, numeric_array_slice, 0)
+{ PRED_LD
+  numeric_array *a, *s;
+  int64_t start, len;
+
+  if ( !get_array(A1, &a PASS_LD) ||
+       !PL_get_int64_ex(A2, &start) ||
+       !PL_get_int64_ex(A3, &len) )
+    return FALSE;
+  if ( start < 1 || len < 0 || (uint64_t)(start-1) > a->size ||
+       (uint64_t)len > a->size-(start-1) )
+    return FALSE;
+
+  if ( !(s = new_array(a->type, (size_t)len)) )
+    return FALSE;
+  memcpy(s->data.i, &a->data.i[start-1], (size_t)len*sizeof(int64_t));
+
+  return unify_array(A4, s);
+}
+
+
+static
+PRED_IMPL("numeric_array_sum", 2, numeric_array_sum, 0)
+{ PRED_LD
+  AR_CTX
+  numeric_array *a;
+  number r;
+  int rc;
+
+  if ( !get_array(A1, &a PASS_LD) )
+    return FALSE;
+
+  AR_BEGIN();
+  if ( (rc=array_sum(a, &r)) )
+  { rc = PL_unify_number(A2, &r);
+    clearNumber(&r);
+  }
+  AR_END();
+
+  return rc;
+}
+
+
+static
+PRED_IMPL("numeric_array_dot", 3, numeric_array_dot, 0)
+{ PRED_LD
+  AR_CTX
+  numeric_array *a, *b;
+  number r;
+  int rc;
+
+  if ( !get_array(A1, &a PASS_LD) ||
+       !get_array(A2, &b PASS_LD) ||
+       !same_size(a, b, valTermRef(A2) PASS_LD) )
+    return FALSE;
+
+  AR_BEGIN();
+  if ( (rc=array_dot(a, b, &r)) )
+  { rc = PL_unify_number(A3, &r);
+    clearNumber(&r);
+  }
+  AR_END();
+
+  return rc;
+}
+
+
+static int
+min_max(term_t array, term_t value, int max ARG_LD)
+{ numeric_array *a;
+  number r;
+
+  return ( get_array(array, &a PASS_LD) &&
+	   array_min_max(a, max, &r) &&
+	   PL_unify_number(value, &r) );
+}
+
+
+static
+PRED_IMPL("numeric_array_min", 2, numeric_array_min, 0)
+{ PRED_LD
+
+  return min_max(A1, A2, FALSE PASS_LD);
+}
+
+
+static
+PRED_IMPL("numeric_array_max", 2, numeric_array_max, 0)
+{ PRED_LD
+
+  return min_max(A1, A2, TRUE PASS_LD);
+}
+
+
+/** numeric_array_scale(+Array, +Factor, -Scaled)
+ */
+
+static
+PRED_IMPL("numeric_array_scale", 3, numeric_array_scale, 0)
+{ PRED_LD
+  numeric_array *a;
+  number k;
+  int rc;
+
+  if ( !get_array(A1, &a PASS_LD) )
+    return FALSE;
+  if ( !PL_get_number(A2, &k) )
+    return PL_type_error("number", A2);
+
+  rc = unify_new_array(A3, array_scale(a, &k));
+  clearNumber(&k);
+
+  return rc;
+}
+
+
+static
+PRED_IMPL("numeric_array_add", 3, numeric_array_add, 0)
+{ PRED_LD
+  numeric_array *a, *b;
+
+  return ( get_array(A1, &a PASS_LD) &&
+	   get_array(A2, &b PASS_LD) &&
+	   same_size(a, b, valTermRef(A2) PASS_LD) &&
+	   unify_new_array(A3, array_add(a, b)) );
+}
+
+
+static
+PRED_IMPL("numeric_array_sort", 2, numeric_array_sort, 0)
+{ PRED_LD
+  numeric_array *a, *s;
+
+  if ( !get_array(A1, &a PASS_LD) ||
+       !(s = new_array(a->type, a->size)) )
+    return FALSE;
+
+  memcpy(s->data.i, a->data.i, a->size*sizeof(int64_t));
+  qsort(s->data.i, s->size, sizeof(int64_t),
+	s->type == NA_FLOAT ? compare_double : compare_int64);
+
+  return unify_array(A2, s);
+}
+
+
+		 /*******************************
+		 *      PUBLISH PREDICATES	*
+		 *******************************/
+
+BeginPredDefs(numarray)
+  PRED_DEF("numeric_array",         2, numeric_array,         0)
+  PRED_DEF("numeric_array",         3, numeric_array,         0)
+  PRED_DEF("is_numeric_array",      1, is_numeric_array,      0)
+  PRED_DEF("numeric_array_to_list", 2, numeric_array_to_list, 0)
+  PRED_DEF("numeric_array_size",    2, numeric_array_size,    0)
+  PRED_DEF("numeric_array_type",    2, numeric_array_type,    0)
+  PRED_DEF("numeric_array_get",     3, numeric_array_get,     0)
+  PRED_DEF("numeric_array_slice",   4, numeric_array_slice,   0)
+  PRED_DEF("numeric_array_sum",     2, numeric_array_sum,     0)
+  PRED_DEF("numeric_array_dot",     3, numeric_array_dot,     0)
+  PRED_DEF("numeric_array_min",     2, numeric_array_min,     0)
+  PRED_DEF("numeric_array_max",     2, numeric_array_max,     0)
+  PRED_DEF("numeric_array_scale",   3, numeric_array_scale,   0)
+  PRED_DEF("numeric_array_add",     3, numeric_array_add,     0)
+  PRED_DEF("numeric_array_sort",    2, numeric_array_sort,    0)
+EndPredDefs
+
+/* Register the blob type, so it can be found by name when loading
+   arrays from a saved state.
+*/
+
+void
+initNumericArrays(void)
+{ PL_register_blob_type(&numeric_array_blob);
+}
@@ -5293,6 +5293,14 @@ swi_statistics__LD(atom_t key, Number v, PL_local_data_t *ld)
     v->value.i = gc_status.collections;
   else if (key == ATOM_collected)
     v->value.i = gc_status.trail_gained + gc_status.global_gained;
+  else if (key == ATOM_young_collections)
+    v->value.i = gc_status.young_collections;
+  else if (key == ATOM_young_collected)
+    v->value.i = gc_status.young_gained;
+  else if (key == ATOM_young_gctime)
+  { v->type = V_FLOAT;
+    v->value.f = gc_status.young_time;
+  }
 #ifdef HAVE_BOEHM_GC
   else if ( key == ATOM_heap_gc )
     v->value.i = GC_get_gc_no();
@@ -5308,6 +5316,16 @@ swi_statistics__LD(atom_t key, Number v, PL_local_data_t *ld)
   { v->type = V_FLOAT;
     v->value.f = GD->atoms.gc_time;
   }
+  else if (key == ATOM_agc_mark_time)
+  { v->type = V_FLOAT;
+    v->value.f = GD->atoms.mark_time;
+  } else if (key == ATOM_agc_sweep_time)
+  { v->type = V_FLOAT;
+    v->value.f = GD->atoms.sweep_time;
+  } else if (key == ATOM_agc_max_pause)
+  { v->type = V_FLOAT;
+    v->value.f = GD->atoms.max_pause;
+  }
 #endif
 #ifdef O_ATOMGC
   else if (key == ATOM_cgc)
@@ -5354,6 +5372,8 @@ swi_statistics__LD(atom_t key, Number v, PL_local_data_t *ld)
     v->value.i = GD->statistics.indexes.created;
   else if (key == ATOM_indexes_destroyed)
     v->value.i = GD->statistics.indexes.destroyed;
+  else if (key == ATOM_indexes_background)
+    v->value.i = GD->statistics.indexes.background;
 
   else
     return -1;				/* unknown key */
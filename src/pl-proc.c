@@ -36,6 +36,7 @@
 /*#define O_DEBUG 1*/
 #include "pl-incl.h"
 #include "pl-dbref.h"
+#include "pl-tabling.h"
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 General  handling  of  procedures:  creation;  adding/removing  clauses;
@@ -157,10 +158,17 @@ guarantee they are not in use.
 
 void
 destroyDefinition(Definition def)
-{ ATOMIC_DEC(&GD->statistics.predicates);
+{
+#ifdef O_PLMT
+  cancelIndexJobs(def);
+#endif
+  freeOrderedIndexes(def);
+  ATOMIC_DEC(&GD->statistics.predicates);
   ATOMIC_SUB(&def->module->code_size, sizeof(*def));
 
   freeCodesDefinition(def, FALSE);
+  if ( def->tabling )
+    idg_destroy_definition(def);
 
   if ( false(def, P_FOREIGN|P_THREAD_LOCAL) )	/* normal Prolog predicate */
   { freeHeap(def->impl.any.args, sizeof(arg_info)*def->functor->arity);
@@ -1058,15 +1066,15 @@ newClauseRef(Clause clause, word key)
 }
 
 
-static void
-freeClauseRef(ClauseRef cref)
-{ Clause cl = cref->value.clause;
-
-  DEBUG(MSG_CGC_CREF_PL,
-	Sdprintf("/**/ d(%p, %p, %d).\n",
-		 cref, cl, (int)cl->references));
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+releaseClause() drops a reference to cl that was obtained by incrementing
+cl->references.  Besides clause references, ordered indexes (pl-index.c)
+hold such references.  The clause is freed if this was the last one.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-  if ( ATOMIC_DEC(&cl->references) == 0 )
+void
+releaseClause(Clause cl)
+{ if ( ATOMIC_DEC(&cl->references) == 0 )
   { size_t size = sizeofClause(cl->code_size) + SIZEOF_CREF_CLAUSE;
 
     ATOMIC_SUB(&GD->clauses.erased_size, size);
@@ -1075,7 +1083,18 @@ freeClauseRef(ClauseRef cref)
     reclaimRetracted(cl);
     freeClause(cl);
   }
+}
+
+
+static void
+freeClauseRef(ClauseRef cref)
+{ Clause cl = cref->value.clause;
 
+  DEBUG(MSG_CGC_CREF_PL,
+	Sdprintf("/**/ d(%p, %p, %d).\n",
+		 cref, cl, (int)cl->references));
+
+  releaseClause(cl);
   freeHeap(cref, SIZEOF_CREF_CLAUSE);
 }
 
@@ -1241,9 +1260,93 @@ assertProcedure(Procedure proc, Clause clause, ClauseRef where ARG_LD)
   DEBUG(CHK_SECURE, checkDefinition(def));
   UNLOCKDEF(def);
 
+  if ( true(def, P_INCREMENTAL) )
+    idg_changed(def);
+
   return cref;
 }
 
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+assertProcedures() is the batch version  of   assertProcedure(),  used by
+assertz_list/1 and friends. Clause clauses[i]   is  added to procs[i] at
+`where`, which is either CL_START or CL_END. Consecutive clauses for the
+same predicate are added while holding the  lock once and the clause
+indexes are extended once for the   whole run. All clauses are created
+in the same generation, so they  (nearly)   atomically  become visible.
+See reconsultFinalizePredicate() for the same trick.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+assertClausesDefinition(Definition def, Clause *clauses, size_t count,
+			ClauseRef where, gen_t update ARG_LD)
+{ size_t i, rules = 0;
+
+  LOCKDEF(def);
+  acquire_def(def);
+  for(i=0; i<count; i++)
+  { Clause clause = clauses[i];
+    ClauseRef cref;
+    word key;
+
+    argKey(clause->codes, 0, &key);
+    cref = newClauseRef(clause, key);
+#ifdef O_LOGICAL_UPDATE
+    clause->generation.created = update;
+    clause->generation.erased  = GEN_MAX;
+#endif
+    if ( !def->impl.clauses.last_clause )
+    { def->impl.clauses.first_clause = def->impl.clauses.last_clause = cref;
+    } else if ( where == CL_START )
+    { cref->next = def->impl.clauses.first_clause;
+      def->impl.clauses.first_clause = cref;
+    } else
+    { def->impl.clauses.last_clause->next = cref;
+      def->impl.clauses.last_clause = cref;
+    }
+    if ( false(clause, UNIT_CLAUSE) )
+      rules++;
+  }
+
+  def->impl.clauses.number_of_clauses += (unsigned int)count;
+  def->impl.clauses.number_of_rules += (unsigned int)rules;
+  ATOMIC_ADD(&GD->statistics.clauses, count);
+#ifdef O_LOGICAL_UPDATE
+  setLastModifiedPredicate(def, update);
+#endif
+
+  if ( false(def, P_DYNAMIC) )
+    freeCodesDefinition(def, TRUE);
+
+  addClausesToIndexes(def, clauses, count, where);
+  release_def(def);
+  DEBUG(CHK_SECURE, checkDefinition(def));
+  UNLOCKDEF(def);
+
+  if ( true(def, P_INCREMENTAL) )
+    idg_changed(def);
+}
+
+
+void
+assertProcedures(Procedure *procs, Clause *clauses, size_t count,
+		 ClauseRef where ARG_LD)
+{ gen_t update = global_generation()+1;
+  size_t i, start;
+
+  for(start=0; start<count; start=i)
+  { Definition def = getProcDefinition(procs[start]);
+
+    for(i=start+1; i<count && getProcDefinition(procs[i]) == def; i++)
+      ;
+    assertClausesDefinition(def, &clauses[start], i-start, where,
+			    update PASS_LD);
+  }
+
+  if ( global_generation() < update )
+    next_global_generation();
+}
+
 /*  Abolish a procedure.  Referenced  clauses  are   unlinked  and left
     dangling in the dark until the procedure referencing it deletes it.
 
@@ -1396,11 +1499,103 @@ retractClauseDefinition(Definition def, Clause clause)
   ATOMIC_INC(&GD->clauses.erased);
 
   registerDirtyDefinition(def PASS_LD);
+  if ( true(def, P_INCREMENTAL) )
+    idg_changed(def);
 
   return TRUE;
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+retractClauses() is the batch version of retractClauseDefinition(), used
+by retract_list/1. Clause clauses[i] belongs to defs[i]. The predicates
+are locked while we verify that  none   of   the  clauses was
+retracted concurrently and erase them  in   the  same generation. If a
+clause was already retracted, nothing is   changed  and we return FALSE,
+after which the caller must select the clauses again.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+retractClausesDefinition(Definition def, Clause *clauses, size_t count,
+			 gen_t update)
+{ size_t i;
+
+  assert(true(def, P_DYNAMIC));
+
+  for(i=0; i<count; i++)
+  { Clause clause = clauses[i];
+
+    set(clause, CL_ERASED);
+    deleteActiveClauseFromIndexes(def, clause);
+    def->impl.clauses.number_of_clauses--;
+    def->impl.clauses.erased_clauses++;
+    if ( false(clause, UNIT_CLAUSE) )
+      def->impl.clauses.number_of_rules--;
+#ifdef O_LOGICAL_UPDATE
+    clause->generation.erased = update;
+#endif
+    registerRetracted(clause);
+  }
+#ifdef O_LOGICAL_UPDATE
+  setLastModifiedPredicate(def, update);
+#endif
+  DEBUG(CHK_SECURE, checkDefinition(def));
+}
+
+
+int
+retractClauses(Definition *defs, Clause *clauses, size_t count ARG_LD)
+{ gen_t update;
+  size_t i, start;
+  int rc = TRUE;
+
+  if ( count == 0 )
+    return TRUE;
+
+  LOCKDEF(defs[0]);			/* L_PREDICATE: locks all predicates */
+
+  for(i=0; i<count; i++)
+  { if ( true(clauses[i], CL_ERASED) )
+    { rc = FALSE;
+      break;
+    }
+  }
+
+  if ( rc )
+  { update = global_generation()+1;
+    for(start=0; start<count; start=i)
+    { for(i=start+1; i<count && defs[i] == defs[start]; i++)
+	;
+      retractClausesDefinition(defs[start], &clauses[start], i-start, update);
+    }
+    if ( global_generation() < update )
+      next_global_generation();
+  }
+
+  UNLOCKDEF(defs[0]);
+
+  if ( rc )
+  { for(start=0; start<count; start=i)
+    { Definition def = defs[start];
+      size_t memory = 0;
+
+      for(i=start; i<count && defs[i] == def; i++)
+	memory += sizeofClause(clauses[i]->code_size) + SIZEOF_CREF_CLAUSE;
+
+      ATOMIC_SUB(&def->module->code_size, memory);
+      ATOMIC_ADD(&GD->clauses.erased_size, memory);
+      ATOMIC_ADD(&GD->clauses.erased, i-start);
+
+      registerDirtyDefinition(def PASS_LD);
+      if ( true(def, P_INCREMENTAL) )
+	idg_changed(def);
+    }
+  }
+
+  return rc;
+}
+
+
 void
 unallocClause(Clause c)
 { ATOMIC_SUB(&GD->statistics.codes, c->code_size);
@@ -2138,6 +2333,7 @@ pl_garbage_collect_clauses(void)
     markPredicatesInEnvironments(LD);
 #ifdef O_PLMT
     forThreadLocalDataUnsuspended(markPredicatesInEnvironments, 0);
+    markIndexBuilder(PASS_LD1);
 #endif
 
     DEBUG(MSG_CGC, Sdprintf("(marking done)\n"));
@@ -2607,6 +2803,182 @@ PRED_IMPL("retract", 1, retract,
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+retract_terms() implements retract_list/1 and PL_retract_list(). For each
+element of the list we select the first  clause that unifies and was not
+selected for an earlier element. If all  elements have a clause, the
+selected clauses are erased using  retractClauses(),   which  uses a
+single generation for the  whole  batch.   Otherwise  nothing  is
+retracted and we fail. The predicates are   kept accessed until we are
+done, so clause GC cannot reclaim the selected clauses. If another thread
+retracted one of the selected clauses  before   we  could erase it, we
+undo the bindings and start again, as retract/1 does.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static ClauseRef
+select_clause(term_t cl, term_t head, Definition def, Table selected ARG_LD)
+{ struct clause_choice chp;
+  ClauseRef cref;
+  Word argv;
+  fid_t fid;
+
+  argv = valTermRef(head);
+  deRef(argv);
+  if ( isTerm(*argv) )
+    argv = argTermP(*argv, 0);
+  else
+    argv = NULL;
+
+  if ( !(fid = PL_open_foreign_frame()) )
+    return NULL;
+  for(cref = firstClause(argv, environment_frame, def, &chp PASS_LD);
+      cref;
+      cref = nextClause(&chp, argv, environment_frame, def))
+  { if ( selected && lookupHTable(selected, cref->value.clause) )
+      continue;
+    if ( decompile(cref->value.clause, cl, 0) )
+      break;
+    if ( PL_exception(0) )
+    { cref = NULL;
+      break;
+    }
+    PL_rewind_foreign_frame(fid);
+  }
+  PL_close_foreign_frame(fid);
+
+  return cref;
+}
+
+
+int
+retract_terms(term_t list, Module module ARG_LD)
+{ term_t tail = PL_new_term_ref();
+  term_t elem = PL_new_term_ref();
+  term_t cl   = PL_new_term_ref();
+  term_t head = PL_new_term_ref();
+  term_t body = PL_new_term_ref();
+  term_t list0;
+  tmp_buffer defs, clauses, accessed;
+  Definition last = NULL;
+  Table selected = NULL;
+  fid_t fid;
+  int rc = TRUE;
+
+  if ( !PL_strip_module_ex(list, &module, tail) ||
+       lengthList(tail, TRUE) < 0 ||
+       !(list0 = PL_copy_term_ref(tail)) ||
+       !(fid = PL_open_foreign_frame()) )
+    return FALSE;
+
+  initBuffer(&defs);
+  initBuffer(&clauses);
+  initBuffer(&accessed);
+retry:
+  while( PL_get_list(tail, elem, tail) )
+  { Module m = module;
+    Procedure proc;
+    Definition def;
+    ClauseRef cref;
+    functor_t fd;
+    atom_t b;
+
+    if ( !PL_strip_module_ex(elem, &m, cl) ||
+	 !get_head_and_body_clause(cl, head, body, NULL PASS_LD) )
+    { rc = FALSE;
+      break;
+    }
+    if ( PL_get_atom(body, &b) && b == ATOM_true )
+      PL_put_term(cl, head);
+
+    if ( !PL_get_functor(head, &fd) )
+    { rc = PL_error(NULL, 0, NULL, ERR_TYPE, ATOM_callable, head);
+      break;
+    }
+    if ( !(proc = isCurrentProcedure(fd, m)) )
+    { checkModifySystemProc(fd);
+      rc = FALSE;
+      break;
+    }
+    def = getProcDefinition(proc);
+    if ( true(def, P_FOREIGN) ||
+	 (false(def, P_DYNAMIC) && isDefinedProcedure(proc)) )
+    { rc = PL_error(NULL, 0, NULL, ERR_MODIFY_STATIC_PROC, proc);
+      break;
+    }
+    if ( false(def, P_DYNAMIC) )
+    { setDynamicDefinition(def, TRUE);	/* implicit */
+      rc = FALSE;			/* no clauses */
+      break;
+    }
+
+    if ( def != last )
+    { setGenerationFrameVal(environment_frame, pushPredicateAccess(def));
+      addBuffer(&accessed, def, Definition);
+      last = def;
+    }
+
+    if ( !(cref = select_clause(cl, head, def, selected PASS_LD)) )
+    { rc = FALSE;
+      break;
+    }
+    if ( !selected )
+      selected = newHTable(16);
+    addNewHTable(selected, cref->value.clause, (void*)TRUE);
+    addBuffer(&defs, def, Definition);
+    addBuffer(&clauses, cref->value.clause, Clause);
+  }
+
+  if ( rc &&
+       !retractClauses(baseBuffer(&defs, Definition),
+		       baseBuffer(&clauses, Clause),
+		       entriesBuffer(&clauses, Clause) PASS_LD) )
+    rc = -1;				/* concurrently retracted */
+
+  while( !isEmptyBuffer(&accessed) )
+  { Definition def = popBuffer(&accessed, Definition);
+
+    popPredicateAccess(def);
+  }
+  if ( selected )
+  { destroyHTable(selected);
+    selected = NULL;
+  }
+
+  if ( rc == -1 )
+  { PL_rewind_foreign_frame(fid);
+    PL_put_term(tail, list0);
+    emptyBuffer(&defs);
+    emptyBuffer(&clauses);
+    last = NULL;
+    rc = TRUE;
+    goto retry;
+  }
+
+  PL_close_foreign_frame(fid);
+  discardBuffer(&defs);
+  discardBuffer(&clauses);
+  discardBuffer(&accessed);
+
+  return rc;
+}
+
+
+static
+PRED_IMPL("retract_list", 1, retract_list, PL_FA_TRANSPARENT)
+{ PRED_LD
+
+  return retract_terms(A1, NULL PASS_LD);
+}
+
+
+int
+PL_retract_list(term_t clauses, module_t module)
+{ GET_LD
+
+  return retract_terms(clauses, module PASS_LD);
+}
+
+
 static int
 allVars(int argc, Word argv ARG_LD)
 { int i, r, allvars = TRUE;
@@ -2819,6 +3191,7 @@ static const patt_mask patt_masks[] =
   { ATOM_non_terminal,	   P_NON_TERMINAL },
   { ATOM_quasi_quotation_syntax, P_QUASI_QUOTATION_SYNTAX },
   { ATOM_clausable,	   P_CLAUSABLE },
+  { ATOM_incremental,	   P_INCREMENTAL },
   { (atom_t)0,		   0 }
 };
 
@@ -3062,6 +3435,30 @@ setClausableDefinition(Definition def, int val)
   return TRUE;
 }
 
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Incremental dynamic predicates use the  S_INCR_DYNAMIC supervisor, so we
+must reset the supervisor if the property changes.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+setIncrementalDefinition(Definition def, int val)
+{ if ( (val && true(def, P_INCREMENTAL)) ||
+       (!val && false(def, P_INCREMENTAL)) )
+    return TRUE;
+
+  LOCKDEF(def);
+  if ( val )
+    set(def, P_INCREMENTAL);
+  else
+    clear(def, P_INCREMENTAL);
+  freeCodesDefinition(def, TRUE);	/* reset to S_VIRGIN */
+  UNLOCKDEF(def);
+
+  return TRUE;
+}
+
+
 int
 setAttrDefinition(Definition def, unsigned attr, int val)
 { int rc;
@@ -3072,6 +3469,8 @@ setAttrDefinition(Definition def, unsigned attr, int val)
   { rc = setThreadLocalDefinition(def, val);
   } else if ( attr == P_CLAUSABLE )
   { rc = setClausableDefinition(def, val);
+  } else if ( attr == P_INCREMENTAL )
+  { rc = setIncrementalDefinition(def, val);
   } else
   { if ( !val )
     { clear(def, attr);
@@ -3494,6 +3893,7 @@ BeginPredDefs(proc)
   PRED_DEF("$get_clause_attribute", 3, get_clause_attribute, 0)
   PRED_DEF("retract", 1, retract,
 	   PL_FA_TRANSPARENT|PL_FA_NONDETERMINISTIC|PL_FA_ISO)
+  PRED_DEF("retract_list", 1, retract_list, PL_FA_TRANSPARENT)
   PRED_DEF("copy_predicate_clauses", 2, copy_predicate_clauses, PL_FA_TRANSPARENT)
   PRED_DEF("$cgc_params", 6, cgc_params, 0)
 EndPredDefs
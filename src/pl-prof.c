@@ -1150,6 +1150,394 @@ freeProfileData(void)
   assert(LD->profile.nodes == 0);
 }
 
+
+#ifdef O_PLMT
+
+		 /*******************************
+		 *	 SAMPLING PROFILER	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+The sampling profiler records  the  call  stack   of  all  threads  at a
+regular interval. Unlike the profiler above,   it does not instrument
+the ports and it can profile all threads concurrently.
+
+The sampler is a Prolog thread  (see library(prolog_sampler)) that calls
+'$prof_sample_tick'/0 at the sampling rate.   For all other running
+threads, this increments LD->profile.sample_pending and raises
+SIG_PROF_SAMPLE. A thread handles the signal at   the next safe point,
+where recordProfileSample() walks its  own   environment  chain and adds
+the stack to a table that maps stacks to sample counts, weighted by the
+number of ticks that were pending. Threads thus never inspect each
+other's stacks and the sampler never waits for a thread.
+
+Threads that wait for a message  check   for  signals regularly and are
+sampled in the predicate they  are  waiting  in.   Ticks  that arrive
+while a thread is in a blocking   system call or in foreign code that
+does not check for signals are  recorded   at  the  next safe point. As
+all ticks are counted, the profile represents wall time.
+
+Stacks are stored as  (module-name,  functor)   pairs  rather  than as
+predicates such that the data remains  valid   if  a  predicate or its
+module is destroyed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define SAMPLE_MAX_DEPTH	1024	/* Max frames recorded per sample */
+#define SAMPLE_INITIAL_BUCKETS	256
+
+typedef struct sample_frame
+{ atom_t	module;			/* Name of the module */
+  functor_t	functor;		/* Predicate functor */
+} sample_frame;
+
+typedef struct sample_stack
+{ struct sample_stack *next;		/* Next in hash bucket */
+  unsigned int	hash;			/* Hash of the stack */
+  int		thread;			/* Prolog thread id */
+  atom_t	alias;			/* Thread alias or 0 */
+  int		depth;			/* # frames */
+  int		truncated;		/* Stack was deeper than max_depth */
+  uintptr_t	count;			/* # samples */
+  sample_frame	frames[1];		/* Frames, innermost first */
+} sample_stack;
+
+static struct
+{ int		active;			/* Sampling is enabled */
+  int		max_depth;		/* Max frames per sample */
+  uintptr_t	ticks;			/* # calls to '$prof_sample_tick' */
+  uintptr_t	samples;		/* # recorded samples */
+  size_t	entries;		/* # distinct stacks */
+  size_t	bucket_count;		/* # hash buckets */
+  sample_stack **buckets;		/* The hash table */
+} sampler;
+
+static sample_frame sample_buffer[SAMPLE_MAX_DEPTH]; /* guarded by L_PROFILE */
+
+static int
+same_sample(sample_stack *s, unsigned int hash, int thread,
+	    const sample_frame *frames, int depth, int truncated)
+{ return ( s->hash == hash &&
+	   s->thread == thread &&
+	   s->depth == depth &&
+	   s->truncated == truncated &&
+	   memcmp(s->frames, frames, depth*sizeof(*frames)) == 0 );
+}
+
+
+static void
+rehashSamples(void)
+{ size_t newcount = sampler.bucket_count ? sampler.bucket_count*2
+					 : SAMPLE_INITIAL_BUCKETS;
+  sample_stack **newb = allocHeapOrHalt(newcount*sizeof(*newb));
+  size_t i;
+
+  memset(newb, 0, newcount*sizeof(*newb));
+  for(i=0; i<sampler.bucket_count; i++)
+  { sample_stack *s, *next;
+
+    for(s=sampler.buckets[i]; s; s=next)
+    { size_t k = s->hash & (newcount-1);
+
+      next = s->next;
+      s->next = newb[k];
+      newb[k] = s;
+    }
+  }
+
+  if ( sampler.buckets )
+    freeHeap(sampler.buckets, sampler.bucket_count*sizeof(*sampler.buckets));
+  sampler.buckets = newb;
+  sampler.bucket_count = newcount;
+}
+
+
+/* Must be called with L_PROFILE held */
+
+static void
+addSample(int thread, const sample_frame *frames, int depth, int truncated,
+	  unsigned int count)
+{ unsigned int hash = MurmurHashAligned2(frames, depth*sizeof(*frames),
+					 (unsigned int)thread*2+truncated);
+  sample_stack *s;
+  size_t k;
+
+  if ( !sampler.active )
+    return;
+  if ( sampler.entries >= sampler.bucket_count*2 )
+    rehashSamples();
+
+  k = hash & (sampler.bucket_count-1);
+  for(s=sampler.buckets[k]; s; s=s->next)
+  { if ( same_sample(s, hash, thread, frames, depth, truncated) )
+      break;
+  }
+
+  if ( !s )
+  { size_t size = offsetof(sample_stack, frames[depth]);
+    int i;
+
+    s = allocHeapOrHalt(size);
+    s->hash      = hash;
+    s->thread    = thread;
+    s->depth     = depth;
+    s->truncated = truncated;
+    s->count     = 0;
+    memcpy(s->frames, frames, depth*sizeof(*frames));
+    for(i=0; i<depth; i++)
+      PL_register_atom(frames[i].module);
+    if ( PL_get_thread_alias(thread, &s->alias) )
+      PL_register_atom(s->alias);
+    else
+      s->alias = 0;
+    s->next = sampler.buckets[k];
+    sampler.buckets[k] = s;
+    sampler.entries++;
+  }
+  s->count += count;
+  sampler.samples += count;
+}
+
+
+static void
+freeSamples(void)
+{ size_t i;
+
+  for(i=0; i<sampler.bucket_count; i++)
+  { sample_stack *s, *next;
+
+    for(s=sampler.buckets[i]; s; s=next)
+    { int f;
+
+      next = s->next;
+      for(f=0; f<s->depth; f++)
+	PL_unregister_atom(s->frames[f].module);
+      if ( s->alias )
+	PL_unregister_atom(s->alias);
+      freeHeap(s, offsetof(sample_stack, frames[s->depth]));
+    }
+    sampler.buckets[i] = NULL;
+  }
+  sampler.entries = 0;
+  sampler.samples = 0;
+  sampler.ticks   = 0;
+}
+
+
+/* recordProfileSample() is the SIG_PROF_SAMPLE handler.  It is called
+   from handleSignals() and thus at a point where the environment
+   chain is consistent.
+*/
+
+void
+recordProfileSample(void)
+{ GET_LD
+  unsigned int count;
+  LocalFrame fr;
+  int depth = 0;
+
+  do
+  { count = LD->profile.sample_pending;
+  } while ( !COMPARE_AND_SWAP(&LD->profile.sample_pending, count, 0) );
+
+  if ( count == 0 || !sampler.active )
+    return;
+
+  PL_LOCK(L_PROFILE);
+  for(fr = environment_frame;
+      fr && depth < sampler.max_depth;
+      fr = parentFrame(fr))
+  { Definition def = fr->predicate;
+
+    sample_buffer[depth].module  = def->module->name;
+    sample_buffer[depth].functor = def->functor->functor;
+    depth++;
+  }
+
+  if ( depth > 0 )
+    addSample(PL_thread_self(), sample_buffer, depth, fr != NULL, count);
+  PL_UNLOCK(L_PROFILE);
+}
+
+
+/* request_sample() is called by the sampler thread for each other
+   running thread.
+*/
+
+static int
+request_sample(PL_thread_info_t *info, PL_local_data_t *ld)
+{ (void)info;
+
+  ATOMIC_INC(&ld->profile.sample_pending);
+  return raiseSignal(ld, SIG_PROF_SAMPLE);
+}
+
+
+/** '$prof_sample_start'(+MaxDepth)
+ *  '$prof_sample_stop'
+ *
+ * Enable/disable recording samples.  Samples are only triggered if the
+ * sampler thread calls '$prof_sample_tick'/0.
+ */
+
+static
+PRED_IMPL("$prof_sample_start", 1, prof_sample_start, 0)
+{ int depth;
+
+  if ( !PL_get_integer_ex(A1, &depth) )
+    return FALSE;
+  if ( depth < 1 || depth > SAMPLE_MAX_DEPTH )
+    return PL_error(NULL, 0, NULL, ERR_DOMAIN, ATOM_max_depth, A1);
+
+  PL_LOCK(L_PROFILE);
+  if ( !sampler.buckets )
+    rehashSamples();
+  sampler.max_depth = depth;
+  sampler.active = TRUE;
+  PL_UNLOCK(L_PROFILE);
+
+  return TRUE;
+}
+
+
+static
+PRED_IMPL("$prof_sample_stop", 0, prof_sample_stop, 0)
+{ PL_LOCK(L_PROFILE);
+  sampler.active = FALSE;
+  PL_UNLOCK(L_PROFILE);
+
+  return TRUE;
+}
+
+
+static
+PRED_IMPL("$prof_sample_reset", 0, prof_sample_reset, 0)
+{ PL_LOCK(L_PROFILE);
+  freeSamples();
+  PL_UNLOCK(L_PROFILE);
+
+  return TRUE;
+}
+
+
+/** '$prof_sample_tick'
+ *
+ * Record a sample of all other running threads.
+ */
+
+static
+PRED_IMPL("$prof_sample_tick", 0, prof_sample_tick, 0)
+{ int active;
+
+  PL_LOCK(L_PROFILE);
+  if ( (active = sampler.active) )
+    sampler.ticks++;
+  PL_UNLOCK(L_PROFILE);
+
+  if ( active )
+    forOtherRunningThreads(request_sample);
+
+  return TRUE;
+}
+
+
+/** '$prof_sample_statistics'(-Ticks, -Samples, -Stacks)
+ */
+
+static
+PRED_IMPL("$prof_sample_statistics", 3, prof_sample_statistics, 0)
+{ PRED_LD
+  uintptr_t ticks, samples;
+  size_t stacks;
+
+  PL_LOCK(L_PROFILE);
+  ticks   = sampler.ticks;
+  samples = sampler.samples;
+  stacks  = sampler.entries;
+  PL_UNLOCK(L_PROFILE);
+
+  return ( PL_unify_int64(A1, ticks) &&
+	   PL_unify_int64(A2, samples) &&
+	   PL_unify_int64(A3, stacks) );
+}
+
+
+static int
+unify_sample_frame(term_t t, const sample_frame *f)
+{ GET_LD
+
+  return PL_unify_term(t,
+		       PL_FUNCTOR, FUNCTOR_colon2,
+			 PL_ATOM, f->module,
+			 PL_FUNCTOR, FUNCTOR_divide2,
+			   PL_ATOM, nameFunctor(f->functor),
+			   PL_INT, (int)arityFunctor(f->functor));
+}
+
+
+static int
+unify_sample(term_t t, sample_stack *s)
+{ GET_LD
+  term_t av    = PL_new_term_refs(4);
+  term_t tail  = PL_copy_term_ref(av+2);
+  term_t head  = PL_new_term_ref();
+  int i;
+
+  if ( s->alias )
+    PL_put_atom(av+0, s->alias);
+  else
+    PL_put_integer(av+0, s->thread);
+  PL_put_atom(av+1, s->truncated ? ATOM_true : ATOM_false);
+  for(i=s->depth-1; i>=0; i--)		/* outermost first */
+  { if ( !PL_unify_list(tail, head, tail) ||
+	 !unify_sample_frame(head, &s->frames[i]) )
+      return FALSE;
+  }
+  if ( !PL_unify_nil(tail) ||
+       !PL_put_int64(av+3, s->count) )
+    return FALSE;
+
+  return PL_unify_term(t,
+		       PL_FUNCTOR_CHARS, "sample", 4,
+			 PL_TERM, av+0,
+			 PL_TERM, av+1,
+			 PL_TERM, av+2,
+			 PL_TERM, av+3);
+}
+
+
+/** '$prof_samples'(-Samples)
+ *
+ * Samples is a list of sample(Thread, Truncated, Stack, Count), where
+ * Stack is a list of Module:Name/Arity, outermost first.
+ */
+
+static
+PRED_IMPL("$prof_samples", 1, prof_samples, 0)
+{ PRED_LD
+  term_t tail = PL_copy_term_ref(A1);
+  term_t head = PL_new_term_ref();
+  int rc = TRUE;
+  size_t i;
+
+  PL_LOCK(L_PROFILE);
+  for(i=0; rc && i<sampler.bucket_count; i++)
+  { sample_stack *s;
+
+    for(s=sampler.buckets[i]; s; s=s->next)
+    { if ( !PL_unify_list(tail, head, tail) ||
+	   !unify_sample(head, s) )
+      { rc = FALSE;
+	break;
+      }
+    }
+  }
+  PL_UNLOCK(L_PROFILE);
+
+  return rc && PL_unify_nil(tail);
+}
+
+#endif /*O_PLMT*/
+
 #else /* O_PROFILE */
 
 		 /*******************************
@@ -1244,6 +1632,14 @@ BeginPredDefs(profile)
   PRED_DEF("$prof_sibling_of", 2, prof_sibling_of, PL_FA_NONDETERMINISTIC)
   PRED_DEF("$prof_procedure_data", 7, prof_procedure_data, PL_FA_TRANSPARENT)
   PRED_DEF("$prof_statistics", 5, prof_statistics, 0)
+#if defined(O_PROFILE) && defined(O_PLMT)
+  PRED_DEF("$prof_sample_start", 1, prof_sample_start, 0)
+  PRED_DEF("$prof_sample_stop", 0, prof_sample_stop, 0)
+  PRED_DEF("$prof_sample_reset", 0, prof_sample_reset, 0)
+  PRED_DEF("$prof_sample_tick", 0, prof_sample_tick, 0)
+  PRED_DEF("$prof_sample_statistics", 3, prof_sample_statistics, 0)
+  PRED_DEF("$prof_samples", 1, prof_samples, 0)
+#endif
 #ifdef O_PROF_PENTIUM
   PRED_DEF("show_pentium_profile", 0, show_pentium_profile, 0)
   PRED_DEF("reset_pentium_profile", 0, reset_pentium_profile, 0)
@@ -49,5 +49,8 @@ COMMON(void)		profResumeParent(struct call_node *node ARG_LD);
 COMMON(void)		profExit(struct call_node *node ARG_LD);
 COMMON(void)		profRedo(struct call_node *node ARG_LD);
 COMMON(void)		profSetHandle(struct call_node *node, void *handle);
+#ifdef SIG_PROF_SAMPLE
+COMMON(void)		recordProfileSample(void);
+#endif
 
 #endif /*PL_PROF_H_INCLUDED*/
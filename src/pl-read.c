@@ -4841,6 +4841,147 @@ PRED_IMPL("read_clause", 3, read_clause, 0)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+'$load_facts'(+Stream, +Module, -Count, -Term)
+
+Bulk loader for library(load_facts). Reads  clauses from Stream using the
+syntax of Module and adds each ground fact  to the end of its predicate
+in Module, compiling it directly from  the   term  we read.  The global
+stack is rewound after each fact, so   loading  a large file neither
+grows the stacks nor triggers GC.  Term   is unified with the first term
+that is not a plain ground fact  (a   rule,  directive, grammar rule,
+qualified term, term using functional   notation or `end_of_file`) and
+Count with the number of facts added.  These are left to Prolog, which
+passes them through term expansion.
+Syntax errors are printed and skipped as in read_clause/3.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define BULK_FACT_MAX_DEPTH 100
+
+static int
+is_ground_data(Word p, functor_t fdot, int depth ARG_LD)
+{ for(;;)
+  { deRef(p);
+
+    if ( canBind(*p) )
+      return FALSE;
+    if ( isTerm(*p) )
+    { Functor f = valueTerm(*p);
+      size_t i, arity = arityFunctor(f->definition);
+
+      if ( f->definition == fdot )		/* functional notation */
+	return FALSE;
+      if ( arity == 0 )
+	return TRUE;
+      if ( arity > 1 && depth >= BULK_FACT_MAX_DEPTH )
+	return FALSE;			/* leave deep terms to Prolog */
+      for(i=0; i<arity-1; i++)
+      { if ( !is_ground_data(&f->arguments[i], fdot, depth+1 PASS_LD) )
+	  return FALSE;
+      }
+      p = &f->arguments[arity-1];
+      continue;
+    }
+
+    return TRUE;
+  }
+}
+
+
+static int
+is_bulk_fact(term_t t, functor_t fdot ARG_LD)
+{ Word p = valTermRef(t);
+
+  deRef(p);
+  if ( isTerm(*p) )
+  { functor_t f = functorTerm(*p);
+
+    if ( f == FUNCTOR_prove2 || f == FUNCTOR_prove1 ||
+	 f == FUNCTOR_query1 || f == FUNCTOR_grammar2 ||
+	 f == FUNCTOR_colon2 || f == FUNCTOR_colon_eq2 )
+      return FALSE;
+
+    return is_ground_data(p, fdot, 0 PASS_LD);
+  }
+
+  return isTextAtom(*p) && *p != ATOM_end_of_file;
+}
+
+
+static
+PRED_IMPL("$load_facts", 4, load_facts, 0)
+{ PRED_LD
+  IOSTREAM *s;
+  atom_t mname;
+  Module m;
+  term_t t, mt, qt;
+  fid_t fid;
+  functor_t fdot = 0;
+  int64_t count = 0;
+  int rc;
+
+  if ( ATOM_dot != codeToAtom('.') )	/* SWI-7: '.'/2 is a dict call */
+    fdot = lookupFunctorDef(codeToAtom('.'), 2);
+
+  if ( !PL_get_atom_ex(A2, &mname) )
+    return FALSE;
+  m = lookupModule(mname);
+  if ( !(t  = PL_new_term_ref()) ||
+       !(mt = PL_new_term_ref()) ||
+       !(qt = PL_new_term_ref()) )
+    return FALSE;
+  PL_put_atom(mt, mname);
+  if ( !getTextInputStream(A1, &s) )
+    return FALSE;
+  if ( !(fid=PL_open_foreign_frame()) )
+  { PL_release_stream(s);
+    return FALSE;
+  }
+
+  for(;;)
+  { read_data rd;
+
+    init_read_data(&rd, s PASS_LD);
+    set_module_read_data(&rd, m);
+    rd.on_error = ATOM_dec10;
+    rc = read_term(t, &rd PASS_LD);
+    if ( !rc && rd.has_exception && reportReadError(&rd) )
+    { LD->exception.processing = FALSE;
+      PL_rewind_foreign_frame(fid);
+      free_read_data(&rd);
+      continue;
+    }
+    free_read_data(&rd);
+    if ( !rc )
+      break;
+
+    if ( !is_bulk_fact(t, fdot PASS_LD) )
+    { rc = PL_unify(A4, t);
+      break;
+    }
+    if ( !PL_cons_functor(qt, FUNCTOR_colon2, mt, t) ||
+	 !assert_term(qt, CL_END, NULL_ATOM, NULL PASS_LD) )
+    { rc = FALSE;
+      break;
+    }
+    count++;
+    PL_rewind_foreign_frame(fid);
+
+    if ( (count % 1024) == 0 && PL_handle_signals() < 0 )
+    { rc = FALSE;
+      break;
+    }
+  }
+  PL_close_foreign_frame(fid);
+
+  if ( Sferror(s) )
+    return streamStatus(s);
+  PL_release_stream(s);
+
+  return rc && PL_unify_int64(A3, count);
+}
+
+
 static const opt_spec read_term_options[] =
 { { ATOM_variable_names,    OPT_TERM },
   { ATOM_variables,         OPT_TERM },
@@ -5285,6 +5426,7 @@ BeginPredDefs(read)
   PRED_DEF("read_term",		  3, read_term,		  PL_FA_ISO)
   PRED_DEF("read_term",		  2, read_term,		  PL_FA_ISO)
   PRED_DEF("read_clause",	  3, read_clause,	  0)
+  PRED_DEF("$load_facts",	  4, load_facts,	  0)
   PRED_DEF("read_term_from_atom", 3, read_term_from_atom, 0)
   PRED_DEF("atom_to_term",	  3, atom_to_term,	  0)
   PRED_DEF("term_to_atom",	  2, term_to_atom,	  0)
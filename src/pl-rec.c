@@ -45,7 +45,6 @@ static RecordList lookupRecordList(word);
 static RecordList isCurrentRecordList(word, int must_be_non_empty);
 static void freeRecordRef(RecordRef r);
 static void unallocRecordList(RecordList rl);
-static int  is_external(const char *rec, size_t len);
 
 #define RECORDA 0
 #define RECORDZ 1
@@ -1560,7 +1559,7 @@ copyRecordToGlobal(term_t copy, Record r, int flags ARG_LD)
 }
 
 
-static int
+int
 is_external(const char *rec, size_t len)
 { if ( len >= 2 )
   { copy_info info;
@@ -41,11 +41,22 @@
 #include "pl-dbref.h"
 #include "pl-trie.h"
 #include "pl-tabling.h"
+#include "pl-prof.h"
+#include "pl-vmstat.h"
 #include <sys/stat.h>
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
 #include <errno.h>
+#ifdef O_MMAP_STACKS
+#include <sys/mman.h>
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+#endif
 
 #undef max
 #define max(a,b) ((a) > (b) ? (a) : (b))
@@ -117,6 +128,8 @@ setupProlog(void)
   initRecords();
   DEBUG(1, Sdprintf("Tries ...\n"));
   initTries();
+  DEBUG(1, Sdprintf("Numeric arrays ...\n"));
+  initNumericArrays();
   DEBUG(1, Sdprintf("Flags ...\n"));
   initFlags();
   DEBUG(1, Sdprintf("Foreign Predicates ...\n"));
@@ -305,6 +318,12 @@ static struct signame
 #endif
   { SIG_CLAUSE_GC,     "prolog:clause_gc",     0 },
   { SIG_PLABORT,       "prolog:abort",         0 },
+#ifdef SIG_ATOM_MARK
+  { SIG_ATOM_MARK,     "prolog:atom_mark",     0 },
+#endif
+#ifdef SIG_PROF_SAMPLE
+  { SIG_PROF_SAMPLE,   "prolog:prof_sample",   0 },
+#endif
 
   { -1,		NULL,     0}
 };
@@ -698,6 +717,26 @@ agc_handler(int sig)
 }
 
 
+#ifdef SIG_ATOM_MARK
+static void
+agc_mark_handler(int sig)
+{ (void)sig;
+
+  markAtomsAtSafePoint();
+}
+#endif
+
+
+#ifdef SIG_PROF_SAMPLE
+static void
+prof_sample_handler(int sig)
+{ (void)sig;
+
+  recordProfileSample();
+}
+#endif
+
+
 static void
 gc_handler(int sig)
 { (void)sig;
@@ -792,6 +831,12 @@ initSignals(void)
 #ifdef SIG_ATOM_GC
   PL_signal(SIG_ATOM_GC|PL_SIGSYNC,       agc_handler);
 #endif
+#ifdef SIG_ATOM_MARK
+  PL_signal(SIG_ATOM_MARK|PL_SIGSYNC,     agc_mark_handler);
+#endif
+#ifdef SIG_PROF_SAMPLE
+  PL_signal(SIG_PROF_SAMPLE|PL_SIGSYNC|PL_SIGNOFRAME, prof_sample_handler);
+#endif
 }
 
 
@@ -1377,6 +1422,372 @@ init_stack(Stack s, char *name, size_t size, size_t spare, int gc)
 }
 
 
+#ifdef O_MMAP_STACKS
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Reserved virtual memory stacks
+
+If the OS allows us to, we reserve address space for the global, local
+and trail stacks at thread creation using  a single mmap() with PROT_NONE
+protection. The address space is split in three regions of equal size,
+holding the global, local and trail stack.   Each region is large enough
+to hold all stacks for the current  stack_limit.   Growing or shrinking
+a stack merely changes the protection  of   pages  at  the  end  of its
+region, so the stacks never move and  there   is  no need to relocate
+the pointers on the stacks.   Shrinking  returns   the  pages  to  the
+OS using madvise().
+
+The region size is bounded  by  MAX_VM_STACK_REGION,   such  that  we do
+not run out of address  space  if  there   are  many  threads  with  a
+huge stack limit.  If a stack outgrows its region, i.e., after raising
+the stack_limit flag, we reserve a new,   larger, area and move the stacks
+as the malloc() based implementation does.
+
+Note that the local stack is not  adjacent   to  the  global stack, but
+still located above it, which is all the VM relies upon.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define MAX_VM_STACK_REGION ((size_t)32<<30)
+
+static size_t
+vm_page_size(void)
+{ static size_t psize = 0;
+
+  if ( !psize )
+  { long sz;
+
+#ifdef HAVE_SYSCONF
+    sz = sysconf(_SC_PAGESIZE);
+#else
+    sz = getpagesize();
+#endif
+    psize = (sz > 0 ? (size_t)sz : 4096);
+  }
+
+  return psize;
+}
+
+
+static size_t
+vm_region_size(size_t size)
+{ if ( size > MAX_VM_STACK_REGION )
+    size = MAX_VM_STACK_REGION;
+
+  return ROUND(size, vm_page_size());
+}
+
+
+static char *
+vm_reserve(size_t size)
+{ void *mem = mmap(NULL, size, PROT_NONE,
+		   MAP_PRIVATE|MAP_ANONYMOUS|MAP_NORESERVE, -1, 0);
+
+  return mem == MAP_FAILED ? NULL : mem;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+vm_commit() changes the accessible part of  the region that starts at
+`region` from `osize` to `size` bytes.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static int
+vm_commit(char *region, size_t osize, size_t size)
+{ size_t psize = vm_page_size();
+  size_t o = ROUND(osize, psize);
+  size_t n = ROUND(size, psize);
+
+  if ( n > o )
+  { if ( mprotect(region+o, n-o, PROT_READ|PROT_WRITE) != 0 )
+      return FALSE;
+  } else if ( n < o )
+  {
+#ifdef MADV_DONTNEED
+    madvise(region+n, o-n, MADV_DONTNEED);
+#endif
+    mprotect(region+n, o-n, PROT_NONE);
+  }
+
+  if ( size > osize )
+    ATOMIC_ADD(&GD->statistics.stack_space, size-osize);
+  else
+    ATOMIC_SUB(&GD->statistics.stack_space, osize-size);
+
+  return TRUE;
+}
+
+
+static char *
+vm_alloc_stacks(size_t vsize, size_t sizes[3])
+{ char *base;
+  int i;
+
+  if ( !(base = vm_reserve(3*vsize)) )
+    return NULL;
+
+  for(i=0; i<3; i++)
+  { if ( !vm_commit(base+i*vsize, 0, sizes[i]) )
+    { while(--i >= 0)
+	vm_commit(base+i*vsize, sizes[i], 0);
+      munmap(base, 3*vsize);
+      return NULL;
+    }
+  }
+
+  return base;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Released regions are kept in a small cache.   Engines and short lived
+threads otherwise spend most of their life  in mmap() and munmap() and
+faulting in the initial pages  of  their   stacks.  A cached region keeps
+at most VM_CACHE_KEEP committed bytes per   stack, such that the cache
+does not hold on to the memory of a thread that used large stacks.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define VM_CACHE_SIZE 16
+#define VM_CACHE_KEEP (16*SIZEOF_VOIDP K)
+
+typedef struct vm_region
+{ char   *base;				/* Reserved address space */
+  size_t  size;				/* Size of each region */
+  size_t  committed[3];			/* Committed global, local, trail */
+} vm_region;
+
+static vm_region vm_cache[VM_CACHE_SIZE];
+static int	 vm_cache_count = 0;
+
+static int
+vm_cache_put(char *base, size_t vsize, size_t committed[3])
+{ int rc = FALSE;
+
+  PL_LOCK(L_STACKS);
+  if ( vm_cache_count < VM_CACHE_SIZE &&
+       GD->cleaning == CLN_NORMAL )
+  { vm_region *r = &vm_cache[vm_cache_count++];
+    int i;
+
+    for(i=0; i<3; i++)
+    { if ( committed[i] > VM_CACHE_KEEP )
+      { vm_commit(base+i*vsize, committed[i], VM_CACHE_KEEP);
+	committed[i] = VM_CACHE_KEEP;
+      }
+    }
+    r->base = base;
+    r->size = vsize;
+    memcpy(r->committed, committed, sizeof(r->committed));
+    rc = TRUE;
+  }
+  PL_UNLOCK(L_STACKS);
+
+  return rc;
+}
+
+
+static char *
+vm_cache_get(size_t vsize, size_t committed[3])
+{ char *base = NULL;
+  int i;
+
+  PL_LOCK(L_STACKS);
+  for(i=vm_cache_count-1; i>=0; i--)
+  { if ( vm_cache[i].size == vsize )
+    { base = vm_cache[i].base;
+      memcpy(committed, vm_cache[i].committed, sizeof(vm_cache[i].committed));
+      vm_cache[i] = vm_cache[--vm_cache_count];
+      break;
+    }
+  }
+  PL_UNLOCK(L_STACKS);
+
+  if ( base )
+    ATOMIC_ADD(&GD->statistics.stack_space,
+	       committed[0]+committed[1]+committed[2]);
+
+  return base;
+}
+
+
+void
+cleanupStackCache(void)
+{ PL_LOCK(L_STACKS);
+  while( vm_cache_count > 0 )
+  { vm_region *r = &vm_cache[--vm_cache_count];
+
+    munmap(r->base, 3*r->size);
+  }
+  PL_UNLOCK(L_STACKS);
+}
+
+
+/* Cached regions do not count as stack space.  vm_cache_put() trims
+   the regions using vm_commit(), which accounts for the trimmed part,
+   and leaves the kept sizes in committed.
+*/
+
+static void
+vm_free_stacks(ARG1_LD)
+{ size_t *committed = LD->stacks.vm.committed;
+  int cached = vm_cache_put(LD->stacks.vm.base, LD->stacks.vm.size,
+			    committed);
+
+  ATOMIC_SUB(&GD->statistics.stack_space,
+	     committed[0] + committed[1] + committed[2]);
+  if ( !cached )
+    munmap(LD->stacks.vm.base, 3*LD->stacks.vm.size);
+  LD->stacks.vm.base = NULL;
+}
+
+
+static int
+vm_alloc_initial_stacks(size_t iglobal, size_t ilocal, size_t itrail ARG_LD)
+{ size_t vsize = vm_region_size(LD->stacks.limit);
+  size_t sizes[3];
+  size_t committed[3];
+  char *base;
+  int i;
+
+  sizes[0] = iglobal;
+  sizes[1] = ilocal;
+  sizes[2] = itrail;
+
+  if ( vsize < iglobal || vsize < ilocal || vsize < itrail )
+    return FALSE;
+
+  if ( (base = vm_cache_get(vsize, committed)) )
+  { for(i=0; i<3; i++)
+    { if ( sizes[i] > committed[i] )
+      { if ( !vm_commit(base+i*vsize, committed[i], sizes[i]) )
+	{ LD->stacks.vm.base = base;
+	  LD->stacks.vm.size = vsize;
+	  memcpy(LD->stacks.vm.committed, committed, sizeof(committed));
+	  vm_free_stacks(PASS_LD1);
+	  return FALSE;
+	}
+	committed[i] = sizes[i];
+      }
+    }
+  } else if ( (base = vm_alloc_stacks(vsize, sizes)) )
+  { memcpy(committed, sizes, sizeof(sizes));
+  } else
+    return FALSE;
+
+  LD->stacks.vm.base = base;
+  LD->stacks.vm.size = vsize;
+  memcpy(LD->stacks.vm.committed, committed, sizeof(committed));
+
+  gBase = (Word)       base;
+  lBase = (LocalFrame) (base+vsize);
+  tBase = (TrailEntry) (base+2*vsize);
+
+  return TRUE;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+resize_vm_stacks() is called by grow_stacks() from  pl-gc.c to resize the
+stacks if they live in reserved   address  space. The sizes include the
+marked cell below the global stack. On  success, *gb, *lb and *tb hold
+the new bases of the stacks, which only differ from the current bases if
+a stack outgrew its region.  Returns FALSE if there is not enough memory,
+leaving the stacks untouched.
+
+Shrinking a stack does not  release   its  pages:  the  garbage collector
+shrinks and grows the stacks frequently and  giving the pages back to the
+OS would make us pay for the page faults   over  and over again. This is
+left to trim_vm_stacks(), which is called by trimStacks().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+int
+resize_vm_stacks(size_t gsize, size_t lsize, size_t tsize,
+		 Word *gb, LocalFrame *lb, TrailEntry *tb ARG_LD)
+{ char *base = LD->stacks.vm.base;
+  size_t vsize = LD->stacks.vm.size;
+  size_t *committed = LD->stacks.vm.committed;
+  size_t sizes[3];
+  int i;
+
+  sizes[0] = gsize;
+  sizes[1] = lsize;
+  sizes[2] = tsize;
+
+  if ( gsize <= vsize && lsize <= vsize && tsize <= vsize )
+  { for(i=0; i<3; i++)
+    { if ( sizes[i] > committed[i] )
+      { if ( !vm_commit(base+i*vsize, committed[i], sizes[i]) )
+	{ while(--i >= 0)		/* roll back */
+	  { if ( sizes[i] > committed[i] )
+	      vm_commit(base+i*vsize, sizes[i], committed[i]);
+	  }
+	  return FALSE;
+	}
+      }
+    }
+    for(i=0; i<3; i++)
+    { if ( sizes[i] > committed[i] )
+	committed[i] = sizes[i];
+    }
+  } else				/* outgrew the reservation */
+  { char *nbase;
+    size_t nsize = LD->stacks.limit;
+
+    nsize = max(nsize, gsize);
+    nsize = max(nsize, lsize);
+    nsize = max(nsize, tsize);
+    nsize = ROUND(nsize, vm_page_size());
+
+    if ( !(nbase = vm_alloc_stacks(nsize, sizes)) )
+      return FALSE;
+    for(i=0; i<3; i++)
+    { size_t copy = (sizes[i] < committed[i] ? sizes[i] : committed[i]);
+
+      memcpy(nbase+i*nsize, base+i*vsize, copy);
+    }
+    vm_free_stacks(PASS_LD1);
+
+    LD->stacks.vm.base = base = nbase;
+    LD->stacks.vm.size = vsize = nsize;
+    memcpy(committed, sizes, sizeof(sizes));
+  }
+
+  *gb = (Word)       base;
+  *lb = (LocalFrame) (base+vsize);
+  *tb = (TrailEntry) (base+2*vsize);
+
+  return TRUE;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+trim_vm_stacks() returns the pages above the  current size of the stacks
+(including the spare and the extra cell   at the end of the global and
+trail stack; see initPrologStacks()) to the OS.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+trim_vm_stacks(ARG1_LD)
+{ char *base = LD->stacks.vm.base;
+  size_t vsize = LD->stacks.vm.size;
+  size_t *committed = LD->stacks.vm.committed;
+  size_t sizes[3];
+  int i;
+
+  sizes[0] = ((char*)(gMax+1) + LD->stacks.global.spare) - base;
+  sizes[1] = ((char*)lMax     + LD->stacks.local.spare)  - (base+vsize);
+  sizes[2] = ((char*)(tMax+1) + LD->stacks.trail.spare)  - (base+2*vsize);
+
+  for(i=0; i<3; i++)
+  { if ( sizes[i] < committed[i] )
+    { vm_commit(base+i*vsize, committed[i], sizes[i]);
+      committed[i] = sizes[i];
+    }
+  }
+}
+
+#endif /*O_MMAP_STACKS*/
+
+
 static int
 allocStacks(void)
 { GET_LD
@@ -1390,11 +1801,18 @@ allocStacks(void)
   size_t ilocal  = nextStackSizeAbove(minlocal-1);
 
   gBase = NULL;
+  lBase = NULL;
   tBase = NULL;
   aBase = NULL;
 
-  gBase = (Word)       stack_malloc(iglobal + ilocal);
-  tBase = (TrailEntry) stack_malloc(itrail);
+#ifdef O_MMAP_STACKS
+  LD->stacks.vm.base = NULL;
+  if ( GD->options.nommapstacks ||
+       !vm_alloc_initial_stacks(iglobal, ilocal, itrail PASS_LD) )
+#endif
+  { gBase = (Word)       stack_malloc(iglobal + ilocal);
+    tBase = (TrailEntry) stack_malloc(itrail);
+  }
   aBase = (Word *)     stack_malloc(minarg);
 
   if ( !gBase || !tBase || !aBase )
@@ -1404,7 +1822,8 @@ allocStacks(void)
     return FALSE;
   }
 
-  lBase = (LocalFrame) addPointer(gBase, iglobal);
+  if ( !lBase )
+    lBase = (LocalFrame) addPointer(gBase, iglobal);
 
   init_stack((Stack)&LD->stacks.global,
 	     "global",   iglobal, 512*SIZEOF_VOIDP, TRUE);
@@ -1423,7 +1842,16 @@ allocStacks(void)
 
 void
 freeStacks(ARG1_LD)
-{ if ( gBase )
+{
+#ifdef O_MMAP_STACKS
+  if ( LD->stacks.vm.base )
+  { vm_free_stacks(PASS_LD1);
+    gTop = NULL; gBase = NULL;
+    lTop = NULL; lBase = NULL;
+    tTop = NULL; tBase = NULL;
+  }
+#endif
+  if ( gBase )
   { gBase--;
     stack_free(gBase);
     gTop = NULL; gBase = NULL;
@@ -1555,6 +1983,10 @@ trimStacks(int resize ARG_LD)
 
   if ( resize )
   { growStacks(GROW_TRIM, GROW_TRIM, GROW_TRIM);
+#ifdef O_MMAP_STACKS
+    if ( LD->stacks.vm.base )
+      trim_vm_stacks(PASS_LD1);
+#endif
   } else
   { trim_stack((Stack) &LD->stacks.local);
     trim_stack((Stack) &LD->stacks.global);
@@ -1630,6 +2062,9 @@ freePrologLocalData(PL_local_data_t *ld)
 #endif
 
   freeArithLocalData(ld);
+#ifdef O_VMI_STATISTICS
+  freeVMIStatistics(ld);
+#endif
 #ifdef O_PLMT
   if ( ld->prolog_flag.table )
   { PL_LOCK(L_PLFLAG);
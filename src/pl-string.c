@@ -371,8 +371,14 @@ backSkipPadding(const char *in, size_t len, PL_chars_t *pad)
 
 
 /** read_string(+Stream, +Delimiters, +Padding, -Delimiter, -String)
+ *
+ * The input is decoded in chunks using Sread_codes(), stopping at the
+ * first delimiter.
 */
 
+#define READ_CHUNK 1024
+#define MAX_FAST_SEP 16
+
 static
 PRED_IMPL("read_string", 5, read_string, 0)
 { PRED_LD
@@ -389,21 +395,47 @@ PRED_IMPL("read_string", 5, read_string, 0)
   if ( getTextInputStream(A1, &s) &&
        PL_get_text(A2, &sep, flags) &&
        PL_get_text(A3, &pad, flags) )
-  { int chr;
-
-    do
-    { chr = Sgetcode(s);
-    } while(chr != EOF && text_chr(&pad, chr) != (size_t)-1);
+  { int codes[READ_CHUNK];
+    int seps[MAX_FAST_SEP];
+    size_t nsep = 0;
+    int skip_pad = TRUE;
+    int chr = EOF;
+
+    if ( sep.length <= MAX_FAST_SEP )
+    { for(nsep=0; nsep < sep.length; nsep++)
+	seps[nsep] = text_get_char(&sep, nsep);
+    }
 
     for(;;)
-    { if ( chr == EOF && Sferror(s) )
+    { ssize_t i, n;
+
+      if ( nsep == sep.length )
+	n = Sread_codes(s, codes, READ_CHUNK, seps, nsep);
+      else
+	n = Sread_codes(s, codes, 1, NULL, 0);
+
+      if ( n < 0 )
 	goto out;
-      if ( chr == EOF || text_chr(&sep, chr) != (size_t)-1 )
+      if ( n == 0 )
 	break;
-      addUTF8Buffer((Buffer)&tmpbuf, chr);
-      chr = Sgetcode(s);
+
+      for(i=0; i<n; i++)
+      { int c = codes[i];
+
+	if ( skip_pad )
+	{ if ( text_chr(&pad, c) != (size_t)-1 )
+	    continue;
+	  skip_pad = FALSE;
+	}
+	if ( text_chr(&sep, c) != (size_t)-1 )
+	{ chr = c;
+	  goto done;
+	}
+	addUTF8Buffer((Buffer)&tmpbuf, c);
+      }
     }
 
+  done:
     tmpbuf.top = backSkipPadding(baseBuffer(&tmpbuf,char),
 				 entriesBuffer(&tmpbuf, char),
 				 &pad);
@@ -446,16 +478,21 @@ PRED_IMPL("read_string", 3, read_string, 0)
        ( (vlen=PL_is_variable(A2)) ||
 	 PL_get_size_ex(A2, &len)
        ) )
-  { size_t count;
+  { int codes[READ_CHUNK];
+    size_t count = 0;
 
-    for(count=0; count < len; count++)
-    { int chr = Sgetcode(s);
-      if ( chr == EOF )
-      { if ( Sferror(s) )
-	  goto out;
+    while( count < len )
+    { size_t max = len-count < READ_CHUNK ? len-count : READ_CHUNK;
+      ssize_t i, n = Sread_codes(s, codes, max, NULL, 0);
+
+      if ( n < 0 )
+	goto out;
+      if ( n == 0 )
 	break;
-      }
-      addUTF8Buffer((Buffer)&tmpbuf, chr);
+
+      for(i=0; i<n; i++)
+	addUTF8Buffer((Buffer)&tmpbuf, codes[i]);
+      count += n;
     }
 
     rc = ( PL_unify_chars(A3, PL_STRING|REP_UTF8,
@@ -273,7 +273,10 @@ static Code
 multifileSupervisor(Definition def)
 { if ( true(def, (P_DYNAMIC|P_MULTIFILE)) )
   { if ( true(def, P_DYNAMIC) )
+    { if ( true(def, P_INCREMENTAL) )
+	return SUPERVISOR(incr_dynamic);
       return SUPERVISOR(dynamic);
+    }
     else
       return SUPERVISOR(multifile);
   }
@@ -438,6 +441,7 @@ initSupervisors(void)
   MAKE_SV1(virgin,	 S_VIRGIN);
   MAKE_SV1(undef,	 S_UNDEF);
   MAKE_SV1(dynamic,      S_DYNAMIC);
+  MAKE_SV1(incr_dynamic, S_INCR_DYNAMIC);
   MAKE_SV1(thread_local, S_THREAD_LOCAL);
   MAKE_SV1(multifile,    S_MULTIFILE);
   MAKE_SV1(staticp,      S_STATIC);
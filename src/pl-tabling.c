@@ -41,6 +41,11 @@
 #define PL_recorded(r, t) put_fastheap(r, t PASS_LD)
 #define PL_erase(r)	  free_fastheap(r)
 
+#define WL_IS_SPECIAL(wl)  (((intptr_t)(wl)) & 0x1)
+#define WL_IS_WORKLIST(wl) ((wl) && !WL_IS_SPECIAL(wl))
+
+#define WL_COMPLETE ((worklist *)0x11)
+
 static void	free_worklist(worklist *wl);
 #ifdef O_DEBUG
 static void	print_worklist(const char *prefix, worklist *wl);
@@ -169,6 +174,187 @@ newly_created_worklists(worklist ***wlp ARG_LD)
 
 
 
+		 /*******************************
+		 *  INCREMENTAL DEPENDENCY GRAPH	*
+		 *******************************/
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Incremental tabling maintains the  Incremental Dependency Graph (IDG). Its
+nodes are the tables of incremental tabled predicates and the incremental
+dynamic predicates.  Each node has  a  set   of  nodes  that are affected
+if it changes and the set of nodes it  depends on. The latter is used to
+remove a table from the graph if it is destroyed.
+
+Edges are added while evaluating an incremental table if it calls another
+incremental table or an incremental dynamic  predicate.  The table being
+evaluated is the worklist in the  global   variable  '$tbl_current' that
+is set by delim/3,4 in boot/tabling.pl.
+
+Modifying an incremental dynamic predicate  marks all tables that depend
+on it as invalid. An  invalid  complete  table   is  discarded  when  it
+is called and thus re-evaluated.  We   maintain  that  all tables that
+depend on an invalid table are invalid.
+
+The graph is shared between threads and protected by L_TABLING.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static idg_node *
+idg_new(trie *atrie)
+{ idg_node *n = PL_malloc(sizeof(*n));
+
+  n->affected     = newHTable(4);
+  n->dependencies = newHTable(4);
+  n->atrie        = atrie;
+  n->invalid      = FALSE;
+
+  return n;
+}
+
+
+static void
+idg_invalidate(idg_node *n)
+{ tmp_buffer agenda;
+
+  initBuffer(&agenda);
+  addBuffer(&agenda, n, idg_node*);
+
+  while( !isEmptyBuffer(&agenda) )
+  { idg_node *a = popBuffer(&agenda, idg_node*);
+    TableEnum e = newTableEnum(a->affected);
+    void *k, *v;
+
+    while( advanceTableEnum(e, &k, &v) )
+    { idg_node *p = k;
+
+      if ( !p->invalid )
+      { p->invalid = TRUE;
+	addBuffer(&agenda, p, idg_node*);
+      }
+    }
+    freeTableEnum(e);
+  }
+
+  discardBuffer(&agenda);
+}
+
+
+/* Destroy the IDG node of a table.  Tables that depend on it lose this
+ * dependency and are therefore invalidated.
+ */
+
+static void
+idg_destroy(idg_node *n)
+{ TableEnum e;
+  void *k, *v;
+
+  PL_LOCK(L_TABLING);
+  idg_invalidate(n);
+  e = newTableEnum(n->dependencies);
+  while( advanceTableEnum(e, &k, &v) )
+    deleteHTable(((idg_node*)k)->affected, n);
+  freeTableEnum(e);
+  e = newTableEnum(n->affected);
+  while( advanceTableEnum(e, &k, &v) )
+    deleteHTable(((idg_node*)k)->dependencies, n);
+  freeTableEnum(e);
+  PL_UNLOCK(L_TABLING);
+
+  destroyHTable(n->affected);
+  destroyHTable(n->dependencies);
+  PL_free(n);
+}
+
+
+/* Find the IDG node of the incremental table we are evaluating.
+ */
+
+static idg_node *
+idg_current(ARG1_LD)
+{ word w;
+
+  if ( gvar_value__LD(ATOM_dtbl_current, &w PASS_LD) )
+  { term_t t = pushWordAsTermRef(&w);
+    void *ptr;
+    int rc = PL_get_pointer(t, &ptr);
+
+    popTermRef();
+    if ( rc )
+    { worklist *wl = ptr;
+
+      assert(wl->magic == WORKLIST_MAGIC);
+      return wl->table->data.IDG;
+    }
+  }
+
+  return NULL;
+}
+
+
+/* Register that caller depends on callee.  Must be called with
+ * L_TABLING locked.
+ */
+
+static void
+idg_add_edge(idg_node *callee, idg_node *caller ARG_LD)
+{ if ( callee != caller && !lookupHTable(callee->affected, caller) )
+  { addNewHTable(callee->affected, caller, caller);
+    addNewHTable(caller->dependencies, callee, callee);
+  }
+  if ( callee->invalid && !caller->invalid )
+  { caller->invalid = TRUE;
+    idg_invalidate(caller);
+  }
+}
+
+
+/* Called through S_INCR_DYNAMIC if an incremental dynamic predicate is
+ * called.
+ */
+
+void
+idg_add_dyncall(Definition def ARG_LD)
+{ idg_node *caller;
+
+  if ( (caller=idg_current(PASS_LD1)) )
+  { PL_LOCK(L_TABLING);
+    if ( !def->tabling )
+      def->tabling = idg_new(NULL);
+    idg_add_edge(def->tabling, caller PASS_LD);
+    PL_UNLOCK(L_TABLING);
+  }
+}
+
+
+/* Called after a clause was added to or removed from an incremental
+ * dynamic predicate.
+ */
+
+void
+idg_changed(Definition def)
+{ idg_node *n;
+
+  if ( (n=def->tabling) )
+  { PL_LOCK(L_TABLING);
+    idg_invalidate(n);
+    PL_UNLOCK(L_TABLING);
+  }
+}
+
+
+/* Called if an incremental dynamic predicate is destroyed.
+ */
+
+void
+idg_destroy_definition(Definition def)
+{ idg_node *n;
+
+  if ( (n=def->tabling) )
+  { def->tabling = NULL;
+    idg_destroy(n);
+  }
+}
+
+
 		 /*******************************
 		 *     THREAD VARIANT TABLE	*
 		 *******************************/
@@ -197,6 +383,10 @@ release_variant_table_node(trie *variant_table, trie_node *node)
     assert(vtrie->data.variant == node);
     vtrie->data.variant = NULL;
     vtrie->data.worklist = NULL;
+    if ( vtrie->data.IDG )
+    { idg_destroy(vtrie->data.IDG);
+      vtrie->data.IDG = NULL;
+    }
     trie_empty(vtrie);
   }
 }
@@ -237,9 +427,275 @@ get_variant_table(term_t t, int create ARG_LD)
 }
 
 
+/* Get the table for an incremental tabled predicate.  Invalid complete
+ * tables are discarded, so the caller re-evaluates them.  If we are
+ * evaluating an incremental table, it depends on the returned table.
+ */
+
+static trie *
+get_incr_variant_table(term_t t ARG_LD)
+{ trie *atrie;
+
+  while( (atrie=get_variant_table(t, TRUE PASS_LD)) )
+  { idg_node *caller;
+
+    if ( !atrie->data.IDG )
+    { idg_node *n = idg_new(atrie);
+
+      PL_LOCK(L_TABLING);
+      atrie->data.IDG = n;
+      PL_UNLOCK(L_TABLING);
+    } else if ( atrie->data.IDG->invalid &&
+		atrie->data.worklist == WL_COMPLETE )
+    { prune_node(thread_variant_table(PASS_LD1), atrie->data.variant);
+      continue;
+    }
+
+    if ( (caller=idg_current(PASS_LD1)) )
+    { PL_LOCK(L_TABLING);
+      idg_add_edge(atrie->data.IDG, caller PASS_LD);
+      PL_UNLOCK(L_TABLING);
+    }
+
+    break;
+  }
+
+  return atrie;
+}
+
+
+		 /*******************************
+		 *     SHARED VARIANT TABLE	*
+		 *******************************/
+
+/* Tables for predicates declared using `:- table p/1 as shared` live
+ * in a global variant table.  Only the thread that created the table
+ * (trie->data.tid) adds answers to it.  Other threads that call the
+ * variant while it is incomplete wait for its completion.  If waiting
+ * would deadlock because the owner (indirectly) waits for a table we
+ * are computing, we evaluate the variant using a private table.  The
+ * variant table is guarded by GD->thread.tabling.mutex, completed
+ * answer tries are read without locking.
+ */
+
+#ifdef O_PLMT
+#define LOCK_SHARED_TABLES()   pthread_mutex_lock(&GD->thread.tabling.mutex)
+#define UNLOCK_SHARED_TABLES() pthread_mutex_unlock(&GD->thread.tabling.mutex)
+#define SIGNAL_SHARED_TABLES() pthread_cond_broadcast(&GD->thread.tabling.cond)
+#else
+#define LOCK_SHARED_TABLES()   (void)0
+#define UNLOCK_SHARED_TABLES() (void)0
+#define SIGNAL_SHARED_TABLES() (void)0
+#endif
+
+/* Release a node of the shared variant table.  Other threads may read
+ * the completed answer trie without locking.  We therefore only mark it
+ * abolished by clearing its variant.  Clearing the node unregisters the
+ * trie's symbol, after which atom-GC destroys the trie if no thread
+ * references it.
+ */
+
+static void
+release_shared_variant_table_node(trie *variant_table, trie_node *node)
+{ (void)variant_table;
+
+  if ( node->value )
+  { trie *atrie = symbol_trie(node->value);
+
+    assert(atrie->data.variant == node);
+    atrie->data.variant = NULL;
+  }
+}
+
+
+static trie *
+shared_variant_table(void)
+{ if ( !GD->tabling.variant_table )
+  { trie *vt;
+
+    if ( !(vt = trie_create()) )
+      return NULL;
+    trie_symbol(vt);
+    vt->release_node = release_shared_variant_table_node;
+    GD->tabling.node_pool.limit = GD->options.tableSpace;
+    GD->tabling.variant_table = vt;
+  }
+
+  return GD->tabling.variant_table;
+}
+
+
+#ifdef O_PLMT
+/* True if waiting for atrie makes us wait for ourselves.  Must be
+ * called with the shared table mutex locked.
+ */
+
+static int
+shared_table_deadlock(trie *atrie, int me)
+{ int steps;
+
+  for(steps=0; atrie && steps < GD->thread.thread_max; steps++)
+  { int tid = atrie->data.tid;
+    PL_thread_info_t *info;
+
+    if ( tid == me )
+      return TRUE;
+    if ( tid <= 0 || tid >= GD->thread.thread_max ||
+	 !(info=GD->thread.threads[tid]) || !info->thread_data )
+      return FALSE;
+    atrie = info->thread_data->tabling.shared_wait;
+  }
+
+  return FALSE;
+}
+
+
+static void
+wait_for_shared_table(trie *atrie ARG_LD)
+{ struct timespec deadline;
+
+  get_current_timespec(&deadline);
+  deadline.tv_nsec += 250000000;	/* check signals every 0.25 sec */
+  carry_timespec_nanos(&deadline);
+
+  LD->tabling.shared_wait = atrie;
+  pthread_cond_timedwait(&GD->thread.tabling.cond,
+			 &GD->thread.tabling.mutex, &deadline);
+  LD->tabling.shared_wait = NULL;
+}
+#endif /*O_PLMT*/
+
+
+/* Get the shared table for the variant t.  The symbol of the returned
+ * trie is registered to keep it alive if the tables are abolished.  The
+ * caller must unregister it.
+ */
+
+static trie *
+get_shared_variant_table(term_t t ARG_LD)
+{
+#ifdef O_PLMT
+  Word v = valTermRef(t);
+  int me = PL_thread_self();
+
+  for(;;)
+  { trie *variants, *atrie;
+    trie_node *node;
+    int rc;
+
+    LOCK_SHARED_TABLES();
+    if ( !(variants = shared_variant_table()) )
+    { UNLOCK_SHARED_TABLES();
+      return NULL;
+    }
+    if ( (rc=trie_lookup(variants, &node, v, TRUE PASS_LD)) != TRUE )
+    { UNLOCK_SHARED_TABLES();
+      trie_error(rc, t);
+      return NULL;
+    }
+
+    if ( !node->value )
+    { if ( (atrie = trie_create()) )
+      { node->value = trie_symbol(atrie);
+	atrie->data.variant = node;
+	atrie->data.tid = me;
+	atrie->alloc_pool = &GD->tabling.node_pool;
+	GD->tabling.active++;
+	PL_register_atom(atrie->symbol);
+      } else
+      { prune_node(variants, node);
+      }
+      UNLOCK_SHARED_TABLES();
+      return atrie;
+    }
+
+    atrie = symbol_trie(node->value);
+    if ( atrie->data.worklist == WL_COMPLETE || atrie->data.tid == me )
+    { PL_register_atom(atrie->symbol);	/* may be abolished after unlock */
+      UNLOCK_SHARED_TABLES();
+      return atrie;
+    }
+    if ( shared_table_deadlock(atrie, me) )
+    { trie *ptrie;
+
+      UNLOCK_SHARED_TABLES();
+      DEBUG(MSG_TABLING_WORK,
+	    Sdprintf("[%d] shared table deadlock; using private table\n", me));
+      if ( (ptrie=get_variant_table(t, TRUE PASS_LD)) )
+	PL_register_atom(ptrie->symbol);
+      return ptrie;
+    }
+
+    PL_register_atom(atrie->symbol);	/* keep the trie while waiting */
+    wait_for_shared_table(atrie PASS_LD);
+    UNLOCK_SHARED_TABLES();
+    PL_unregister_atom(atrie->symbol);
+
+    if ( PL_handle_signals() < 0 )
+      return NULL;
+  }
+#else
+  trie *atrie;
+
+  if ( (atrie=get_variant_table(t, TRUE PASS_LD)) )
+    PL_register_atom(atrie->symbol);
+  return atrie;
+#endif
+}
+
+
+/* Complete or abandon a shared table we are computing and wakeup
+ * threads waiting for it.
+ */
+
+static void
+complete_shared_table(trie *atrie)
+{ LOCK_SHARED_TABLES();
+  atrie->data.worklist = WL_COMPLETE;
+  atrie->data.tid = 0;
+  GD->tabling.active--;
+  SIGNAL_SHARED_TABLES();
+  UNLOCK_SHARED_TABLES();
+}
+
+
+static void
+abandon_shared_table(trie *atrie)
+{ LOCK_SHARED_TABLES();
+  atrie->data.tid = 0;
+  GD->tabling.active--;
+  if ( atrie->data.variant )
+    prune_node(GD->tabling.variant_table, atrie->data.variant);
+  SIGNAL_SHARED_TABLES();
+  UNLOCK_SHARED_TABLES();
+}
+
+
+static void
+abandon_shared_tables(PL_local_data_t *ld)
+{ tbl_component *c;
+  worklist_set *wls;
+
+  if ( (c=ld->tabling.component) && (wls=c->created_worklists) )
+  { worklist **wlp = (worklist**)baseBuffer(&wls->members, worklist*);
+    size_t i, nwpl = entriesBuffer(&wls->members, worklist*);
+
+    for(i=0; i<nwpl; i++)
+    { trie *atrie = wlp[i]->table;
+
+      if ( atrie->data.tid )
+      { atrie->data.worklist = NULL;
+	abandon_shared_table(atrie);
+      }
+    }
+  }
+}
+
+
 void
 clearThreadTablingData(PL_local_data_t *ld)
-{ reset_global_worklist(ld);
+{ abandon_shared_tables(ld);
+  reset_global_worklist(ld);
   reset_newly_created_worklists(ld);
   clear_variant_table(ld);
 }
@@ -522,11 +978,6 @@ print_worklist(const char *prefix, worklist *wl)
 		 *	PROLOG CONNECTION	*
 		 *******************************/
 
-#define WL_IS_SPECIAL(wl)  (((intptr_t)(wl)) & 0x1)
-#define WL_IS_WORKLIST(wl) ((wl) && !WL_IS_SPECIAL(wl))
-
-#define WL_COMPLETE ((worklist *)0x11)
-
 static int
 unify_table_status(term_t t, trie *trie ARG_LD)
 { worklist *wl = trie->data.worklist;
@@ -605,7 +1056,8 @@ PRED_IMPL("$tbl_new_worklist", 2, tbl_new_worklist, 0)
 
 /** '$tbl_destroy_table'(+Trie)
  *
- * Destroy a single trie table.
+ * Destroy a single trie table.  Raises a permission error if Trie is a
+ * shared table that is being computed by some thread.
  */
 
 static
@@ -621,6 +1073,19 @@ PRED_IMPL("$tbl_destroy_table", 1, tbl_destroy_table, 0)
       { prune_node(vtrie, table->data.variant);
 	return TRUE;
       }
+      if ( vtrie == GD->tabling.variant_table )
+      { int complete;
+
+	LOCK_SHARED_TABLES();
+	if ( (complete = (table->data.worklist == WL_COMPLETE)) &&
+	     table->data.variant )
+	  prune_node(vtrie, table->data.variant);
+	UNLOCK_SHARED_TABLES();
+
+	if ( !complete )
+	  return PL_permission_error("abolish", "table", A1);
+	return TRUE;
+      }
 
       return PL_type_error("table", A1);
     }
@@ -1000,6 +1465,63 @@ PRED_IMPL("$tbl_variant_table", 1, tbl_variant_table, 0)
 }
 
 
+/** '$tbl_incr_variant_table'(+Variant, -Trie, -Status) is det.
+ *
+ * As '$tbl_variant_table'/3, but for incremental tables.  Invalid
+ * tables are re-created and the table we are evaluating, if any, is
+ * registered to depend on Trie.
+ */
+
+static
+PRED_IMPL("$tbl_incr_variant_table", 3, tbl_incr_variant_table, 0)
+{ PRED_LD
+  trie *trie;
+
+  if ( (trie=get_incr_variant_table(A1 PASS_LD)) )
+  { return ( _PL_unify_atomic(A2, trie->symbol) &&
+	     unify_table_status(A3, trie PASS_LD) );
+  }
+
+  return FALSE;
+}
+
+
+/** '$tbl_shared_variant_table'(+Variant, -Trie, -Status) is det.
+ *
+ * As '$tbl_variant_table'/3, but use the global table for tables that
+ * are shared between threads.  If the table is being computed by
+ * another thread, wait for it to complete.
+ */
+
+static
+PRED_IMPL("$tbl_shared_variant_table", 3, tbl_shared_variant_table, 0)
+{ PRED_LD
+  trie *trie;
+
+  if ( (trie=get_shared_variant_table(A1 PASS_LD)) )
+  { int rc = ( _PL_unify_atomic(A2, trie->symbol) &&
+	       unify_table_status(A3, trie PASS_LD) );
+
+    PL_unregister_atom(trie->symbol);
+    return rc;
+  }
+
+  return FALSE;
+}
+
+
+static
+PRED_IMPL("$tbl_shared_variant_table", 1, tbl_shared_variant_table, 0)
+{ PRED_LD
+  trie *trie = GD->tabling.variant_table;
+
+  if ( trie )
+    return PL_unify_atom(A1, trie->symbol);
+
+  return FALSE;
+}
+
+
 /** '$tbl_table_status'(+Trie, -Status)
  *
  * Set the status of Trie. Old is unified to one of `fresh`, `active`, a
@@ -1032,7 +1554,10 @@ PRED_IMPL("$tbl_table_complete_all", 0, tbl_table_complete_all, 0)
   { worklist *wl = wls[i];
     trie *trie = wl->table;
 
-    trie->data.worklist = WL_COMPLETE;
+    if ( trie->data.tid )
+      complete_shared_table(trie);
+    else
+      trie->data.worklist = WL_COMPLETE;
     free_worklist(wl);
   }
   reset_newly_created_worklists(LD);
@@ -1058,7 +1583,10 @@ PRED_IMPL("$tbl_table_discard_all", 0, tbl_table_discard_all, 0)
   { worklist *wl = wls[i];
     trie *trie = wl->table;
 
-    prune_node(LD->tabling.variant_table, trie->data.variant);
+    if ( trie->data.tid )
+      abandon_shared_table(trie);
+    else
+      prune_node(LD->tabling.variant_table, trie->data.variant);
     if ( !wl->in_global_wl )
       free_worklist(wl);
   }
@@ -1141,6 +1669,38 @@ PRED_IMPL("$tbl_abolish_all_tables", 0, tbl_abolish_all_tables, 0)
   }
 }
 
+/** '$tbl_abolish_shared_tables' is det.
+ *
+ * Clear the tables that are shared between threads.
+ */
+
+static
+PRED_IMPL("$tbl_abolish_shared_tables", 0, tbl_abolish_shared_tables, 0)
+{ PRED_LD
+  int rc = TRUE;
+
+  LOCK_SHARED_TABLES();
+  if ( GD->tabling.active == 0 )
+  { trie *vt;
+
+    if ( (vt=GD->tabling.variant_table) )
+    { GD->tabling.variant_table = NULL;
+      PL_unregister_atom(vt->symbol);	/* atom-GC destroys the tables */
+    }
+  } else
+    rc = FALSE;
+  UNLOCK_SHARED_TABLES();
+
+  if ( !rc )
+  { term_t ex = PL_new_term_ref();
+
+    PL_put_atom(ex, ATOM_shared);
+    return PL_permission_error("abolish", "tables", ex);
+  }
+
+  return TRUE;
+}
+
 /** '$tbl_trienode'(-X) is det.
  *
  * X is the reserved node value for non-moded arguments.
@@ -1168,6 +1728,9 @@ BeginPredDefs(tabling)
   PRED_DEF("$tbl_wkl_work",		7, tbl_wkl_work, PL_FA_NONDETERMINISTIC)
   PRED_DEF("$tbl_variant_table",	3, tbl_variant_table,	     0)
   PRED_DEF("$tbl_variant_table",        1, tbl_variant_table,        0)
+  PRED_DEF("$tbl_incr_variant_table",	3, tbl_incr_variant_table,   0)
+  PRED_DEF("$tbl_shared_variant_table", 3, tbl_shared_variant_table, 0)
+  PRED_DEF("$tbl_shared_variant_table", 1, tbl_shared_variant_table, 0)
   PRED_DEF("$tbl_table_status",		2, tbl_table_status,	     0)
   PRED_DEF("$tbl_table_complete_all",	0, tbl_table_complete_all,   0)
   PRED_DEF("$tbl_table_discard_all",    0, tbl_table_discard_all,    0)
@@ -1175,6 +1738,7 @@ BeginPredDefs(tabling)
   PRED_DEF("$tbl_create_subcomponent",  0, tbl_create_subcomponent,  0)
   PRED_DEF("$tbl_completed_component",  0, tbl_completed_component,  0)
   PRED_DEF("$tbl_abolish_all_tables",   0, tbl_abolish_all_tables,   0)
+  PRED_DEF("$tbl_abolish_shared_tables", 0, tbl_abolish_shared_tables, 0)
   PRED_DEF("$tbl_destroy_table",        1, tbl_destroy_table,        0)
   PRED_DEF("$tbl_trienode",             1, tbl_trienode,             0)
 EndPredDefs
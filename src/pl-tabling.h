@@ -83,6 +83,22 @@ typedef struct worklist
 } worklist;
 
 
+
+		 /*******************************
+		 *     INCREMENTAL TABLING	*
+		 *******************************/
+
+typedef struct idg_node
+{ Table		affected;		/* Nodes that depend on me */
+  Table		dependencies;		/* Nodes I depend on */
+  trie	       *atrie;			/* answer trie (NULL: dynamic pred) */
+  int		invalid;		/* Table must be re-evaluated */
+} idg_node;
+
+
 COMMON(void) clearThreadTablingData(PL_local_data_t *ld);
+COMMON(void) idg_add_dyncall(Definition def ARG_LD);
+COMMON(void) idg_changed(Definition def);
+COMMON(void) idg_destroy_definition(Definition def);
 
 #endif /*_PL_TABLING_H*/
@@ -298,7 +298,10 @@ counting_mutex _PL_mutexes[] =
   COUNT_MUTEX_INITIALIZER("L_SORTR"),
   COUNT_MUTEX_INITIALIZER("L_UMUTEX"),
   COUNT_MUTEX_INITIALIZER("L_INIT_ATOMS"),
-  COUNT_MUTEX_INITIALIZER("L_CGCGEN")
+  COUNT_MUTEX_INITIALIZER("L_CGCGEN"),
+  COUNT_MUTEX_INITIALIZER("L_TABLING"),
+  COUNT_MUTEX_INITIALIZER("L_PROFILE"),
+  COUNT_MUTEX_INITIALIZER("L_STACKS")
 #ifdef __WINDOWS__
 , COUNT_MUTEX_INITIALIZER("L_DDE")
 , COUNT_MUTEX_INITIALIZER("L_CSTACK")
@@ -844,6 +847,11 @@ initPrologThreads(void)
     GD->statistics.threads_created = 1;
     pthread_mutex_init(&GD->thread.index.mutex, NULL);
     pthread_cond_init(&GD->thread.index.cond, NULL);
+    GD->thread.index.background_min = JITI_BACKGROUND_MIN;
+    pthread_mutex_init(&GD->thread.tabling.mutex, NULL);
+    pthread_cond_init(&GD->thread.tabling.cond, NULL);
+    pthread_mutex_init(&GD->thread.agc.mutex, NULL);
+    pthread_cond_init(&GD->thread.agc.cond, NULL);
     initMutexes();
     link_mutexes();
     threads_ready = TRUE;
@@ -910,6 +918,8 @@ exitPrologThreads(void)
 
   DEBUG(MSG_THREAD, Sdprintf("exitPrologThreads(): me = %d\n", me));
 
+  stopIndexWorker();
+
   sem_init(sem_canceled_ptr, USYNC_THREAD, 0);
 
   for(i=1; i<= thread_highest_id; i++)
@@ -1628,7 +1638,7 @@ set_system_thread_id(PL_thread_info_t *info)
 }
 
 
-static int
+int
 set_os_thread_name_from_charp(const char *s)
 {
 #ifdef HAVE_PTHREAD_SETNAME_NP
@@ -3762,14 +3772,180 @@ are not equal and there are multiple waiters we must be using broadcast.
 
 typedef struct thread_message
 { struct thread_message *next;		/* next in queue */
+  struct thread_message *prev;		/* previous in queue */
+  struct thread_message *next_key;	/* next with the same key */
+  struct thread_message *prev_key;	/* previous with the same key */
   record_t            message;		/* message in queue */
   word		      key;		/* Indexing key */
   uint64_t	      sequence_id;	/* Numbered sequence */
 } thread_message;
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Messages are indexed on their  key.  For   each  key, the queue keeps a
+chain of messages in queue order in   queue->key_index.  Messages with
+key 0 (variables) may unify with any pattern  and are kept in the chain
+queue->no_key.  A pattern with key 0 must   scan the entire queue, while
+other patterns only have to consider the   messages  in the chain of the
+key and the no_key chain.
+
+The key is the key of the term, i.e.,   the name and arity for compound
+terms.  If the queue was created using   the index(Arg) option, the key
+of argument Arg is combined with the functor.  If this argument is a
+variable, the key is 0.  This makes   selective receives such as
+reply(Id, Result) on a queue with many   reply/2  messages O(1) if the
+queue is indexed on the first argument.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static word
+message_key(message_queue *queue, term_t msg ARG_LD)
+{ word key = getIndexOfTerm(msg);
+  atom_t name;
+  size_t arity;
+
+  if ( key && queue->index_arg &&
+       PL_get_name_arity(msg, &name, &arity) &&
+       (size_t)queue->index_arg <= arity )
+  { term_t a = PL_new_term_ref();
+    word k[2];
+
+    _PL_get_arg(queue->index_arg, msg, a);
+    k[0] = key;
+    if ( !(k[1] = getIndexOfTerm(a)) )
+      return 0;
+    key = MurmurHashAligned2(k, sizeof(k), MURMUR_SEED);
+    if ( !key )
+      key = 1;
+  }
+
+  return key;
+}
+
+
+static message_chain *
+key_chain(message_queue *queue, word key, int create ARG_LD)
+{ message_chain *ch;
+
+  if ( !key )
+    return &queue->no_key;
+  if ( queue->key_index &&
+       (ch = lookupHTable(queue->key_index, (void*)key)) )
+    return ch;
+
+  if ( create )
+  { if ( !queue->key_index )
+      queue->key_index = newHTable(16);
+    ch = allocHeapOrHalt(sizeof(*ch));
+    ch->head = ch->tail = NULL;
+    addNewHTable(queue->key_index, (void*)key, ch);
+
+    return ch;
+  }
+
+  return NULL;
+}
+
+
+static void
+link_message(message_queue *queue, thread_message *msgp ARG_LD)
+{ message_chain *ch = key_chain(queue, msgp->key, TRUE PASS_LD);
+
+  msgp->next = NULL;
+  if ( (msgp->prev = queue->tail) )
+    queue->tail->next = msgp;
+  else
+    queue->head = msgp;
+  queue->tail = msgp;
+
+  msgp->next_key = NULL;
+  if ( (msgp->prev_key = ch->tail) )
+    ch->tail->next_key = msgp;
+  else
+    ch->head = msgp;
+  ch->tail = msgp;
+}
+
+
+static void
+unlink_message(message_queue *queue, thread_message *msgp ARG_LD)
+{ message_chain *ch = key_chain(queue, msgp->key, FALSE PASS_LD);
+
+  if ( msgp->prev )
+    msgp->prev->next = msgp->next;
+  else
+    queue->head = msgp->next;
+  if ( msgp->next )
+    msgp->next->prev = msgp->prev;
+  else
+    queue->tail = msgp->prev;
+
+  if ( msgp->prev_key )
+    msgp->prev_key->next_key = msgp->next_key;
+  else
+    ch->head = msgp->next_key;
+  if ( msgp->next_key )
+    msgp->next_key->prev_key = msgp->prev_key;
+  else
+    ch->tail = msgp->prev_key;
+
+  if ( !ch->head && msgp->key )
+  { deleteHTable(queue->key_index, (void*)msgp->key);
+    freeHeap(ch, sizeof(*ch));
+  }
+}
+
+
+/* Enumerate the messages that may match a pattern with key in queue
+ * order.
+ */
+
+typedef struct message_enum
+{ thread_message *keyed;		/* Next in chain for key */
+  thread_message *unkeyed;		/* Next in no_key chain */
+  thread_message *any;			/* Next in queue */
+  int		  indexed;		/* Use the chains */
+} message_enum;
+
+
+static void
+init_message_enum(message_enum *e, message_queue *queue, word key ARG_LD)
+{ if ( key )
+  { message_chain *ch = key_chain(queue, key, FALSE PASS_LD);
+
+    e->indexed = TRUE;
+    e->keyed   = (ch ? ch->head : NULL);
+    e->unkeyed = queue->no_key.head;
+    e->any     = NULL;
+  } else
+  { e->indexed = FALSE;
+    e->keyed   = e->unkeyed = NULL;
+    e->any     = queue->head;
+  }
+}
+
+
 static thread_message *
-create_thread_message(term_t msg ARG_LD)
+next_message_enum(message_enum *e)
+{ thread_message *msgp;
+
+  if ( !e->indexed )
+  { if ( (msgp = e->any) )
+      e->any = msgp->next;
+  } else if ( e->keyed &&
+	      (!e->unkeyed ||
+	       e->keyed->sequence_id < e->unkeyed->sequence_id) )
+  { msgp = e->keyed;
+    e->keyed = msgp->next_key;
+  } else if ( (msgp = e->unkeyed) )
+  { e->unkeyed = msgp->next_key;
+  }
+
+  return msgp;
+}
+
+
+static thread_message *
+create_thread_message(message_queue *queue, term_t msg ARG_LD)
 { thread_message *msgp;
   record_t rec;
 
@@ -3779,7 +3955,7 @@ create_thread_message(term_t msg ARG_LD)
   if ( (msgp = allocHeap(sizeof(*msgp))) )
   { msgp->next    = NULL;
     msgp->message = rec;
-    msgp->key     = getIndexOfTerm(msg);
+    msgp->key     = message_key(queue, msg PASS_LD);
   } else
   { freeRecord(rec);
   }
@@ -3840,12 +4016,7 @@ queue_message(message_queue *queue, thread_message *msgp,
   }
 
   msgp->sequence_id = ++queue->sequence_next;
-  if ( !queue->head )
-  { queue->head = queue->tail = msgp;
-  } else
-  { queue->tail->next = msgp;
-    queue->tail = msgp;
-  }
+  link_message(queue, msgp PASS_LD);
   queue->size++;
 
   if ( queue->waiting )
@@ -4046,15 +4217,15 @@ markAtomsMessageQueue() scans it. This fixes the reopened Bug#142.
 static int
 get_message(message_queue *queue, term_t msg, struct timespec *deadline ARG_LD)
 { int isvar = PL_is_variable(msg) ? 1 : 0;
-  word key = (isvar ? 0L : getIndexOfTerm(msg));
+  word key = (isvar ? 0L : message_key(queue, msg PASS_LD));
   fid_t fid = PL_open_foreign_frame();
   uint64_t seen = 0;
 
   QSTAT(getmsg);
 
   for(;;)
-  { thread_message *msgp = queue->head;
-    thread_message *prev = NULL;
+  { message_enum e;
+    thread_message *msgp;
 
     if ( queue->destroyed )
       return MSG_WAIT_DESTROYED;
@@ -4064,7 +4235,8 @@ get_message(message_queue *queue, term_t msg, struct timespec *deadline ARG_LD)
 	    Sdprintf("%d: scanning queue (size=%ld)\n",
 		     PL_thread_self(), queue->size));
 
-    for( ; msgp; prev = msgp, msgp = msgp->next )
+    init_message_enum(&e, queue, key PASS_LD);
+    while( (msgp = next_message_enum(&e)) )
     { int rc;
       term_t tmp;
 
@@ -4076,11 +4248,6 @@ get_message(message_queue *queue, term_t msg, struct timespec *deadline ARG_LD)
       }
       seen = msgp->sequence_id;
 
-      if ( key && msgp->key && key != msgp->key )
-      { DEBUG(MSG_QUEUE, Sdprintf("Message key mismatch\n"));
-	continue;			/* fast search */
-      }
-
       QSTAT(unified);
       tmp = PL_new_term_ref();
       if ( !PL_recorded(msgp->message, tmp) )
@@ -4099,13 +4266,7 @@ get_message(message_queue *queue, term_t msg, struct timespec *deadline ARG_LD)
 	  markAtomsRecord(msgp->message);
 
         simpleMutexLock(&queue->gc_mutex);	/* see (*) */
-	if ( prev )
-	{ if ( !(prev->next = msgp->next) )
-	    queue->tail = prev;
-	} else
-	{ if ( !(queue->head = msgp->next) )
-	    queue->tail = NULL;
-	}
+	unlink_message(queue, msgp PASS_LD);
         simpleMutexUnlock(&queue->gc_mutex);
 
 	free_thread_message(msgp);
@@ -4168,18 +4329,15 @@ get_message(message_queue *queue, term_t msg, struct timespec *deadline ARG_LD)
 
 static int
 peek_message(message_queue *queue, term_t msg ARG_LD)
-{ thread_message *msgp;
+{ message_enum e;
+  thread_message *msgp;
   term_t tmp = PL_new_term_ref();
-  word key = getIndexOfTerm(msg);
+  word key = message_key(queue, msg PASS_LD);
   fid_t fid = PL_open_foreign_frame();
 
-  msgp = queue->head;
-
-  for( msgp = queue->head; msgp; msgp = msgp->next )
-  { if ( key && msgp->key && key != msgp->key )
-      continue;
-
-    if ( !PL_recorded(msgp->message, tmp) )
+  init_message_enum(&e, queue, key PASS_LD);
+  while( (msgp = next_message_enum(&e)) )
+  { if ( !PL_recorded(msgp->message, tmp) )
       return raiseStackOverflow(GLOBAL_OVERFLOW);
 
     if ( PL_unify(msg, tmp) )
@@ -4215,6 +4373,16 @@ destroy_message_queue(message_queue *queue)
     freeRecord(msgp->message);
     freeHeap(msgp, sizeof(*msgp));
   }
+  if ( queue->key_index )
+  { TableEnum e = newTableEnum(queue->key_index);
+    void *k, *v;
+
+    while( advanceTableEnum(e, &k, &v) )
+      freeHeap(v, sizeof(message_chain));
+    freeTableEnum(e);
+    destroyHTable(queue->key_index);
+    queue->key_index = NULL;
+  }
 
   simpleMutexDelete(&queue->gc_mutex);
   cv_destroy(&queue->cond_var);
@@ -4397,7 +4565,7 @@ thread_send_message__LD(term_t queue, term_t msgterm,
 
   if ( !get_message_queue__LD(queue, &q PASS_LD) )
     return FALSE;
-  if ( !(msg = create_thread_message(msgterm PASS_LD)) )
+  if ( !(msg = create_thread_message(q, msgterm PASS_LD)) )
   { release_message_queue(q);
     return PL_no_memory();
   }
@@ -4564,7 +4732,7 @@ free_queue_symbol(void *name, void *value)
 
 
 static message_queue *
-unlocked_message_queue_create(term_t queue, long max_size)
+unlocked_message_queue_create(term_t queue, long max_size, int index_arg)
 { GET_LD
   atom_t name = NULL_ATOM;
   message_queue *q;
@@ -4593,6 +4761,7 @@ unlocked_message_queue_create(term_t queue, long max_size)
 
   q = PL_malloc(sizeof(*q));
   init_message_queue(q, max_size);
+  q->index_arg = index_arg;
   q->type = QTYPE_QUEUE;
   if ( !id )
   { mqref ref;
@@ -4752,7 +4921,7 @@ PRED_IMPL("message_queue_create", 1, message_queue_create, 0)
 { int rval;
 
   PL_LOCK(L_THREAD);
-  rval = (unlocked_message_queue_create(A1, 0) ? TRUE : FALSE);
+  rval = (unlocked_message_queue_create(A1, 0, 0) ? TRUE : FALSE);
   PL_UNLOCK(L_THREAD);
 
   return rval;
@@ -4762,6 +4931,7 @@ PRED_IMPL("message_queue_create", 1, message_queue_create, 0)
 static const opt_spec message_queue_options[] =
 { { ATOM_alias,		OPT_ATOM },
   { ATOM_max_size,	OPT_SIZE },
+  { ATOM_index,		OPT_INT },
   { NULL_ATOM,		0 }
 };
 
@@ -4771,13 +4941,22 @@ PRED_IMPL("message_queue_create", 2, message_queue_create2, 0)
 { PRED_LD
   atom_t alias = 0;
   size_t max_size = 0;			/* to be processed */
+  int index_arg = 0;
   message_queue *q;
 
   if ( !scan_options(A2, 0,
 		     ATOM_queue_option, message_queue_options,
 		     &alias,
-		     &max_size) )
+		     &max_size,
+		     &index_arg) )
     fail;
+  if ( index_arg < 0 )
+  { term_t ex;
+
+    return ( (ex = PL_new_term_ref()) &&
+	     PL_put_integer(ex, index_arg) &&
+	     PL_domain_error("not_less_than_zero", ex) );
+  }
 
   if ( alias )
   { if ( !PL_unify_atom(A1, alias) )
@@ -4785,7 +4964,7 @@ PRED_IMPL("message_queue_create", 2, message_queue_create2, 0)
   }
 
   PL_LOCK(L_THREAD);
-  q = unlocked_message_queue_create(A1, max_size);
+  q = unlocked_message_queue_create(A1, max_size, index_arg);
   PL_UNLOCK(L_THREAD);
 
   return q ? TRUE : FALSE;
@@ -4852,10 +5031,20 @@ message_queue_max_size_property(message_queue *q, term_t prop ARG_LD)
 }
 
 
+static int		/* message_queue_property(Queue, index(Arg)) */
+message_queue_index_property(message_queue *q, term_t prop ARG_LD)
+{ if ( q->index_arg > 0 )
+    return PL_unify_integer(prop, q->index_arg);
+
+  fail;
+}
+
+
 static const tprop qprop_list [] =
 { { FUNCTOR_alias1,	    message_queue_alias_property },
   { FUNCTOR_size1,	    message_queue_size_property },
   { FUNCTOR_max_size1,	    message_queue_max_size_property },
+  { FUNCTOR_index1,	    message_queue_index_property },
   { 0,			    NULL }
 };
 
@@ -6203,6 +6392,229 @@ forThreadLocalDataUnsuspended(void (*func)(PL_local_data_t *), unsigned flags)
 		 *	 ATOM MARK SUPPORT	*
 		 *******************************/
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Marking the stacks of other threads for atom-gc. Scanning the stacks of
+a thread from the collector requires holding its scan_lock, which stalls
+the thread if it wants to run GC and, with many threads, makes the mark
+phase long.  Instead, markAtomsOnThreadStacks() starts a new marking
+round and raises SIG_ATOM_MARK in all running threads.  Each thread that
+reaches a safe point (PL_handle_signals()) marks its own stacks through
+markAtomsAtSafePoint() and continues.
+
+Threads that are blocked, e.g., in a system call or waiting for a message,
+never reach a safe point.  We poll every AGC_MARK_POLL nanoseconds and a
+thread that did not make any inferences since the previous poll is
+scanned by the collector as before.  After AGC_MARK_POLLS polls we scan
+all remaining threads.  Marking twice is harmless, so markAtomsThread()
+merely avoids redundant work.  The gc thread is never signalled as it
+does not run Prolog code.
+
+We do not use alertThread() as interrupting a blocking system call just
+to mark a thread we can also scan ourselves is not worth the risk.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define AGC_MARK_POLL  1000000		/* nanoseconds */
+#define AGC_MARK_POLLS 10
+
+static double
+markAtomsThread(PL_local_data_t *ld, int generation)
+{ double pause;
+
+  simpleMutexLock(&ld->thread.scan_lock);
+  if ( ld->atoms.marked != generation )
+  { double t0 = WallTime();
+
+    markAtomsOnStacks(ld);
+    ld->atoms.mark_pause = WallTime() - t0;
+    ld->atoms.marked = generation;
+  }
+  pause = ld->atoms.mark_pause;
+  simpleMutexUnlock(&ld->thread.scan_lock);
+
+  return pause;
+}
+
+
+static int
+agc_thread(PL_thread_info_t *info, int me)
+{ return ( info && info->pl_tid != me && info->thread_data &&
+	   ( info->status == PL_THREAD_RUNNING || info->in_exit_hooks ) );
+}
+
+
+/* unmarked_threads() counts the threads that were asked to mark their
+ * stacks and did not yet do so.  If `stalled` is TRUE, it marks the
+ * stacks of such threads that made no progress since the last call.
+ */
+
+static int
+unmarked_threads(int generation, int stalled)
+{ GET_LD
+  int me = PL_thread_self();
+  int i, count = 0;
+
+  for( i=1; i<=thread_highest_id; i++ )
+  { PL_thread_info_t *info = GD->thread.threads[i];
+    PL_local_data_t *ld;
+
+    if ( agc_thread(info, me) && (ld = acquire_ldata(info)) )
+    { if ( ld->magic == LD_MAGIC &&
+	   ld->atoms.mark_request == generation &&
+	   ld->atoms.marked != generation )
+      { if ( stalled )
+	{ int64_t inferences = ld->statistics.inferences;
+
+	  if ( inferences == ld->atoms.mark_inferences )
+	  { markAtomsThread(ld, generation);
+	    continue;
+	  }
+	  ld->atoms.mark_inferences = inferences;
+	}
+	count++;
+      }
+    }
+  }
+  release_ldata(LD);
+
+  return count;
+}
+
+
+/* forThreadsLocalData() calls func() with the local data of all threads
+   that are not being destroyed.  The local data is protected from
+   being freed, but the thread continues running.
+*/
+
+void
+forThreadsLocalData(void (*func)(PL_local_data_t *ld, void *closure),
+		    void *closure)
+{ GET_LD
+  int i;
+
+  for( i=1; i<=thread_highest_id; i++ )
+  { PL_thread_info_t *info = GD->thread.threads[i];
+    PL_local_data_t *ld;
+
+    if ( info && (ld = acquire_ldata(info)) )
+      (*func)(ld, closure);
+  }
+  release_ldata(LD);
+}
+
+
+void
+markAtomsOnThreadStacks(void)
+{ GET_LD
+  int me = PL_thread_self();
+  int generation = ++GD->atoms.mark_generation;
+  int i, polls, signalled = 0;
+  double max_pause = 0.0;
+
+  for( i=1; i<=thread_highest_id; i++ )
+  { PL_thread_info_t *info = GD->thread.threads[i];
+    PL_local_data_t *ld;
+
+    if ( agc_thread(info, me) && i != GC_id &&
+	 info->status == PL_THREAD_RUNNING &&
+	 (ld = acquire_ldata(info)) )
+    { if ( ld->magic == LD_MAGIC )
+      { ld->atoms.mark_inferences = ld->statistics.inferences;
+	ld->atoms.mark_request = generation;
+	if ( raiseSignal(ld, SIG_ATOM_MARK) )
+	  signalled++;
+      }
+    }
+  }
+  release_ldata(LD);
+
+  for(polls = 0; signalled > 0 && polls < AGC_MARK_POLLS; polls++)
+  { struct timespec deadline;
+
+    get_current_timespec(&deadline);
+    deadline.tv_nsec += AGC_MARK_POLL;
+    carry_timespec_nanos(&deadline);
+
+    pthread_mutex_lock(&GD->thread.agc.mutex);
+    while( (signalled = unmarked_threads(generation, FALSE)) > 0 &&
+	   pthread_cond_timedwait(&GD->thread.agc.cond,
+				  &GD->thread.agc.mutex, &deadline) != ETIMEDOUT )
+      ;
+    pthread_mutex_unlock(&GD->thread.agc.mutex);
+
+    if ( signalled > 0 )
+      signalled = unmarked_threads(generation, TRUE);
+  }
+
+  for( i=1; i<=thread_highest_id; i++ )
+  { PL_thread_info_t *info = GD->thread.threads[i];
+    PL_local_data_t *ld;
+
+    if ( agc_thread(info, me) && (ld = acquire_ldata(info)) )
+    { double pause = markAtomsThread(ld, generation);
+
+      if ( pause > max_pause )
+	max_pause = pause;
+    }
+  }
+  release_ldata(LD);
+
+  if ( max_pause > GD->atoms.max_pause )
+    GD->atoms.max_pause = max_pause;
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+markAtomsAtSafePoint() is the SIG_ATOM_MARK handler.  If we are in GC we
+own our scan_lock, so we leave the job to the collector.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+void
+markAtomsAtSafePoint(void)
+{ GET_LD
+  int generation = GD->atoms.mark_generation;
+
+  if ( GD->atoms.gc_active && LD->atoms.marked != generation &&
+       !LD->gc.active )
+  { markAtomsThread(LD, generation);
+
+    pthread_mutex_lock(&GD->thread.agc.mutex);
+    pthread_cond_broadcast(&GD->thread.agc.cond);
+    pthread_mutex_unlock(&GD->thread.agc.mutex);
+  }
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+forOtherRunningThreads() calls func for all running threads except the
+caller. The local data of the thread  is protected using acquire_ldata()
+during the call. It is used by the sampling profiler. Returns the number
+of threads for which func returned TRUE.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+int
+forOtherRunningThreads(int (*func)(PL_thread_info_t *info,
+				   PL_local_data_t *ld))
+{ GET_LD
+  int me = PL_thread_self();
+  int i, count = 0;
+
+  for( i=1; i<=thread_highest_id; i++ )
+  { PL_thread_info_t *info = GD->thread.threads[i];
+    PL_local_data_t *ld;
+
+    if ( info && info->pl_tid != me &&
+	 info->status == PL_THREAD_RUNNING &&
+	 (ld = acquire_ldata(info)) )
+    { if ( ld->magic == LD_MAGIC && (*func)(info, ld) )
+	count++;
+    }
+  }
+  release_ldata(LD);
+
+  return count;
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 We do not register atoms  in   message  queues as the PL_register_atom()
 calls seriously harms concurrency  due  to   contention  on  L_ATOM. So,
@@ -6317,6 +6729,7 @@ localiseDefinition(Definition def)
   clear(local, P_THREAD_LOCAL|P_DIRTYREG);	/* remains P_DYNAMIC */
   local->impl.clauses.first_clause = NULL;
   local->impl.clauses.clause_indexes = NULL;
+  local->ordered = NULL;
   ATOMIC_INC(&GD->statistics.predicates);
   ATOMIC_ADD(&local->module->code_size, sizeof(*local));
   DEBUG(MSG_PROC_COUNT, Sdprintf("Localise %s\n", predicateName(def)));
@@ -6702,6 +7115,11 @@ predicates_in_use(void)
   Definition *buckets = allocHeapOrHalt(sz * sizeof(Definition));
   memset(buckets, 0, sz * sizeof(Definition*));
 
+  pthread_mutex_lock(&GD->thread.index.mutex);
+  if ( (buckets[index] = GD->thread.index.building) )
+    index++;				/* background index builder */
+  pthread_mutex_unlock(&GD->thread.index.mutex);
+
   for(i=1; i<=thread_highest_id; i++)
   { PL_thread_info_t *info = GD->thread.threads[i];
     if ( info && info->access.predicate )
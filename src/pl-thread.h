@@ -150,6 +150,11 @@ typedef struct thread_handle
 #define QTYPE_THREAD	0
 #define QTYPE_QUEUE	1
 
+typedef struct message_chain
+{ struct thread_message *head;		/* First message in chain */
+  struct thread_message *tail;		/* Last message in chain */
+} message_chain;
+
 typedef struct message_queue
 { simpleMutex	       mutex;		/* Message queue mutex */
 #ifdef __WINDOWS__
@@ -161,6 +166,9 @@ typedef struct message_queue
 #endif
   struct thread_message   *head;	/* Head of message queue */
   struct thread_message   *tail;	/* Tail of message queue */
+  Table		       key_index;	/* key --> message_chain */
+  message_chain	       no_key;		/* Messages without a key */
+  int		       index_arg;	/* Argument indexed (0: none) */
   uint64_t	       sequence_next;	/* next for sequence id */
   word		       id;		/* Id of the queue */
   size_t	       size;		/* # terms in queue */
@@ -218,9 +226,12 @@ extern counting_mutex _PL_mutexes[];	/* Prolog mutexes */
 #define L_UMUTEX       23
 #define L_INIT_ATOMS   24
 #define L_CGCGEN       25
+#define L_TABLING      26
+#define L_PROFILE      27
+#define L_STACKS       28
 #ifdef __WINDOWS__
-#define L_DDE	       26
-#define L_CSTACK       27
+#define L_DDE	       29
+#define L_CSTACK       30
 #endif
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
@@ -391,6 +402,13 @@ COMMON(void)	forThreadLocalDataUnsuspended(
 COMMON(void)	resumeThreads(void);
 COMMON(void)	markAtomsMessageQueues(void);
 COMMON(void)	markAtomsThreadMessageQueue(PL_local_data_t *ld);
+COMMON(void)	markAtomsOnThreadStacks(void);
+COMMON(void)	markAtomsAtSafePoint(void);
+COMMON(void)	forThreadsLocalData(void (*func)(PL_local_data_t *ld,
+						 void *closure),
+				    void *closure);
+COMMON(int)	forOtherRunningThreads(int (*func)(PL_thread_info_t *info,
+						   PL_local_data_t *ld));
 
 #define acquire_ldata(info)	acquire_ldata__LD(info PASS_LD)
 #define release_ldata(ld)	(LD->thread.info->access.ldata = NULL)
@@ -456,5 +474,6 @@ COMMON(void)	markAccessedPredicates(PL_local_data_t *ld);
 COMMON(int)     cgc_thread_stats(cgc_stats *stats ARG_LD);
 COMMON(int)	signalGCThread(int sig);
 COMMON(int)	isSignalledGCThread(int sig ARG_LD);
+COMMON(int)	set_os_thread_name_from_charp(const char *s);
 
 #endif /*PL_THREAD_H_DEFINED*/
@@ -48,9 +48,16 @@ The _value_ associated with a  term  always   appears  in  a _leaf_ node
 because a sequence that represents a term   is  _never_ the prefix of of
 the sequence of another term.
 
+Nodes with a single child  use   a  trie_children_key  node.  If more
+children are added, we first use a trie_children_compact node, which is
+a plain array of keys followed by an array of children.  Lookup is a
+linear scan over the keys, which is faster than hashing for a small
+number of keys and much more compact than a hash table.  As these nodes
+are updated using CAS, adding a child creates a new copy.  If a node
+gets more than TRIE_COMPACT_MAX children it is turned into a hash table.
+
 TODO
   - Limit size of the tries
-  - Avoid using a hash-table for small number of branches
   - Thread safe reclaiming
     - Reclaim single-child node after moving to a hash
     - Make pruning the trie thread-safe
@@ -175,6 +182,7 @@ static void
 trie_destroy(trie *trie)
 { DEBUG(MSG_TRIE_GC, Sdprintf("Destroying trie %p\n", trie));
   trie_empty(trie);
+  free_lingering(&trie->lingering, GEN_MAX);
   PL_free(trie);
 }
 
@@ -193,10 +201,78 @@ trie_empty(trie *trie)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Children blocks that are replaced  by   insert_child()  or prune_node()
+may still be used by threads that walk  the trie without locking.  These
+threads hold a reference to the trie, so we keep the replaced blocks in
+trie->lingering and free them if the last reference is released.
+
+A block is added to the list after  it was unlinked from the trie.  Only
+threads that held a reference at that  moment   can  use it.  If we take
+the list and no reference is left, none of these threads is still using
+any of the blocks.  Otherwise, we put the list back.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static void
+retire_children(trie *trie, try_children_any *children)
+{ linger(&trie->lingering, PL_free, children);
+}
+
+
+static void
+free_retired_children(trie *trie)
+{ linger_list *l;
+
+  if ( (l=trie->lingering) &&
+       COMPARE_AND_SWAP(&trie->lingering, l, NULL) )
+  { if ( trie->references == 0 )
+    { free_lingering(&l, GEN_MAX);
+    } else
+    { linger_list *tail, *o;
+
+      for(tail=l; tail->next; tail=tail->next)
+	;
+      do
+      { o = trie->lingering;
+	tail->next = o;
+      } while( !COMPARE_AND_SWAP(&trie->lingering, o, l) );
+    }
+  }
+}
+
+
 void
 trie_clean(trie *trie)
 { if ( trie->magic == TRIE_CMAGIC )
     trie_empty(trie);
+  free_retired_children(trie);
+}
+
+
+static trie_children_compact *
+new_compact(unsigned int count)
+{ trie_children_compact *c = PL_malloc(sizeof_compact(count));
+
+  c->type  = TN_COMPACT;
+  c->count = count;
+  c->nvars = 0;
+  c->gsize = 0;
+
+  return c;
+}
+
+
+static trie_node *
+compact_child(trie_children_compact *c, word key)
+{ unsigned int i, count = c->count;
+  const word *keys = c->keys;
+
+  for(i=0; i<count; i++)
+  { if ( keys[i] == key )
+      return compact_children(c)[i];
+  }
+
+  return NULL;
 }
 
 
@@ -210,6 +286,8 @@ get_child(trie_node *n, word key ARG_LD)
 	if ( children.key->key == key )
 	  return children.key->child;
         return NULL;
+      case TN_COMPACT:
+	return compact_child(children.compact, key);
       case TN_HASHED:
 	return lookupHTable(children.hash->table, (void*)key);
       default:
@@ -265,6 +343,15 @@ clear_node(trie *trie, trie_node *n)
 	destroy_node(trie, children.key->child);
         PL_free(children.key);
 	break;
+      case TN_COMPACT:
+      { trie_children_compact *c = children.compact;
+	unsigned int i;
+
+	for(i=0; i<c->count; i++)
+	  destroy_node(trie, compact_children(c)[i]);
+	PL_free(c);
+	break;
+      }
       case TN_HASHED:
       { TableEnum e = newTableEnum(children.hash->table);
 	void *k, *v;
@@ -305,6 +392,7 @@ prune_node(trie *trie, trie_node *n)
 { trie_node *p;
   int empty = TRUE;
 
+  acquire_trie(trie);			/* see retire_children() */
   for(; empty && n->parent; n = p)
   { trie_children children;
 
@@ -315,8 +403,44 @@ prune_node(trie *trie, trie_node *n)
     { switch( children.any->type )
       { case TN_KEY:
 	  if ( COMPARE_AND_SWAP(&p->children.any, children.any, NULL) )
-	    PL_free(children.any);
+	    retire_children(trie, children.any);
+	  break;
+	case TN_COMPACT:
+	{ trie_children_compact *c = children.compact;
+	  try_children_any *new;
+	  unsigned int i;
+
+	  if ( c->count == 2 )
+	  { trie_children_key *k = PL_malloc(sizeof(*k));
+
+	    i = (c->keys[0] == n->key);
+	    k->type  = TN_KEY;
+	    k->key   = c->keys[i];
+	    k->child = compact_children(c)[i];
+	    new = (try_children_any*)k;
+	  } else
+	  { trie_children_compact *nc = new_compact(c->count-1);
+	    unsigned int j;
+
+	    nc->nvars = c->nvars;
+	    nc->gsize = c->gsize;
+	    for(i=0, j=0; i<c->count; i++)
+	    { if ( c->keys[i] != n->key )
+	      { nc->keys[j] = c->keys[i];
+		compact_children(nc)[j] = compact_children(c)[i];
+		j++;
+	      }
+	    }
+	    new = (try_children_any*)nc;
+	  }
+
+	  if ( COMPARE_AND_SWAP(&p->children.any, children.any, new) )
+	    retire_children(trie, children.any);
+	  else
+	    PL_free(new);
+	  empty = FALSE;
 	  break;
+	}
 	case TN_HASHED:
 	  deleteHTable(children.hash->table, (void*)n->key);
 	  empty = children.hash->table->size == 0;
@@ -326,6 +450,31 @@ prune_node(trie *trie, trie_node *n)
 
     destroy_node(trie, n);
   }
+  release_trie(trie);
+}
+
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+insert_child() adds a child for key to n.  The children of n change from
+none to a single key, to a compact array and finally to a hash table as
+the number of children grows.  A compact node is never modified after it
+has been published.  Instead we create an extended copy and replace it
+using CAS.  The replaced node is released using retire_children().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static trie_children_hashed *
+compact_to_hashed(trie_children_compact *c)
+{ trie_children_hashed *hnode = PL_malloc(sizeof(*hnode));
+  unsigned int i;
+
+  hnode->type  = TN_HASHED;
+  hnode->table = newHTable(c->count*2);
+  for(i=0; i<c->count; i++)
+    addHTable(hnode->table, (void*)c->keys[i], compact_children(c)[i]);
+  hnode->nvars = c->nvars;
+  hnode->gsize = c->gsize;
+
+  return hnode;
 }
 
 
@@ -342,32 +491,74 @@ insert_child(trie *trie, trie_node *n, word key ARG_LD)
     { switch( children.any->type )
       { case TN_KEY:
 	{ if ( children.key->key == key )
-	  { return children.key->child;
+	  { destroy_node(trie, new);
+	    return children.key->child;
 	  } else
-	  { trie_children_hashed *hnode = PL_malloc(sizeof(*hnode));
+	  { trie_children_compact *c = new_compact(2);
 
-	    hnode->type  = TN_HASHED;
-	    hnode->table = newHTable(4);
-	    addHTable(hnode->table, (void*)children.key->key,
-				    children.key->child);
-	    addHTable(hnode->table, (void*)key, (void*)new);
+	    c->keys[0] = children.key->key;
+	    c->keys[1] = key;
+	    compact_children(c)[0] = children.key->child;
+	    compact_children(c)[1] = new;
 
-	    hnode->nvars = key_nvar(children.key->key);
-	    max_nvar(&hnode->nvars, key);
-	    hnode->gsize = key_gsize(trie, children.key->key);
-	    max_gsize(&hnode->gsize, trie, key);
+	    c->nvars = key_nvar(children.key->key);
+	    max_nvar(&c->nvars, key);
+	    c->gsize = key_gsize(trie, children.key->key);
+	    max_gsize(&c->gsize, trie, key);
 
-	    if ( COMPARE_AND_SWAP(&n->children.hash, children.hash, hnode) )
-	    { PL_free(children.any);		/* TBD: Safely free */
+	    if ( COMPARE_AND_SWAP(&n->children.compact, children.compact, c) )
+	    { retire_children(trie, children.any);
 	      new->parent = n;
 	      return new;
 	    }
 	    destroy_node(trie, new);
-	    destroyHTable(hnode->table);
-	    PL_free(hnode);
+	    PL_free(c);
 	    continue;
 	  }
 	}
+	case TN_COMPACT:
+	{ trie_children_compact *c = children.compact;
+	  try_children_any *ext;
+	  trie_node *old;
+
+	  if ( (old=compact_child(c, key)) )
+	  { destroy_node(trie, new);
+	    return old;
+	  }
+
+	  if ( c->count < TRIE_COMPACT_MAX )
+	  { trie_children_compact *nc = new_compact(c->count+1);
+
+	    memcpy(nc->keys, c->keys, c->count*sizeof(word));
+	    nc->keys[c->count] = key;
+	    memcpy(compact_children(nc), compact_children(c),
+		   c->count*sizeof(trie_node*));
+	    compact_children(nc)[c->count] = new;
+	    nc->nvars = c->nvars;
+	    nc->gsize = c->gsize;
+	    max_nvar(&nc->nvars, key);
+	    max_gsize(&nc->gsize, trie, key);
+	    ext = (try_children_any*)nc;
+	  } else
+	  { trie_children_hashed *hnode = compact_to_hashed(c);
+
+	    addHTable(hnode->table, (void*)key, (void*)new);
+	    max_nvar(&hnode->nvars, key);
+	    max_gsize(&hnode->gsize, trie, key);
+	    ext = (try_children_any*)hnode;
+	  }
+
+	  if ( COMPARE_AND_SWAP(&n->children.any, children.any, ext) )
+	  { retire_children(trie, children.any);
+	    new->parent = n;
+	    return new;
+	  }
+	  destroy_node(trie, new);
+	  if ( ext->type == TN_HASHED )
+	    destroyHTable(((trie_children_hashed*)ext)->table);
+	  PL_free(ext);
+	  continue;
+	}
 	case TN_HASHED:
 	{ trie_node *old = addHTable(children.hash->table,
 				     (void*)key, (void*)new);
@@ -455,6 +646,7 @@ trie_lookup(trie *trie, trie_node **nodep, Word k, int add ARG_LD)
   int rc = TRUE;
   int compounds = 0;
 
+  acquire_trie(trie);			/* see retire_children() */
   initTermAgenda(&agenda, 1, k);
   while( node && (p=nextTermAgenda(&agenda)) )
   { word w = *p;
@@ -501,6 +693,7 @@ trie_lookup(trie *trie, trie_node **nodep, Word k, int add ARG_LD)
   }
   clearTermAgenda(&agenda);
   clear_vars(k, var_number PASS_LD);
+  release_trie(trie);
 
   if ( rc == TRUE )
   { if ( node )
@@ -765,8 +958,11 @@ put_trie_term(trie_node *node, term_t term ARG_LD)
 typedef struct trie_stats
 { size_t bytes;
   size_t nodes;
+  size_t compacts;
   size_t hashes;
   size_t values;
+  size_t compact_bytes;
+  size_t hash_bytes;
 } trie_stats;
 
 
@@ -785,11 +981,26 @@ stat_node(trie_node *n, trie_stats *stats)
 	stats->bytes += sizeof(*children.key);
         stat_node(children.key->child, stats);
         break;
+      case TN_COMPACT:
+      { trie_children_compact *c = children.compact;
+	size_t bytes = sizeof_compact(c->count);
+	unsigned int i;
+
+	stats->bytes += bytes;
+	stats->compact_bytes += bytes;
+	stats->compacts++;
+
+	for(i=0; i<c->count; i++)
+	  stat_node(compact_children(c)[i], stats);
+	break;
+      }
       case TN_HASHED:
       { TableEnum e = newTableEnum(children.hash->table);
 	void *k, *v;
+	size_t bytes = sizeofTable(children.hash->table);
 
-	stats->bytes += sizeofTable(children.hash->table);
+	stats->bytes += bytes;
+	stats->hash_bytes += bytes;
 	stats->hashes++;
 
 	while( advanceTableEnum(e, &k, &v) )
@@ -807,10 +1018,8 @@ stat_node(trie_node *n, trie_stats *stats)
 
 static void
 stat_trie(trie *t, trie_stats *stats)
-{ stats->bytes  = sizeof(*t) - sizeof(t->root);
-  stats->nodes  = 0;
-  stats->hashes = 0;
-  stats->values = 0;
+{ memset(stats, 0, sizeof(*stats));
+  stats->bytes  = sizeof(*t) - sizeof(t->root);
 
   acquire_trie(t);
   stat_node(&t->root, stats);
@@ -1237,7 +1446,10 @@ typedef struct trie_choice
 { union
   { void *any;
     TableEnum table;
+    trie_children_compact *compact;	/* Copy, allocated with choice */
   } choice;
+  tn_node_type type;			/* Type of the node */
+  unsigned int index;			/* Index into compact node */
   word key;
   trie_node *child;
   size_t gsize;
@@ -1253,6 +1465,13 @@ typedef struct
 } trie_gen_state;
 
 
+static void
+clear_choice(trie_choice *ch)
+{ if ( ch->choice.any && ch->type == TN_HASHED )
+    freeTableEnum(ch->choice.table);
+}
+
+
 static void
 clear_trie_state(trie_gen_state *state)
 { trie_choice *ch, *next;
@@ -1260,8 +1479,7 @@ clear_trie_state(trie_gen_state *state)
   for(ch=state->head; ch; ch=next)
   { next = ch->next;
 
-    if ( ch->choice.table )
-      freeTableEnum(ch->choice.table);
+    clear_choice(ch);
     PL_free(ch);
   }
 
@@ -1271,13 +1489,19 @@ clear_trie_state(trie_gen_state *state)
 
 trie_choice *
 add_choice(trie_gen_state *state, trie_node *node)
-{ trie_choice *ch = PL_malloc(sizeof(*ch));
+{ trie_choice *ch;
   trie_children children = node->children;
   size_t gsize = state->tail ? state->tail->gsize : 0;
   unsigned int nvars = state->tail ? state->tail->nvars : 0;
+  size_t csize = 0;
+
+  if ( children.any && children.any->type == TN_COMPACT )
+    csize = sizeof_compact(children.compact->count);
+  ch = PL_malloc(sizeof(*ch) + csize);
 
   if ( children.any )
-  { switch( children.any->type )
+  { ch->type = children.any->type;
+    switch( children.any->type )
     { case TN_KEY:
       {	word key   = children.key->key;
 
@@ -1289,6 +1513,20 @@ add_choice(trie_gen_state *state, trie_node *node)
         ch->choice.any = NULL;
 	break;
       }
+      case TN_COMPACT:
+      { trie_children_compact *c = children.compact;
+
+	if ( c->nvars > nvars )
+	  nvars = c->nvars;
+	gsize += c->gsize;
+
+					/* copy; c may be replaced */
+	ch->choice.compact = memcpy(ch+1, c, csize);
+	ch->index = 0;
+	ch->key   = c->keys[0];
+	ch->child = compact_children(c)[0];
+	break;
+      }
       case TN_HASHED:
       { void *k, *v;
 	unsigned int maxchildvar;
@@ -1340,8 +1578,7 @@ static trie_choice *
 previous_choice(trie_gen_state *state)
 { trie_choice *ch = state->tail;
 
-  if ( ch->choice.table )
-    freeTableEnum(ch->choice.table);
+  clear_choice(ch);
   state->tail = ch->prev;
   if ( state->tail )
     state->tail->next = NULL;
@@ -1355,14 +1592,32 @@ previous_choice(trie_gen_state *state)
 
 static int
 advance_node(trie_choice *ch)
-{ if ( ch->choice.table )
-  { void *k, *v;
+{ if ( ch->choice.any )
+  { switch( ch->type )
+    { case TN_COMPACT:
+      { trie_children_compact *c = ch->choice.compact;
 
-    if ( advanceTableEnum(ch->choice.table, &k, &v) )
-    { ch->key   = (word)k;
-      ch->child = (trie_node*)v;
+	if ( ++ch->index < c->count )
+	{ ch->key   = c->keys[ch->index];
+	  ch->child = compact_children(c)[ch->index];
 
-      return TRUE;
+	  return TRUE;
+	}
+	break;
+      }
+      case TN_HASHED:
+      { void *k, *v;
+
+	if ( advanceTableEnum(ch->choice.table, &k, &v) )
+	{ ch->key   = (word)k;
+	  ch->child = (trie_node*)v;
+
+	  return TRUE;
+	}
+	break;
+      }
+      default:
+	assert(0);
     }
   }
 
@@ -1523,6 +1778,18 @@ PRED_IMPL("$trie_property", 2, trie_property, 0)
       { trie_stats stats;
 	stat_trie(trie, &stats);
 	return PL_unify_int64(arg, stats.hashes);
+      } else if ( name == ATOM_hashed_size )
+      { trie_stats stats;
+	stat_trie(trie, &stats);
+	return PL_unify_int64(arg, stats.hash_bytes);
+      } else if ( name == ATOM_compact )
+      { trie_stats stats;
+	stat_trie(trie, &stats);
+	return PL_unify_int64(arg, stats.compacts);
+      } else if ( name == ATOM_compact_size )
+      { trie_stats stats;
+	stat_trie(trie, &stats);
+	return PL_unify_int64(arg, stats.compact_bytes);
       } else if ( name == ATOM_value_count )
       { trie_stats stats;
 	stat_trie(trie, &stats);
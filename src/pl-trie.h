@@ -41,9 +41,12 @@
 
 typedef enum
 { TN_KEY,				/* Single key */
+  TN_COMPACT,				/* Small array of keys */
   TN_HASHED				/* Hashed */
 } tn_node_type;
 
+#define TRIE_COMPACT_MAX 16		/* Max children in a compact node */
+
 typedef struct try_children_any
 { tn_node_type type;
 } try_children_any;
@@ -61,10 +64,25 @@ typedef struct trie_children_key
   struct trie_node *child;
 } trie_children_key;
 
+typedef struct trie_children_compact
+{ tn_node_type type;
+  unsigned int count;			/* # children */
+  unsigned int nvars;
+  size_t gsize;
+  word keys[1];				/* [count] keys, followed by */
+					/* [count] children */
+} trie_children_compact;
+
+#define compact_children(c) ((struct trie_node**)&(c)->keys[(c)->count])
+#define sizeof_compact(n) \
+	(offsetof(trie_children_compact, keys) + \
+	 (n)*(sizeof(word)+sizeof(struct trie_node*)))
+
 typedef union trie_children
-{ try_children_any     *any;
-  trie_children_key    *key;
-  trie_children_hashed *hash;
+{ try_children_any      *any;
+  trie_children_key     *key;
+  trie_children_compact *compact;
+  trie_children_hashed  *hash;
 } trie_children;
 
 
@@ -90,9 +108,12 @@ typedef struct trie
   indirect_table       *indirects;	/* indirect values */
   void		      (*release_node)(struct trie *, trie_node *);
   trie_allocation_pool *alloc_pool;	/* Node allocation pool */
+  linger_list	       *lingering;	/* replaced children blocks */
   struct
   { struct worklist *worklist;		/* tabling worklist */
     trie_node	    *variant;		/* node in variant trie */
+    int		     tid;		/* thread computing shared table */
+    struct idg_node *IDG;		/* incremental dependency graph node */
   } data;
 } trie;
 
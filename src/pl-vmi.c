@@ -2887,6 +2887,18 @@ VMI(S_DYNAMIC, 0, 0, ())
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+S_INCR_DYNAMIC: Incremental dynamic predicate.  If  we  are evaluating an
+incremental table, record that this table depends on the predicate.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+VMI(S_INCR_DYNAMIC, 0, 0, ())
+{ idg_add_dyncall(DEF PASS_LD);
+
+  VMI_GOTO(S_DYNAMIC);
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 S_THREAD_LOCAL: Get thread-local definition
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
@@ -3262,6 +3274,11 @@ A_FUNC0, function
 A_FUNC1, function
 A_FUNC2, function
 
+A_FUNC1 calls the float kernel of the function directly if the argument
+is a float and the function has a kernel (see ar_floatdefs in pl-arith.c).
+If the result is not a finite float, the full function is called to raise
+the error.
+
 TBD: Keep knowledge on #argument in function!
 - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
@@ -3276,8 +3293,20 @@ VMI(A_FUNC0, 0, 1, (CA1_AFUNC))
 }
 
 VMI(A_FUNC1, 0, 1, (CA1_AFUNC))
-{ an = 1;
+{ Number n = argvArithStack(1 PASS_LD);
+  ArithFloatF ff;
+
+  an = 1;
   fn = *PC++;
+
+  if ( n->type == V_FLOAT && (ff=GD->arith.float_functions[fn]) )
+  { double f = (*ff)(n->value.f);
+
+    if ( isfinite(f) )
+    { n->value.f = f;
+      NEXT_INSTRUCTION;
+    }
+  }
   goto common_an;
 }
 
@@ -3309,38 +3338,53 @@ END_SHAREDVARS
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 A_ADD: Shorthand for A_FUNC2 pl_ar_add()
-- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+A_SUB: Shorthand for A_FUNC2 ar_minus()
+A_MUL: Shorthand for A_FUNC2 ar_mul()
+A_DIV: Shorthand for A_FUNC2 ar_divide()
 
-VMI(A_ADD, 0, 0, ())
-{ Number argv = argvArithStack(2 PASS_LD);
-  int rc;
-  number r;
+If the result is a float (one argument  is   a  float  and the other is a
+float or small integer), it is computed   in  place on the arithmetic stack.
+Results that are not finite are left to the full function, which raises
+the error.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
 
-  SAVE_REGISTERS(qid);
-  rc = pl_ar_add(argv, argv+1, &r);
-  LOAD_REGISTERS(qid);
-  popArgvArithStack(2 PASS_LD);
-  if ( rc )
-  { pushArithStack(&r PASS_LD);
-    NEXT_INSTRUCTION;
+BEGIN_SHAREDVARS
+  Number argv;
+  ArithF af;
+
+#define AR_FLOAT_OP(op) \
+  { double f1, f2, f; \
+    argv = argvArithStack(2 PASS_LD); \
+    if ( floatArgs(argv, argv+1, &f1, &f2) && isfinite(f = f1 op f2) ) \
+    { argv->value.f = f; \
+      argv->type = V_FLOAT; \
+      popArgvArithStack(1 PASS_LD); \
+      NEXT_INSTRUCTION; \
+    } \
   }
 
-  resetArithStack(PASS_LD1);
-  THROW_EXCEPTION;
+VMI(A_ADD, 0, 0, ())
+{ AR_FLOAT_OP(+);
+  af = pl_ar_add;
+  goto a_binary;
 }
 
-
-/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
-A_MUL: Shorthand for A_FUNC2 ar_mul()
-- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+VMI(A_SUB, 0, 0, ())
+{ AR_FLOAT_OP(-);
+  af = ar_minus;
+  goto a_binary;
+}
 
 VMI(A_MUL, 0, 0, ())
-{ Number argv = argvArithStack(2 PASS_LD);
-  int rc;
+{ int rc;
   number r;
 
+  AR_FLOAT_OP(*);
+  af = ar_mul;
+
+a_binary:
   SAVE_REGISTERS(qid);
-  rc = ar_mul(argv, argv+1, &r);
+  rc = (*af)(argv, argv+1, &r);
   LOAD_REGISTERS(qid);
   popArgvArithStack(2 PASS_LD);
   if ( rc )
@@ -3352,6 +3396,15 @@ VMI(A_MUL, 0, 0, ())
   THROW_EXCEPTION;
 }
 
+VMI(A_DIV, 0, 0, ())
+{ AR_FLOAT_OP(/);
+  af = ar_divide;
+  goto a_binary;
+}
+
+#undef AR_FLOAT_OP
+END_SHAREDVARS
+
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 A_ADD_FC: Simple case A is B + <int>, where   A is a firstvar and B is a
@@ -3488,6 +3541,12 @@ BEGIN_SHAREDVARS
       default: \
         ; \
     } \
+  } else \
+  { double f1, f2; \
+    if ( floatArgs(n1, n2, &f1, &f2) && !isnan(f1) && !isnan(f2) ) \
+    { rc = f1 op f2; \
+      goto a_cmp_out; \
+    } \
   }
 
 
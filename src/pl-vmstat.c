@@ -0,0 +1,528 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "pl-incl.h"
+#include "pl-vmstat.h"
+#include "pl-thread.h"
+#ifdef O_VMI_STATISTICS
+#ifdef HAVE_LINUX_PERF_EVENT_H
+#include <linux/perf_event.h>
+#endif
+#ifdef HAVE_SYS_SYSCALL_H
+#include <sys/syscall.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#include <time.h>
+
+#undef LD
+#define LD LOCAL_LD
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Count VM instructions, instruction pairs and the cycles spent in each VM
+instruction. See pl-vmstat.h for the hook called by the VMI() macro.
+
+The cycles of an instruction  are  the   clock  ticks  from entering the
+instruction until entering the next instruction executed by  the same
+thread. They thus include the time spent   in  foreign predicates, GC,
+etc. that is started from the instruction as well as the overhead of the
+instrumentation itself. The clock is selected when  a thread executes
+its first instruction:
+
+  - On Linux, we use a perf_event_open() CPU cycle counter for the
+    thread that only counts cycles in user space.  If the kernel allows
+    us to read the counter using `rdpmc`, we do so.  Otherwise we need
+    a read() system call for each instruction, which is slow but still
+    counts only cycles spent in the thread.
+  - Otherwise, on x86 we use the time stamp counter (`rdtsc`).  This
+    counts wall time and thus includes time the thread was not running.
+  - Otherwise we use clock_gettime() with CLOCK_MONOTONIC (nanoseconds).
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define VMI_CLOCK_PERF_RDPMC	1	/* perf counter read with rdpmc */
+#define VMI_CLOCK_PERF_READ	2	/* perf counter read with read() */
+#define VMI_CLOCK_TSC		3	/* x86 time stamp counter */
+#define VMI_CLOCK_NS		4	/* clock_gettime(CLOCK_MONOTONIC) */
+
+#if defined(HAVE_LINUX_PERF_EVENT_H) && defined(HAVE_SYS_SYSCALL_H) && \
+    defined(SYS_perf_event_open)
+#define VMI_PERF 1
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VMI_X86 1
+
+static inline uint64_t
+rdtsc(void)
+{ unsigned int lo, hi;
+
+  __asm__ __volatile__ ("rdtsc" : "=a" (lo), "=d" (hi));
+
+  return (uint64_t)hi<<32 | lo;
+}
+
+static inline uint64_t
+rdpmc(unsigned int counter)
+{ unsigned int lo, hi;
+
+  __asm__ __volatile__ ("rdpmc" : "=a" (lo), "=d" (hi) : "c" (counter));
+
+  return (uint64_t)hi<<32 | lo;
+}
+#endif
+
+static vmi_counters *vmi_finished;	/* Counters of finished threads */
+
+
+		 /*******************************
+		 *	       CLOCKS		*
+		 *******************************/
+
+#ifdef VMI_PERF
+static int
+open_perf_counter(vmi_statistics *vs)
+{ struct perf_event_attr attr;
+  int fd;
+
+  memset(&attr, 0, sizeof(attr));
+  attr.type		= PERF_TYPE_HARDWARE;
+  attr.size		= sizeof(attr);
+  attr.config		= PERF_COUNT_HW_CPU_CYCLES;
+  attr.exclude_kernel	= 1;
+  attr.exclude_hv	= 1;
+
+  if ( (fd=(int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0)) < 0 )
+    return FALSE;
+
+  vs->perf_fd = fd;
+  vs->clock   = VMI_CLOCK_PERF_READ;
+#if defined(VMI_X86) && defined(HAVE_MMAP)
+{ void *page = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ, MAP_SHARED, fd, 0);
+
+  if ( page != MAP_FAILED )
+  { struct perf_event_mmap_page *pc = page;
+
+    vs->perf_page = page;
+    if ( pc->cap_user_rdpmc )
+      vs->clock = VMI_CLOCK_PERF_RDPMC;
+  }
+}
+#endif
+
+  return TRUE;
+}
+
+
+static void
+close_perf_counter(vmi_statistics *vs)
+{
+#if defined(VMI_X86) && defined(HAVE_MMAP)
+  if ( vs->perf_page )
+    munmap(vs->perf_page, sysconf(_SC_PAGESIZE));
+#endif
+  if ( vs->perf_fd >= 0 )
+    close(vs->perf_fd);
+}
+
+
+#if defined(VMI_X86) && defined(HAVE_MMAP)
+/* Self-monitoring read as described in linux/perf_event.h.  Fails if
+   the counter is not scheduled on the CPU.
+*/
+
+#define compiler_barrier() __asm__ __volatile__ ("" ::: "memory")
+
+static int
+read_perf_rdpmc(vmi_statistics *vs, uint64_t *value)
+{ volatile struct perf_event_mmap_page *pc = vs->perf_page;
+  uint32_t seq, idx;
+  uint64_t count;
+
+  do
+  { seq = pc->lock;
+    compiler_barrier();
+    idx = pc->index;
+    count = pc->offset;
+    if ( !pc->cap_user_rdpmc || idx == 0 )
+      return FALSE;
+    { unsigned int width = pc->pmc_width;
+      int64_t pmc = (int64_t)(rdpmc(idx-1) << (64-width));
+
+      count += (uint64_t)(pmc >> (64-width));
+    }
+    compiler_barrier();
+  } while ( pc->lock != seq );
+
+  *value = count;
+  return TRUE;
+}
+#endif
+#endif /*VMI_PERF*/
+
+
+uint64_t
+vmiClock(vmi_statistics *vs)
+{ switch(vs->clock)
+  {
+#ifdef VMI_PERF
+#if defined(VMI_X86) && defined(HAVE_MMAP)
+    case VMI_CLOCK_PERF_RDPMC:
+    { uint64_t value;
+
+      if ( read_perf_rdpmc(vs, &value) )
+	return value;
+    }
+    /*FALLTHROUGH*/
+#endif
+    case VMI_CLOCK_PERF_READ:
+    { uint64_t value;
+
+      if ( read(vs->perf_fd, &value, sizeof(value)) == sizeof(value) )
+	return value;
+      return vs->last;
+    }
+#endif
+#ifdef VMI_X86
+    case VMI_CLOCK_TSC:
+      return rdtsc();
+#endif
+    default:
+    { struct timespec ts;
+
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return (uint64_t)ts.tv_sec*1000000000 + (uint64_t)ts.tv_nsec;
+    }
+  }
+}
+
+
+static atom_t
+clock_name(int clock)
+{ switch(clock)
+  { case VMI_CLOCK_PERF_RDPMC:
+    case VMI_CLOCK_PERF_READ:
+      return ATOM_cycles;
+    case VMI_CLOCK_TSC:
+      return ATOM_tsc;
+    default:
+      return ATOM_nanoseconds;
+  }
+}
+
+
+		 /*******************************
+		 *	 THREAD COUNTERS	*
+		 *******************************/
+
+vmi_statistics *
+initVMIStatistics(ARG1_LD)
+{ vmi_statistics *vs = allocHeapOrHalt(sizeof(*vs));
+
+  memset(vs, 0, sizeof(*vs));
+  vs->prev    = -1;
+  vs->perf_fd = -1;
+#ifdef VMI_PERF
+  if ( !open_perf_counter(vs) )
+#endif
+  {
+#ifdef VMI_X86
+    vs->clock = VMI_CLOCK_TSC;
+#else
+    vs->clock = VMI_CLOCK_NS;
+#endif
+  }
+
+  PL_LOCK(L_PROFILE);
+  LD->vmi_statistics = vs;
+  PL_UNLOCK(L_PROFILE);
+
+  return vs;
+}
+
+
+static void
+add_counters(vmi_counters *into, const vmi_counters *from)
+{ int i, j;
+
+  for(i=0; i<I_HIGHEST; i++)
+  { into->count[i]  += from->count[i];
+    into->cycles[i] += from->cycles[i];
+    for(j=0; j<I_HIGHEST; j++)
+      into->pairs[i][j] += from->pairs[i][j];
+  }
+}
+
+
+/* freeVMIStatistics() is called when the local data of a thread or
+   engine is destroyed.  Its counters are added to vmi_finished.
+*/
+
+void
+freeVMIStatistics(PL_local_data_t *ld)
+{ vmi_statistics *vs;
+
+  PL_LOCK(L_PROFILE);
+  if ( (vs=ld->vmi_statistics) )
+  { ld->vmi_statistics = NULL;
+    if ( !vmi_finished )
+    { vmi_finished = allocHeapOrHalt(sizeof(*vmi_finished));
+      memset(vmi_finished, 0, sizeof(*vmi_finished));
+    }
+    add_counters(vmi_finished, &vs->counters);
+  }
+  PL_UNLOCK(L_PROFILE);
+
+  if ( vs )
+  {
+#ifdef VMI_PERF
+    close_perf_counter(vs);
+#endif
+    freeHeap(vs, sizeof(*vs));
+  }
+}
+
+
+static void
+add_thread_counters(PL_local_data_t *ld, void *closure)
+{ if ( ld->vmi_statistics )
+    add_counters(closure, &ld->vmi_statistics->counters);
+}
+
+
+static void
+reset_thread_counters(PL_local_data_t *ld, void *closure)
+{ vmi_statistics *vs = ld->vmi_statistics;
+
+  (void)closure;
+  if ( vs )
+  { memset(&vs->counters, 0, sizeof(vs->counters));
+    vs->prev = -1;
+  }
+}
+
+
+/* for_all_vmi_statistics() calls func on the local data of all
+   threads.  Must be called with L_PROFILE locked.  Counters of running
+   threads are read without synchronization and may thus be slightly
+   inconsistent.
+*/
+
+static void
+for_all_vmi_statistics(void (*func)(PL_local_data_t *ld, void *closure),
+		       void *closure ARG_LD)
+{
+#ifdef O_PLMT
+  forThreadsLocalData(func, closure);
+#else
+  (*func)(LD, closure);
+#endif
+}
+
+
+		 /*******************************
+		 *	  PROLOG INTERFACE	*
+		 *******************************/
+
+typedef struct vmi_pair
+{ uint64_t	count;
+  int		prev;
+  int		next;
+} vmi_pair;
+
+static int
+compare_vmi_pair(const void *p1, const void *p2)
+{ const vmi_pair *v1 = p1;
+  const vmi_pair *v2 = p2;
+
+  return v1->count > v2->count ? -1 :
+	 v1->count < v2->count ?  1 : 0;
+}
+
+
+static int
+unify_instructions(term_t t, const vmi_counters *c)
+{ GET_LD
+  vmi_pair order[I_HIGHEST];
+  term_t tail = PL_copy_term_ref(t);
+  term_t head = PL_new_term_ref();
+  int i, n = 0;
+
+  for(i=0; i<I_HIGHEST; i++)
+  { if ( c->count[i] )
+    { order[n].count = c->count[i];
+      order[n].prev  = i;
+      n++;
+    }
+  }
+  qsort(order, n, sizeof(*order), compare_vmi_pair);
+
+  for(i=0; i<n; i++)
+  { int op = order[i].prev;
+
+    if ( !PL_unify_list(tail, head, tail) ||
+	 !PL_unify_term(head,
+			PL_FUNCTOR, FUNCTOR_vmi3,
+			  PL_CHARS, codeTable[op].name,
+			  PL_INT64, (int64_t)c->count[op],
+			  PL_INT64, (int64_t)c->cycles[op]) )
+      return FALSE;
+  }
+
+  return PL_unify_nil(tail);
+}
+
+
+static int
+unify_pairs(term_t t, const vmi_counters *c)
+{ GET_LD
+  vmi_pair *pairs;
+  size_t n = 0, i;
+  int rc = TRUE;
+  int p, q;
+
+  for(p=0; p<I_HIGHEST; p++)
+  { for(q=0; q<I_HIGHEST; q++)
+    { if ( c->pairs[p][q] )
+	n++;
+    }
+  }
+  if ( !(pairs = malloc(n*sizeof(*pairs)+1)) )
+    return PL_no_memory();
+
+  for(n=0, p=0; p<I_HIGHEST; p++)
+  { for(q=0; q<I_HIGHEST; q++)
+    { if ( c->pairs[p][q] )
+      { pairs[n].count = c->pairs[p][q];
+	pairs[n].prev  = p;
+	pairs[n].next  = q;
+	n++;
+      }
+    }
+  }
+  qsort(pairs, n, sizeof(*pairs), compare_vmi_pair);
+
+  { term_t tail = PL_copy_term_ref(t);
+    term_t head = PL_new_term_ref();
+
+    for(i=0; i<n && rc; i++)
+    { rc = ( PL_unify_list(tail, head, tail) &&
+	     PL_unify_term(head,
+			   PL_FUNCTOR, FUNCTOR_pair3,
+			     PL_CHARS, codeTable[pairs[i].prev].name,
+			     PL_CHARS, codeTable[pairs[i].next].name,
+			     PL_INT64, (int64_t)pairs[i].count) );
+    }
+    rc = rc && PL_unify_nil(tail);
+  }
+
+  free(pairs);
+  return rc;
+}
+
+
+/** vm_statistics(-Statistics) is det.
+ *
+ * Statistics is a list clock(Clock), instructions(List) and
+ * pairs(List).  See the manual for details.
+ */
+
+static
+PRED_IMPL("vm_statistics", 1, vm_statistics, 0)
+{ PRED_LD
+  vmi_counters *c = malloc(sizeof(*c));
+  vmi_statistics *vs = LD->vmi_statistics;
+  term_t instr = PL_new_term_ref();
+  term_t pairs = PL_new_term_ref();
+  int rc;
+
+  if ( !c )
+    return PL_no_memory();
+  if ( !vs )
+    vs = initVMIStatistics(PASS_LD1);
+
+  memset(c, 0, sizeof(*c));
+  PL_LOCK(L_PROFILE);
+  if ( vmi_finished )
+    add_counters(c, vmi_finished);
+  for_all_vmi_statistics(add_thread_counters, c PASS_LD);
+  PL_UNLOCK(L_PROFILE);
+
+  rc = ( unify_instructions(instr, c) &&
+	 unify_pairs(pairs, c) &&
+	 PL_unify_term(A1,
+		       PL_FUNCTOR, FUNCTOR_dot2,
+			 PL_FUNCTOR, FUNCTOR_clock1,
+			   PL_ATOM, clock_name(vs->clock),
+		       PL_FUNCTOR, FUNCTOR_dot2,
+			 PL_FUNCTOR, FUNCTOR_instructions1,
+			   PL_TERM, instr,
+		       PL_FUNCTOR, FUNCTOR_dot2,
+			 PL_FUNCTOR, FUNCTOR_pairs1,
+			   PL_TERM, pairs,
+		       PL_ATOM, ATOM_nil) );
+  free(c);
+
+  return rc;
+}
+
+
+static
+PRED_IMPL("reset_vm_statistics", 0, reset_vm_statistics, 0)
+{ PRED_LD
+
+  PL_LOCK(L_PROFILE);
+  if ( vmi_finished )
+    memset(vmi_finished, 0, sizeof(*vmi_finished));
+  for_all_vmi_statistics(reset_thread_counters, NULL PASS_LD);
+  PL_UNLOCK(L_PROFILE);
+
+  return TRUE;
+}
+
+#endif /*O_VMI_STATISTICS*/
+
+		 /*******************************
+		 *      PUBLISH PREDICATES	*
+		 *******************************/
+
+BeginPredDefs(vmstat)
+#ifdef O_VMI_STATISTICS
+  PRED_DEF("vm_statistics",	  1, vm_statistics,	  0)
+  PRED_DEF("reset_vm_statistics", 0, reset_vm_statistics, 0)
+#endif
+EndPredDefs
@@ -0,0 +1,90 @@
+/*  Part of SWI-Prolog
+
+    Author:        Jan Wielemaker
+    E-mail:        J.Wielemaker@vu.nl
+    WWW:           http://www.swi-prolog.org
+    Copyright (c)  2019, VU University Amsterdam
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions
+    are met:
+
+    1. Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright
+       notice, this list of conditions and the following disclaimer in
+       the documentation and/or other materials provided with the
+       distribution.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+    COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+    POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef PL_VMSTAT_H_INCLUDED
+#define PL_VMSTAT_H_INCLUDED
+
+#ifdef O_VMI_STATISTICS
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+VMI statistics are collected if  the   system  is  configured using the
+cmake option -DVMI_STATISTICS=ON. Each VMI()   in  pl-vmi.c then calls
+vmiStatEnter(), which counts the  instruction   and  the  pair (previous
+instruction, this instruction) and  charges  the   cycles  since  the
+previous instruction was entered to the previous instruction.
+
+Counters are kept per thread  (engine)   and  merged  into  a global
+table when the thread terminates. See pl-vmstat.c.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+typedef struct vmi_counters
+{ uint64_t	count[I_HIGHEST];		/* # times executed */
+  uint64_t	cycles[I_HIGHEST];		/* cycles until next VMI */
+  uint64_t	pairs[I_HIGHEST][I_HIGHEST];	/* [previous][next] */
+} vmi_counters;
+
+typedef struct vmi_statistics
+{ vmi_counters	counters;		/* The counters */
+  int		prev;			/* Previous VMI or -1 */
+  int		clock;			/* VMI_CLOCK_* */
+  uint64_t	last;			/* Clock when prev started */
+  int		perf_fd;		/* perf_event_open() handle or -1 */
+  void	       *perf_page;		/* mmap()ed perf_event page */
+} vmi_statistics;
+
+COMMON(vmi_statistics *) initVMIStatistics(ARG1_LD);
+COMMON(void)		freeVMIStatistics(PL_local_data_t *ld);
+COMMON(uint64_t)	vmiClock(vmi_statistics *vs);
+
+static inline void
+vmiStatEnter(int op ARG_LD)
+{ vmi_statistics *vs = LD->vmi_statistics;
+  uint64_t now;
+
+  if ( unlikely(!vs) )
+    vs = initVMIStatistics(PASS_LD1);
+
+  now = vmiClock(vs);
+  if ( vs->prev >= 0 )
+  { vs->counters.cycles[vs->prev] += now - vs->last;
+    vs->counters.pairs[vs->prev][op]++;
+  }
+  vs->counters.count[op]++;
+  vs->prev = op;
+  vs->last = now;
+}
+
+#endif /*O_VMI_STATISTICS*/
+
+#endif /*PL_VMSTAT_H_INCLUDED*/
@@ -39,6 +39,7 @@
 #include "os/pl-utf8.h"
 #include "pl-dbref.h"
 #include "pl-dict.h"
+#include "pl-zip.h"
 #ifdef HAVE_SYS_PARAM_H
 #include <sys/param.h>
 #endif
@@ -556,10 +557,52 @@ zigzag_decode(uint64_t n)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Integers are stored as a sequence of 7-bit groups where the last byte has
+the high bit set. If the stream buffer holds  enough bytes for the longest
+encoding we decode directly from the   buffer. This is always the case
+for mapped QLF files (see openQlfInput()).
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#define MAX_VARINT_BYTES 10		/* 64 bits in 7-bit groups */
+
+static inline int
+getVarIntFast(IOSTREAM *fd, uint64_t *vp)
+{
+#ifndef O_DEBUG
+  if ( fd->limitp - fd->bufp >= MAX_VARINT_BYTES )
+  { const unsigned char *p = (const unsigned char *)fd->bufp;
+    const unsigned char *e = p+MAX_VARINT_BYTES;
+    uint64_t v = 0;
+    int shift = 0;
+
+    while( p < e )
+    { unsigned int c = *p++;
+
+      v |= (uint64_t)(c&0x7f)<<shift;
+      if ( (c&0x80) )
+      { fd->bufp = (char *)p;
+	*vp = v;
+	return TRUE;
+      }
+      shift += 7;
+    }
+  }
+#endif
+
+  return FALSE;
+}
+
+
 static int64_t
 getInt64(IOSTREAM *fd)
-{ int c = Qgetc(fd);
+{ uint64_t v0;
+  int c;
+
+  if ( getVarIntFast(fd, &v0) )
+    return zigzag_decode(v0);
 
+  c = Qgetc(fd);
   if ( c&0x80 )
   { DEBUG(MSG_QLF_INTEGER, Sdprintf("%" PRId64 "\n", zigzag_decode(c&0x7f)));
     return zigzag_decode(c&0x7f);
@@ -595,8 +638,13 @@ getInt(IOSTREAM *fd)
 
 static unsigned int
 getUInt(IOSTREAM *fd)
-{ unsigned int c = Qgetc(fd);
+{ uint64_t v0;
+  unsigned int c;
+
+  if ( getVarIntFast(fd, &v0) )
+    return (unsigned int)v0;
 
+  c = Qgetc(fd);
   if ( c&0x80 )
   { DEBUG(MSG_QLF_INTEGER, Sdprintf("%d\n", c&0x7f));
     return c&0x7f;
@@ -959,12 +1007,29 @@ loadWicFromStream(const char *rcpath, IOSTREAM *fd)
 }
 
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+openQlfInput() opens a QLF file for loading. If possible, the file is
+mapped into memory such that  the  loader   reads  directly  from the
+file pages rather than copying the data through read().
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+static IOSTREAM *
+openQlfInput(const char *file)
+{ IOSTREAM *fd;
+
+  if ( (fd = Sopen_mapped_file(file)) )
+    return fd;
+
+  return Sopen_file(file, "rbr");
+}
+
+
 static int
 loadWicFile(const char *file)
 { IOSTREAM *fd;
   int rval;
 
-  if ( !(fd = Sopen_file(file, "rbr")) )
+  if ( !(fd = openQlfInput(file)) )
   { warning("Cannot open Quick Load File %s: %s", file, OsError());
     return FALSE;
   }
@@ -3551,6 +3616,27 @@ PRED_IMPL("$qlf_close", 0, qlf_close, 0)
 }
 
 
+/** '$qlf_open_input'(+File, -Stream) is det.
+
+Open File for loading using '$qlf_load'/2.
+*/
+
+static
+PRED_IMPL("$qlf_open_input", 2, qlf_open_input, 0)
+{ char *name;
+  IOSTREAM *s;
+
+  if ( !PL_get_file_name(A1, &name, 0) )
+    return FALSE;
+
+  if ( (s = openQlfInput(name)) )
+    return PL_unify_stream(A2, s);
+
+  return PL_error(NULL, 0, OsError(), ERR_FILE_OPERATION,
+		  ATOM_open, ATOM_source_sink, A1);
+}
+
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
 $qlf_load(:Stream, -ModuleOut)
 
@@ -4066,6 +4152,7 @@ wicPutStringW(const pl_wchar_t *w, size_t len, IOSTREAM *fd)
 BeginPredDefs(wic)
   PRED_DEF("$qlf_info",		    7, qlf_info,	     0)
   PRED_DEF("$qlf_sources",	    2, qlf_sources,	     0)
+  PRED_DEF("$qlf_open_input",	    2, qlf_open_input,	     0)
   PRED_DEF("$qlf_load",		    2, qlf_load,	     PL_FA_TRANSPARENT)
   PRED_DEF("$add_directive_wic",    1, add_directive_wic,    PL_FA_TRANSPARENT)
   PRED_DEF("$qlf_start_module",	    1, qlf_start_module,     0)
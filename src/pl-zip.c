@@ -1119,6 +1119,10 @@ PRED_IMPL("$rc_handle", 1, rc_handle, 0)
 typedef struct mapped_file
 { char *start;
   char *end;
+#ifdef HAVE_MMAP
+  int fd;					/* kept open, see Sopen_mapped_file() */
+  struct stat stat;				/* status when mapped */
+#endif
 #ifdef __WINDOWS__
   HANDLE hfile;					/* handle to the file */
   HANDLE hmap;					/* handle to the map */
@@ -1130,7 +1134,7 @@ typedef struct mapped_file
 #endif
 
 static mapped_file *
-map_file(const char *name)
+map_file(const char *name, int keep_open)
 { mapped_file *mf;
 
   if ( !(mf=malloc(sizeof(*mf))) )
@@ -1141,20 +1145,29 @@ map_file(const char *name)
   int fd;
 
   mf->start = MAP_FAILED;
+  mf->fd    = -1;
   if ( (fd = open(name, O_RDONLY)) >= 0 )
   { struct stat buf;
 
-    if ( fstat(fd, &buf) == 0 )
+    if ( fstat(fd, &buf) == 0 &&
+	 S_ISREG(buf.st_mode) &&
+	 buf.st_size > 0 &&
+	 (uint64_t)buf.st_size <= (uint64_t)LONG_MAX &&
+	 (uint64_t)buf.st_size <= (uint64_t)SIZE_MAX )
     { mf->start = mmap(NULL,
 		       buf.st_size,
 		       PROT_READ,
 		       MAP_SHARED,
 		       fd,
 		       0);
-      mf->end = mf->start + buf.st_size;
+      mf->end  = mf->start + buf.st_size;
+      mf->stat = buf;
     }
 
-    close(fd);
+    if ( keep_open && mf->start != MAP_FAILED )
+      mf->fd = fd;
+    else
+      close(fd);
   }
 
   if ( mf->start == MAP_FAILED )
@@ -1168,6 +1181,8 @@ map_file(const char *name)
   DWORD fsize;
   wchar_t buf[PATH_MAX];
 
+  (void)keep_open;			/* FILE_SHARE_READ blocks writers */
+
   if ( !_xos_os_filenameW(name, buf, PATH_MAX) )
     goto errio;
   mf->hfile = CreateFileW(buf,
@@ -1222,6 +1237,8 @@ unmap_file(mapped_file *mf)
 #ifdef HAVE_MMAP
   if ( mf->start )
     munmap(mf->start, mf->end - mf->start);
+  if ( mf->fd >= 0 )
+    close(mf->fd);
 #endif
 #ifdef __WINDOWS__
   if ( mf->start )
@@ -1235,6 +1252,131 @@ unmap_file(mapped_file *mf)
   free(mf);
 }
 
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+Sopen_mapped_file() opens a file for  binary   input  by mapping it into
+memory. The mapping is used as the stream  buffer, so reading does not
+copy the data. Returns NULL if the  file   cannot  be mapped, in which
+case the caller should use Sopen_file().
+
+The mapping is read-only. This  is  fine   for  the  QLF loader, but
+Sungetc() and friends may not be used on these streams.
+
+Accessing a mapped page after the file  has been truncated raises SIGBUS
+and a file that is modified  in  place   changes  the  data  under the
+reader. We therefore only map files that have not been modified for
+MAP_SETTLE_SECONDS and  whose  size  and   modification  time  did  not
+change while mapping. Other files are read  using read(). As writing
+the file updates its modification time, the stream  checks the file
+again when the data is exhausted and  when   it  is closed and reports
+an I/O error if the file was changed.
+- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - */
+
+#ifdef HAVE_MMAP
+
+#define MAP_SETTLE_SECONDS 2
+
+static int
+mapped_file_unchanged(const mapped_file *mf)
+{ struct stat buf;
+
+  return ( fstat(mf->fd, &buf) == 0 &&
+	   buf.st_size  == mf->stat.st_size &&
+	   buf.st_mtime == mf->stat.st_mtime );
+}
+
+static int
+mapped_file_settled(const mapped_file *mf)
+{ return ( mapped_file_unchanged(mf) &&
+	   time(NULL) - mf->stat.st_mtime >= MAP_SETTLE_SECONDS );
+}
+
+#else /*HAVE_MMAP*/
+
+#define mapped_file_unchanged(mf) TRUE
+#define mapped_file_settled(mf)   TRUE
+
+#endif /*HAVE_MMAP*/
+
+static ssize_t
+Sread_mapped(void *handle, char *buf, size_t size)
+{ mapped_file *mf = handle;
+
+  (void)buf;
+  (void)size;
+
+  if ( !mapped_file_unchanged(mf) )
+  { errno = EIO;
+    return -1;
+  }
+
+  return 0;				/* all data is in the buffer */
+}
+
+static long
+Sseek_mapped(void *handle, long offset, int whence)
+{ mapped_file *mf = handle;
+
+  if ( offset == 0 && whence == SIO_SEEK_CUR )
+    return (long)(mf->end - mf->start);	/* for Stell() */
+
+  errno = ESPIPE;
+  return -1;
+}
+
+static int
+Sclose_mapped(void *handle)
+{ mapped_file *mf = handle;
+  int changed = !mapped_file_unchanged(mf);
+
+  unmap_file(mf);
+  if ( changed )
+  { errno = EIO;
+    return -1;
+  }
+
+  return 0;
+}
+
+static IOFUNCTIONS Smappedfunctions =
+{ Sread_mapped,
+  NULL,
+  Sseek_mapped,
+  Sclose_mapped
+};
+
+IOSTREAM *
+Sopen_mapped_file(const char *name)
+{ mapped_file *mf;
+  IOSTREAM *s;
+
+  if ( !(mf=map_file(name, TRUE)) )
+    return NULL;
+  if ( mf->end == mf->start ||
+       !mapped_file_settled(mf) ||
+       !(s=Snew(mf, SIO_INPUT|SIO_FBUF|SIO_USERBUF, &Smappedfunctions)) )
+  { unmap_file(mf);
+    return NULL;
+  }
+
+  s->buffer   = mf->start;
+  s->unbuffer = mf->start;
+  s->bufp     = mf->start;
+  s->limitp   = mf->end;
+  s->bufsize  = mf->end - mf->start;
+
+  return s;
+}
+
+#else /*HAVE_FILE_MAPPING*/
+
+IOSTREAM *
+Sopen_mapped_file(const char *name)
+{ (void)name;
+
+  return NULL;
+}
+
 #endif /*HAVE_FILE_MAPPING*/
 
 		 /*******************************
@@ -1256,7 +1398,7 @@ zip_open_archive(const char *file, int flags)
 
     DEBUG(MSG_ZIP, Sdprintf("Opening %s using file mapping\n", file));
 
-    if ( (mf=map_file(file)) )
+    if ( (mf=map_file(file, FALSE)) )
     { if ( !(r=zip_open_archive_mem((const unsigned char *)mf->start,
 				    mf->end-mf->start, flags)) )
 	unmap_file(mf);
@@ -95,5 +95,6 @@ COMMON(int)		zip_close_archive(zipper *z);
 COMMON(IOSTREAM *)	SopenZIP(zipper *z, const char *name, int flags);
 COMMON(char *)		rc_strerror(int);
 COMMON(const char *)    zipper_file(const zipper *z);
+COMMON(IOSTREAM *)	Sopen_mapped_file(const char *name);
 
 #endif /*H_PLZIP_INCLUDED*/